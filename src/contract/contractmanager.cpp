@@ -12,6 +12,7 @@ See the LICENSE.txt file in the project root for more information.
 #include "customcontracts.h"
 #include "../core/rdpos.h"
 #include "../core/state.h"
+#include "../utils/tracer.h"
 
 ContractManager::ContractManager(
   const std::unique_ptr<DB>& db, State* state,
@@ -94,6 +95,7 @@ const Bytes ContractManager::ethCallView(const ethCallInfo& data) const {
 }
 
 void ContractManager::callContract(const TxBlock& tx, const Hash& blockHash, const uint64_t& txIndex) {
+  TraceSpan span("ContractManager::callContract");
   this->callLogger_ = std::make_unique<ContractCallLogger>(*this);
   auto callInfo = tx.txToCallInfo();
   const auto& [from, to, gasLimit, gasPrice, value, functor, data] = callInfo;
@@ -247,12 +249,23 @@ const std::vector<Event> ContractManager::getEvents(
   return this->eventManager_->getEvents(fromBlock, toBlock, address, topics);
 }
 
+const std::vector<Event> ContractManager::getEvents(
+  const uint64_t& fromBlock, const uint64_t& toBlock, const Address& address,
+  const std::function<bool(const Event&)>& matches, const uint64_t& maxEvents
+) const {
+  return this->eventManager_->getEvents(fromBlock, toBlock, address, matches, maxEvents);
+}
+
 const std::vector<Event> ContractManager::getEvents(
   const Hash& txHash, const uint64_t& blockIndex, const uint64_t& txIndex
 ) const {
   return this->eventManager_->getEvents(txHash, blockIndex, txIndex);
 }
 
+std::vector<Event> ContractManager::takeCommittedEvents() {
+  return this->eventManager_->takeCommittedEvents();
+}
+
 void ContractManager::updateContractGlobals(
   const Address& coinbase, const Hash& blockHash,
   const uint64_t& blockHeight, const uint64_t& blockTimestamp
@@ -252,6 +252,20 @@ class ContractManager : public BaseContract {
       const Address& address = Address(), const std::vector<Hash>& topics = {}
     ) const;
 
+    /**
+     * Overload of getEvents() with custom criteria, checked before the log cap is applied.
+     * @param fromBlock The initial block height to look for.
+     * @param toBlock The final block height to look for.
+     * @param address The address to look for, to narrow down the search. Empty for all available addresses.
+     * @param matches Function that tells if an event matches the criteria.
+     * @param maxEvents The maximum number of events to return.
+     * @return A list of matching events, up to `maxEvents`.
+     */
+    const std::vector<Event> getEvents(
+      const uint64_t& fromBlock, const uint64_t& toBlock, const Address& address,
+      const std::function<bool(const Event&)>& matches, const uint64_t& maxEvents
+    ) const;
+
     /**
      * Overload of getEvents() for transaction receipts.
      * @param txHash The hash of the transaction to look for events.
@@ -263,6 +277,13 @@ class ContractManager : public BaseContract {
       const Hash& txHash, const uint64_t& blockIndex, const uint64_t& txIndex
     ) const;
 
+    /**
+     * Take the events committed since the last call.
+     * Used by the State to notify subscribers about the events of each new block.
+     * @return The committed events, in commit order.
+     */
+    std::vector<Event> takeCommittedEvents();
+
     /**
      * Update the ContractGlobals variables
      * Used by the State (when processing a block) to update the variables.
@@ -518,7 +518,7 @@ class DynamicContract : public BaseContract {
     template<typename TContract, typename... Args> Address callCreateContract(
       const uint256_t& gas, const uint256_t& gasPrice, const uint256_t& value, Args&&... args
     ) {
-      Utils::safePrint("CallCreateContract being called...");
+      LOGTRACE(Log::dynamicContract, "Creating a contract");
       Bytes encoder;
       if constexpr (sizeof...(Args) > 0) {
         encoder = ABI::Encoder::encodeData(std::forward<Args>(args)...);
@@ -90,6 +90,15 @@ EventManager::~EventManager() {
 const std::vector<Event> EventManager::getEvents(
   const uint64_t& fromBlock, const uint64_t& toBlock,
   const Address& address, const std::vector<Hash>& topics
+) const {
+  return this->getEvents(fromBlock, toBlock, address,
+    [this, &topics](const Event& e) { return this->matchTopics(e, topics); }, this->options_->getEventLogCap()
+  );
+}
+
+const std::vector<Event> EventManager::getEvents(
+  const uint64_t& fromBlock, const uint64_t& toBlock, const Address& address,
+  const std::function<bool(const Event&)>& matches, const uint64_t& maxEvents
 ) const {
   std::vector<Event> ret;
   // Check if block range is within limits
@@ -98,17 +107,15 @@ const std::vector<Event> EventManager::getEvents(
     "Block range too large for event querying! Max allowed is " +
     std::to_string(this->options_->getEventBlockCap())
   );
-  // Fetch from memory, then match topics from memory
+  // Fetch from memory, then match the criteria from memory
   for (const Event& e : this->filterFromMemory(fromBlock, toBlock, address)) {
-    if (this->matchTopics(e, topics) && ret.size() < this->options_->getEventLogCap()) {
-      ret.push_back(e);
-    }
+    if (ret.size() >= maxEvents) return ret;
+    if (matches(e)) ret.push_back(e);
   }
-  if (ret.size() >= this->options_->getEventLogCap()) return ret;
+  if (ret.size() >= maxEvents) return ret;
   // Fetch from database if we have space left
-  for (const Event& e : this->filterFromDB(fromBlock, toBlock, address, topics)) {
-    if (ret.size() >= this->options_->getEventLogCap()) break;
-    ret.push_back(std::move(e));
+  for (const Event& e : this->filterFromDB(fromBlock, toBlock, address, matches, maxEvents - ret.size())) {
+    ret.push_back(e);
   }
   return ret;
 }
@@ -159,8 +166,8 @@ const std::vector<Event> EventManager::filterFromMemory(
 }
 
 const std::vector<Event> EventManager::filterFromDB(
-  const uint64_t& fromBlock, const uint64_t& toBlock,
-  const Address& address, const std::vector<Hash>& topics
+  const uint64_t& fromBlock, const uint64_t& toBlock, const Address& address,
+  const std::function<bool(const Event&)>& matches, const uint64_t& maxEvents
 ) const {
   // Filter by block range
   std::vector<Event> ret;
@@ -182,9 +189,9 @@ const std::vector<Event> EventManager::filterFromDB(
 
   // Get the key values
   for (DBEntry item : this->db_->getBatch(DBPrefix::events, dbKeys)) {
-    if (ret.size() >= this->options_->getEventLogCap()) break;
+    if (ret.size() >= maxEvents) break;
     Event e(Utils::bytesToString(item.value));
-    if (this->matchTopics(e, topics)) ret.push_back(e);
+    if (matches(e)) ret.push_back(e);
   }
   return ret;
 }
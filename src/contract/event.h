@@ -9,6 +9,7 @@ See the LICENSE.txt file in the project root for more information.
 #define EVENT_H
 
 #include <algorithm>
+#include <functional>
 #include <shared_mutex>
 #include <source_location>
 #include <string>
@@ -18,6 +19,7 @@ See the LICENSE.txt file in the project root for more information.
 #include "../utils/db.h"
 #include "../utils/options.h"
 #include "../utils/strings.h"
+#include "../utils/tracer.h"
 #include "../utils/utils.h"
 
 #include "abi.h"
@@ -191,6 +193,7 @@ class EventManager {
     // TODO: keep up to 1000 (maybe 10000? 100000? 1M seems too much) events in memory, dump older ones to DB (this includes checking save/load - maybe this should be a deque?)
     EventContainer events_;                   ///< List of all emitted events in memory. Older ones FIRST, newer ones LAST.
     EventContainer tempEvents_;               ///< List of temporary events waiting to be commited or reverted.
+    std::vector<Event> committedEvents_;      ///< Events committed since the last takeCommittedEvents() call, for subscribers.
     const std::unique_ptr<DB>& db_;           ///< Reference pointer to the database.
     const std::unique_ptr<Options>& options_; ///< Reference pointer to the Options singleton.
     mutable std::shared_mutex lock_;          ///< Mutex for managing read/write access to the permanent events vector.
@@ -224,6 +227,22 @@ class EventManager {
       const Address& address = Address(), const std::vector<Hash>& topics = {}
     ) const;
 
+    /**
+     * Overload of getEvents() with custom criteria, checked before the log cap is applied.
+     * Used by "eth_getFilterLogs", whose criteria may have several addresses and topic alternatives.
+     * @param fromBlock The initial block height to look for.
+     * @param toBlock The final block height to look for.
+     * @param address The address to look for, to narrow down the search. Empty for all available addresses.
+     * @param matches Function that tells if an event matches the criteria.
+     * @param maxEvents The maximum number of events to return.
+     * @return A list of matching events, up to `maxEvents`.
+     * @throw std::out_of_range if specified block range exceeds the limit set in Options.
+     */
+    const std::vector<Event> getEvents(
+      const uint64_t& fromBlock, const uint64_t& toBlock, const Address& address,
+      const std::function<bool(const Event&)>& matches, const uint64_t& maxEvents
+    ) const;
+
     /**
      * Overload of getEvents() used by "eth_getTransactionReceipts", where
      * parameters are filtered differently (by exact tx, not a range).
@@ -251,13 +270,14 @@ class EventManager {
      * Filter events in the database. Used by getEvents().
      * @param fromBlock The starting block range to query.
      * @param toBlock Tne ending block range to query.
-     * @param address The address to look for. Defaults to empty (look for all available addresses).
-     * @param topics The topics to filter by. Defaults to empty (look for all available topics).
+     * @param address The address to look for. Empty for all available addresses.
+     * @param matches Function that tells if an event matches the criteria.
+     * @param maxEvents The maximum number of events to return.
      * @return A list of found events.
      */
     const std::vector<Event> filterFromDB(
-      const uint64_t& fromBlock, const uint64_t& toBlock,
-      const Address& address = Address(), const std::vector<Hash>& topics = {}
+      const uint64_t& fromBlock, const uint64_t& toBlock, const Address& address,
+      const std::function<bool(const Event&)>& matches, const uint64_t& maxEvents
     ) const;
 
     /**
@@ -285,6 +305,8 @@ class EventManager {
      * @param txIndex The index of the transaction inside the block that emitted the events.
      */
     void commitEvents(const Hash& txHash, const uint64_t txIndex) {
+      TraceSpan span("EventManager::commitEvents");
+      span.attr("events", this->tempEvents_.size());
       uint64_t logIndex = 0;
       auto it = tempEvents_.begin(); // Use iterators to loop through the MultiIndex container
       while (it != tempEvents_.end()) {
@@ -293,6 +315,7 @@ class EventManager {
         e.setStateData(logIndex, txHash, txIndex,
           ContractGlobals::getBlockHash(), ContractGlobals::getBlockHeight()
         );                            // ...modify it...
+        committedEvents_.push_back(e); // ...keep a copy for subscribers...
         events_.insert(std::move(e)); // ...move it to the permanent container...
         it = tempEvents_.erase(it);   // ...erase the original from the temp...
         logIndex++;                   // ...and move on to the next
@@ -301,6 +324,17 @@ class EventManager {
 
     /// Discard events in the temporary list.
     void revertEvents() { this->tempEvents_.clear(); }
+
+    /**
+     * Take the events committed since the last call (used by State to notify subscribers
+     * about the events of each new block).
+     * @return The committed events, in commit order.
+     */
+    std::vector<Event> takeCommittedEvents() {
+      std::vector<Event> events;
+      events.swap(this->committedEvents_);
+      return events;
+    }
 };
 
 #endif  // EVENT_H
@@ -104,9 +104,9 @@ Address DEXV2Factory::createPair(const Address& tokenA, const Address& tokenB) {
   auto& token1 = (tokenA < tokenB) ? tokenB : tokenA;
   if (token0 == Address()) throw std::runtime_error("DEXV2Factory::createPair: ZERO_ADDRESS");
   if (this->getPair(token0, token1) != Address()) throw std::runtime_error("DEXV2Factory::createPair: PAIR_EXISTS");
-  Utils::safePrint("DEXV2Factory: creating pair...");
+  LOGTRACE(Log::dexV2Factory, "Creating pair");
   auto pair = this->callCreateContract<DEXV2Pair>(0, 0, 0);
-  Utils::safePrint("DEXV2Factory: pair created...");
+  LOGTRACE(Log::dexV2Factory, "Pair created");
   this->callContractFunction(pair, &DEXV2Pair::initialize, token0, token1);
   getPair_[token0][token1] = pair;
   getPair_[token1][token0] = pair;
@@ -78,12 +78,12 @@ std::pair<uint256_t, uint256_t> DEXV2Router02::_addLiquidity(
     this->factory_.get(), &DEXV2Factory::getPair, tokenA, tokenB
   );
   if (!pairAddress) {
-    Utils::safePrint("_addLiquidity: contract doesn't exist!");
+    LOGTRACE(Log::dexV2Router, "Pair doesn't exist, creating it");
     pairAddress = this->callContractFunction(
       this->factory_.get(), &DEXV2Factory::createPair, tokenA, tokenB
     );
   } else {
-    Utils::safePrint("_addLiquidity: contract exists!");
+    LOGTRACE(Log::dexV2Router, "Pair exists");
   }
   auto reserves = this->callContractViewFunction(pairAddress.get(), &DEXV2Pair::getReservess);
   const auto& [reserveA, reserveB] = reserves;
@@ -7,8 +7,22 @@ See the LICENSE.txt file in the project root for more information.
 
 #include "blockchain.h"
 
+/**
+ * Load the options of a blockchain and apply their log levels, before any other component logs.
+ * @param blockchainPath Path to the blockchain's root folder.
+ * @return The options.
+ */
+static std::unique_ptr<Options> loadOptions(const std::string& blockchainPath) {
+  auto options = std::make_unique<Options>(Options::fromFile(blockchainPath));
+  const LogOptions& log = options->getLogOptions();
+  Logger::clearComponentLevels();
+  Logger::setLogLevel(log.logLevel);
+  for (const auto& [component, level] : log.componentLevels) Logger::setLogLevel(component, level);
+  return options;
+}
+
 Blockchain::Blockchain(const std::string& blockchainPath) :
-  options_(std::make_unique<Options>(Options::fromFile(blockchainPath))),
+  options_(loadOptions(blockchainPath)),
   db_(std::make_unique<DB>(blockchainPath + "/database")),
   storage_(std::make_unique<Storage>(db_, options_)),
   rdpos_(std::make_unique<rdPoS>(db_, storage_, p2p_, options_, state_)),
@@ -26,84 +40,102 @@ const std::atomic<bool>& Blockchain::isSynced() const { return this->syncer_->is
 
 void Syncer::updateCurrentlyConnectedNodes() {
   // Get the list of currently connected nodes
-  std::vector<P2P::NodeID> connectedNodes = blockchain_.p2p_->getSessionsIDs();
-  while (connectedNodes.size() < blockchain_.p2p_->minConnections() && !this->stopSyncer_) {
-    Logger::logToDebug(LogType::INFO, Log::syncer, __func__,
+  // If we have less than the minimum number of connections,
+  // wait for discoveryWorker to kick in and connect to more nodes
+  EventSignal& sessionsSignal = blockchain_.p2p_->sessionsSignal();
+  std::vector<P2P::NodeID> connectedNodes;
+  while (true) {
+    uint64_t seen = sessionsSignal.sequence();
+    if (this->stopSyncer_) break;
+    connectedNodes = blockchain_.p2p_->getSessionsIDs();
+    if (connectedNodes.size() >= blockchain_.p2p_->minConnections()) break;
+    LOGINFO(Log::syncer,
       "Waiting for discoveryWorker to connect to more nodes, currently connected to: "
       + std::to_string(connectedNodes.size())
     );
-    // If we have less than the minimum number of connections,
-    // wait for a bit for discoveryWorker to kick in and connect to more nodes
-    std::this_thread::sleep_for(std::chrono::seconds(1));
-    connectedNodes = blockchain_.p2p_->getSessionsIDs();
-  }
-
-  // Update information of already connected nodes
-  for (const auto& [nodeId, nodeInfo] : this->currentlyConnectedNodes_) {
-    // If node is not connected, remove it from the list
-    if (std::find(connectedNodes.begin(), connectedNodes.end(), nodeId) == connectedNodes.end()) {
-      this->currentlyConnectedNodes_.erase(nodeId);
-      continue;
-    }
-    // If node is connected, update its information
-    auto newNodeInfo = blockchain_.p2p_->requestNodeInfo(nodeId);
-    // If node is not responding, remove it from the list
-    if (newNodeInfo == P2P::NodeInfo()) {
-      this->currentlyConnectedNodes_.erase(nodeId);
-      continue;
-    }
-    // If node is responding, update its information
-    this->currentlyConnectedNodes_[nodeId] = newNodeInfo;
+    sessionsSignal.wait(seen);
   }
 
-  // Add new nodes to the list
-  for (const auto& nodeId : connectedNodes) {
-    if (!this->currentlyConnectedNodes_.contains(nodeId)) {
-      auto newNodeInfo = blockchain_.p2p_->requestNodeInfo(nodeId);
-      if (newNodeInfo != P2P::NodeInfo()) {
-        this->currentlyConnectedNodes_[nodeId] = newNodeInfo;
-      }
+  // Ask all connected nodes for their info at once, and replace the list with the nodes that answered.
+  // Nodes that disconnected or are not responding are left out.
+  std::unordered_map<P2P::NodeID, P2P::NodeInfo, SafeHash> updatedNodes;
+  blockchain_.p2p_->requestNodeInfoFromAll(connectedNodes,
+    [&](const P2P::NodeID& nodeId, const P2P::NodeInfo& nodeInfo) {
+      if (nodeInfo != P2P::NodeInfo()) updatedNodes[nodeId] = nodeInfo;
     }
-  }
+  );
+  this->currentlyConnectedNodes_ = std::move(updatedNodes);
 }
 
 bool Syncer::checkLatestBlock() { return (this->latestBlock_ != this->blockchain_.storage_->latest()); }
 
 void Syncer::doSync() {
-  // TODO: Fully implement Sync
   this->latestBlock_ = blockchain_.storage_->latest();
-  // Get the list of currently connected nodes and their current height
-  this->updateCurrentlyConnectedNodes();
-  std::pair<P2P::NodeID, uint64_t> highestNode = {P2P::NodeID(), 0};
-
-  // Get the highest node.
-  for (auto& [nodeId, nodeInfo] : this->currentlyConnectedNodes_) {
-    if (nodeInfo.latestBlockHeight > highestNode.second) {
-      highestNode = {nodeId, nodeInfo.latestBlockHeight};
+  // Keep syncing until no node is ahead of us, or a round makes no progress
+  // (e.g. every node that is ahead is unreachable or misbehaving).
+  while (!this->stopSyncer_) {
+    // Get the list of currently connected nodes and their current height
+    this->updateCurrentlyConnectedNodes();
+    uint64_t highestHeight = 0;
+    for (auto& [nodeId, nodeInfo] : this->currentlyConnectedNodes_) {
+      highestHeight = std::max(highestHeight, nodeInfo.latestBlockHeight);
     }
-  }
-
-  // Sync from the best node.
-  if (highestNode.second > this->latestBlock_->getNHeight()) {
-    // TODO: currently we are starting all the nodes from genesis (0)
+    if (highestHeight <= blockchain_.storage_->latest()->getNHeight()) break;
+    if (this->syncEngine_.sync(this->currentlyConnectedNodes_, this->stopSyncer_) == 0) break;
   }
 
   this->latestBlock_ = blockchain_.storage_->latest();
   this->synced_ = true;
 }
 
-void Syncer::doValidatorBlock() {
-  // TODO: Improve this somehow.
-  // Wait until we have enough transactions in the rdpos mempool.
-  while (this->blockchain_.rdpos_->getMempool().size() < rdPoS::minValidators * 2) {
-    if (this->stopSyncer_) return;
-    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+std::optional<Block> Syncer::draftBlock(const std::shared_ptr<const Block> latestBlock) {
+  // Wait until the block building policy allows building the block.
+  const BlockBuilderOptions& builder = this->blockchain_.options_->getBlockBuilderOptions();
+  const auto roundStart = std::chrono::steady_clock::now();
+  EventSignal& mempoolSignal = this->blockchain_.state_->mempoolSignal();
+  while (true) {
+    uint64_t seen = mempoolSignal.sequence();
+    if (this->stopSyncer_) return std::nullopt;
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - roundStart);
+    size_t mempoolSize = this->blockchain_.state_->getMempoolSize();
+    std::optional<std::chrono::milliseconds> deadline;
+    if (elapsed < builder.minBlockInterval) {
+      deadline = builder.minBlockInterval;
+    } else if (mempoolSize >= builder.maxBlockTxs) {
+      break;  // Enough transactions to fill a block.
+    } else if (mempoolSize > 0 && elapsed >= builder.targetBlockInterval) {
+      break;  // Enough time to gather transactions.
+    } else if (builder.maxBlockInterval.count() > 0 && elapsed >= builder.maxBlockInterval) {
+      break;  // Waited too long, build the block even if it ends up empty.
+    } else if (mempoolSize > 0) {
+      deadline = builder.targetBlockInterval;
+    } else if (builder.maxBlockInterval.count() > 0) {
+      deadline = builder.maxBlockInterval;
+    }
+    if (deadline) {
+      mempoolSignal.waitFor(seen, *deadline - elapsed);
+    } else {
+      mempoolSignal.wait(seen);
+    }
   }
 
-  // Wait until we have at least one transaction in the state mempool.
-  while (this->blockchain_.state_->getMempoolSize() < 1) {
+  // The mempool was refreshed against the state after the latest block, so its transactions are valid for the next one.
+  Block block(latestBlock->hash(), latestBlock->getTimestamp(), latestBlock->getNHeight() + 1);
+  this->blockchain_.state_->fillBlockWithTransactions(block);
+  return block;
+}
+
+void Syncer::doValidatorBlock() {
+  // Select the block transactions while the randomness round is still running.
+  auto draft = std::async(std::launch::async, &Syncer::draftBlock, this, this->blockchain_.storage_->latest());
+
+  // Wait until we have enough transactions in the rdpos mempool.
+  EventSignal& validatorMempoolSignal = this->blockchain_.rdpos_->mempoolSignal();
+  while (true) {
+    uint64_t seen = validatorMempoolSignal.sequence();
     if (this->stopSyncer_) return;
-    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    if (this->blockchain_.rdpos_->getMempool().size() >= rdPoS::minValidators * 2) break;
+    validatorMempoolSignal.wait(seen);
   }
 
   // Create the block.
@@ -112,13 +144,16 @@ void Syncer::doValidatorBlock() {
   auto randomList = this->blockchain_.rdpos_->getRandomList();
 
   // Order the transactions in the proper manner.
+  // Selectors of the randomHash and random (seed) transactions, see rdPoS::getTxValidatorFunction().
+  constexpr Functor randomHashHash(Bytes{0xcf, 0xff, 0xe7, 0x46});
+  constexpr Functor randomSeedHash(Bytes{0x6f, 0xc5, 0xa2, 0xd6});
   std::vector<TxValidator> randomHashTxs;
   std::vector<TxValidator> randomnessTxs;
   uint64_t i = 1;
   while (randomHashTxs.size() != rdPoS::minValidators) {
     for (const auto& [txHash, tx] : mempool) {
       if (this->stopSyncer_) return;
-      if (tx.getFrom() == randomList[i] && tx.getFunctor() == Hex::toBytes("0xcfffe746")) {
+      if (tx.getFrom() == randomList[i] && tx.getFunctor() == randomHashHash) {
         randomHashTxs.emplace_back(tx);
         i++;
         break;
@@ -128,7 +163,7 @@ void Syncer::doValidatorBlock() {
   i = 1;
   while (randomnessTxs.size() != rdPoS::minValidators) {
     for (const auto& [txHash, tx] : mempool) {
-      if (tx.getFrom() == randomList[i] && tx.getFunctor() == Hex::toBytes("0x6fc5a2d6")) {
+      if (tx.getFrom() == randomList[i] && tx.getFunctor() == randomSeedHash) {
         randomnessTxs.emplace_back(tx);
         i++;
         break;
@@ -137,25 +172,23 @@ void Syncer::doValidatorBlock() {
   }
   if (this->stopSyncer_) return;
 
-  // Create the block and append to all chains, we can use any storage for latest block.
-  const std::shared_ptr<const Block> latestBlock = this->blockchain_.storage_->latest();
-  Block block(latestBlock->hash(), latestBlock->getTimestamp(), latestBlock->getNHeight() + 1);
-
-  // Append transactions towards block.
+  // Append the Validator transactions to the drafted block.
+  std::optional<Block> drafted = draft.get();
+  if (!drafted || this->stopSyncer_) return;
+  Block block = std::move(*drafted);
   for (const auto& tx: randomHashTxs) block.appendTxValidator(tx);
   for (const auto& tx: randomnessTxs) block.appendTxValidator(tx);
-  if (this->stopSyncer_) return;
 
-  // Add transactions from state, sign, validate and process the block.
-  this->blockchain_.state_->fillBlockWithTransactions(block);
+  // Sign and process the block. processNextBlock() validates it, so there is no need to do it beforehand.
   this->blockchain_.rdpos_->signBlock(block);
-  if (!this->blockchain_.state_->validateNextBlock(block)) {
-    Logger::logToDebug(LogType::ERROR, Log::syncer, __func__, "Block is not valid!");
-    throw std::runtime_error("Block is not valid!");
-  }
   if (this->stopSyncer_) return;
   Hash latestBlockHash = block.hash();
-  this->blockchain_.state_->processNextBlock(std::move(block));
+  try {
+    this->blockchain_.state_->processNextBlock(std::move(block));
+  } catch (std::exception& e) {
+    Logger::logToDebug(LogType::ERROR, Log::syncer, __func__, std::string("Block is not valid! ") + e.what());
+    throw std::runtime_error("Block is not valid!");
+  }
   if (this->blockchain_.storage_->latest()->hash() != latestBlockHash) {
     Logger::logToDebug(LogType::ERROR, Log::syncer, __func__, "Block is not valid!");
     throw std::runtime_error("Block is not valid!");
@@ -171,7 +204,7 @@ void Syncer::doValidatorTx() const {
 }
 
 void Syncer::validatorLoop() {
-  Logger::logToDebug(LogType::INFO, Log::syncer, __func__, "Starting validator loop.");
+  LOGINFO(Log::syncer, "Starting validator loop.");
   Validator me(Secp256k1::toAddress(Secp256k1::toUPub(this->blockchain_.options_->getValidatorPrivKey())));
   this->blockchain_.rdpos_->startrdPoSWorker();
   while (!this->stopSyncer_) {
@@ -187,21 +220,30 @@ void Syncer::validatorLoop() {
     if (this->stopSyncer_) return;
     if (!isBlockCreator) this->doValidatorTx();
 
-    while (!this->checkLatestBlock() && !this->stopSyncer_) {
-      // Wait for next block to be created.
-      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    // Wait for next block to be created.
+    EventSignal& newBlockSignal = this->blockchain_.storage_->newBlockSignal();
+    while (true) {
+      uint64_t seen = newBlockSignal.sequence();
+      if (this->stopSyncer_) return;
+      if (this->checkLatestBlock()) break;
+      newBlockSignal.wait(seen);
     }
   }
 }
 
 void Syncer::nonValidatorLoop() const {
-  // TODO: Improve tx broadcasting and syncing
-  while (!this->stopSyncer_) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  // Blocks and transactions are relayed by P2P, so there is nothing to do until the syncer is stopped.
+  EventSignal& newBlockSignal = this->blockchain_.storage_->newBlockSignal();
+  while (true) {
+    uint64_t seen = newBlockSignal.sequence();
+    if (this->stopSyncer_) return;
+    newBlockSignal.wait(seen);
+  }
 }
 
 bool Syncer::syncerLoop() {
   Utils::safePrint("Starting OrbiterSDK Node...");
-  Logger::logToDebug(LogType::INFO, Log::syncer, __func__, "Starting syncer loop.");
+  LOGINFO(Log::syncer, "Starting syncer loop.");
   // Connect to all seed nodes from the config and start the discoveryThread.
   auto discoveryNodeList = this->blockchain_.options_->getDiscoveryNodes();
   for (const auto &[ipAddress, port]: discoveryNodeList) {
@@ -231,6 +273,11 @@ void Syncer::start() {
 
 void Syncer::stop() {
   this->stopSyncer_ = true;
+  // Wake up the syncer loop if it's waiting for an event.
+  this->blockchain_.p2p_->sessionsSignal().notify();
+  this->blockchain_.rdpos_->mempoolSignal().notify();
+  this->blockchain_.state_->mempoolSignal().notify();
+  this->blockchain_.storage_->newBlockSignal().notify();
   this->blockchain_.rdpos_->stoprdPoSWorker(); // Stop the rdPoS worker.
   if (this->syncerLoopFuture_.valid()) this->syncerLoopFuture_.wait();
 }
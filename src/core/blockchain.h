@@ -11,6 +11,7 @@ See the LICENSE.txt file in the project root for more information.
 #include "storage.h"
 #include "rdpos.h"
 #include "state.h"
+#include "syncengine.h"
 #include "../net/p2p/managerbase.h"
 #include "../net/http/httpserver.h"
 #include "../utils/options.h"
@@ -110,20 +111,35 @@ class Syncer {
     /// Pointer to the blockchain's latest block.
     std::shared_ptr<const Block> latestBlock_;
 
+    /// Engine for syncing blocks from other nodes.
+    SyncEngine syncEngine_;
+
     /// Update `currentlyConnectedNodes`.
     void updateCurrentlyConnectedNodes();
 
     /// Check latest block (used by validatorLoop()).
     bool checkLatestBlock();
 
-    /// Do the syncing.
+    /// Sync with the network until no connected node is ahead of us.
     void doSync();
 
+    /**
+     * Draft the next block with transactions from the state mempool, once the
+     * block building policy in `Options::getBlockBuilderOptions()` allows it
+     * (called by doValidatorBlock()).
+     * @param latestBlock The latest block, which the draft is built on.
+     * @return The drafted block, without Validator transactions, or an empty optional if the syncer was stopped.
+     */
+    std::optional<Block> draftBlock(const std::shared_ptr<const Block> latestBlock);
+
     /**
      * Create and broadcast a Validator block (called by validatorLoop()).
      * If the node is a Validator and it has to create a new block,
      * this function will be called, the new block will be created based on the
      * current State and rdPoS objects, and then it will be broadcasted.
+     * The block transactions are selected in a separate thread while the
+     * randomness round runs, so only appending the Validator transactions,
+     * signing and processing are left once it completes.
      * @throw std::runtime_error if block is invalid.
      */
     void doValidatorBlock();
@@ -158,7 +174,8 @@ class Syncer {
      * Constructor.
      * @param blockchain Reference to the parent blockchain.
      */
-    explicit Syncer(Blockchain& blockchain) : blockchain_(blockchain) {};
+    explicit Syncer(Blockchain& blockchain) : blockchain_(blockchain),
+      syncEngine_(blockchain.p2p_, blockchain.storage_, blockchain.state_) {};
 
     /**
      * Destructor.
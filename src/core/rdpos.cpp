@@ -10,6 +10,7 @@ See the LICENSE.txt file in the project root for more information.
 #include "state.h"
 #include "../contract/contractmanager.h"
 #include "../utils/block.h"
+#include "../utils/tracer.h"
 
 rdPoS::rdPoS(const std::unique_ptr<DB>& db,
   const std::unique_ptr<Storage>& storage,
@@ -28,7 +29,7 @@ rdPoS::rdPoS(const std::unique_ptr<DB>& db,
 {
   // Initialize blockchain.
   std::unique_lock lock(this->mutex_);
-  Logger::logToDebug(LogType::INFO, Log::rdPoS, __func__, "Initializing rdPoS.");
+  LOGINFO(Log::rdPoS, "Initializing rdPoS.");
   initializeBlockchain();
 
   /**
@@ -43,7 +44,7 @@ rdPoS::rdPoS(const std::unique_ptr<DB>& db,
     Logger::logToDebug(LogType::ERROR, Log::rdPoS, __func__, "No rdPoS in DB, cannot proceed.");
     throw std::runtime_error("No rdPoS in DB.");
   }
-  Logger::logToDebug(LogType::INFO, Log::rdPoS, __func__, "Found " + std::to_string(validatorsDb.size()) + " rdPoS in DB");
+  LOGINFO(Log::rdPoS, "Found " + std::to_string(validatorsDb.size()) + " rdPoS in DB");
   // TODO: check if no index is missing from DB.
   for (const auto& validator : validatorsDb) {
     this->validators_.insert(Validator(Address(validator.value)));
@@ -60,7 +61,7 @@ rdPoS::~rdPoS() {
   this->stoprdPoSWorker();
   std::unique_lock lock(this->mutex_);
   DBBatch validatorsBatch;
-  Logger::logToDebug(LogType::INFO, Log::rdPoS, __func__, "Descontructing rdPoS, saving to DB.");
+  LOGINFO(Log::rdPoS, "Descontructing rdPoS, saving to DB.");
   // Save rdPoS to DB.
   uint64_t index = 0;
   for (const auto &validator : this->validators_) {
@@ -71,6 +72,7 @@ rdPoS::~rdPoS() {
 }
 
 bool rdPoS::validateBlock(const Block& block) const {
+  TraceSpan span("rdPoS::validateBlock");
   std::lock_guard lock(this->mutex_);
   auto latestBlock = this->storage_->latest();
   // Check if block signature matches randomList[0]
@@ -219,6 +221,7 @@ bool rdPoS::validateBlock(const Block& block) const {
 }
 
 Hash rdPoS::processBlock(const Block& block) {
+  TraceSpan span("rdPoS::processBlock");
   std::unique_lock lock(this->mutex_);
   if (!block.isFinalized()) {
     Logger::logToDebug(LogType::ERROR, Log::rdPoS, __func__, "Block is not finalized.");
@@ -229,6 +232,10 @@ Hash rdPoS::processBlock(const Block& block) {
   this->bestRandomSeed_ = block.getBlockRandomness();
   this->randomGen_.setSeed(this->bestRandomSeed_);
   this->randomGen_.shuffle(this->randomList_);
+  // Transactions pushed early for the new round can now be checked against the new random list.
+  for (const auto& [txHash, tx] : this->nextRoundTxs_) this->addValidatorTxInternal(tx, block.getNHeight() + 1);
+  this->nextRoundTxs_.clear();
+  this->mempoolSignal_.notify();
   return this->bestRandomSeed_;
 }
 
@@ -242,16 +249,41 @@ void rdPoS::signBlock(Block &block) {
 
 bool rdPoS::addValidatorTx(const TxValidator& tx) {
   std::unique_lock lock(this->mutex_);
+  uint64_t nextHeight = this->storage_->latest()->getNHeight() + 1;
+  // Validators of the next round may push their transactions before we get the current block.
+  if (tx.getNHeight() == nextHeight + 1) return this->bufferNextRoundTx(tx);
+  return this->addValidatorTxInternal(tx, nextHeight);
+}
+
+bool rdPoS::bufferNextRoundTx(const TxValidator& tx) {
+  if (this->nextRoundTxs_.contains(tx.hash())) return true;
+  // The random list of the next round is not known yet, so only check if the sender is a Validator.
+  if (!this->validators_.contains(Validator(tx.getFrom()))) {
+    Logger::logToDebug(LogType::ERROR, Log::rdPoS, __func__, "TxValidator sender is not a validator.");
+    return false;
+  }
+  uint64_t senderTxs = 0;
+  for (const auto& [txHash, bufferedTx] : this->nextRoundTxs_) {
+    if (bufferedTx.getFrom() == tx.getFrom()) senderTxs++;
+  }
+  if (senderTxs >= 2) {
+    Logger::logToDebug(LogType::ERROR, Log::rdPoS, __func__, "TxValidator sender already has two transactions for the next round.");
+    return false;
+  }
+  this->nextRoundTxs_.emplace(tx.hash(), tx);
+  return true;
+}
+
+bool rdPoS::addValidatorTxInternal(const TxValidator& tx, const uint64_t& nextHeight) {
   if (this->validatorMempool_.contains(tx.hash())) {
-    Logger::logToDebug(LogType::INFO, Log::rdPoS, __func__, "TxValidator already exists in mempool.");
+    LOGINFO(Log::rdPoS, "TxValidator already exists in mempool.");
     return true;
   }
 
-  if (tx.getNHeight() != this->storage_->latest()->getNHeight() + 1) {
+  if (tx.getNHeight() != nextHeight) {
     Logger::logToDebug(LogType::ERROR, Log::rdPoS, __func__,
       "TxValidator is not for the next block. Expected: "
-      + std::to_string(this->storage_->latest()->getNHeight() + 1)
-      + " Got: " + std::to_string(tx.getNHeight())
+      + std::to_string(nextHeight) + " Got: " + std::to_string(tx.getNHeight())
     );
     return false;
   }
@@ -278,6 +310,7 @@ bool rdPoS::addValidatorTx(const TxValidator& tx) {
   }
   if (txs.empty()) { // No transactions from this sender yet, add it.
     this->validatorMempool_.emplace(tx.hash(), tx);
+    this->mempoolSignal_.notify();
     return true;
   } else if (txs.size() == 1) { // We already have one transaction from this sender, check if it is the same function.
     if (txs[0].getFunctor() == tx.getFunctor()) {
@@ -285,6 +318,7 @@ bool rdPoS::addValidatorTx(const TxValidator& tx) {
       return false;
     }
     this->validatorMempool_.emplace(tx.hash(), tx);
+    this->mempoolSignal_.notify();
   } else { // We already have two transactions from this sender, it is the max we can have per validator.
     Logger::logToDebug(LogType::ERROR, Log::rdPoS, __func__, "TxValidator sender already has two transactions.");
     return false;
@@ -296,7 +330,7 @@ bool rdPoS::addValidatorTx(const TxValidator& tx) {
 void rdPoS::initializeBlockchain() const {
   auto validatorsDb = db_->getBatch(DBPrefix::rdPoS);
   if (validatorsDb.empty()) {
-    Logger::logToDebug(LogType::INFO, Log::rdPoS,__func__, "No rdPoS in DB, initializing.");
+    LOGINFO(Log::rdPoS, "No rdPoS in DB, initializing.");
     // Use the genesis validators from Options, OPTIONS JSON FILE VALIDATOR ARRAY ORDER **MATTERS**
     for (uint64_t i = 0; i < this->options_->getGenesisValidators().size(); ++i) {
       this->db_->put(Utils::uint64ToBytes(i), this->options_->getGenesisValidators()[i].get(), DBPrefix::rdPoS);
@@ -352,6 +386,16 @@ bool rdPoSWorker::checkLatestBlock() {
   return false;
 }
 
+void rdPoSWorker::requestValidatorTxsFromPeers() {
+  auto connectedNodesList = this->rdpos_.p2p_->getSessionsIDs();
+  if (connectedNodesList.empty()) return;
+  this->rdpos_.p2p_->requestValidatorTxsFromAll(connectedNodesList,
+    [&](const P2P::NodeID&, std::vector<TxValidator>&& txList) {
+      for (auto const& tx : txList) this->rdpos_.state_->addValidatorTx(tx);
+    }
+  );
+}
+
 bool rdPoSWorker::workerLoop() {
   Validator me(Secp256k1::toAddress(Secp256k1::toUPub(this->rdpos_.validatorKey_)));
   this->latestBlock_ = this->rdpos_.storage_->latest();
@@ -379,32 +423,15 @@ bool rdPoSWorker::workerLoop() {
     }
 
     // After processing everything. wait until the new block is appended to the chain.
-    while (!this->checkLatestBlock() && !this->stopWorker_) {
-      Logger::logToDebug(LogType::INFO, Log::rdPoS, __func__,
-        "Waiting for new block to be appended to the chain. (Height: "
-        + std::to_string(this->latestBlock_->getNHeight()) + ")" + " latest height: "
-        + std::to_string(this->rdpos_.storage_->latest()->getNHeight())
-      );
-      Logger::logToDebug(LogType::INFO, Log::rdPoS, __func__,
-        "Currently has " + std::to_string(this->rdpos_.validatorMempool_.size())
-        + " transactions in mempool."
-      );
-      std::unique_lock mempoolSizeLock(this->rdpos_.mutex_);
-      uint64_t mempoolSize = this->rdpos_.validatorMempool_.size();
-      if (mempoolSize < rdPoS::minValidators) { // Always try to fill the mempool to 8 transactions
-        mempoolSizeLock.unlock();
-        // Try to get more transactions from other nodes within the network
-        auto connectedNodesList = this->rdpos_.p2p_->getSessionsIDs();
-        for (auto const& nodeId : connectedNodesList) {
-          if (this->checkLatestBlock() || this->stopWorker_) break;
-          auto txList = this->rdpos_.p2p_->requestValidatorTxs(nodeId);
-          if (this->checkLatestBlock() || this->stopWorker_) break;
-          for (auto const& tx : txList) this->rdpos_.state_->addValidatorTx(tx);
-        }
-      } else {
-        mempoolSizeLock.unlock();
-      }
-      std::this_thread::sleep_for(std::chrono::milliseconds(25));
+    LOGINFO(Log::rdPoS,
+      "Waiting for new block to be appended to the chain. (Height: "
+      + std::to_string(this->latestBlock_->getNHeight()) + ")"
+    );
+    EventSignal& newBlockSignal = this->rdpos_.storage_->newBlockSignal();
+    while (true) {
+      uint64_t seen = newBlockSignal.sequence();
+      if (this->stopWorker_ || this->checkLatestBlock()) break;
+      newBlockSignal.wait(seen);
     }
     // Update latest block if necessary.
     if (isBlockCreator) this->canCreateBlock_ = false;
@@ -413,30 +440,25 @@ bool rdPoSWorker::workerLoop() {
   return true;
 }
 
-void rdPoSWorker::doBlockCreation() {
-  // TODO: add requesting transactions to other nodes when mempool is not filled up
-  Logger::logToDebug(LogType::INFO, Log::rdPoS, __func__, "Block creator: waiting for txs");
-  uint64_t validatorMempoolSize = 0;
-  while (validatorMempoolSize != rdPoS::minValidators * 2 && !this->stopWorker_)
-  {
-    Logger::logToDebug(LogType::INFO, Log::rdPoS, __func__,
-      "Block creator has: " + std::to_string(validatorMempoolSize) + " transactions in mempool"
-    );
-    // Scope for lock.
+bool rdPoSWorker::waitForMempool(const uint64_t& size) {
+  while (!this->stopWorker_) {
+    uint64_t seen = this->rdpos_.mempoolSignal_.sequence();
+    uint64_t validatorMempoolSize;
     {
-      std::unique_lock mempoolSizeLock(this->rdpos_.mutex_);
+      std::shared_lock mempoolSizeLock(this->rdpos_.mutex_);
       validatorMempoolSize = this->rdpos_.validatorMempool_.size();
     }
-    // Try to get more transactions from other nodes within the network
-    auto connectedNodesList = this->rdpos_.p2p_->getSessionsIDs();
-    for (auto const& nodeId : connectedNodesList) {
-      auto txList = this->rdpos_.p2p_->requestValidatorTxs(nodeId);
-      if (this->stopWorker_) return;
-      for (auto const& tx : txList) this->rdpos_.state_->addValidatorTx(tx);
-    }
-    std::this_thread::sleep_for(std::chrono::milliseconds(25));
+    if (validatorMempoolSize >= size) return true;
+    // Wake up as soon as a transaction is pushed to us, and only ask peers if none was for a while.
+    if (!this->rdpos_.mempoolSignal_.waitFor(seen, pullTimeout_)) this->requestValidatorTxsFromPeers();
   }
-  Logger::logToDebug(LogType::INFO, Log::rdPoS, __func__, "Validator ready to create a block");
+  return false;
+}
+
+void rdPoSWorker::doBlockCreation() {
+  LOGINFO(Log::rdPoS, "Block creator: waiting for txs");
+  if (!this->waitForMempool(rdPoS::minValidators * 2)) return;
+  LOGINFO(Log::rdPoS, "Validator ready to create a block");
   // After processing everything, we can let everybody know that we are ready to create a block
   this->canCreateBlock_ = true;
 }
@@ -444,7 +466,7 @@ void rdPoSWorker::doBlockCreation() {
 void rdPoSWorker::doTxCreation(const uint64_t& nHeight, const Validator& me) {
   Hash randomness = Hash::random();
   Hash randomHash = Utils::sha3(randomness.get());
-  Logger::logToDebug(LogType::INFO, Log::rdPoS, __func__, "Creating random Hash transaction");
+  LOGINFO(Log::rdPoS, "Creating random Hash transaction");
   Bytes randomHashBytes = Hex::toBytes("0xcfffe746");
   randomHashBytes.insert(randomHashBytes.end(), randomHash.get().begin(), randomHash.get().end());
   TxValidator randomHashTx(
@@ -469,38 +491,20 @@ void rdPoSWorker::doTxCreation(const uint64_t& nHeight, const Validator& me) {
   BytesArrView randomHashTxView(randomHashTx.getData());
   BytesArrView randomSeedTxView(seedTx.getData());
   if (Utils::sha3(randomSeedTxView.subspan(4)) != randomHashTxView.subspan(4)) {
-    Logger::logToDebug(LogType::INFO, Log::rdPoS, __func__, "RandomHash transaction is not valid!!!");
+    LOGINFO(Log::rdPoS, "RandomHash transaction is not valid!!!");
     return;
   }
 
   // Append to mempool and broadcast the transaction across all nodes.
-  Logger::logToDebug(LogType::INFO, Log::rdPoS, __func__, "Broadcasting randomHash transaction");
+  LOGINFO(Log::rdPoS, "Broadcasting randomHash transaction");
   this->rdpos_.state_->addValidatorTx(randomHashTx);
   this->rdpos_.p2p_->broadcastTxValidator(randomHashTx);
 
   // Wait until we received all randomHash transactions to broadcast the randomness transaction
-  Logger::logToDebug(LogType::INFO, Log::rdPoS, __func__, "Waiting for randomHash transactions to be broadcasted");
-  uint64_t validatorMempoolSize = 0;
-  while (validatorMempoolSize < rdPoS::minValidators && !this->stopWorker_) {
-    Logger::logToDebug(LogType::INFO, Log::rdPoS, __func__,
-      "Validator has: " + std::to_string(validatorMempoolSize) + " transactions in mempool"
-    );
-    // Scope for lock
-    {
-      std::unique_lock mempoolSizeLock(this->rdpos_.mutex_);
-      validatorMempoolSize = this->rdpos_.validatorMempool_.size();
-    }
-    // Try to get more transactions from other nodes within the network
-    auto connectedNodesList = this->rdpos_.p2p_->getSessionsIDs();
-    for (auto const& nodeId : connectedNodesList) {
-      if (this->stopWorker_) return;
-      auto txList = this->rdpos_.p2p_->requestValidatorTxs(nodeId);
-      for (auto const& tx : txList) this->rdpos_.state_->addValidatorTx(tx);
-    }
-    std::this_thread::sleep_for(std::chrono::milliseconds(25));
-  }
+  LOGINFO(Log::rdPoS, "Waiting for randomHash transactions to be broadcasted");
+  if (!this->waitForMempool(rdPoS::minValidators)) return;
 
-  Logger::logToDebug(LogType::INFO, Log::rdPoS, __func__, "Broadcasting random transaction");
+  LOGINFO(Log::rdPoS, "Broadcasting random transaction");
   // Append and broadcast the randomness transaction.
   this->rdpos_.state_->addValidatorTx(seedTx);
   this->rdpos_.p2p_->broadcastTxValidator(seedTx);
@@ -514,6 +518,9 @@ void rdPoSWorker::start() {
 void rdPoSWorker::stop() {
   if (this->workerFuture_.valid()) {
     this->stopWorker_ = true;
+    // Wake up the worker if it's waiting for transactions or a new block.
+    this->rdpos_.mempoolSignal_.notify();
+    this->rdpos_.storage_->newBlockSignal().notify();
     this->workerFuture_.wait();
     this->workerFuture_.get();
   }
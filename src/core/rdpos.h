@@ -14,6 +14,7 @@ See the LICENSE.txt file in the project root for more information.
 #include "../utils/safehash.h"
 #include "../utils/randomgen.h"
 #include "../utils/options.h"
+#include "../utils/eventsignal.h"
 #include "../net/p2p/managernormal.h"
 
 #include <optional>
@@ -81,6 +82,9 @@ class rdPoS : public BaseContract {
     /// Mempool for validator transactions.
     std::unordered_map<Hash, TxValidator, SafeHash> validatorMempool_;
 
+    /// Validator transactions received early for the round after the next block, moved to the mempool once the block is processed.
+    std::unordered_map<Hash, TxValidator, SafeHash> nextRoundTxs_;
+
     /// Private key for operating a validator.
     const PrivKey validatorKey_;
 
@@ -96,12 +100,31 @@ class rdPoS : public BaseContract {
     /// Mutex for managing read/write access to the class members.
     mutable std::shared_mutex mutex_;
 
+    /// Signal notified every time the Validator mempool changes.
+    EventSignal mempoolSignal_;
+
     /**
      * Initializes the blockchain with the default information for rdPoS.
      * Called by the constructor if no previous blockchain is found.
      */
     void initializeBlockchain() const;
 
+    /**
+     * Hold a Validator transaction for the round after the next block.
+     * Caller must hold `mutex_`.
+     * @param tx The transaction to hold.
+     * @return `true` if the transaction was held, `false` if invalid otherwise.
+     */
+    bool bufferNextRoundTx(const TxValidator& tx);
+
+    /**
+     * Add a Validator transaction to the mempool. Caller must hold `mutex_`.
+     * @param tx The transaction to add.
+     * @param nextHeight The height of the next block.
+     * @return `true` if the transaction was added, `false` if invalid otherwise.
+     */
+    bool addValidatorTxInternal(const TxValidator& tx, const uint64_t& nextHeight);
+
   public:
     /// Enum for Validator transaction functions.
     enum TxValidatorFunction { INVALID, RANDOMHASH, RANDOMSEED };
@@ -155,8 +178,14 @@ class rdPoS : public BaseContract {
      */
     const bool isValidatorAddress(const Address& add) const { std::shared_lock lock(this->mutex_); return validators_.contains(Validator(add)); }
 
+    /// Getter for `mempoolSignal_`.
+    EventSignal& mempoolSignal() { return this->mempoolSignal_; }
+
     /// Clear the mempool.
-    void clearMempool() { std::unique_lock lock(this->mutex_); this->validatorMempool_.clear(); }
+    void clearMempool() {
+      { std::unique_lock lock(this->mutex_); this->validatorMempool_.clear(); }
+      this->mempoolSignal_.notify();
+    }
 
     /**
      * Validate a block.
@@ -185,8 +214,10 @@ class rdPoS : public BaseContract {
      * Should ONLY be called by the State, as it locks the current state mutex,
      * not allowing a race condition of adding transactions that are not for
      * the current block height.
+     * Transactions for the round after the next block are held until that
+     * block is processed, so pushes that arrive early are not lost.
      * @param tx The transaction to add.
-     * @return `true` if the transaction was added, `false` if invalid otherwise.
+     * @return `true` if the transaction was added (or held), `false` if invalid otherwise.
      */
     bool addValidatorTx(const TxValidator& tx);
 
@@ -245,6 +276,21 @@ class rdPoSWorker {
     /// Pointer to the latest block.
     std::shared_ptr<const Block> latestBlock_;
 
+    /**
+     * Time without new Validator transactions after which they are requested from peers.
+     * Validators push their transactions as soon as they create them, so this is only a fallback.
+     */
+    static constexpr std::chrono::milliseconds pullTimeout_ = std::chrono::milliseconds(250);
+
+    /**
+     * Wait until the Validator mempool has at least a given number of transactions.
+     * Transactions are requested from peers on every `pullTimeout_` that passes
+     * without the mempool changing.
+     * @param size The number of wanted transactions.
+     * @return `true` if the mempool was filled up, `false` if the worker was stopped.
+     */
+    bool waitForMempool(const uint64_t& size);
+
     /**
      * Check if the latest block has updated.
      * Does NOT update latestBlock per se, this is done by workerLoop().
@@ -252,6 +298,12 @@ class rdPoSWorker {
      */
     bool checkLatestBlock();
 
+    /**
+     * Request Validator transactions from all connected nodes at once and add them to the mempool.
+     * Returns when every node answered or the request deadline passed.
+     */
+    void requestValidatorTxsFromPeers();
+
     /**
      * Entry function for the worker thread (runs the workerLoop() function).
      * TODO: document return
@@ -5,7 +5,43 @@ This software is distributed under the MIT License.
 See the LICENSE.txt file in the project root for more information.
 */
 
+#include <queue>
+
 #include "state.h"
+#include "../utils/metrics.h"
+#include "../utils/tracer.h"
+
+/**
+ * Get the histogram of the time spent in a phase of State::processNextBlock().
+ * @param phase The phase name.
+ * @return The histogram.
+ */
+static Histogram& blockPhaseHistogram(const std::string& phase) {
+  return Metrics::histogram("orbitersdk_block_phase_seconds", "Time spent in each phase of processing a block",
+    Metrics::latencyBuckets, {{"phase", phase}}, 1e-6
+  );
+}
+static Histogram& blockValidateSeconds = blockPhaseHistogram("validate");
+static Histogram& blockTransactionsSeconds = blockPhaseHistogram("transactions");
+static Histogram& blockRdPoSSeconds = blockPhaseHistogram("rdpos");
+static Histogram& blockMempoolSeconds = blockPhaseHistogram("mempool");
+static Histogram& blockStorageSeconds = blockPhaseHistogram("storage");
+static Histogram& blockListenersSeconds = blockPhaseHistogram("listeners");
+static Counter& blocksProcessed = Metrics::counter("orbitersdk_blocks_processed_total", "Blocks added to the chain");
+static Counter& txsProcessed = Metrics::counter("orbitersdk_txs_processed_total", "Transactions added to the chain");
+
+/**
+ * Get the counter of transactions rejected from the mempool for a reason.
+ * @param reason The reason name.
+ * @return The counter.
+ */
+static Counter& mempoolRejects(const std::string& reason) {
+  return Metrics::counter("orbitersdk_mempool_rejects_total", "Transactions rejected from the mempool", {{"reason", reason}});
+}
+static Counter& mempoolRejectsUnknownAccount = mempoolRejects("unknown_account");
+static Counter& mempoolRejectsBalance = mempoolRejects("balance");
+static Counter& mempoolRejectsNonce = mempoolRejects("nonce");
+static Gauge& mempoolSize = Metrics::gauge("orbitersdk_mempool_size", "Transactions in the mempool");
 
 State::State(
   const std::unique_ptr<DB>& db,
@@ -97,12 +133,13 @@ TxInvalid State::validateTransactionInternal(const TxBlock& tx) const {
 
   /// Verify if transaction already exists within the mempool, if on mempool, it has been validated previously.
   if (this->mempool_.contains(tx.hash())) {
-    Logger::logToDebug(LogType::INFO, Log::state, __func__, "Transaction: " + tx.hash().hex().get() + " already in mempool");
+    LOGINFO(Log::state, "Transaction: " + tx.hash().hex().get() + " already in mempool");
     return TxInvalid::NotInvalid;
   }
   auto accountIt = this->accounts_.find(tx.getFrom());
   if (accountIt == this->accounts_.end()) {
     Logger::logToDebug(LogType::ERROR, Log::state, __func__, "Account doesn't exist (0 balance and 0 nonce)");
+    mempoolRejectsUnknownAccount.inc();
     return TxInvalid::InvalidBalance;
   }
   const auto& accBalance = accountIt->second.balance;
@@ -112,6 +149,7 @@ TxInvalid State::validateTransactionInternal(const TxBlock& tx) const {
     Logger::logToDebug(LogType::ERROR, Log::state, __func__,
                       "Transaction sender: " + tx.getFrom().hex().get() + " doesn't have balance to send transaction"
                       + " expected: " + txWithFees.str() + " has: " + accBalance.str());
+    mempoolRejectsBalance.inc();
     return TxInvalid::InvalidBalance;
   }
   // TODO: The blockchain is able to store higher nonce transactions until they are valid
@@ -119,6 +157,7 @@ TxInvalid State::validateTransactionInternal(const TxBlock& tx) const {
   if (accNonce != tx.getNonce()) {
     Logger::logToDebug(LogType::ERROR, Log::state, __func__, "Transaction: " + tx.hash().hex().get() + " nonce mismatch, expected: " + std::to_string(accNonce)
                                             + " got: " + tx.getNonce().str());
+    mempoolRejectsNonce.inc();
     return TxInvalid::InvalidNonce;
   }
 
@@ -131,6 +170,8 @@ void State::processTransaction(const TxBlock& tx, const Hash& blockHash, const u
   // Lock is already called by processNextBlock.
   // processNextBlock already calls validateTransaction in every tx,
   // as it calls validateNextBlock as a sanity check.
+  TraceSpan span("State::processTransaction");
+  span.attr("index", txIndex);
   auto accountIt = this->accounts_.find(tx.getFrom());
   auto& balance = accountIt->second.balance;
   auto& nonce = accountIt->second.nonce;
@@ -141,7 +182,7 @@ void State::processTransaction(const TxBlock& tx, const Hash& blockHash, const u
     balance -= txValueWithFees;
     this->accounts_[tx.getTo()].balance += tx.getValue();
     if (this->contractManager_->isContractCall(tx)) {
-      Utils::safePrint(std::string("Processing transaction call txid: ") + tx.hash().hex().get());
+      LOGTRACE(Log::state, "Processing transaction call txid: " + tx.hash().hex().get());
       if (this->contractManager_->isPayable(tx.txToCallInfo())) this->processingPayable_ = true;
       this->contractManager_->callContract(tx, blockHash, txIndex);
       this->processingPayable_ = false;
@@ -162,6 +203,8 @@ void State::processTransaction(const TxBlock& tx, const Hash& blockHash, const u
 
 void State::refreshMempool(const Block& block) {
   /// No need to lock mutex as function caller (this->processNextBlock) already lock mutex.
+  TraceSpan span("State::refreshMempool");
+  span.attr("mempool", this->mempool_.size());
   /// Remove all transactions within the block that exists on the unordered_map.
   for (const auto& tx : block.getTxs()) {
     const auto it = this->mempool_.find(tx.hash());
@@ -182,6 +225,7 @@ void State::refreshMempool(const Block& block) {
       this->mempool_.insert({hash, tx});
     }
   }
+  mempoolSize.set(this->mempool_.size());
 }
 
 const uint256_t State::getNativeBalance(const Address &addr) const {
@@ -219,7 +263,7 @@ bool State::validateNextBlock(const Block& block) const {
    * All transactions within Block are valid (does not return false on validateTransaction)
    * Block constructor already checks if merkle roots within a block are valid.
    */
-
+  TraceSpan span("State::validateNextBlock");
   auto latestBlock = this->storage_->latest();
   if (block.getNHeight() != latestBlock->getNHeight() + 1) {
     Logger::logToDebug(LogType::ERROR, Log::state, __func__, "Block nHeight doesn't match, expected "
@@ -252,11 +296,14 @@ bool State::validateNextBlock(const Block& block) const {
     }
   }
 
-  Logger::logToDebug(LogType::INFO, Log::state, __func__, "Block " + block.hash().hex().get() + " is valid. (Sanity Check Passed)");
+  LOGINFO(Log::state, "Block " + block.hash().hex().get() + " is valid. (Sanity Check Passed)");
   return true;
 }
 
 void State::processNextBlock(Block&& block) {
+  TraceSpan span("State::processNextBlock");
+  span.attr("height", block.getNHeight()).attr("txs", block.getTxs().size());
+  auto phaseStart = std::chrono::steady_clock::now();
   // Sanity check - if it passes, the block is valid and will be processed
   if (!this->validateNextBlock(block)) {
     Logger::logToDebug(LogType::ERROR, Log::state, __func__,
@@ -265,6 +312,7 @@ void State::processNextBlock(Block&& block) {
     throw std::runtime_error("Invalid block detected during processNextBlock sanity check");
   }
 
+  blockValidateSeconds.observeSince(phaseStart);
   std::unique_lock lock(this->stateMutex_);
 
   // Update contract globals based on (now) latest block
@@ -278,24 +326,91 @@ void State::processNextBlock(Block&& block) {
     txIndex++;
   }
 
+  std::vector<Event> events = this->contractManager_->takeCommittedEvents();
+  blockTransactionsSeconds.observeSince(phaseStart);
+  blocksProcessed.inc();
+  txsProcessed.inc(txIndex);
+
   // Process rdPoS State
   this->rdpos_->processBlock(block);
+  blockRdPoSSeconds.observeSince(phaseStart);
 
   // Refresh the mempool based on the block transactions
   this->refreshMempool(block);
-  Logger::logToDebug(LogType::INFO, Log::state, __func__, "Block " + block.hash().hex().get() + " processed successfully.) block bytes: " + Hex::fromBytes(block.serializeBlock()).get());
-  Utils::safePrint("Block: " + block.hash().hex().get() + " height: " + std::to_string(block.getNHeight()) + " was added to the blockchain");
-  for (const auto& tx : block.getTxs()) {
-    Utils::safePrint("Transaction: " + tx.hash().hex().get() + " was accepted in the blockchain");
-  }
+  blockMempoolSeconds.observeSince(phaseStart);
 
   // Move block to storage
   this->storage_->pushBack(std::move(block));
+  const auto latest = this->storage_->latest();
+  lock.unlock();
+  blockStorageSeconds.observeSince(phaseStart);
+
+  // Diagnostics are only built after releasing the lock, and the full dumps only when tracing
+  LOGINFO(Log::state, "Block " + blockHash.hex().get() + " height: " + std::to_string(latest->getNHeight())
+    + " was added to the blockchain with " + std::to_string(txIndex) + " transactions"
+  );
+  if (Logger::isEnabled(LogType::TRACE, Log::state)) {
+    LOGTRACE(Log::state, "Block " + blockHash.hex().get() + " bytes: " + Hex::fromBytes(latest->serializeBlock()).get());
+    for (const auto& tx : latest->getTxs()) {
+      LOGTRACE(Log::state, "Transaction: " + tx.hash().hex().get() + " was accepted in the blockchain");
+    }
+  }
+
+  std::lock_guard listenersLock(this->listenersMutex_);
+  for (StateListener* listener : this->listeners_) listener->onNewBlock(latest, events);
+  blockListenersSeconds.observeSince(phaseStart);
 }
 
 void State::fillBlockWithTransactions(Block& block) const {
+  const BlockBuilderOptions& limits = this->options_->getBlockBuilderOptions();
+  auto higherFee = [](const TxBlock* a, const TxBlock* b) {
+    if (a->getMaxFeePerGas() != b->getMaxFeePerGas()) return a->getMaxFeePerGas() > b->getMaxFeePerGas();
+    return a->hash() < b->hash();
+  };
   std::shared_lock lock(this->stateMutex_);
-  for (const auto& [hash, tx] : this->mempool_) block.appendTx(tx);
+
+  // Queue the executable transactions of each sender in nonce order, keeping the highest fee for each nonce.
+  std::unordered_map<Address, std::vector<const TxBlock*>, SafeHash> txsBySender;
+  for (const auto& [hash, tx] : this->mempool_) txsBySender[tx.getFrom()].push_back(&tx);
+  std::vector<std::vector<const TxBlock*>> queues;
+  for (auto& [from, txs] : txsBySender) {
+    auto accountIt = this->accounts_.find(from);
+    if (accountIt == this->accounts_.end()) continue;
+    std::sort(txs.begin(), txs.end(), [&](const TxBlock* a, const TxBlock* b) {
+      if (a->getNonce() != b->getNonce()) return a->getNonce() < b->getNonce();
+      return higherFee(a, b);
+    });
+    std::vector<const TxBlock*> queue;
+    uint256_t nextNonce = accountIt->second.nonce;
+    for (const TxBlock* tx : txs) {
+      if (tx->getNonce() > nextNonce) break;
+      if (tx->getNonce() < nextNonce) continue;
+      queue.push_back(tx);
+      nextNonce++;
+    }
+    if (!queue.empty()) queues.push_back(std::move(queue));
+  }
+
+  // Take the highest fee transaction among the heads of the queues until the block is full.
+  std::vector<size_t> positions(queues.size(), 0);
+  auto lowerPriority = [&](size_t a, size_t b) { return higherFee(queues[b][positions[b]], queues[a][positions[a]]); };
+  std::priority_queue<size_t, std::vector<size_t>, decltype(lowerPriority)> heads(lowerPriority);
+  for (size_t i = 0; i < queues.size(); i++) heads.push(i);
+  uint64_t blockBytes = 0;
+  uint256_t blockGas = 0;
+  uint64_t blockTxs = 0;
+  while (!heads.empty() && blockTxs < limits.maxBlockTxs) {
+    size_t queue = heads.top();
+    heads.pop();
+    const TxBlock* tx = queues[queue][positions[queue]];
+    uint64_t txBytes = tx->rlpSerialize().size();
+    if (blockBytes + txBytes > limits.maxBlockBytes || blockGas + tx->getGasLimit() > limits.maxBlockGas) continue;
+    block.appendTx(*tx);
+    blockBytes += txBytes;
+    blockGas += tx->getGasLimit();
+    blockTxs++;
+    if (++positions[queue] < queues[queue].size()) heads.push(queue);
+  }
 }
 
 TxInvalid State::validateTransaction(const TxBlock& tx) const {
@@ -309,10 +424,25 @@ TxInvalid State::addTx(TxBlock&& tx) {
   std::unique_lock lock(this->stateMutex_);
   auto txHash = tx.hash();
   this->mempool_.insert({txHash, std::move(tx)});
-  Utils::safePrint("Transaction: " + tx.hash().hex().get() + " was added to the mempool");
+  mempoolSize.set(this->mempool_.size());
+  lock.unlock();
+  this->mempoolSignal_.notify();
+  LOGTRACE(Log::state, "Transaction: " + txHash.hex().get() + " was added to the mempool");
+  std::lock_guard listenersLock(this->listenersMutex_);
+  for (StateListener* listener : this->listeners_) listener->onNewTx(txHash);
   return TxInvalid;
 }
 
+void State::addListener(StateListener* listener) {
+  std::lock_guard lock(this->listenersMutex_);
+  this->listeners_.push_back(listener);
+}
+
+void State::removeListener(StateListener* listener) {
+  std::lock_guard lock(this->listenersMutex_);
+  std::erase(this->listeners_, listener);
+}
+
 bool State::addValidatorTx(const TxValidator& tx) {
   std::unique_lock lock(this->stateMutex_);
   return this->rdpos_->addValidatorTx(tx);
@@ -330,6 +460,19 @@ std::unique_ptr<TxBlock> State::getTxFromMempool(const Hash &txHash) const {
   return std::make_unique<TxBlock>(it->second);
 }
 
+std::vector<std::unique_ptr<TxBlock>> State::getTxsFromMempoolByShortId(const std::vector<uint64_t>& shortTxIds) const {
+  std::vector<std::unique_ptr<TxBlock>> txs(shortTxIds.size());
+  std::shared_lock lock(this->stateMutex_);
+  std::unordered_map<uint64_t, const TxBlock*, SafeHash> shortIdMap;
+  shortIdMap.reserve(this->mempool_.size());
+  for (const auto& [txHash, tx] : this->mempool_) shortIdMap.emplace(P2P::getShortTxId(txHash), &tx);
+  for (size_t i = 0; i < shortTxIds.size(); i++) {
+    auto it = shortIdMap.find(shortTxIds[i]);
+    if (it != shortIdMap.end()) txs[i] = std::make_unique<TxBlock>(*it->second);
+  }
+  return txs;
+}
+
 void State::addBalance(const Address& addr) {
   std::unique_lock lock(this->stateMutex_);
   this->accounts_[addr].balance += uint256_t("1000000000000000000000");
@@ -361,7 +504,6 @@ bool State::estimateGas(const ethCallInfo& callInfo) {
   }
 
   if (this->contractManager_->isContractAddress(to)) {
-    Utils::safePrint("Estimating gas from state...");
     this->contractManager_->validateCallContractWithTx(callInfo);
   }
 
@@ -388,6 +530,14 @@ const std::vector<Event> State::getEvents(
   return this->contractManager_->getEvents(fromBlock, toBlock, address, topics);
 }
 
+const std::vector<Event> State::getEvents(
+  const uint64_t& fromBlock, const uint64_t& toBlock, const Address& address,
+  const std::function<bool(const Event&)>& matches, const uint64_t& maxEvents
+) const {
+  std::shared_lock lock(this->stateMutex_);
+  return this->contractManager_->getEvents(fromBlock, toBlock, address, matches, maxEvents);
+}
+
 const std::vector<Event> State::getEvents(
   const Hash& txHash, const uint64_t& blockIndex, const uint64_t& txIndex
 ) const {
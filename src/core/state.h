@@ -21,6 +21,29 @@ See the LICENSE.txt file in the project root for more information.
 /// Enum for labeling transaction validity.
 enum TxInvalid { NotInvalid, InvalidNonce, InvalidBalance };
 
+/**
+ * Interface for being notified about new blocks and mempool transactions (e.g. by RPC subscriptions).
+ * Listeners are called outside of the state lock, and should return quickly.
+ */
+class StateListener {
+  public:
+    /// Default destructor.
+    virtual ~StateListener() = default;
+
+    /**
+     * Called after a new block is processed and stored.
+     * @param block The new block.
+     * @param events The events emitted by the block's transactions.
+     */
+    virtual void onNewBlock(const std::shared_ptr<const Block>& block, const std::vector<Event>& events) = 0;
+
+    /**
+     * Called after a new transaction is added to the mempool.
+     * @param txHash The hash of the transaction.
+     */
+    virtual void onNewTx(const Hash& txHash) = 0;
+};
+
 /**
  * Abstraction of the blockchain's state.
  * Responsible for maintaining the current blockchain state at the current block.
@@ -54,6 +77,15 @@ class State {
     /// Mutex for managing read/write access to the state object.
     mutable std::shared_mutex stateMutex_;
 
+    /// Signal notified every time a transaction is added to the mempool.
+    EventSignal mempoolSignal_;
+
+    /// Listeners notified about new blocks and mempool transactions.
+    std::vector<StateListener*> listeners_;
+
+    /// Mutex for managing read/write access to the listeners.
+    std::mutex listenersMutex_;
+
     /**
      * Verify if a transaction can be accepted within the current state.
      * @param tx The transaction to check.
@@ -131,6 +163,21 @@ class State {
       return this->mempool_.size();
     }
 
+    /// Getter for `mempoolSignal_`.
+    EventSignal& mempoolSignal() { return this->mempoolSignal_; }
+
+    /**
+     * Register a listener for new blocks and mempool transactions.
+     * @param listener The listener. Must be removed with removeListener() before it is destroyed.
+     */
+    void addListener(StateListener* listener);
+
+    /**
+     * Remove a listener. Once this returns, the listener is not being called anymore.
+     * @param listener The listener.
+     */
+    void removeListener(StateListener* listener);
+
     /**
      * Validate the next block given the current state and its transactions.
      * Does NOT update the state.
@@ -151,7 +198,11 @@ class State {
     void processNextBlock(Block&& block);
 
     /**
-     * Fill a block with all transactions currently in the mempool.
+     * Fill a block with transactions from the mempool, within the limits set in `Options::getBlockBuilderOptions()`.
+     * Selection is deterministic: each sender's transactions are taken in nonce order,
+     * starting at the account's nonce, and senders are interleaved by highest fee
+     * (`maxFeePerGas`, then lowest hash). A transaction that doesn't fit in the block
+     * leaves out the sender's later ones, so no nonce gap is created.
      * DOES NOT FINALIZE THE BLOCK.
      * @param block The block to fill.
      */
@@ -197,6 +248,15 @@ class State {
      */
     std::unique_ptr<TxBlock> getTxFromMempool(const Hash& txHash) const;
 
+    /**
+     * Get transactions from the mempool by their short IDs (see P2P::getShortTxId()).
+     * Used to rebuild compact blocks from the transactions we already have.
+     * @param shortTxIds The short IDs of the transactions.
+     * @return A list with one pointer per short ID, in the same order,
+     *         or `nullptr` for the transactions that are not in the mempool.
+     */
+    std::vector<std::unique_ptr<TxBlock>> getTxsFromMempoolByShortId(const std::vector<uint64_t>& shortTxIds) const;
+
     /**
      * Add balance to a given account.
      * Used through HTTP RPC to add balance to a given address
@@ -250,6 +310,20 @@ class State {
       const Address& address = Address(), const std::vector<Hash>& topics = {}
     ) const;
 
+    /**
+     * Overload of getEvents() with custom criteria, checked before the log cap is applied.
+     * @param fromBlock The initial block height to look for.
+     * @param toBlock The final block height to look for.
+     * @param address The address to look for, to narrow down the search. Empty for all available addresses.
+     * @param matches Function that tells if an event matches the criteria.
+     * @param maxEvents The maximum number of events to return.
+     * @return A list of matching events, up to `maxEvents`.
+     */
+    const std::vector<Event> getEvents(
+      const uint64_t& fromBlock, const uint64_t& toBlock, const Address& address,
+      const std::function<bool(const Event&)>& matches, const uint64_t& maxEvents
+    ) const;
+
     /**
      * Overload of getEvents() for transaction receipts.
      * @param txHash The hash of the transaction to look for events.
@@ -7,18 +7,70 @@ See the LICENSE.txt file in the project root for more information.
 
 #include "storage.h"
 
+BlockFeeStats::BlockFeeStats(const Block& block) {
+  // Effective priority fee and gas of each transaction, cheapest first
+  std::vector<std::pair<uint64_t, uint64_t>> fees;
+  fees.reserve(block.getTxs().size());
+  for (const TxBlock& tx : block.getTxs()) {
+    uint256_t fee = (tx.getMaxFeePerGas() > baseFee) ? tx.getMaxFeePerGas() - baseFee : uint256_t(0);
+    fee = std::min(fee, tx.getMaxPriorityFeePerGas());
+    uint256_t gas = tx.getGasLimit();
+    fees.emplace_back(
+      uint64_t(std::min(fee, uint256_t(UINT64_MAX))), uint64_t(std::min(gas, uint256_t(UINT64_MAX)))
+    );
+    this->gasUsed = (UINT64_MAX - this->gasUsed < fees.back().second) ? UINT64_MAX : this->gasUsed + fees.back().second;
+  }
+  this->txCount = fees.size();
+  if (fees.empty()) return;
+  std::sort(fees.begin(), fees.end());
+  // Walk the transactions once, filling every percentile whose share of the gas was reached
+  uint256_t cumulativeGas = fees[0].second;
+  size_t i = 0;
+  for (uint64_t percentile = 0; percentile <= 100; percentile++) {
+    uint256_t threshold = uint256_t(this->gasUsed) * percentile / 100;
+    while (cumulativeGas < threshold && i + 1 < fees.size()) cumulativeGas += fees[++i].second;
+    this->rewards[percentile] = fees[i].first;
+  }
+}
+
+BlockFeeStats::BlockFeeStats(const BytesArrView bytes) {
+  if (bytes.size() != 8 * (2 + this->rewards.size())) {
+    throw std::runtime_error("Invalid fee stats size - expected "
+      + std::to_string(8 * (2 + this->rewards.size())) + ", got " + std::to_string(bytes.size())
+    );
+  }
+  this->gasUsed = Utils::bytesToUint64(bytes.subspan(0, 8));
+  this->txCount = Utils::bytesToUint64(bytes.subspan(8, 8));
+  for (size_t i = 0; i < this->rewards.size(); i++) {
+    this->rewards[i] = Utils::bytesToUint64(bytes.subspan(16 + (8 * i), 8));
+  }
+}
+
+Bytes BlockFeeStats::serialize() const {
+  Bytes ret;
+  ret.reserve(8 * (2 + this->rewards.size()));
+  Utils::appendBytes(ret, Utils::uint64ToBytes(this->gasUsed));
+  Utils::appendBytes(ret, Utils::uint64ToBytes(this->txCount));
+  for (const uint64_t& reward : this->rewards) Utils::appendBytes(ret, Utils::uint64ToBytes(reward));
+  return ret;
+}
+
+uint64_t BlockFeeStats::reward(const double& percentile) const {
+  return this->rewards[std::clamp<uint64_t>(uint64_t(std::ceil(std::max(percentile, 0.0))), 0, 100)];
+}
+
 Storage::Storage(const std::unique_ptr<DB>& db, const std::unique_ptr<Options>& options) : db_(db), options_(options) {
-  Logger::logToDebug(LogType::INFO, Log::storage, __func__, "Loading blockchain from DB");
+  LOGINFO(Log::storage, "Loading blockchain from DB");
 
   // Initialize the blockchain if latest block doesn't exist.
   initializeBlockchain();
 
   // Get the latest block from the database
-  Logger::logToDebug(LogType::INFO, Log::storage, __func__, "Loading latest block");
+  LOGINFO(Log::storage, "Loading latest block");
   auto blockBytes = this->db_->get(Utils::stringToBytes("latest"), DBPrefix::blocks);
   Block latest(blockBytes, this->options_->getChainID());
   uint64_t depth = latest.getNHeight();
-  Logger::logToDebug(LogType::INFO, Log::storage, __func__,
+  LOGINFO(Log::storage,
     std::string("Got latest block: ") + latest.hash().hex().get()
     + std::string(" - height ") + std::to_string(depth)
   );
@@ -26,12 +78,12 @@ Storage::Storage(const std::unique_ptr<DB>& db, const std::unique_ptr<Options>&
   std::unique_lock<std::shared_mutex> lock(this->chainLock_);
 
   // Parse block mappings (hash -> height / height -> hash) from DB
-  Logger::logToDebug(LogType::INFO, Log::storage, __func__, "Parsing block mappings");
+  LOGINFO(Log::storage, "Parsing block mappings");
   std::vector<DBEntry> maps = this->db_->getBatch(DBPrefix::blockHeightMaps);
   for (DBEntry& map : maps) {
     // TODO: Check if a block is missing.
     // Might be interesting to change DB::getBatch to return a map instead of a vector
-    Logger::logToDebug(LogType::DEBUG, Log::storage, __func__, std::string(": ")
+    LOGDEBUG(Log::storage, std::string(": ")
       + std::to_string(Utils::bytesToUint64(map.key))
       + std::string(", hash ") + Hash(map.value).hex().get()
     );
@@ -40,9 +92,9 @@ Storage::Storage(const std::unique_ptr<DB>& db, const std::unique_ptr<Options>&
   }
 
   // Append up to 500 most recent blocks from DB to chain
-  Logger::logToDebug(LogType::INFO, Log::storage, __func__, "Appending recent blocks");
+  LOGINFO(Log::storage, "Appending recent blocks");
   for (uint64_t i = 0; i <= 500 && i <= depth; i++) {
-    Logger::logToDebug(LogType::DEBUG, Log::storage, __func__,
+    LOGDEBUG(Log::storage,
       std::string("Height: ") + std::to_string(depth - i) + ", Hash: "
       + this->blockHashByHeight_[depth - i].hex().get()
     );
@@ -50,7 +102,7 @@ Storage::Storage(const std::unique_ptr<DB>& db, const std::unique_ptr<Options>&
     this->pushFrontInternal(std::move(block));
   }
 
-  Logger::logToDebug(LogType::INFO, Log::storage, __func__, "Blockchain successfully loaded");
+  LOGINFO(Log::storage, "Blockchain successfully loaded");
 }
 
 Storage::~Storage() {
@@ -65,6 +117,10 @@ Storage::~Storage() {
       std::shared_ptr<const Block> block = this->chain_.front();
       batchedOperations.push_back(block->hash().get(), block->serializeBlock(), DBPrefix::blocks);
       batchedOperations.push_back(Utils::uint64ToBytes(block->getNHeight()), block->hash().get(), DBPrefix::blockHeightMaps);
+      auto feeStats = this->feeStatsByHeight_.find(block->getNHeight());
+      if (feeStats != this->feeStatsByHeight_.end()) {
+        batchedOperations.push_back(Utils::uint64ToBytes(block->getNHeight()), feeStats->second.serialize(), DBPrefix::feeStats);
+      }
 
       // Batch txs to be saved to the database and delete them from the mappings
       auto Txs = block->getTxs();
@@ -80,6 +136,7 @@ Storage::~Storage() {
 
       // Delete block from internal mappings and the chain
       this->blockByHash_.erase(block->hash());
+      this->feeStatsByHeight_.erase(block->getNHeight());
       this->chain_.pop_front();
     }
   }
@@ -99,7 +156,7 @@ void Storage::initializeBlockchain() {
     this->db_->put(std::string("latest"), genesis.serializeBlock(), DBPrefix::blocks);
     this->db_->put(Utils::uint64ToBytes(genesis.getNHeight()), genesis.hash().get(), DBPrefix::blockHeightMaps);
     this->db_->put(genesis.hash().get(), genesis.serializeBlock(), DBPrefix::blocks);
-    Logger::logToDebug(LogType::INFO, Log::storage, __func__,
+    LOGINFO(Log::storage,
       std::string("Created genesis block: ") + Hex::fromBytes(genesis.hash().get()).get()
     );
   }
@@ -148,6 +205,7 @@ void Storage::pushBackInternal(Block&& block) {
   this->blockByHash_.insert({newBlock->hash(), newBlock});
   this->blockHashByHeight_.insert({newBlock->getNHeight(), newBlock->hash()});
   this->blockHeightByHash_.insert({newBlock->hash(), newBlock->getNHeight()});
+  this->feeStatsByHeight_.emplace(newBlock->getNHeight(), BlockFeeStats(*newBlock));
   const auto& Txs = newBlock->getTxs();
   for (uint32_t i = 0; i < Txs.size(); i++) {
     this->txByHash_.insert({ Txs[i].hash(), { newBlock->hash(), i, newBlock->getNHeight() }});
@@ -175,6 +233,11 @@ void Storage::pushFrontInternal(Block&& block) {
   this->blockByHash_.insert({newBlock->hash(), newBlock});
   this->blockHashByHeight_.insert({newBlock->getNHeight(), newBlock->hash()});
   this->blockHeightByHash_.insert({newBlock->hash(), newBlock->getNHeight()});
+  // Blocks loaded back from the database already have their fee statistics saved there
+  Bytes feeStats = this->db_->get(Utils::uint64ToBytes(newBlock->getNHeight()), DBPrefix::feeStats);
+  this->feeStatsByHeight_.emplace(newBlock->getNHeight(),
+    (feeStats.empty()) ? BlockFeeStats(*newBlock) : BlockFeeStats(feeStats)
+  );
   const auto& Txs = newBlock->getTxs();
   for (uint32_t i = 0; i < Txs.size(); i++) {
     this->txByHash_.insert({Txs[i].hash(), { newBlock->hash(), i, newBlock->getNHeight()}});
@@ -182,8 +245,11 @@ void Storage::pushFrontInternal(Block&& block) {
 }
 
 void Storage::pushBack(Block&& block) {
-  std::unique_lock<std::shared_mutex> lock(this->chainLock_);
-  this->pushBackInternal(std::move(block));
+  {
+    std::unique_lock<std::shared_mutex> lock(this->chainLock_);
+    this->pushBackInternal(std::move(block));
+  }
+  this->newBlockSignal_.notify();
 }
 
 void Storage::pushFront(Block&& block) {
@@ -197,6 +263,7 @@ void Storage::popBack() {
   std::shared_ptr<const Block> block = this->chain_.back();
   for (const TxBlock& tx : block->getTxs()) this->txByHash_.erase(tx.hash());
   this->blockByHash_.erase(block->hash());
+  this->feeStatsByHeight_.erase(block->getNHeight());
   this->chain_.pop_back();
 }
 
@@ -206,6 +273,7 @@ void Storage::popFront() {
   std::shared_ptr<const Block> block = this->chain_.front();
   for (const TxBlock& tx : block->getTxs()) this->txByHash_.erase(tx.hash());
   this->blockByHash_.erase(block->hash());
+  this->feeStatsByHeight_.erase(block->getNHeight());
   this->chain_.pop_front();
 }
 
@@ -269,7 +337,7 @@ const std::shared_ptr<const Block> Storage::getBlock(const uint64_t& height) {
   // Check chain first, then cache, then database
   StorageStatus blockStatus = this->blockExists(height);
   if (blockStatus == StorageStatus::NotFound) return nullptr;
-  Logger::logToDebug(LogType::INFO, Log::storage, __func__, "height: " + std::to_string(height));
+  LOGINFO(Log::storage, "height: " + std::to_string(height));
   switch (blockStatus) {
     case StorageStatus::NotFound: {
       return nullptr;
@@ -421,6 +489,22 @@ const std::shared_ptr<const Block> Storage::latest() {
 
 uint64_t Storage::currentChainSize() { return this->latest()->getNHeight() + 1; }
 
+BlockFeeStats Storage::getFeeStats(const uint64_t& height) {
+  {
+    std::shared_lock<std::shared_mutex> lock(this->chainLock_);
+    auto it = this->feeStatsByHeight_.find(height);
+    if (it != this->feeStatsByHeight_.end()) return it->second;
+  }
+  Bytes feeStatsBytes = this->db_->get(Utils::uint64ToBytes(height), DBPrefix::feeStats);
+  if (!feeStatsBytes.empty()) return BlockFeeStats(feeStatsBytes);
+  // Only blocks saved before the statistics were are parsed, and only once
+  const auto block = this->getBlock(height);
+  if (block == nullptr) throw std::runtime_error("Block " + std::to_string(height) + " not found");
+  BlockFeeStats feeStats(*block);
+  this->db_->put(Utils::uint64ToBytes(height), feeStats.serialize(), DBPrefix::feeStats);
+  return feeStats;
+}
+
 void Storage::periodicSaveToDB() const {
   while (!this->stopPeriodicSave_) {
     std::this_thread::sleep_for(std::chrono::seconds(this->periodicSaveCooldown_));
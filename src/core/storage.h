@@ -13,6 +13,7 @@ See the LICENSE.txt file in the project root for more information.
 #include "../utils/block.h"
 #include "../utils/db.h"
 #include "../utils/ecdsa.h"
+#include "../utils/eventsignal.h"
 #include "../utils/randomgen.h"
 #include "../utils/safehash.h"
 #include "../utils/utils.h"
@@ -21,6 +22,48 @@ See the LICENSE.txt file in the project root for more information.
 /// Enum for the status of a block or transaction inside the storage.
 enum StorageStatus { NotFound, OnChain, OnCache, OnDB };
 
+/**
+ * Fee statistics of a block, for `eth_feeHistory` and `eth_maxPriorityFeePerGas`.
+ * Computed once when the block enters the chain. Priority fees are kept as a
+ * gas-weighted percentile table instead of the list of transactions, so the
+ * size doesn't depend on the number of transactions in the block.
+ */
+struct BlockFeeStats {
+  /// Base fee per gas. Fixed, as there's no EIP-1559 fee market (same as `eth_gasPrice`).
+  static constexpr uint64_t baseFee = 2500000000;
+
+  uint64_t gasUsed = 0;                   ///< Sum of the gas limits of the block's transactions.
+  uint64_t txCount = 0;                   ///< Number of transactions in the block.
+  std::array<uint64_t, 101> rewards = {}; ///< Effective priority fee per gas at each integer percentile (0-100) of the gas used.
+
+  /**
+   * Compute the statistics of a block.
+   * @param block The block.
+   */
+  explicit BlockFeeStats(const Block& block);
+
+  /**
+   * Load the statistics of a block from their serialized form.
+   * @param bytes The serialized statistics (see serialize()).
+   * @throw std::runtime_error if the size of the data is wrong.
+   */
+  explicit BlockFeeStats(const BytesArrView bytes);
+
+  /**
+   * Serialize the statistics for storing them in the database.
+   * @return The gas used, the transaction count and the rewards, as 64-bit big-endian integers.
+   */
+  Bytes serialize() const;
+
+  /**
+   * Get the effective priority fee per gas at a given percentile of the gas used.
+   * Fractional percentiles are rounded up to the next integer.
+   * @param percentile The percentile (0-100).
+   * @return The priority fee per gas, or 0 for an empty block.
+   */
+  uint64_t reward(const double& percentile) const;
+};
+
 /**
  * Abstraction of the blockchain history.
  * Used to store blocks in memory and on disk, and helps the State process
@@ -59,6 +102,12 @@ class Storage {
     /// Map that indexes all block hashes in the chain by their respective heights.
     std::unordered_map<uint64_t, const Hash, SafeHash> blockHashByHeight_;
 
+    /**
+     * Map that indexes the fee statistics of the blocks in memory by their respective heights.
+     * Saved to the database (DBPrefix::feeStats) along with the blocks.
+     */
+    std::unordered_map<uint64_t, const BlockFeeStats, SafeHash> feeStatsByHeight_;
+
     /// Cache space for blocks that will be included in the blockchain.
     mutable std::unordered_map<Hash, const std::shared_ptr<const Block>, SafeHash> cachedBlocks_;
 
@@ -82,6 +131,9 @@ class Storage {
     /// Flag for stopping the periodic save thread, if required.
     bool stopPeriodicSave_ = false;
 
+    /// Signal notified every time a block is added to the end of the chain.
+    EventSignal newBlockSignal_;
+
     /**
      * Add a block to the end of the chain.
      * Only call this function directly if absolutely sure that `chainLock_` is locked.
@@ -216,6 +268,19 @@ class Storage {
     /// Get the number of blocks currently in the chain (nHeight of latest block + 1).
     uint64_t currentChainSize();
 
+    /**
+     * Get the fee statistics of a block. Blocks in memory have them precomputed,
+     * older blocks have them saved to the database. Blocks saved before that are
+     * parsed once and their statistics saved too.
+     * @param height The block height.
+     * @return The fee statistics of the block.
+     * @throw std::runtime_error if the block is not found.
+     */
+    BlockFeeStats getFeeStats(const uint64_t& height);
+
+    /// Getter for `newBlockSignal_`.
+    EventSignal& newBlockSignal() { return this->newBlockSignal_; }
+
     /// Start the periodic save thread. TODO: this should be called by the constructor.
     void periodicSaveToDB() const;
 
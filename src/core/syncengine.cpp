@@ -0,0 +1,265 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include <algorithm>
+
+#include "syncengine.h"
+#include "storage.h"
+#include "state.h"
+
+bool SyncEngine::banNode(const P2P::NodeID& nodeId, const std::string& reason) {
+  if (!this->bannedNodes_.insert(nodeId).second) return false;
+  Logger::logToDebug(LogType::WARNING, Log::syncEngine, __func__,
+    "Banning " + nodeId.first.to_string() + ":" + std::to_string(nodeId.second) + ", reason: " + reason
+  );
+  return true;
+}
+
+bool SyncEngine::isBanned(const P2P::NodeID& nodeId) {
+  std::lock_guard lock(this->mutex_);
+  return this->bannedNodes_.contains(nodeId);
+}
+
+void SyncEngine::fetchHeaders(
+  const std::vector<std::pair<P2P::NodeID, uint64_t>>& candidates, const std::atomic<bool>& stop
+) {
+  auto latest = this->storage_->latest();
+  Hash prevHash = latest->hash();
+  uint64_t height = latest->getNHeight() + 1;
+  // Fetch as much as possible from the highest node, and fall back to the next ones if it fails.
+  for (const auto& [nodeId, nodeHeight] : candidates) {
+    if (height > this->targetHeight_ || stop) break;
+    if (this->isBanned(nodeId)) continue;
+    while (height <= std::min(nodeHeight, this->targetHeight_) && !stop) {
+      std::vector<P2P::BlockHeader> headers;
+      try {
+        headers = this->p2p_->requestBlockHeaders(nodeId, height, std::min(nodeHeight, this->targetHeight_) - height + 1);
+      } catch (std::exception& e) {
+        std::unique_lock lock(this->mutex_);
+        bool banned = this->banNode(nodeId, std::string("Malformed headers: ") + e.what());
+        lock.unlock();
+        if (banned) this->p2p_->disconnectSession(nodeId);
+        break;
+      }
+      if (headers.empty()) break;
+      bool linked = true;
+      for (auto& header : headers) {
+        if (header.nHeight != height || header.prevBlockHash != prevHash) { linked = false; break; }
+        prevHash = header.hash;
+        height++;
+        this->headers_.push_back(std::move(header));
+        this->headerSources_.push_back(nodeId);
+      }
+      if (!linked) {
+        std::unique_lock lock(this->mutex_);
+        bool banned = this->banNode(nodeId, "Headers don't link to our chain");
+        lock.unlock();
+        if (banned) this->p2p_->disconnectSession(nodeId);
+        break;
+      }
+    }
+  }
+  LOGINFO(Log::syncEngine,
+    "Fetched " + std::to_string(this->headers_.size()) + " headers, up to height " + std::to_string(height - 1)
+  );
+}
+
+std::optional<std::pair<SyncEngine::Range, P2P::NodeID>> SyncEngine::takeRange() {
+  for (auto it = this->pendingRanges_.begin(); it != this->pendingRanges_.end(); it++) {
+    Range& range = it->second;
+    // Don't run too far ahead of the processing loop.
+    if (range.start >= this->nextHeight_ + this->pipelineCapacity_) return std::nullopt;
+    uint64_t lastHeight = range.start + range.count - 1;
+    bool hasCandidate = false;
+    for (const auto& [nodeId, nodeHeight] : this->nodeHeights_) {
+      if (nodeHeight < lastHeight || this->bannedNodes_.contains(nodeId) || range.triedNodes.contains(nodeId)) continue;
+      hasCandidate = true;
+      if (this->busyNodes_.contains(nodeId)) continue;
+      auto taken = std::make_pair(std::move(range), nodeId);
+      this->pendingRanges_.erase(it);
+      this->busyNodes_.insert(nodeId);
+      return taken;
+    }
+    if (!hasCandidate) {
+      Logger::logToDebug(LogType::WARNING, Log::syncEngine, __func__,
+        "No node left to download blocks " + std::to_string(range.start) + " to " + std::to_string(lastHeight) + ", aborting sync."
+      );
+      this->aborted_ = true;
+      this->cv_.notify_all();
+      return std::nullopt;
+    }
+  }
+  return std::nullopt;
+}
+
+void SyncEngine::downloadRange(Range&& range, const P2P::NodeID& nodeId) {
+  std::vector<Block> blocks;
+  std::string error;
+  bool malformed = false;
+  try {
+    auto bodies = this->p2p_->requestBlockBodies(nodeId, range.start, range.count);
+    if (bodies.size() > range.count) throw std::runtime_error("Too many bodies");
+    blocks.reserve(bodies.size());
+    uint64_t firstHeight = this->headers_.front().nHeight;
+    for (auto& body : bodies) {
+      // Rebuilding verifies the body against the header, and the Validator signature.
+      // A mismatch may be the header's fault, so it doesn't ban the node by itself.
+      const auto& header = this->headers_[range.start + blocks.size() - firstHeight];
+      try {
+        blocks.emplace_back(header.signedHeader, std::move(body.txs), std::move(body.txValidators));
+      } catch (std::exception& e) {
+        error = e.what();
+        break;
+      }
+    }
+  } catch (std::exception& e) {
+    error = e.what();
+    malformed = true;
+  }
+
+  std::unique_lock lock(this->mutex_);
+  this->busyNodes_.erase(nodeId);
+  bool banned = malformed && this->banNode(nodeId, "Malformed bodies: " + error);
+  uint64_t delivered = blocks.size();
+  for (uint64_t i = 0; i < delivered; i++) {
+    this->downloaded_.emplace(range.start + i, std::make_pair(std::move(blocks[i]), nodeId));
+  }
+  if (delivered < range.count) {
+    if (delivered == 0 || !error.empty()) {
+      LOGDEBUG(Log::syncEngine,
+        "Node " + nodeId.first.to_string() + ":" + std::to_string(nodeId.second) + " failed to deliver blocks " +
+        std::to_string(range.start + delivered) + " to " + std::to_string(range.start + range.count - 1) +
+        (error.empty() ? "" : ", error: " + error)
+      );
+      range.triedNodes.insert(nodeId);
+    }
+    range.start += delivered;
+    range.count -= delivered;
+    this->pendingRanges_.emplace(range.start, std::move(range));
+  }
+  this->cv_.notify_all();
+  lock.unlock();
+  if (banned) this->p2p_->disconnectSession(nodeId);
+}
+
+void SyncEngine::downloadLoop(const std::atomic<bool>& stop) {
+  std::unique_lock lock(this->mutex_);
+  while (!stop && !this->aborted_ && this->nextHeight_ <= this->targetHeight_) {
+    auto taken = this->takeRange();
+    if (!taken) {
+      this->cv_.wait_for(lock, std::chrono::milliseconds(100));
+      continue;
+    }
+    lock.unlock();
+    this->downloadRange(std::move(taken->first), taken->second);
+    lock.lock();
+  }
+}
+
+uint64_t SyncEngine::sync(
+  const std::unordered_map<P2P::NodeID, P2P::NodeInfo, SafeHash>& nodes, const std::atomic<bool>& stop
+) {
+  std::vector<std::pair<P2P::NodeID, uint64_t>> candidates;
+  {
+    std::lock_guard lock(this->mutex_);
+    this->nodeHeights_.clear();
+    this->headers_.clear();
+    this->headerSources_.clear();
+    this->pendingRanges_.clear();
+    this->busyNodes_.clear();
+    this->downloaded_.clear();
+    this->aborted_ = false;
+    for (const auto& [nodeId, nodeInfo] : nodes) {
+      if (this->bannedNodes_.contains(nodeId)) continue;
+      this->nodeHeights_[nodeId] = nodeInfo.latestBlockHeight;
+      candidates.emplace_back(nodeId, nodeInfo.latestBlockHeight);
+    }
+  }
+  std::sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b) { return a.second > b.second; });
+  uint64_t startHeight = this->storage_->latest()->getNHeight() + 1;
+  if (candidates.empty() || candidates.front().second < startHeight) return 0;
+  this->targetHeight_ = candidates.front().second;
+
+  // Stage 1: headers.
+  this->fetchHeaders(candidates, stop);
+  if (this->headers_.empty() || stop) return 0;
+
+  // Stage 2: bodies, downloaded by several threads.
+  {
+    std::lock_guard lock(this->mutex_);
+    this->targetHeight_ = this->headers_.back().nHeight;
+    this->nextHeight_ = startHeight;
+    for (uint64_t start = startHeight; start <= this->targetHeight_; start += this->rangeSize_) {
+      this->pendingRanges_.emplace(start, Range{start, std::min(this->rangeSize_, this->targetHeight_ - start + 1), {}});
+    }
+  }
+  std::vector<std::future<void>> downloaders;
+  uint64_t downloaderCount = std::min<uint64_t>(maxParallelDownloads, this->nodeHeights_.size());
+  for (uint64_t i = 0; i < downloaderCount; i++) {
+    downloaders.emplace_back(std::async(std::launch::async, &SyncEngine::downloadLoop, this, std::cref(stop)));
+  }
+
+  // Stage 3: validate and process the blocks in order, as they arrive.
+  uint64_t processed = 0;
+  std::vector<P2P::NodeID> bannedNodes;
+  std::unique_lock lock(this->mutex_);
+  while (!stop && !this->aborted_ && this->nextHeight_ <= this->targetHeight_) {
+    auto it = this->downloaded_.find(this->nextHeight_);
+    if (it == this->downloaded_.end()) {
+      this->cv_.wait_for(lock, std::chrono::milliseconds(100));
+      continue;
+    }
+    Block block = std::move(it->second.first);
+    P2P::NodeID nodeId = it->second.second;
+    this->downloaded_.erase(it);
+    lock.unlock();
+
+    bool valid = true;
+    uint64_t height = block.getNHeight();
+    // The block may have already arrived through a broadcast.
+    if (this->storage_->latest()->getNHeight() < height) {
+      if (this->state_->validateNextBlock(block)) {
+        try {
+          this->state_->processNextBlock(std::move(block));
+          processed++;
+        } catch (std::exception& e) {
+          // Only acceptable if a broadcast of the same block was processed in the meantime.
+          valid = (this->storage_->latest()->getNHeight() >= height);
+        }
+      } else {
+        // Same as above, a broadcast may have moved the chain past this block after the height check.
+        valid = (this->storage_->latest()->getNHeight() >= height);
+      }
+    }
+
+    lock.lock();
+    if (!valid) {
+      // The body matched its header, so both the header and body sources served an invalid block.
+      // Abort, the next sync starts over from fresh headers.
+      if (this->banNode(nodeId, "Invalid block at height " + std::to_string(this->nextHeight_))) {
+        bannedNodes.push_back(nodeId);
+      }
+      const P2P::NodeID& headerSource = this->headerSources_[this->nextHeight_ - startHeight];
+      if (this->banNode(headerSource, "Invalid header at height " + std::to_string(this->nextHeight_))) {
+        bannedNodes.push_back(headerSource);
+      }
+      this->aborted_ = true;
+      break;
+    }
+    this->nextHeight_++;
+    this->cv_.notify_all();
+  }
+  this->cv_.notify_all();
+  lock.unlock();
+  for (const auto& bannedNode : bannedNodes) this->p2p_->disconnectSession(bannedNode);
+  for (auto& downloader : downloaders) downloader.wait();
+  LOGINFO(Log::syncEngine,
+    "Processed " + std::to_string(processed) + " blocks, now at height " +
+    std::to_string(this->storage_->latest()->getNHeight())
+  );
+  return processed;
+}
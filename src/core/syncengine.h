@@ -0,0 +1,172 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#ifndef SYNCENGINE_H
+#define SYNCENGINE_H
+
+#include <condition_variable>
+#include <map>
+#include <unordered_set>
+
+#include "../net/p2p/managernormal.h"
+#include "../utils/block.h"
+#include "../utils/options.h"
+
+// Forward declarations.
+class Storage;
+class State;
+
+/**
+ * Header-first, multi-peer block synchronization engine.
+ * A sync goes through the following stages:
+ * 1. The chain of signed headers is fetched from the highest node (falling back to
+ *    the next highest ones), and checked to link back to our latest block.
+ * 2. Block bodies are downloaded in fixed-size ranges from several nodes at once.
+ *    Each body is rebuilt against its header on the download thread, which verifies
+ *    transaction signatures, Merkle roots and the Validator signature in parallel.
+ * 3. Rebuilt blocks are validated against the State and processed in height order
+ *    by the calling thread, overlapping with the downloads of the next ranges.
+ *    Downloads never run more than `pipelineCapacity` blocks ahead of processing.
+ * Ranges that fail are retried on other nodes. Nodes that send malformed data or
+ * invalid blocks are banned (disconnected and never asked again).
+ * The engine is NOT reentrant, only one sync may run at a time.
+ */
+class SyncEngine {
+  public:
+    /// Maximum number of body ranges downloaded at the same time.
+    static constexpr uint64_t maxParallelDownloads = 8;
+
+  private:
+    /// A range of block bodies to download.
+    struct Range {
+      uint64_t start;  ///< Height of the first block of the range.
+      uint64_t count;  ///< Number of blocks in the range.
+      std::unordered_set<P2P::NodeID, SafeHash> triedNodes;  ///< Nodes that already failed to deliver the range.
+    };
+
+    /// Pointer to the P2P connection manager.
+    const std::unique_ptr<P2P::ManagerNormal>& p2p_;
+
+    /// Pointer to the blockchain's storage.
+    const std::unique_ptr<Storage>& storage_;
+
+    /// Pointer to the blockchain's state.
+    const std::unique_ptr<State>& state_;
+
+    /// Number of blocks in each body range.
+    const uint64_t rangeSize_;
+
+    /// Maximum number of blocks downloaded but not yet processed.
+    const uint64_t pipelineCapacity_;
+
+    /// Nodes that sent invalid data.
+    std::unordered_set<P2P::NodeID, SafeHash> bannedNodes_;
+
+    /// Mutex for managing read/write access to the sync state below.
+    std::mutex mutex_;
+
+    /// Condition variable for waking up the download threads and the processing loop.
+    std::condition_variable cv_;
+
+    /// Known height of each candidate node.
+    std::unordered_map<P2P::NodeID, uint64_t, SafeHash> nodeHeights_;
+
+    /// Chain of headers being synced, starting right after our latest block.
+    std::vector<P2P::BlockHeader> headers_;
+
+    /// Node that sent each header in `headers_`.
+    std::vector<P2P::NodeID> headerSources_;
+
+    /// Body ranges waiting to be downloaded (start height -> range).
+    std::map<uint64_t, Range> pendingRanges_;
+
+    /// Nodes currently serving a download.
+    std::unordered_set<P2P::NodeID, SafeHash> busyNodes_;
+
+    /// Rebuilt blocks waiting to be processed (height -> block and the node that sent it).
+    std::map<uint64_t, std::pair<Block, P2P::NodeID>> downloaded_;
+
+    /// Height of the next block to be processed.
+    uint64_t nextHeight_ = 0;
+
+    /// Height of the last block to be synced.
+    uint64_t targetHeight_ = 0;
+
+    /// Indicates whether the current sync was aborted.
+    bool aborted_ = false;
+
+    /**
+     * Ban a node. Caller must hold `mutex_`, and disconnect the node after releasing it.
+     * @param nodeId The ID of the node to ban.
+     * @param reason The reason for the ban, for logging.
+     * @return `true` if the node was not banned before, `false` otherwise.
+     */
+    bool banNode(const P2P::NodeID& nodeId, const std::string& reason);
+
+    /**
+     * Fetch the chain of headers after our latest block, filling `headers_`.
+     * @param candidates The candidate nodes and their heights, highest first.
+     * @param stop Flag for stopping the sync.
+     */
+    void fetchHeaders(const std::vector<std::pair<P2P::NodeID, uint64_t>>& candidates, const std::atomic<bool>& stop);
+
+    /**
+     * Take the lowest pending range that can be downloaded now, and pick a node for it.
+     * Caller must hold `mutex_`. Aborts the sync if a range has no node left to try.
+     * @return The range and the chosen node, or an empty optional if nothing can be downloaded yet.
+     */
+    std::optional<std::pair<Range, P2P::NodeID>> takeRange();
+
+    /**
+     * Entry function for the download threads.
+     * @param stop Flag for stopping the sync.
+     */
+    void downloadLoop(const std::atomic<bool>& stop);
+
+    /**
+     * Download and rebuild the blocks of a range from a given node.
+     * @param range The range to download. Whatever is not delivered is queued again.
+     * @param nodeId The ID of the node to download from.
+     */
+    void downloadRange(Range&& range, const P2P::NodeID& nodeId);
+
+  public:
+    /**
+     * Constructor.
+     * @param p2p Pointer to the P2P connection manager.
+     * @param storage Pointer to the blockchain's storage.
+     * @param state Pointer to the blockchain's state.
+     * @param rangeSize Number of blocks in each body range.
+     * @param pipelineCapacity Maximum number of blocks downloaded but not yet processed.
+     */
+    SyncEngine(
+      const std::unique_ptr<P2P::ManagerNormal>& p2p, const std::unique_ptr<Storage>& storage,
+      const std::unique_ptr<State>& state, const uint64_t& rangeSize = 128, const uint64_t& pipelineCapacity = 1024
+    ) : p2p_(p2p), storage_(storage), state_(state),
+      rangeSize_(std::min(rangeSize, P2P::ManagerNormal::maxBodiesPerRequest)),
+      pipelineCapacity_(std::max(pipelineCapacity, rangeSize)) {}
+
+    /**
+     * Sync with the network, up to the height of the highest given node.
+     * Blocks until the sync is done, stopped or aborted.
+     * @param nodes The candidate nodes and their info.
+     * @param stop Flag for stopping the sync.
+     * @return The number of blocks that were processed.
+     */
+    uint64_t sync(
+      const std::unordered_map<P2P::NodeID, P2P::NodeInfo, SafeHash>& nodes, const std::atomic<bool>& stop
+    );
+
+    /**
+     * Check if a node is banned.
+     * @param nodeId The ID of the node.
+     * @return `true` if the node sent invalid data in a previous sync, `false` otherwise.
+     */
+    bool isBanned(const P2P::NodeID& nodeId);
+};
+
+#endif // SYNCENGINE_H
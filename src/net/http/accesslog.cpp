@@ -0,0 +1,70 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include "accesslog.h"
+
+AccessLog::AccessLog(const std::string& path, const RPCOptions& options) : sampling_(options.accessLogSampling) {
+  if (this->sampling_ == 0) return;
+  this->file_.open(path, std::ios::out | std::ios::app);
+  this->writer_ = std::thread(&AccessLog::write, this);
+}
+
+AccessLog::~AccessLog() {
+  if (!this->writer_.joinable()) return;
+  {
+    std::lock_guard lock(this->mutex_);
+    this->stop_ = true;
+  }
+  this->cv_.notify_one();
+  this->writer_.join();
+}
+
+void AccessLog::record(AccessLogEntry&& entry) {
+  {
+    std::lock_guard lock(this->mutex_);
+    if (this->queue_.size() >= AccessLog::maxQueued) { this->dropped_++; return; }
+    this->queue_.emplace_back(std::move(entry));
+  }
+  this->cv_.notify_one();
+}
+
+void AccessLog::write() {
+  std::vector<AccessLogEntry> entries;
+  while (true) {
+    uint64_t dropped = 0;
+    bool stop = false;
+    {
+      std::unique_lock lock(this->mutex_);
+      this->cv_.wait(lock, [this]() { return !this->queue_.empty() || this->stop_; });
+      entries.swap(this->queue_);
+      std::swap(dropped, this->dropped_);
+      stop = this->stop_;
+    }
+    // Formatting and writing happen outside the lock, the workers only wait to push
+    for (const AccessLogEntry& entry : entries) this->file_ << AccessLog::format(entry) << '\n';
+    if (dropped != 0) this->file_ << R"({"dropped":)" << dropped << "}\n";
+    this->file_.flush();
+    entries.clear();
+    if (stop) return;
+  }
+}
+
+std::string AccessLog::format(const AccessLogEntry& entry) {
+  auto itt = std::chrono::system_clock::to_time_t(entry.time);
+  auto millisec = std::chrono::duration_cast<std::chrono::milliseconds>(entry.time.time_since_epoch()) % 1000;
+  std::ostringstream time;
+  time << std::put_time(gmtime(&itt), "%Y-%m-%dT%H:%M:%S") << '.' << std::setfill('0') << std::setw(3) << millisec.count() << 'Z';
+  json line = {
+    {"time", time.str()},
+    {"peer", entry.peer},
+    {"method", entry.method},
+    {"status", entry.status},
+    {"latencyUs", entry.latencyUs},
+    {"bytes", entry.bytes}
+  };
+  return line.dump();
+}
@@ -0,0 +1,109 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#ifndef ACCESSLOG_H
+#define ACCESSLOG_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../utils/options.h"
+
+/// A JSON-RPC request, as written to the access log.
+struct AccessLogEntry {
+  std::chrono::system_clock::time_point time; ///< When the response was ready.
+  std::string peer;                           ///< IP address of the client.
+  std::string method;                         ///< Method of the request ("-" if the body couldn't be parsed).
+  int status = 0;                             ///< JSON-RPC error code of the response, 0 on success.
+  uint64_t latencyUs = 0;                     ///< Time from receiving the request to having the response, in microseconds.
+  uint64_t bytes = 0;                         ///< Size of the response, in bytes.
+};
+
+/**
+ * Sampled access log of the JSON-RPC requests, written as one JSON object per line.
+ * Requests are sampled (one out of every `RPCOptions::accessLogSampling`) and queued
+ * by the RPC workers, and a dedicated thread formats and writes them, so the workers
+ * never wait on the file or on each other. When sampling is 0 the log is disabled:
+ * no file or thread is created and sample() is a single check.
+ * If the writer falls behind, entries past `maxQueued` are dropped and counted.
+ */
+class AccessLog {
+  private:
+    /// Log one out of every `sampling_` requests, 0 disables the log.
+    const uint64_t sampling_;
+
+    /// Number of requests seen by sample().
+    std::atomic<uint64_t> counter_ = 0;
+
+    /// The log file.
+    std::ofstream file_;
+
+    /// Entries waiting to be written.
+    std::vector<AccessLogEntry> queue_;
+
+    /// Number of entries dropped because the queue was full, not reported yet.
+    uint64_t dropped_ = 0;
+
+    /// Indicates whether the writer thread should stop.
+    bool stop_ = false;
+
+    /// Mutex for managing read/write access to the queue.
+    std::mutex mutex_;
+
+    /// Condition variable to wake up the writer thread.
+    std::condition_variable cv_;
+
+    /// The writer thread, only started if the log is enabled.
+    std::thread writer_;
+
+    /// Write the queued entries until the log is destroyed.
+    void write();
+
+  public:
+    /// Maximum number of entries waiting to be written.
+    static constexpr uint64_t maxQueued = 65536;
+
+    /**
+     * Constructor. Opens the file and starts the writer thread if the log is enabled.
+     * @param path Path to the log file (appended to).
+     * @param options The RPC options with the sampling rate.
+     */
+    AccessLog(const std::string& path, const RPCOptions& options);
+
+    /// Destructor. Writes the remaining entries and stops the writer thread.
+    ~AccessLog();
+
+    /**
+     * Decide if the next request should be logged.
+     * @return `true` if the request was sampled, `false` otherwise (always if the log is disabled).
+     */
+    bool sample() {
+      if (this->sampling_ == 0) return false;
+      return this->counter_.fetch_add(1, std::memory_order_relaxed) % this->sampling_ == 0;
+    }
+
+    /**
+     * Queue an entry to be written. Only call it for requests that were sampled.
+     * @param entry The entry.
+     */
+    void record(AccessLogEntry&& entry);
+
+    /**
+     * Format an entry as a JSON line (without the line break).
+     * @param entry The entry.
+     * @return The formatted entry.
+     */
+    static std::string format(const AccessLogEntry& entry);
+};
+
+#endif  // ACCESSLOG_H
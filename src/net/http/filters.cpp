@@ -0,0 +1,122 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include "filters.h"
+
+FilterRegistry::FilterRegistry(const std::unique_ptr<State>& state, const RPCOptions& options)
+  : state_(state), options_(options)
+{
+  if (this->state_) this->state_->addListener(this);
+}
+
+FilterRegistry::~FilterRegistry() {
+  if (this->state_) this->state_->removeListener(this);
+}
+
+void FilterRegistry::expire() {
+  const auto now = std::chrono::steady_clock::now();
+  const auto timeout = std::chrono::seconds(this->options_.filterTimeout);
+  std::erase_if(this->filters_, [&](const auto& item) { return now - item.second.lastPoll > timeout; });
+}
+
+std::string FilterRegistry::add(Filter&& filter) {
+  std::lock_guard lock(this->mutex_);
+  this->expire();
+  if (this->filters_.size() >= this->options_.maxFilters) throw std::runtime_error(
+    "Too many filters, the maximum is " + std::to_string(this->options_.maxFilters)
+  );
+  std::string id = Hex::fromBytes(Utils::randBytes(16), true).get();
+  filter.lastPoll = std::chrono::steady_clock::now();
+  this->filters_.emplace(id, std::move(filter));
+  return id;
+}
+
+bool FilterRegistry::overflowed(const std::string& id, const Filter& filter) const {
+  if (filter.changes.size() <= this->options_.maxFilterChanges) return false;
+  Logger::logToDebug(LogType::WARNING, Log::filterRegistry, __func__,
+    "Filter " + id + " has more than " + std::to_string(this->options_.maxFilterChanges)
+    + " changes since it was last polled, uninstalling it"
+  );
+  return true;
+}
+
+std::string FilterRegistry::newLogFilter(LogFilter&& criteria, const uint64_t& fromBlock, const uint64_t& toBlock) {
+  Filter filter;
+  filter.type = LOGS_FILTER;
+  filter.criteria = std::move(criteria);
+  filter.fromBlock = fromBlock;
+  filter.toBlock = toBlock;
+  return this->add(std::move(filter));
+}
+
+std::string FilterRegistry::newFilter(const FilterType& type) {
+  Filter filter;
+  filter.type = type;
+  filter.fromBlock = 0;
+  filter.toBlock = UINT64_MAX;
+  return this->add(std::move(filter));
+}
+
+bool FilterRegistry::uninstall(const std::string& id) {
+  std::lock_guard lock(this->mutex_);
+  return this->filters_.erase(id) > 0;
+}
+
+json FilterRegistry::getChanges(const std::string& id) {
+  std::lock_guard lock(this->mutex_);
+  this->expire();
+  auto it = this->filters_.find(id);
+  if (it == this->filters_.end()) throw std::runtime_error("filter not found");
+  it->second.lastPoll = std::chrono::steady_clock::now();
+  json ret = json::array();
+  ret.swap(it->second.changes);
+  return ret;
+}
+
+std::tuple<LogFilter, uint64_t, uint64_t> FilterRegistry::getLogFilter(const std::string& id) {
+  std::lock_guard lock(this->mutex_);
+  this->expire();
+  auto it = this->filters_.find(id);
+  if (it == this->filters_.end() || it->second.type != LOGS_FILTER) throw std::runtime_error("filter not found");
+  it->second.lastPoll = std::chrono::steady_clock::now();
+  return std::make_tuple(it->second.criteria, it->second.fromBlock, it->second.toBlock);
+}
+
+void FilterRegistry::onNewBlock(const std::shared_ptr<const Block>& block, const std::vector<Event>& events) {
+  std::lock_guard lock(this->mutex_);
+  this->expire();
+  if (this->filters_.empty()) return;
+  const std::string blockHash = block->hash().hex(true).get();
+  const uint64_t height = block->getNHeight();
+  std::vector<json> logs; // Serialized on demand, once for all filters
+  for (auto it = this->filters_.begin(); it != this->filters_.end();) {
+    Filter& filter = it->second;
+    if (filter.type == BLOCK_FILTER) {
+      filter.changes.push_back(blockHash);
+    } else if (filter.type == LOGS_FILTER && height >= filter.fromBlock && height <= filter.toBlock) {
+      for (size_t i = 0; i < events.size(); i++) {
+        if (!filter.criteria.matches(events[i])) continue;
+        if (logs.empty()) {
+          logs.reserve(events.size());
+          for (const Event& event : events) logs.emplace_back(json::parse(event.serializeForRPC()));
+        }
+        filter.changes.push_back(logs[i]);
+      }
+    }
+    it = this->overflowed(it->first, filter) ? this->filters_.erase(it) : std::next(it);
+  }
+}
+
+void FilterRegistry::onNewTx(const Hash& txHash) {
+  std::lock_guard lock(this->mutex_);
+  if (this->filters_.empty()) return;
+  const std::string hash = txHash.hex(true).get();
+  for (auto it = this->filters_.begin(); it != this->filters_.end();) {
+    if (it->second.type == PENDING_TX_FILTER) it->second.changes.push_back(hash);
+    it = this->overflowed(it->first, it->second) ? this->filters_.erase(it) : std::next(it);
+  }
+}
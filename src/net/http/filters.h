@@ -0,0 +1,129 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#ifndef FILTERS_H
+#define FILTERS_H
+
+#include <chrono>
+
+#include "subscriptions.h"
+
+/// Enum for the types of `eth_newFilter`-style filters.
+enum FilterType { BLOCK_FILTER, LOGS_FILTER, PENDING_TX_FILTER };
+
+/**
+ * In-memory registry of the filters installed with `eth_newFilter`, `eth_newBlockFilter`
+ * and `eth_newPendingTransactionFilter`.
+ * Each filter keeps the changes since its last poll, appended as blocks are stored and
+ * transactions enter the mempool, so `eth_getFilterChanges` only hands over (and clears)
+ * the new items instead of querying a block range again.
+ * Filters that aren't polled for `RPCOptions::filterTimeout` seconds, or that pile up more
+ * than `RPCOptions::maxFilterChanges` changes, are uninstalled.
+ */
+class FilterRegistry : public StateListener {
+  private:
+    /// An installed filter.
+    struct Filter {
+      FilterType type;                                  ///< The filter type.
+      LogFilter criteria;                               ///< The log criteria, for log filters.
+      uint64_t fromBlock;                               ///< The first block to match, for log filters.
+      uint64_t toBlock;                                 ///< The last block to match, for log filters (UINT64_MAX = latest).
+      json changes = json::array();                     ///< Changes since the last poll.
+      std::chrono::steady_clock::time_point lastPoll;   ///< When the filter was installed or last polled.
+    };
+
+    /// Reference pointer to the blockchain's state.
+    const std::unique_ptr<State>& state_;
+
+    /// The RPC options with the filter limits.
+    const RPCOptions options_;
+
+    /// Installed filters (filter ID -> filter).
+    std::unordered_map<std::string, Filter> filters_;
+
+    /// Mutex for managing read/write access to the filters.
+    std::mutex mutex_;
+
+    /// Uninstall the filters that timed out. Must be called with the mutex locked.
+    void expire();
+
+    /**
+     * Install a filter.
+     * @param filter The filter.
+     * @return The filter ID.
+     * @throw std::runtime_error if the maximum number of filters is reached.
+     */
+    std::string add(Filter&& filter);
+
+    /**
+     * Check if a filter has more changes than allowed, logging it.
+     * @param id The filter ID.
+     * @param filter The filter.
+     * @return `true` if the filter should be uninstalled, `false` otherwise.
+     */
+    bool overflowed(const std::string& id, const Filter& filter) const;
+
+  public:
+    /**
+     * Constructor. Registers the registry as a State listener.
+     * @param state Reference pointer to the blockchain's state.
+     * @param options The RPC options with the filter limits.
+     */
+    FilterRegistry(const std::unique_ptr<State>& state, const RPCOptions& options);
+
+    /// Destructor. Unregisters the registry from the State.
+    ~FilterRegistry() override;
+
+    /**
+     * Install a log filter.
+     * @param criteria The log criteria.
+     * @param fromBlock The first block to match.
+     * @param toBlock The last block to match (UINT64_MAX = latest).
+     * @return The filter ID.
+     * @throw std::runtime_error if the maximum number of filters is reached.
+     */
+    std::string newLogFilter(LogFilter&& criteria, const uint64_t& fromBlock, const uint64_t& toBlock);
+
+    /**
+     * Install a block or pending transaction filter.
+     * @param type The filter type.
+     * @return The filter ID.
+     * @throw std::runtime_error if the maximum number of filters is reached.
+     */
+    std::string newFilter(const FilterType& type);
+
+    /**
+     * Uninstall a filter.
+     * @param id The filter ID.
+     * @return `true` if the filter was uninstalled, `false` if it doesn't exist.
+     */
+    bool uninstall(const std::string& id);
+
+    /**
+     * Take the changes of a filter since its last poll.
+     * @param id The filter ID.
+     * @return The changes (block hashes, logs or transaction hashes).
+     * @throw std::runtime_error if the filter doesn't exist.
+     */
+    json getChanges(const std::string& id);
+
+    /**
+     * Get the criteria of a log filter, for `eth_getFilterLogs`.
+     * @param id The filter ID.
+     * @return The log criteria, the first block and the last block (UINT64_MAX = latest).
+     * @throw std::runtime_error if the filter doesn't exist or isn't a log filter.
+     */
+    std::tuple<LogFilter, uint64_t, uint64_t> getLogFilter(const std::string& id);
+
+    /// Append a new block to the block filters and its matching logs to the log filters.
+    void onNewBlock(const std::shared_ptr<const Block>& block, const std::vector<Event>& events) override;
+
+    /// Append a new mempool transaction to the pending transaction filters.
+    void onNewTx(const Hash& txHash) override;
+};
+
+#endif  // FILTERS_H
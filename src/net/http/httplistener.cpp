@@ -10,9 +10,12 @@ See the LICENSE.txt file in the project root for more information.
 HTTPListener::HTTPListener(
   net::io_context& ioc, tcp::endpoint ep, const std::shared_ptr<const std::string>& docroot,
   const std::unique_ptr<State>& state, const std::unique_ptr<Storage>& storage,
-  const std::unique_ptr<P2P::ManagerNormal>& p2p, const std::unique_ptr<Options>& options
+  const std::unique_ptr<P2P::ManagerNormal>& p2p, const std::unique_ptr<Options>& options,
+  RPCWorkerPool& workers, FilterRegistry& filters, RPCCache& cache,
+  AccessLog& accessLog, RateLimiter& limiter, SubscriptionManager& subscriptions
 ) : ioc_(ioc), acc_(net::make_strand(ioc)), docroot_(docroot), state_(state),
-  storage_(storage), p2p_(p2p), options_(options)
+  storage_(storage), p2p_(p2p), options_(options), workers_(workers),
+  filters_(filters), cache_(cache), accessLog_(accessLog), limiter_(limiter), subscriptions_(subscriptions)
 {
   beast::error_code ec;
   this->acc_.open(ep.protocol(), ec);  // Open the acceptor
@@ -34,11 +37,21 @@ void HTTPListener::do_accept() {
 void HTTPListener::on_accept(beast::error_code ec, tcp::socket sock) {
   if (ec) {
     fail("HTTPListener", __func__, ec, "Failed to accept connection");
-  } else {
+    return this->do_accept(); // Accept another connection
+  }
+  auto endpoint = sock.remote_endpoint(ec);
+  const std::string peer = ec ? "-" : endpoint.address().to_string();
+  if (auto connection = this->limiter_.connect(peer)) {
     std::make_shared<HTTPSession>(
-      std::move(sock), this->docroot_, this->state_, this->storage_, this->p2p_,
-      this->options_
+      std::move(sock), connection, this->docroot_, this->state_, this->storage_, this->p2p_,
+      this->options_, this->workers_, this->filters_, this->cache_, this->accessLog_,
+      this->limiter_, this->subscriptions_
     )->start(); // Create the http session and run it
+  } else {
+    // The socket is closed when it goes out of scope
+    Logger::logToDebug(LogType::WARNING, Log::httpListener, __func__,
+      "Refusing connection from " + peer + ", too many open connections"
+    );
   }
   this->do_accept(); // Accept another connection
 }
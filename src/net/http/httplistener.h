@@ -35,11 +35,30 @@ class HTTPListener : public std::enable_shared_from_this<HTTPListener> {
     /// Reference pointer to the options singleton.
     const std::unique_ptr<Options>& options_;
 
+    /// Reference to the RPC worker pool.
+    RPCWorkerPool& workers_;
+
+    /// Reference to the filter registry.
+    FilterRegistry& filters_;
+
+    /// Reference to the cache of immutable responses.
+    RPCCache& cache_;
+
+    /// Reference to the access log.
+    AccessLog& accessLog_;
+
+    /// Reference to the rate limiter.
+    RateLimiter& limiter_;
+
+    /// Reference to the WebSocket subscription manager.
+    SubscriptionManager& subscriptions_;
+
     /// Accept an incoming connection from the endpoint. The new connection gets its own strand.
     void do_accept();
 
     /**
      * Callback for do_accept().
+     * Refuses the connection if it goes over the connection limits (see RateLimiter::connect()).
      * Automatically listens to another session when finished dispatching.
      * @param ec The error code to parse.
      * @param sock The socket to use for creating the HTTP session.
@@ -56,11 +75,19 @@ class HTTPListener : public std::enable_shared_from_this<HTTPListener> {
      * @param storage Reference pointer to the blockchain's storage.
      * @param p2p Reference pointer to the P2P connection manager.
      * @param options Reference pointer to the options singleton.
+     * @param workers Reference to the RPC worker pool.
+     * @param filters Reference to the filter registry.
+     * @param cache Reference to the cache of immutable responses.
+     * @param accessLog Reference to the access log.
+     * @param limiter Reference to the rate limiter.
+     * @param subscriptions Reference to the WebSocket subscription manager.
      */
     HTTPListener(
       net::io_context& ioc, tcp::endpoint ep, const std::shared_ptr<const std::string>& docroot,
       const std::unique_ptr<State>& state, const std::unique_ptr<Storage>& storage,
-      const std::unique_ptr<P2P::ManagerNormal>& p2p, const std::unique_ptr<Options>& options
+      const std::unique_ptr<P2P::ManagerNormal>& p2p, const std::unique_ptr<Options>& options,
+      RPCWorkerPool& workers, FilterRegistry& filters, RPCCache& cache,
+      AccessLog& accessLog, RateLimiter& limiter, SubscriptionManager& subscriptions
     );
 
     void start(); ///< Start accepting incoming connections.
@@ -6,27 +6,72 @@ See the LICENSE.txt file in the project root for more information.
 */
 
 #include "httpparser.h"
+#include "filters.h"
+#include "rpccache.h"
+#include "accesslog.h"
+#include "ratelimiter.h"
 
-std::string parseJsonRpcRequest(
-  const std::string& body,
+/**
+ * Register the latency histograms of the JSON-RPC methods.
+ * @return The histograms, indexed by JsonRPC::Methods.
+ */
+static std::array<Histogram*, JsonRPC::Methods::debug_dumpTrace + 1> registerRpcLatencies() {
+  std::array<Histogram*, JsonRPC::Methods::debug_dumpTrace + 1> ret;
+  ret.fill(&Metrics::histogram("orbitersdk_rpc_request_seconds",
+    "Time to process a JSON-RPC request, by method", Metrics::latencyBuckets, {{"method", "invalid"}}, 1e-6
+  ));
+  for (const auto& [name, method] : JsonRPC::methodsLookupTable) {
+    ret[method] = &Metrics::histogram("orbitersdk_rpc_request_seconds",
+      "Time to process a JSON-RPC request, by method", Metrics::latencyBuckets, {{"method", name}}, 1e-6
+    );
+  }
+  return ret;
+}
+
+/// Latency of each JSON-RPC method (see processJsonRpcRequest()).
+static const auto rpcLatencies = registerRpcLatencies();
+
+/**
+ * Build the response for a request that threw while being processed.
+ * @param id The request id.
+ * @param e The exception.
+ * @return The serialized error response (-32603).
+ */
+static std::string internalError(const json& id, const std::exception& e) {
+  json error;
+  error["id"] = id;
+  error["jsonrpc"] = 2.0;
+  error["error"]["code"] = -32603;
+  error["error"]["message"] = "Internal error: " + std::string(e.what());
+  return error.dump();
+}
+
+std::string processJsonRpcRequest(
+  json& request,
   const std::unique_ptr<State>& state,
   const std::unique_ptr<Storage>& storage,
   const std::unique_ptr<P2P::ManagerNormal>& p2p,
-  const std::unique_ptr<Options>& options
+  const std::unique_ptr<Options>& options,
+  FilterRegistry& filters,
+  RPCCache& cache,
+  int& status
 ) {
   json ret;
-  uint64_t id = 0;
+  json id = 0;
+  std::string cacheKey; // Only set for methods whose (non-null) results never change
+  std::shared_ptr<const std::string> cached;
   try {
-    Utils::safePrint("HTTP Request: " + body);
-    json request = json::parse(body);
-    Utils::safePrint("HTTP Request Parsed!");
-    if (!JsonRPC::Decoding::checkJsonRPCSpec(request)) {
+    if (!request.is_object() || !JsonRPC::Decoding::checkJsonRPCSpec(request)) {
       ret["error"]["code"] = -32600;
       ret["error"]["message"] = "Invalid request - does not conform to JSON-RPC 2.0 spec";
+      status = -32600;
       return ret.dump();
     }
+    // Keep the id for error responses, so batch clients can match them
+    if (request["id"].is_string() || request["id"].is_number()) id = request["id"];
 
     auto RequestMethod = JsonRPC::Decoding::getMethod(request);
+    HistogramTimer timer(*rpcLatencies[RequestMethod]);
     switch (RequestMethod) {
       case JsonRPC::Methods::invalid:
         ret["error"]["code"] = -32601;
@@ -55,16 +100,21 @@ std::string parseJsonRpcRequest(
         JsonRPC::Decoding::eth_protocolVersion(request);
         ret = JsonRPC::Encoding::eth_protocolVersion(options);
         break;
-      case JsonRPC::Methods::eth_getBlockByHash:
-        ret = JsonRPC::Encoding::eth_getBlockByHash(
-          JsonRPC::Decoding::eth_getBlockByHash(request), storage
-        );
+      case JsonRPC::Methods::eth_getBlockByHash: {
+        auto blockInfo = JsonRPC::Decoding::eth_getBlockByHash(request);
+        cacheKey = "eth_getBlockByHash:" + blockInfo.first.hex().get() + (blockInfo.second ? ":full" : "");
+        if ((cached = cache.get(cacheKey))) break;
+        ret = JsonRPC::Encoding::eth_getBlockByHash(blockInfo, storage);
         break;
-      case JsonRPC::Methods::eth_getBlockByNumber:
-        ret = JsonRPC::Encoding::eth_getBlockByNumber(
-          JsonRPC::Decoding::eth_getBlockByNumber(request, storage), storage
-        );
+      }
+      case JsonRPC::Methods::eth_getBlockByNumber: {
+        // Block tags were already resolved to a height, so "latest" never hits an older block
+        auto blockInfo = JsonRPC::Decoding::eth_getBlockByNumber(request, storage);
+        cacheKey = "eth_getBlockByNumber:" + std::to_string(blockInfo.first) + (blockInfo.second ? ":full" : "");
+        if ((cached = cache.get(cacheKey))) break;
+        ret = JsonRPC::Encoding::eth_getBlockByNumber(blockInfo, storage);
         break;
+      }
       case JsonRPC::Methods::eth_getBlockTransactionCountByHash:
         ret = JsonRPC::Encoding::eth_getBlockTransactionCountByHash(
           JsonRPC::Decoding::eth_getBlockTransactionCountByHash(request), storage
@@ -105,11 +155,48 @@ std::string parseJsonRpcRequest(
         JsonRPC::Decoding::eth_gasPrice(request);
         ret = JsonRPC::Encoding::eth_gasPrice();
         break;
+      case JsonRPC::Methods::eth_maxPriorityFeePerGas:
+        JsonRPC::Decoding::eth_maxPriorityFeePerGas(request);
+        ret = JsonRPC::Encoding::eth_maxPriorityFeePerGas(storage);
+        break;
+      case JsonRPC::Methods::eth_feeHistory:
+        ret = JsonRPC::Encoding::eth_feeHistory(
+          JsonRPC::Decoding::eth_feeHistory(request, storage), storage, options
+        );
+        break;
       case JsonRPC::Methods::eth_getLogs:
         ret = JsonRPC::Encoding::eth_getLogs(
           JsonRPC::Decoding::eth_getLogs(request, storage), state
         );
         break;
+      case JsonRPC::Methods::eth_newFilter:
+        ret = JsonRPC::Encoding::eth_newFilter(
+          JsonRPC::Decoding::eth_newFilter(request, storage), filters
+        );
+        break;
+      case JsonRPC::Methods::eth_newBlockFilter:
+        JsonRPC::Decoding::eth_newBlockFilter(request);
+        ret = JsonRPC::Encoding::eth_newBlockFilter(filters);
+        break;
+      case JsonRPC::Methods::eth_newPendingTransactionFilter:
+        JsonRPC::Decoding::eth_newPendingTransactionFilter(request);
+        ret = JsonRPC::Encoding::eth_newPendingTransactionFilter(filters);
+        break;
+      case JsonRPC::Methods::eth_uninstallFilter:
+        ret = JsonRPC::Encoding::eth_uninstallFilter(
+          JsonRPC::Decoding::eth_uninstallFilter(request), filters
+        );
+        break;
+      case JsonRPC::Methods::eth_getFilterChanges:
+        ret = JsonRPC::Encoding::eth_getFilterChanges(
+          JsonRPC::Decoding::eth_getFilterChanges(request), filters
+        );
+        break;
+      case JsonRPC::Methods::eth_getFilterLogs:
+        ret = JsonRPC::Encoding::eth_getFilterLogs(
+          JsonRPC::Decoding::eth_getFilterLogs(request), filters, storage, state, options
+        );
+        break;
       case JsonRPC::Methods::eth_getBalance:
         ret = JsonRPC::Encoding::eth_getBalance(
           JsonRPC::Decoding::eth_getBalance(request, storage), state
@@ -131,12 +218,15 @@ std::string parseJsonRpcRequest(
           state, p2p
         );
         break;
-      case JsonRPC::Methods::eth_getTransactionByHash:
-        ret = JsonRPC::Encoding::eth_getTransactionByHash(
-          JsonRPC::Decoding::eth_getTransactionByHash(request),
-          storage, state
-        );
+      case JsonRPC::Methods::eth_getTransactionByHash: {
+        Hash txHash = JsonRPC::Decoding::eth_getTransactionByHash(request);
+        cacheKey = "eth_getTransactionByHash:" + txHash.hex().get();
+        if ((cached = cache.get(cacheKey))) break;
+        ret = JsonRPC::Encoding::eth_getTransactionByHash(txHash, storage, state);
+        // Transactions still in the mempool don't have a block yet
+        if (ret["result"].is_object() && ret["result"]["blockHash"].is_null()) cacheKey.clear();
         break;
+      }
       case JsonRPC::Methods::eth_getTransactionByBlockHashAndIndex:
         ret = JsonRPC::Encoding::eth_getTransactionByBlockHashAndIndex(
           JsonRPC::Decoding::eth_getTransactionByBlockHashAndIndex(request), storage
@@ -148,36 +238,338 @@ std::string parseJsonRpcRequest(
           storage
         );
         break;
-      case JsonRPC::Methods::eth_getTransactionReceipt:
-        ret = JsonRPC::Encoding::eth_getTransactionReceipt(
-          JsonRPC::Decoding::eth_getTransactionReceipt(request), storage, state
+      case JsonRPC::Methods::eth_getTransactionReceipt: {
+        Hash txHash = JsonRPC::Decoding::eth_getTransactionReceipt(request);
+        cacheKey = "eth_getTransactionReceipt:" + txHash.hex().get();
+        if ((cached = cache.get(cacheKey))) break;
+        ret = JsonRPC::Encoding::eth_getTransactionReceipt(txHash, storage, state);
+        break;
+      }
+      case JsonRPC::Methods::eth_getBlockReceipts:
+        ret = JsonRPC::Encoding::eth_getBlockReceipts(
+          JsonRPC::Decoding::eth_getBlockReceipts(request, storage), storage, state
         );
         break;
+      case JsonRPC::Methods::debug_dumpTrace:
+        JsonRPC::Decoding::debug_dumpTrace(request);
+        ret = JsonRPC::Encoding::debug_dumpTrace(options);
+        break;
       default:
         ret["error"]["code"] = -32601;
         ret["error"]["message"] = "Method not found";
         break;
     }
-    Utils::safePrint("HTTP Response: " + ret.dump());
+    status = ret.contains("error") ? ret["error"].value("code", -32603) : 0;
     if (request["id"].is_string()) {
-      ret["id"] = request["id"].get<std::string>();
+      id = request["id"].get<std::string>();
     } else if (request["id"].is_number()) {
-      ret["id"] = request["id"].get<uint64_t>();
+      id = request["id"].get<uint64_t>();
     } else if(request["id"].is_null()) {
-      ret["id"] = nullptr;
+      id = nullptr;
     } else {
       throw std::runtime_error("Invalid id type");
     }
+    // Missing results (unknown blocks/txs) may exist later, so they're never cached
+    if (cached == nullptr && !cacheKey.empty() && ret.contains("result") && !ret["result"].is_null()) {
+      cached = std::make_shared<const std::string>(ret.dump());
+      cache.put(cacheKey, cached);
+    }
+    if (cached == nullptr) {
+      ret["id"] = id;
+      return ret.dump();
+    }
+    // Objects keep their insertion order, so the id goes last, just like in the uncached response
+    return cached->substr(0, cached->size() - 1) + ",\"id\":" + id.dump() + "}";
   } catch (std::exception &e) {
-    json error;
-    error["id"] = id;
-    error["jsonrpc"] = 2.0;
-    error["error"]["code"] = -32603;
-    error["error"]["message"] = "Internal error: " + std::string(e.what());
-    return error.dump();
+    status = -32603;
+    return internalError(id, e);
+  }
+}
+
+/**
+ * Process a request decoded by JsonRPC::Decoding::parseRequest(), writing the response straight to a string.
+ * The response is the same processJsonRpcRequest() gives for the json request.
+ * @param request The decoded request.
+ * @param state Reference pointer to the blockchain's state.
+ * @param storage Reference pointer to the blockchain's storage.
+ * @param status Set to the JSON-RPC error code of the response, 0 on success.
+ * @return The serialized response.
+ */
+static std::string processParsedRequest(
+  const JsonRPC::Decoding::ParsedRequest& request,
+  const std::unique_ptr<State>& state,
+  const std::unique_ptr<Storage>& storage,
+  int& status
+) {
+  try {
+    HistogramTimer timer(*rpcLatencies[request.method]);
+    switch (request.method) {
+      case JsonRPC::Methods::eth_getBalance:
+        return JsonRPC::Encoding::eth_getBalance(
+          JsonRPC::Decoding::eth_getBalance(request, storage), state, request.id
+        );
+      case JsonRPC::Methods::eth_call:
+        return JsonRPC::Encoding::eth_call(
+          JsonRPC::Decoding::eth_call(request, storage), state, request.id, status
+        );
+      default:
+        throw std::runtime_error("Method is not decoded by parseRequest()");
+    }
+  } catch (std::exception& e) {
+    status = -32603;
+    // Null ids are answered with 0 on errors, just like processJsonRpcRequest() does
+    return internalError(request.id.is_null() ? json(0) : request.id, e);
+  }
+}
+
+/**
+ * Queue an access log entry for a request, see AccessLog.
+ * @param accessLog Reference to the access log.
+ * @param peer IP address of the client.
+ * @param received When the request was received.
+ * @param method The method of the request ("-" if it has none).
+ * @param status JSON-RPC error code of the response, 0 on success.
+ * @param bytes Size of the response, in bytes.
+ */
+static void logAccess(
+  AccessLog& accessLog, const std::string& peer, const std::chrono::steady_clock::time_point& received,
+  const std::string& method, const int& status, const uint64_t& bytes
+) {
+  AccessLogEntry entry;
+  entry.time = std::chrono::system_clock::now();
+  entry.peer = peer;
+  entry.method = method;
+  entry.status = status;
+  entry.latencyUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - received).count();
+  entry.bytes = bytes;
+  accessLog.record(std::move(entry));
+}
+
+/**
+ * Queue an access log entry for a request, see AccessLog.
+ * @param accessLog Reference to the access log.
+ * @param peer IP address of the client.
+ * @param received When the request was received.
+ * @param request The request object (may be invalid).
+ * @param status JSON-RPC error code of the response, 0 on success.
+ * @param bytes Size of the response, in bytes.
+ */
+static void logAccess(
+  AccessLog& accessLog, const std::string& peer, const std::chrono::steady_clock::time_point& received,
+  const json& request, const int& status, const uint64_t& bytes
+) {
+  auto method = request.is_object() ? request.find("method") : request.end();
+  logAccess(accessLog, peer, received,
+    (method != request.end() && method->is_string()) ? method->get<std::string>() : std::string("-"),
+    status, bytes
+  );
+}
+
+std::string parseError(const std::exception& e) {
+  json error;
+  error["id"] = nullptr;
+  error["jsonrpc"] = 2.0;
+  error["error"]["code"] = -32700;
+  error["error"]["message"] = "Parse error: " + std::string(e.what());
+  return error.dump();
+}
+
+/**
+ * Build the response for a request that went over the client's rate limit, see RateLimiter.
+ * @param request The request object.
+ * @return The serialized error response.
+ */
+static std::string limitExceeded(const json& request) {
+  json error;
+  auto id = request.is_object() ? request.find("id") : request.end();
+  error["id"] = (id != request.end() && (id->is_string() || id->is_number())) ? *id : json(nullptr);
+  error["jsonrpc"] = 2.0;
+  error["error"]["code"] = -32005;
+  error["error"]["message"] = "Limit exceeded - too many requests, try again later";
+  return error.dump();
+}
+
+/// A JSON-RPC batch being processed, shared by the tasks of its requests.
+struct JsonRpcBatch {
+  json requests;                                ///< The requests of the batch.
+  std::vector<std::string> responses;           ///< The serialized responses, in the same order as the requests.
+  std::atomic<uint64_t> remaining;              ///< Number of requests still being processed.
+  std::function<void(std::string)> callback;    ///< Function to call with the batch response.
+};
+
+/**
+ * Store the response of a request of a batch, and send the batch response if it was the last one.
+ * @param batch The batch.
+ * @param i Index of the request in the batch.
+ * @param response The serialized response.
+ * @param status JSON-RPC error code of the response, 0 on success.
+ * @param accessLog Reference to the access log.
+ * @param peer IP address of the client.
+ * @param logged Whether the batch was sampled for the access log.
+ * @param received When the batch was received.
+ */
+static void answerBatchRequest(
+  const std::shared_ptr<JsonRpcBatch>& batch, const uint64_t& i, std::string&& response, const int& status,
+  AccessLog& accessLog, const std::string& peer, const bool& logged, const std::chrono::steady_clock::time_point& received
+) {
+  // Each request of a sampled batch is logged on its own
+  if (logged) logAccess(accessLog, peer, received, batch->requests[i], status, response.size());
+  batch->responses[i] = std::move(response);
+  if (--batch->remaining != 0) return;
+  // The responses are already serialized, so the array is joined as a string
+  std::string ret = "[";
+  for (const auto& res : batch->responses) ret += (ret.size() > 1 ? "," : "") + res;
+  ret += "]";
+  batch->callback(std::move(ret));
+}
+
+void dispatchJsonRpcRequest(
+  std::string&& body,
+  const std::unique_ptr<State>& state,
+  const std::unique_ptr<Storage>& storage,
+  const std::unique_ptr<P2P::ManagerNormal>& p2p,
+  const std::unique_ptr<Options>& options,
+  RPCWorkerPool& workers,
+  FilterRegistry& filters,
+  RPCCache& cache,
+  AccessLog& accessLog,
+  RateLimiter& limiter,
+  const std::string& peer,
+  std::function<void(std::string)>&& callback
+) {
+  // Only sampled requests are timed and logged, the rest skip the access log entirely
+  const bool logged = accessLog.sample();
+  const auto received = logged ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+  // Parsing a large body is expensive too, so it is done by the workers as well
+  workers.push(FAST_LANE, [
+    body = std::move(body), &state, &storage, &p2p, &options, &workers, &filters, &cache, &accessLog,
+    &limiter, peer, logged, received, callback = std::move(callback)
+  ]() mutable {
+    if (dispatchParsedJsonRpcRequest(body, state, storage, workers, accessLog, limiter, peer, logged, received, callback)) {
+      return;
+    }
+    json request;
+    try {
+      request = json::parse(body);
+    } catch (std::exception &e) {
+      std::string response = parseError(e);
+      if (logged) logAccess(accessLog, peer, received, request, -32700, response.size());
+      return callback(std::move(response));
+    }
+    dispatchJsonRpcRequest(std::move(request), state, storage, p2p, options, workers, filters, cache,
+      accessLog, limiter, peer, logged, received, std::move(callback)
+    );
+  });
+}
+
+bool dispatchParsedJsonRpcRequest(
+  const std::string& body,
+  const std::unique_ptr<State>& state,
+  const std::unique_ptr<Storage>& storage,
+  RPCWorkerPool& workers,
+  AccessLog& accessLog,
+  RateLimiter& limiter,
+  const std::string& peer,
+  const bool& logged,
+  const std::chrono::steady_clock::time_point& received,
+  std::function<void(std::string)>& callback
+) {
+  JsonRPC::Decoding::ParsedRequest request;
+  if (!JsonRPC::Decoding::parseRequest(body, request)) return false;
+  if (!limiter.allow(peer, limiter.getMethodCost(request.name))) {
+    json envelope;
+    envelope["id"] = request.id;
+    std::string response = limitExceeded(envelope);
+    if (logged) logAccess(accessLog, peer, received, request.name, -32005, response.size());
+    callback(std::move(response));
+    return true;
+  }
+  RPCLane lane = RPCWorkerPool::getLane(request.method);
+  auto process = [
+    request = std::move(request), &state, &storage, &accessLog, peer, logged, received, callback = std::move(callback)
+  ]() {
+    int status = 0;
+    std::string response = processParsedRequest(request, state, storage, status);
+    if (logged) logAccess(accessLog, peer, received, request.name, status, response.size());
+    callback(std::move(response));
+  };
+  if (lane == FAST_LANE) {
+    process();
+  } else {
+    workers.push(lane, std::move(process));
   }
-  Utils::safePrint("Properly returning...");
-  // Set back to the original id
-  return ret.dump();
+  return true;
 }
 
+void dispatchJsonRpcRequest(
+  json&& request,
+  const std::unique_ptr<State>& state,
+  const std::unique_ptr<Storage>& storage,
+  const std::unique_ptr<P2P::ManagerNormal>& p2p,
+  const std::unique_ptr<Options>& options,
+  RPCWorkerPool& workers,
+  FilterRegistry& filters,
+  RPCCache& cache,
+  AccessLog& accessLog,
+  RateLimiter& limiter,
+  const std::string& peer,
+  const bool& logged,
+  const std::chrono::steady_clock::time_point& received,
+  std::function<void(std::string)>&& callback
+) {
+  if (!request.is_array()) {
+    if (!limiter.allow(peer, request)) {
+      std::string response = limitExceeded(request);
+      if (logged) logAccess(accessLog, peer, received, request, -32005, response.size());
+      return callback(std::move(response));
+    }
+    RPCLane lane = RPCWorkerPool::getLane(request);
+    auto process = [
+      request = std::move(request), &state, &storage, &p2p, &options, &filters, &cache, &accessLog,
+      peer, logged, received, callback = std::move(callback)
+    ]() mutable {
+      int status = 0;
+      std::string response = processJsonRpcRequest(request, state, storage, p2p, options, filters, cache, status);
+      if (logged) logAccess(accessLog, peer, received, request, status, response.size());
+      callback(std::move(response));
+    };
+    if (lane == FAST_LANE) return process();
+    return workers.push(lane, std::move(process));
+  }
+
+  // Batch request, answered with an array of responses in the same order
+  json error;
+  error["id"] = nullptr;
+  error["jsonrpc"] = 2.0;
+  error["error"]["code"] = -32600;
+  if (request.empty()) {
+    error["error"]["message"] = "Invalid request - empty batch";
+    return callback(error.dump());
+  }
+  if (request.size() > options->getRPCOptions().maxBatchSize) {
+    error["error"]["message"] = "Invalid request - batch has more than "
+      + std::to_string(options->getRPCOptions().maxBatchSize) + " requests";
+    return callback(error.dump());
+  }
+
+  // Each request of the batch goes to its own lane, the last one to finish sends the response.
+  // Requests are weighed against the rate limit one by one, so a batch costs the same as its requests.
+  auto batch = std::make_shared<JsonRpcBatch>();
+  batch->requests = std::move(request);
+  batch->responses.resize(batch->requests.size());
+  batch->remaining = batch->requests.size();
+  batch->callback = std::move(callback);
+  for (uint64_t i = 0; i < batch->requests.size(); i++) {
+    if (!limiter.allow(peer, batch->requests[i])) {
+      answerBatchRequest(batch, i, limitExceeded(batch->requests[i]), -32005, accessLog, peer, logged, received);
+      continue;
+    }
+    workers.push(RPCWorkerPool::getLane(batch->requests[i]), [
+      batch, i, &state, &storage, &p2p, &options, &filters, &cache, &accessLog, peer, logged, received
+    ]() {
+      int status = 0;
+      std::string response = processJsonRpcRequest(batch->requests[i], state, storage, p2p, options, filters, cache, status);
+      answerBatchRequest(batch, i, std::move(response), status, accessLog, peer, logged, received);
+    });
+  }
+}
@@ -9,11 +9,13 @@ See the LICENSE.txt file in the project root for more information.
 #define HTTPPARSER_H
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <csignal>
 #include <cstdlib>
 #include <fstream>
 #include <functional>
+#include <future>
 #include <iostream>
 #include <memory>
 #include <sstream>
@@ -44,6 +46,9 @@ See the LICENSE.txt file in the project root for more information.
 
 #include "../utils/utils.h"
 #include "../utils/options.h"
+#include "../../utils/metrics.h"
+#include "../../utils/tracer.h"
+#include "rpcworkerpool.h"
 #include "jsonrpc/methods.h"
 #include "jsonrpc/encoding.h"
 #include "jsonrpc/decoding.h"
@@ -58,23 +63,142 @@ using tcp = boost::asio::ip::tcp;       // from <boost/asio/ip/tcp.hpp>
 // The parser functions never access any of these members, only passes them around.
 class State;
 class Storage;
+class FilterRegistry;
+class RPCCache;
+class AccessLog;
+class RateLimiter;
 namespace P2P { class ManagerNormal; }
 
 /**
- * Parse a JSON-RPC request into a JSON-RPC response, handling all requests and errors.
+ * Process a single, already parsed JSON-RPC request into a JSON-RPC response, handling all errors.
+ * Responses that never change are served from (and stored in) the cache, see RPCCache.
+ * @param request The request object.
+ * @param state Reference pointer to the blockchain's state.
+ * @param storage Reference pointer to the blockchain's storage.
+ * @param p2p Reference pointer to the P2P connection manager.
+ * @param options Reference pointer to the options singleton.
+ * @param filters Reference to the filter registry.
+ * @param cache Reference to the cache of immutable responses.
+ * @param status Set to the JSON-RPC error code of the response, or 0 on success.
+ * @return The serialized response.
+ */
+std::string processJsonRpcRequest(
+  json& request,
+  const std::unique_ptr<State>& state,
+  const std::unique_ptr<Storage>& storage,
+  const std::unique_ptr<P2P::ManagerNormal>& p2p,
+  const std::unique_ptr<Options>& options,
+  FilterRegistry& filters,
+  RPCCache& cache,
+  int& status
+);
+
+/**
+ * Build the response for a request that couldn't be parsed.
+ * @param e The parsing error.
+ * @return The serialized error response (-32700).
+ */
+std::string parseError(const std::exception& e);
+
+/**
+ * Parse a JSON-RPC request and process it on the worker pool, handling all requests and errors.
+ * The request may also be a batch (an array of requests, up to `RPCOptions::maxBatchSize`),
+ * in which case the requests are processed concurrently and answered with an array of
+ * responses in the same order.
+ * Requests over the client's rate limit are answered with a "limit exceeded" error (-32005)
+ * without being executed, see RateLimiter.
  * @param body The request string.
  * @param state Reference pointer to the blockchain's state.
  * @param storage Reference pointer to the blockchain's storage.
  * @param p2p Reference pointer to the P2P connection manager.
  * @param options Reference pointer to the options singleton.
- * @return The response string.
+ * @param workers Reference to the RPC worker pool.
+ * @param filters Reference to the filter registry.
+ * @param cache Reference to the cache of immutable responses.
+ * @param accessLog Reference to the access log.
+ * @param limiter Reference to the rate limiter.
+ * @param peer IP address of the client, for the access log and rate limiting.
+ * @param callback Function called with the response string, from a worker thread.
  */
-std::string parseJsonRpcRequest(
+void dispatchJsonRpcRequest(
+  std::string&& body,
+  const std::unique_ptr<State>& state,
+  const std::unique_ptr<Storage>& storage,
+  const std::unique_ptr<P2P::ManagerNormal>& p2p,
+  const std::unique_ptr<Options>& options,
+  RPCWorkerPool& workers,
+  FilterRegistry& filters,
+  RPCCache& cache,
+  AccessLog& accessLog,
+  RateLimiter& limiter,
+  const std::string& peer,
+  std::function<void(std::string)>&& callback
+);
+
+/**
+ * Process a request of the hottest read methods without building a json object, see
+ * JsonRPC::Decoding::parseRequest(). The response is written straight to a string, and is
+ * the same the json path gives.
+ * Must be called from a worker thread, as cheap requests are processed right away.
+ * @param body The request string.
+ * @param state Reference pointer to the blockchain's state.
+ * @param storage Reference pointer to the blockchain's storage.
+ * @param workers Reference to the RPC worker pool.
+ * @param accessLog Reference to the access log.
+ * @param limiter Reference to the rate limiter.
+ * @param peer IP address of the client, for the access log and rate limiting.
+ * @param logged Whether the request was sampled for the access log.
+ * @param received When the request was received, for the access log.
+ * @param callback Function called with the response string, from a worker thread.
+ *                 Only moved from if the request was dispatched.
+ * @return `true` if the request was dispatched, `false` if it must go through the json path.
+ */
+bool dispatchParsedJsonRpcRequest(
   const std::string& body,
   const std::unique_ptr<State>& state,
   const std::unique_ptr<Storage>& storage,
+  RPCWorkerPool& workers,
+  AccessLog& accessLog,
+  RateLimiter& limiter,
+  const std::string& peer,
+  const bool& logged,
+  const std::chrono::steady_clock::time_point& received,
+  std::function<void(std::string)>& callback
+);
+
+/**
+ * Process an already parsed JSON-RPC request (or batch) on the worker pool.
+ * Must be called from a worker thread, as cheap requests are processed right away.
+ * @param request The request object, or array of requests.
+ * @param state Reference pointer to the blockchain's state.
+ * @param storage Reference pointer to the blockchain's storage.
+ * @param p2p Reference pointer to the P2P connection manager.
+ * @param options Reference pointer to the options singleton.
+ * @param workers Reference to the RPC worker pool.
+ * @param filters Reference to the filter registry.
+ * @param cache Reference to the cache of immutable responses.
+ * @param accessLog Reference to the access log.
+ * @param limiter Reference to the rate limiter.
+ * @param peer IP address of the client, for the access log and rate limiting.
+ * @param logged Whether the request was sampled for the access log.
+ * @param received When the request was received, for the access log.
+ * @param callback Function called with the response string, from a worker thread.
+ */
+void dispatchJsonRpcRequest(
+  json&& request,
+  const std::unique_ptr<State>& state,
+  const std::unique_ptr<Storage>& storage,
   const std::unique_ptr<P2P::ManagerNormal>& p2p,
-  const std::unique_ptr<Options>& options
+  const std::unique_ptr<Options>& options,
+  RPCWorkerPool& workers,
+  FilterRegistry& filters,
+  RPCCache& cache,
+  AccessLog& accessLog,
+  RateLimiter& limiter,
+  const std::string& peer,
+  const bool& logged,
+  const std::chrono::steady_clock::time_point& received,
+  std::function<void(std::string)>&& callback
 );
 
 /**
@@ -83,17 +207,26 @@ std::string parseJsonRpcRequest(
  * so the interface requires the caller to pass a generic lambda to receive the response.
  * @param docroot The root directory of the endpoint.
  * @param req The request to handle.
- * @param send TODO: we're missing details on this, Allocator, Body, the function itself and where it's used
+ * @param send TODO: we're missing details on this, Allocator, Body, the function itself and where it's used.
+ *             JSON-RPC responses are sent later from a worker thread, so it must be copyable and thread-safe.
  * @param state Reference pointer to the blockchain's state.
  * @param storage Reference pointer to the blockchain's storage.
  * @param p2p Reference pointer to the P2P connection manager.
  * @param options Reference pointer to the options singleton.
+ * @param workers Reference to the RPC worker pool.
+ * @param filters Reference to the filter registry.
+ * @param cache Reference to the cache of immutable responses.
+ * @param accessLog Reference to the access log.
+ * @param limiter Reference to the rate limiter.
+ * @param peer IP address of the client, for the access log and rate limiting.
  */
 template<class Body, class Allocator, class Send> void handle_request(
     beast::string_view docroot,
     http::request<Body, http::basic_fields<Allocator>>&& req,
     Send&& send, const std::unique_ptr<State>& state, const std::unique_ptr<Storage>& storage,
-    const std::unique_ptr<P2P::ManagerNormal>& p2p, const std::unique_ptr<Options>& options
+    const std::unique_ptr<P2P::ManagerNormal>& p2p, const std::unique_ptr<Options>& options,
+    RPCWorkerPool& workers, FilterRegistry& filters, RPCCache& cache,
+    AccessLog& accessLog, RateLimiter& limiter, const std::string& peer
 ) {
   // Returns a bad request response
   const auto bad_request = [&req](beast::string_view why){
@@ -128,6 +261,17 @@ template<class Body, class Allocator, class Send> void handle_request(
     return res;
   };
 
+  // Serve the metrics (see Metrics) to scrapers
+  if (req.method() == http::verb::get && req.target() == "/metrics") {
+    http::response<http::string_body> res{http::status::ok, req.version()};
+    res.set(http::field::server, BOOST_BEAST_VERSION_STRING);
+    res.set(http::field::content_type, "text/plain; version=0.0.4");
+    res.keep_alive(req.keep_alive());
+    res.body() = Metrics::serialize();
+    res.prepare_payload();
+    return send(std::move(res));
+  }
+
   // Make sure we can handle the method
   if (req.method() != http::verb::post && req.method() != http::verb::options)
     return send(bad_request("Unknown HTTP-method"));
@@ -151,25 +295,27 @@ template<class Body, class Allocator, class Send> void handle_request(
     return send(std::move(res));
   }
 
-  std::string request = req.body();
-  std::string answer = parseJsonRpcRequest(
-    request, state, storage, p2p, options
+  // The request is executed by the workers, the response is built once it's done
+  unsigned version = req.version();
+  bool keepAlive = req.keep_alive();
+  dispatchJsonRpcRequest(std::move(req.body()), state, storage, p2p, options, workers, filters, cache, accessLog, limiter, peer,
+    [send, version, keepAlive](std::string answer) {
+      http::response<http::string_body> res{http::status::ok, version};
+      res.set(http::field::server, BOOST_BEAST_VERSION_STRING);
+      res.set(http::field::access_control_allow_origin, "*");
+      res.set(http::field::access_control_allow_methods, "POST, GET");
+      res.set(http::field::access_control_allow_headers, "content-type");
+      res.set(http::field::content_type, "application/json");
+      res.set(http::field::connection, "keep-alive");
+      res.set(http::field::strict_transport_security, "max-age=0");
+      res.set(http::field::vary, "Origin");
+      res.set(http::field::access_control_allow_credentials, "true");
+      res.body() = std::move(answer);
+      res.keep_alive(keepAlive);
+      res.prepare_payload();
+      send(std::move(res));
+    }
   );
-
-  http::response<http::string_body> res{http::status::ok, req.version()};
-  res.set(http::field::server, BOOST_BEAST_VERSION_STRING);
-  res.set(http::field::access_control_allow_origin, "*");
-  res.set(http::field::access_control_allow_methods, "POST, GET");
-  res.set(http::field::access_control_allow_headers, "content-type");
-  res.set(http::field::content_type, "application/json");
-  res.set(http::field::connection, "keep-alive");
-  res.set(http::field::strict_transport_security, "max-age=0");
-  res.set(http::field::vary, "Origin");
-  res.set(http::field::access_control_allow_credentials, "true");
-  res.body() = answer;
-  res.keep_alive(req.keep_alive());
-  res.prepare_payload();
-  return send(std::move(res));
 }
 
 #endif  // HTTPPARSER_H
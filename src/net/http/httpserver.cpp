@@ -13,22 +13,23 @@ bool HTTPServer::run() {
   auto docroot = std::make_shared<const std::string>(".");
   this->listener_ = std::make_shared<HTTPListener>(
     this->ioc_, tcp::endpoint{address, this->port_}, docroot, this->state_,
-    this->storage_, this->p2p_, this->options_
+    this->storage_, this->p2p_, this->options_, this->workers_, this->filters_, this->cache_, this->accessLog_,
+    this->limiter_, this->subscriptions_
   );
   this->listener_->start();
 
-  // Run the I/O service on the requested number of threads (4)
+  // Run the I/O service on the requested number of threads
   std::vector<std::thread> v;
-  v.reserve(4 - 1);
-  for (int i = 4 - 1; i > 0; i--) v.emplace_back([&]{ this->ioc_.run(); });
-  Logger::logToDebug(LogType::INFO, Log::httpServer, __func__,
+  v.reserve(this->ioThreads_ - 1);
+  for (uint64_t i = this->ioThreads_ - 1; i > 0; i--) v.emplace_back([&]{ this->ioc_.run(); });
+  LOGINFO(Log::httpServer,
     std::string("HTTP Server Started at port: ") + std::to_string(port_)
   );
   this->ioc_.run();
 
   // If we get here, it means we got a SIGINT or SIGTERM. Block until all the threads exit
   for (std::thread& t : v) t.join();
-  Logger::logToDebug(LogType::INFO, Log::httpServer, __func__, "HTTP Server Stopped");
+  LOGINFO(Log::httpServer, "HTTP Server Stopped");
   return true;
 }
 
@@ -37,6 +38,9 @@ void HTTPServer::start() {
     Logger::logToDebug(LogType::ERROR, Log::httpServer, __func__, "HTTP Server is already running");
     return;
   }
+  // Spans are only recorded when they can be dumped (see debug_dumpTrace)
+  const RPCOptions& rpcOptions = this->options_->getRPCOptions();
+  if (rpcOptions.enableDumpTrace && !rpcOptions.traceFile.empty()) Tracer::setEnabled(true);
   this->runFuture_ = std::async(std::launch::async, &HTTPServer::run, this);
 }
 
@@ -26,8 +26,30 @@ class HTTPServer {
     /// Reference pointer to the options singleton.
     const std::unique_ptr<Options>& options_;
 
-    /// Provides core I/O functionality ({x} = max threads the object can use).
-    net::io_context ioc_{4};
+    /// Number of threads for socket I/O.
+    const uint64_t ioThreads_;
+
+    /// Per-client limits, declared before `ioc_` so it outlives the sessions (and their connection slots).
+    RateLimiter limiter_;
+
+    /// Provides core I/O functionality (concurrency hint = max threads the object can use).
+    net::io_context ioc_;
+
+    /// Cache of serialized responses that never change, declared before `workers_` so it outlives their tasks.
+    RPCCache cache_;
+
+    /// Access log of the requests, declared before `workers_` so it outlives their tasks.
+    AccessLog accessLog_;
+
+    /// Filters installed with `eth_newFilter` and friends, declared before `workers_` so it outlives their tasks.
+    FilterRegistry filters_;
+
+    /// Feeds the WebSocket subscriptions, declared after `ioc_` so it unregisters from the State before the sessions go away.
+    SubscriptionManager subscriptions_;
+
+    /// Pool that executes the requests, declared last of the above so it finishes its queued tasks
+    /// (which use them) before any of them is destroyed.
+    RPCWorkerPool workers_;
 
     /// Pointer to the HTTP listener.
     std::shared_ptr<HTTPListener> listener_;
@@ -52,7 +74,12 @@ class HTTPServer {
     HTTPServer(
       const std::unique_ptr<State>& state, const std::unique_ptr<Storage>& storage,
       const std::unique_ptr<P2P::ManagerNormal>& p2p, const std::unique_ptr<Options>& options
-    ) : state_(state), storage_(storage), p2p_(p2p), options_(options), port_(options->getHttpPort())
+    ) : state_(state), storage_(storage), p2p_(p2p), options_(options),
+      ioThreads_(std::max<uint64_t>(options->getRPCOptions().ioThreads, 1)),
+      limiter_(options->getRPCOptions()), ioc_(static_cast<int>(ioThreads_)), cache_(options->getRPCOptions()),
+      accessLog_(options->getRootPath() + "/access.log", options->getRPCOptions()),
+      filters_(state, options->getRPCOptions()), subscriptions_(state), workers_(options->getRPCOptions()),
+      port_(options->getHttpPort())
     {}
 
     /**
@@ -69,6 +96,9 @@ class HTTPServer {
      * @return `true` if the server is running, `false` otherwise.
      */
     bool running() const { return this->runFuture_.valid(); }
+
+    /// Getter for `subscriptions_`.
+    SubscriptionManager& getSubscriptions() { return this->subscriptions_; }
 };
 
 #endif  // HTTPSERVER_H
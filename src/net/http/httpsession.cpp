@@ -7,23 +7,36 @@ See the LICENSE.txt file in the project root for more information.
 
 #include "httpsession.h"
 
-HTTPQueue::HTTPQueue(HTTPSession& session) : session_(session) {
+HTTPQueue::HTTPQueue(HTTPSession& session, const uint64_t& limit) : limit_(limit), session_(session) {
   assert(this->limit_ > 0);
   this->items_.reserve(this->limit_);
 }
 
 bool HTTPQueue::full() const { return this->items_.size() >= this->limit_; }
 
+uint64_t HTTPQueue::reserve() {
+  this->items_.emplace_back(nullptr);
+  return this->firstSlot_ + this->items_.size() - 1;
+}
+
+void HTTPQueue::write() {
+  if (this->writing_ || this->items_.empty() || !this->items_.front()) return;
+  this->writing_ = true;
+  (*this->items_.front())();
+}
+
 bool HTTPQueue::on_write() {
   BOOST_ASSERT(!this->items_.empty());
   bool wasFull = this->full();
   this->items_.erase(this->items_.begin());
-  if (!this->items_.empty()) (*this->items_.front())();
+  this->firstSlot_++;
+  this->writing_ = false;
+  this->write();
   return wasFull;
 }
 
 template<bool isRequest, class Body, class Fields> void HTTPQueue::operator()(
-  http::message<isRequest, Body, Fields>&& msg
+  const uint64_t& slot, http::message<isRequest, Body, Fields>&& msg
 ) {
   // This holds a work item
   struct work_impl : work {
@@ -40,15 +53,17 @@ template<bool isRequest, class Body, class Fields> void HTTPQueue::operator()(
     }
   };
 
-  // Allocate and store the work, and if there was no previous work, start this one
-  this->items_.push_back(boost::make_unique<work_impl>(this->session_, std::move(msg))); // This msg is from the header
-  if (this->items_.size() == 1) (*this->items_.front())();
+  // Allocate and store the work in its slot, and start it if it's the first one
+  BOOST_ASSERT(slot >= this->firstSlot_ && slot < this->firstSlot_ + this->items_.size());
+  this->items_[slot - this->firstSlot_] = boost::make_unique<work_impl>(this->session_, std::move(msg)); // This msg is from the header
+  this->write();
 }
 
 void HTTPSession::do_read() {
   this->parser_.emplace();  // Construct a new parser for each message
-  this->parser_->body_limit(10000); // Apply a reasonable limit to body size in bytes to prevent abuse
-  this->stream_.expires_after(std::chrono::seconds(30)); // Set a reasonable timeout
+  this->parser_->body_limit(this->options_->getRPCOptions().maxBodyBytes); // Limit the body size in bytes to prevent abuse
+  // Idle clients are disconnected, so they don't hold on to their connection slot
+  this->stream_.expires_after(std::chrono::seconds(this->options_->getRPCOptions().idleTimeout));
   // Read a request using the parser-oriented interface
   http::async_read(this->stream_, this->buf_, *this->parser_, beast::bind_front_handler(
     &HTTPSession::on_read, this->shared_from_this()
@@ -60,10 +75,27 @@ void HTTPSession::on_read(beast::error_code ec, std::size_t bytes) {
   // This means the other side closed the connection
   if (ec == http::error::end_of_stream) return this->do_close();
   if (ec) return fail("HTTPSession", __func__, ec, "Failed to close connection");
-  // Send the response
+  // WebSocket upgrades take over the connection, see WSSession
+  if (websocket::is_upgrade(this->parser_->get())) {
+    std::make_shared<WSSession>(
+      this->stream_.release_socket(), this->connection_, this->state_, this->storage_, this->p2p_,
+      this->options_, this->workers_, this->filters_, this->cache_, this->accessLog_, this->limiter_,
+      this->subscriptions_
+    )->start(this->parser_->release());
+    return;
+  }
+  // Send the response. The request may be executed by a worker thread,
+  // so the response is handed back to the session's strand to be queued.
+  uint64_t slot = this->queue_.reserve();
   handle_request(
-    *this->docroot_, this->parser_->release(), this->queue_, this->state_,
-    this->storage_, this->p2p_, this->options_
+    *this->docroot_, this->parser_->release(),
+    [self = this->shared_from_this(), slot](auto&& msg) {
+      net::post(self->stream_.get_executor(), [self, slot, msg = std::move(msg)]() mutable {
+        self->queue_(slot, std::move(msg));
+      });
+    },
+    this->state_, this->storage_, this->p2p_, this->options_, this->workers_, this->filters_,
+    this->cache_, this->accessLog_, this->limiter_, this->connection_->getPeer()
   );
   // If queue still has free space, try to pipeline another request
   if (!this->queue_.full()) this->do_read();
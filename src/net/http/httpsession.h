@@ -9,6 +9,7 @@ See the LICENSE.txt file in the project root for more information.
 #define HTTPSESSION_H
 
 #include "httpparser.h"
+#include "wssession.h"
 
 // Forward declarations.
 class HTTPSession;  // HTTPQueue depends on HTTPSession and vice-versa
@@ -16,7 +17,11 @@ class State;
 class Storage;
 namespace P2P { class ManagerNormal; }
 
-/// Class used for HTTP pipelining.
+/**
+ * Class used for HTTP pipelining.
+ * Requests are executed by the RPC workers and may finish out of order, so each
+ * request reserves a slot when it is read, and responses are written in slot order.
+ */
 class HTTPQueue {
   private:
     /// Type-erased, saved work item.
@@ -25,16 +30,22 @@ class HTTPQueue {
       virtual void operator()() = 0;  ///< Default call operator.
     };
 
-    unsigned int limit_ = 8; ///< Maximum number of responses to queue.
+    const uint64_t limit_;   ///< Maximum number of responses to queue.
     HTTPSession& session_;   ///< Reference to the HTTP session that is handling the queue.
-    std::vector<std::unique_ptr<work>> items_; ///< Array of pointers to work structs.
+    std::vector<std::unique_ptr<work>> items_; ///< Array of pointers to work structs, null while the response is not ready.
+    uint64_t firstSlot_ = 0; ///< Slot number of the first item.
+    bool writing_ = false;   ///< Indicates whether the first item is being written.
+
+    /// Start writing the first item, if it is ready and nothing is being written.
+    void write();
 
   public:
     /**
      * Constructor.
      * @param session Reference to the HTTP session that will handle the queue.
+     * @param limit Maximum number of responses to queue.
      */
-    explicit HTTPQueue(HTTPSession& session);
+    HTTPQueue(HTTPSession& session, const uint64_t& limit);
 
     /**
      * Check if the queue limit was hit.
@@ -42,6 +53,12 @@ class HTTPQueue {
      */
     bool full() const;
 
+    /**
+     * Reserve a slot for the response of a request that was just read.
+     * @return The slot number.
+     */
+    uint64_t reserve();
+
     /**
      * Callback for when a message is sent.
      * @return `true` if the caller should read a message, `false` otherwise.
@@ -51,10 +68,11 @@ class HTTPQueue {
     /**
      * Call operator.
      * Called by the HTTP handler to send a response.
+     * @param slot The slot reserved for the response.
      * @param msg The message to send as a response.
      */
     template<bool isRequest, class Body, class Fields> void operator()(
-      http::message<isRequest, Body, Fields>&& msg
+      const uint64_t& slot, http::message<isRequest, Body, Fields>&& msg
     );
 };
 
@@ -92,11 +110,33 @@ class HTTPSession : public std::enable_shared_from_this<HTTPSession> {
     /// Reference pointer to the options singleton.
     const std::unique_ptr<Options>& options_;
 
+    /// Reference to the RPC worker pool.
+    RPCWorkerPool& workers_;
+
+    /// Reference to the filter registry.
+    FilterRegistry& filters_;
+
+    /// Reference to the cache of immutable responses.
+    RPCCache& cache_;
+
+    /// Reference to the access log.
+    AccessLog& accessLog_;
+
+    /// Reference to the rate limiter.
+    RateLimiter& limiter_;
+
+    /// The connection slot of the client (with its IP address), released when the session ends.
+    const std::shared_ptr<const RateLimiter::Connection> connection_;
+
+    /// Reference to the WebSocket subscription manager.
+    SubscriptionManager& subscriptions_;
+
     /// Read whatever is on the internal buffer.
     void do_read();
 
     /**
      * Callback for do_read().
+     * Hands the connection over to a WSSession if the request is a WebSocket upgrade.
      * Tries to pipeline another request if the queue isn't full.
      * @param ec The error code to parse.
      * @param bytes The number of read bytes.
@@ -119,20 +159,37 @@ class HTTPSession : public std::enable_shared_from_this<HTTPSession> {
     /**
      * Constructor.
      * @param sock The socket to take ownership of.
+     * @param connection The connection slot of the client, see RateLimiter::connect().
      * @param docroot Reference pointer to the root directory of the endpoint.
      * @param state Reference pointer to the blockchain's state.
      * @param storage Reference pointer to the blockchain's storage.
      * @param p2p Reference pointer to the P2P connection manager.
      * @param options Reference pointer to the options singleton.
+     * @param workers Reference to the RPC worker pool.
+     * @param filters Reference to the filter registry.
+     * @param cache Reference to the cache of immutable responses.
+     * @param accessLog Reference to the access log.
+     * @param limiter Reference to the rate limiter.
+     * @param subscriptions Reference to the WebSocket subscription manager.
      */
     HTTPSession(tcp::socket&& sock,
+      const std::shared_ptr<const RateLimiter::Connection>& connection,
       const std::shared_ptr<const std::string>& docroot,
       const std::unique_ptr<State>& state,
       const std::unique_ptr<Storage>& storage,
       const std::unique_ptr<P2P::ManagerNormal>& p2p,
-      const std::unique_ptr<Options>& options
-    ) : stream_(std::move(sock)), docroot_(docroot), queue_(*this), state_(state),
-      storage_(storage), p2p_(p2p), options_(options)
+      const std::unique_ptr<Options>& options,
+      RPCWorkerPool& workers,
+      FilterRegistry& filters,
+      RPCCache& cache,
+      AccessLog& accessLog,
+      RateLimiter& limiter,
+      SubscriptionManager& subscriptions
+    ) : stream_(std::move(sock)), docroot_(docroot),
+      queue_(*this, std::max<uint64_t>(options->getRPCOptions().maxPipelinedRequests, 1)), state_(state),
+      storage_(storage), p2p_(p2p), options_(options), workers_(workers),
+      filters_(filters), cache_(cache), accessLog_(accessLog), limiter_(limiter),
+      connection_(connection), subscriptions_(subscriptions)
     {}
 
     /// Start the HTTP session.
@@ -7,14 +7,41 @@ See the LICENSE.txt file in the project root for more information.
 
 #include "decoding.h"
 #include "../../../core/storage.h"
+#include "../filters.h"
 
 namespace JsonRPC::Decoding {
+  /// Character classes for the hex validators: 0 = not hex, 1 = digit or lowercase, 2 = uppercase.
+  static constexpr std::array<uint8_t, 256> hexClasses = []() {
+    std::array<uint8_t, 256> classes{};
+    for (char c = '0'; c <= '9'; c++) classes[uint8_t(c)] = 1;
+    for (char c = 'a'; c <= 'f'; c++) classes[uint8_t(c)] = 1;
+    for (char c = 'A'; c <= 'F'; c++) classes[uint8_t(c)] = 2;
+    return classes;
+  }();
+
+  bool isHexBytes(std::string_view str, const uint64_t& size, bool lowercase) {
+    if (str.size() != 2 + (size * 2) || str[0] != '0' || str[1] != 'x') return false;
+    const uint8_t maxClass = lowercase ? 1 : 2;
+    for (size_t i = 2; i < str.size(); i++) {
+      const uint8_t c = hexClasses[uint8_t(str[i])];
+      if (c == 0 || c > maxClass) return false;
+    }
+    return true;
+  }
+
+  bool isHexQuantity(std::string_view str) {
+    if (str.size() < 3 || str[0] != '0' || str[1] != 'x') return false;
+    if (str[2] == '0') return str.size() == 3;
+    for (size_t i = 2; i < str.size(); i++) if (hexClasses[uint8_t(str[i])] != 1) return false;
+    return true;
+  }
+
   // https://www.jsonrpc.org/specification
   bool checkJsonRPCSpec(const json& request) {
     try {
       // "jsonrpc": "2.0" is a MUST
       if (!request.contains("jsonrpc")) return false;
-      if (request["jsonrpc"].get<std::string>() != "2.0") return false;
+      if (request["jsonrpc"].get_ref<const std::string&>() != "2.0") return false;
 
       // "method" is a MUST
       if (!request.contains("method")) return false;
@@ -35,7 +62,7 @@ namespace JsonRPC::Decoding {
 
   Methods getMethod(const json& request) {
     try {
-      const std::string& method = request["method"].get<std::string>();
+      const std::string& method = request["method"].get_ref<const std::string&>();
       auto it = methodsLookupTable.find(method);
       if (it == methodsLookupTable.end()) return Methods::invalid;
       return it->second;
@@ -47,6 +74,122 @@ namespace JsonRPC::Decoding {
     }
   }
 
+  /**
+   * SAX handler of parseRequest().
+   * Gives up (returns `false`, which stops the parser) on anything ParsedRequest doesn't cover,
+   * including duplicate keys and values of the wrong type, so the json path can answer them.
+   */
+  class RequestSax : public nlohmann::json_sax<json> {
+    private:
+      /// Members of the request envelope, to catch missing and duplicate ones.
+      enum Member : uint8_t { JSONRPC = 1, ID = 2, METHOD = 4, PARAMS = 8 };
+      ParsedRequest& request_;            ///< The request being decoded.
+      uint64_t depth_ = 0;                ///< Current depth (1 = envelope, 2 = params, 3 = transaction object).
+      std::string key_;                   ///< The last key read.
+      uint8_t members_ = 0;               ///< Envelope members read so far.
+      bool hasTxObject_ = false;          ///< Whether the first param is a transaction object.
+      std::vector<std::string> txKeys_;   ///< Keys of the transaction object read so far, null ones included.
+
+    public:
+      /**
+       * Constructor.
+       * @param request The request to decode into.
+       */
+      explicit RequestSax(ParsedRequest& request) : request_(request) {}
+
+      /// Check if a complete request of a covered method was decoded.
+      bool complete() const {
+        if ((this->members_ & (JSONRPC | METHOD | PARAMS)) != (JSONRPC | METHOD | PARAMS)) return false;
+        if (this->request_.method == Methods::eth_getBalance) {
+          return !this->hasTxObject_ && this->request_.params.size() >= 2;
+        }
+        // eth_call without a "to" field is left to the json path, which throws its own error
+        return this->hasTxObject_ && std::any_of(this->request_.txObject.begin(), this->request_.txObject.end(),
+          [](const auto& field) { return field.first == "to"; }
+        );
+      }
+
+      bool null() override {
+        if (this->depth_ == 1 && this->key_ == "id") { this->request_.id = nullptr; return true; }
+        return this->depth_ == 3; // Null fields of the transaction object are the same as missing ones
+      }
+
+      bool boolean(bool) override { return false; }
+
+      /// Negative ids are left to the json path.
+      bool number_integer(number_integer_t) override { return false; }
+
+      bool number_unsigned(number_unsigned_t val) override {
+        if (this->depth_ != 1 || this->key_ != "id") return false;
+        this->request_.id = val;
+        return true;
+      }
+
+      bool number_float(number_float_t, const string_t&) override { return false; }
+
+      bool string(string_t& val) override {
+        if (this->depth_ == 2) { this->request_.params.push_back(std::move(val)); return true; }
+        if (this->depth_ == 3) { this->request_.txObject.emplace_back(this->key_, std::move(val)); return true; }
+        if (this->depth_ != 1) return false;
+        if (this->key_ == "jsonrpc") return val == "2.0";
+        if (this->key_ == "id") { this->request_.id = std::move(val); return true; }
+        if (this->key_ != "method") return false;
+        // Stop right away for the other methods, so they aren't parsed twice
+        auto it = methodsLookupTable.find(val);
+        if (it == methodsLookupTable.end()) return false;
+        if (it->second != Methods::eth_getBalance && it->second != Methods::eth_call) return false;
+        this->request_.method = it->second;
+        this->request_.name = std::move(val);
+        return true;
+      }
+
+      bool binary(binary_t&) override { return false; }
+
+      bool start_object(std::size_t) override {
+        if (this->depth_ == 0) { this->depth_ = 1; return true; }
+        // Only the first param can be an object (eth_call's transaction object)
+        if (this->depth_ != 2 || this->hasTxObject_ || !this->request_.params.empty()) return false;
+        this->hasTxObject_ = true;
+        this->depth_ = 3;
+        return true;
+      }
+
+      bool key(string_t& val) override {
+        if (this->depth_ == 3) {
+          if (std::find(this->txKeys_.begin(), this->txKeys_.end(), val) != this->txKeys_.end()) return false;
+          this->txKeys_.push_back(val);
+        } else {
+          Member member;
+          if (val == "jsonrpc") member = JSONRPC;
+          else if (val == "id") member = ID;
+          else if (val == "method") member = METHOD;
+          else if (val == "params") member = PARAMS;
+          else return false;
+          if (this->members_ & member) return false;
+          this->members_ |= member;
+        }
+        this->key_ = std::move(val);
+        return true;
+      }
+
+      bool end_object() override { this->depth_--; return true; }
+
+      bool start_array(std::size_t) override {
+        if (this->depth_ != 1 || this->key_ != "params") return false;
+        this->depth_ = 2;
+        return true;
+      }
+
+      bool end_array() override { this->depth_--; return true; }
+
+      bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception&) override { return false; }
+  };
+
+  bool parseRequest(std::string_view body, ParsedRequest& request) {
+    RequestSax sax(request);
+    return json::sax_parse(body.begin(), body.end(), &sax) && sax.complete();
+  }
+
   void web3_clientVersion(const json& request) {
     try {
       // No params are needed.
@@ -69,7 +212,7 @@ namespace JsonRPC::Decoding {
       if (request["params"].size() != 1) throw std::runtime_error(
         "web3_sha3 needs 1 param"
       );
-      std::string data = request["params"].at(0).get<std::string>();
+      const std::string& data = request["params"].at(0).get_ref<const std::string&>();
       if (!Hex::isValid(data, true)) throw std::runtime_error("Invalid hex string");
       return Hex::toBytes(data);
     } catch (std::exception& e) {
@@ -137,11 +280,10 @@ namespace JsonRPC::Decoding {
   }
 
   std::pair<Hash,bool> eth_getBlockByHash(const json& request) {
-    static const std::regex hashFilter("^0x[0-9a-f]{64}$");
     try {
       bool includeTxs = (request["params"].size() == 2) ? request["params"].at(1).get<bool>() : false;
-      std::string blockHash = request["params"].at(0).get<std::string>();
-      if (!std::regex_match(blockHash, hashFilter)) throw std::runtime_error("Invalid block hash hex");
+      const std::string& blockHash = request["params"].at(0).get_ref<const std::string&>();
+      if (!isHexBytes(blockHash, 32, true)) throw std::runtime_error("Invalid block hash hex");
       return std::make_pair(Hash(Hex::toBytes(blockHash)), includeTxs);
     } catch (std::exception& e) {
       Logger::logToDebug(LogType::ERROR, Log::JsonRPCDecoding, __func__,
@@ -154,15 +296,14 @@ namespace JsonRPC::Decoding {
   std::pair<uint64_t,bool> eth_getBlockByNumber(
     const json& request, const std::unique_ptr<Storage>& storage
   ) {
-    static const std::regex numFilter("^0x([1-9a-f]+[0-9a-f]*|0)$");
     try {
       bool includeTxs = (request["params"].size() == 2) ? request["params"].at(1).get<bool>() : false;
       // eth_getBlockByNumber has flags for its params instead of hex numbers.
-      std::string blockNum = request["params"].at(0).get<std::string>();
+      const std::string& blockNum = request["params"].at(0).get_ref<const std::string&>();
       if (blockNum == "latest") return std::make_pair(storage->latest()->getNHeight(), includeTxs);
       if (blockNum == "earliest") return std::make_pair(0, includeTxs);
       if (blockNum == "pending") throw std::runtime_error("Pending block is not supported");
-      if (!std::regex_match(blockNum, numFilter)) throw std::runtime_error("Invalid block hash hex");
+      if (!isHexQuantity(blockNum)) throw std::runtime_error("Invalid block hash hex");
       return std::make_pair(uint64_t(Hex(blockNum).getUint()), includeTxs);
     } catch (std::exception& e) {
       Logger::logToDebug(LogType::ERROR, Log::JsonRPCDecoding, __func__,
@@ -173,11 +314,10 @@ namespace JsonRPC::Decoding {
   }
 
   Hash eth_getBlockTransactionCountByHash(const json& request) {
-    static const std::regex hashFilter("^0x[0-9a-f]{64}$");
     try {
       // Check block hash.
-      std::string blockHash = request["params"].at(0).get<std::string>();
-      if (!std::regex_match(blockHash, hashFilter)) throw std::runtime_error("Invalid block hash hex");
+      const std::string& blockHash = request["params"].at(0).get_ref<const std::string&>();
+      if (!isHexBytes(blockHash, 32, true)) throw std::runtime_error("Invalid block hash hex");
       return Hash(Hex::toBytes(blockHash));
     } catch (std::exception& e) {
       Logger::logToDebug(LogType::ERROR, Log::JsonRPCDecoding, __func__,
@@ -190,14 +330,13 @@ namespace JsonRPC::Decoding {
   }
 
   uint64_t eth_getBlockTransactionCountByNumber(const json& request, const std::unique_ptr<Storage>& storage) {
-    static const std::regex numFilter("^0x([1-9a-f]+[0-9a-f]*|0)$");
     try {
       // eth_getBlockTransactionCountByNumber has flags for its params instead of hex numbers.
-      std::string blockNum = request["params"].at(0).get<std::string>();
+      const std::string& blockNum = request["params"].at(0).get_ref<const std::string&>();
       if (blockNum == "latest") return storage->latest()->getNHeight();
       if (blockNum == "earliest") return 0;
       if (blockNum == "pending") throw std::runtime_error("Pending block is not supported");
-      if (!std::regex_match(blockNum, numFilter)) throw std::runtime_error("Invalid block hash hex");
+      if (!isHexQuantity(blockNum)) throw std::runtime_error("Invalid block hash hex");
       return uint64_t(Hex(blockNum).getUint());
     } catch (std::exception& e) {
       Logger::logToDebug(LogType::ERROR, Log::JsonRPCDecoding, __func__,
@@ -256,73 +395,92 @@ namespace JsonRPC::Decoding {
     }
   }
 
-  ethCallInfoAllocated eth_call(const json& request, const std::unique_ptr<Storage> &storage) {
-    ethCallInfoAllocated result;
-    auto& [from, to, gas, gasPrice, value, functor, data] = result;
-    static const std::regex addFilter("^0x[0-9,a-f,A-F]{40}$");
-    static const std::regex numFilter("^0x([1-9a-f]+[0-9a-f]*|0)$");
-    try {
-      json txObj;
-      if (request["params"].is_array()) {
-        txObj = request["params"].at(0);
-        if (request["params"].size() > 1) {
-          const auto block = request["params"].at(1).get<std::string>();
-          if (block != "latest") {
-            if (!std::regex_match(block, numFilter)) throw std::runtime_error(
-              "Invalid block number"
-            );
-            auto blockNum = uint64_t(Hex(block).getUint());
-            if (blockNum != storage->latest()->getNHeight()) throw std::runtime_error(
-              "Only latest block is supported"
-            );
-          }
-        }
-      } else if (request["params"].is_object()) {
-        txObj = request["params"];
-      } else {
-        throw std::runtime_error("Invalid params");
-      }
+  /**
+   * Check the block param of the methods that only support the latest block.
+   * @param block The block param ("latest" or a hex quantity).
+   * @param storage Pointer to the blockchain's storage.
+   * @throw std::runtime_error if the block is invalid or isn't the latest one.
+   */
+  static void checkLatestBlock(const std::string& block, const std::unique_ptr<Storage>& storage) {
+    if (block == "latest") return;
+    if (!isHexQuantity(block)) throw std::runtime_error("Invalid block number");
+    auto blockNum = uint64_t(Hex(block).getUint());
+    if (blockNum != storage->latest()->getNHeight()) throw std::runtime_error(
+      "Only latest block is supported"
+    );
+  }
 
-      // Optional: Check from address
-      if (txObj.contains("from") && !txObj["from"].is_null()) {
-        std::string fromAdd = txObj["from"].get<std::string>();
-        if (!std::regex_match(fromAdd, addFilter)) throw std::runtime_error("Invalid from address hex");
-        from = Address(Hex::toBytes(fromAdd));
-      }
-      // Check to address
-      std::string toAdd = txObj["to"].get<std::string>();
-      if (!std::regex_match(toAdd, addFilter)) throw std::runtime_error("Invalid to address hex");
-      to = Address(Hex::toBytes(toAdd));
-      // Optional: Check gas
-      if (txObj.contains("gas") && !txObj["gas"].is_null()) {
-        std::string gasHex = txObj["gas"].get<std::string>();
-        if (!std::regex_match(gasHex, numFilter)) throw std::runtime_error("Invalid gas hex");
-        gas = uint64_t(Hex(gasHex).getUint());
-      }
-      // Optional: Check gasPrice
-      if (txObj.contains("gasPrice") && !txObj["gasPrice"].is_null()) {
-        std::string gasPriceHex = txObj["gasPrice"].get<std::string>();
-        if (!std::regex_match(gasPriceHex, numFilter)) throw std::runtime_error("Invalid gasPrice hex");
-        gasPrice = uint256_t(Hex(gasPriceHex).getUint());
+  /**
+   * Get the fields of a JSON transaction object, for decodeCallObject().
+   * @param txObj The transaction object.
+   * @return A function returning the value of a field, or `nullptr` if it's missing or null.
+   */
+  static auto jsonField(const json& txObj) {
+    return [&txObj](const char* name) -> const std::string* {
+      auto it = txObj.find(name);
+      return (it == txObj.end() || it->is_null()) ? nullptr : &it->get_ref<const std::string&>();
+    };
+  }
+
+  /**
+   * Decode the fields of an `eth_call` or `eth_estimateGas` transaction object.
+   * @param result The call info to fill.
+   * @param toAdd The "to" field, or `nullptr` to leave it unset (only `eth_estimateGas` allows that).
+   * @param field Function returning the value of a field, or `nullptr` if it's missing or null.
+   */
+  template <typename Field> static void decodeCallObject(
+    ethCallInfoAllocated& result, const std::string* toAdd, const Field& field
+  ) {
+    auto& [from, to, gas, gasPrice, value, functor, data] = result;
+    // Optional: Check from address
+    if (const std::string* fromAdd = field("from")) {
+      if (!isHexBytes(*fromAdd, 20)) throw std::runtime_error("Invalid from address hex");
+      from = Address(Hex::toBytes(*fromAdd));
+    }
+    // Check to address
+    if (toAdd != nullptr) {
+      if (!isHexBytes(*toAdd, 20)) throw std::runtime_error("Invalid to address hex");
+      to = Address(Hex::toBytes(*toAdd));
+    }
+    // Optional: Check gas
+    if (const std::string* gasHex = field("gas")) {
+      if (!isHexQuantity(*gasHex)) throw std::runtime_error("Invalid gas hex");
+      gas = uint64_t(Hex(*gasHex).getUint());
+    }
+    // Optional: Check gasPrice
+    if (const std::string* gasPriceHex = field("gasPrice")) {
+      if (!isHexQuantity(*gasPriceHex)) throw std::runtime_error("Invalid gasPrice hex");
+      gasPrice = uint256_t(Hex(*gasPriceHex).getUint());
+    }
+    // Optional: Check value
+    if (const std::string* valueHex = field("value")) {
+      if (!isHexQuantity(*valueHex)) throw std::runtime_error("Invalid value hex");
+      value = uint256_t(Hex(*valueHex).getUint());
+    }
+    // Optional: Check data
+    if (const std::string* dataHex = field("data")) {
+      if (!Hex::isValid(*dataHex, true)) throw std::runtime_error("Invalid data hex");
+      auto dataBytes = Hex::toBytes(*dataHex);
+      if (dataBytes.size() >= 4) {
+        functor = Functor(Utils::create_view_span(dataBytes, 0, 4));
       }
-      // Optional: Check value
-      if (txObj.contains("value") && !txObj["value"].is_null()) {
-        std::string valueHex = txObj["value"].get<std::string>();
-        if (!std::regex_match(valueHex, numFilter)) throw std::runtime_error("Invalid value hex");
-        value = uint256_t(Hex(valueHex).getUint());
+      if (dataBytes.size() > 4) {
+        data = Bytes(dataBytes.begin() + 4, dataBytes.end());
       }
-      // Optional: Check data
-      if (txObj.contains("data") && !txObj["data"].is_null()) {
-        std::string dataHex = txObj["data"].get<std::string>();
-        if (!Hex::isValid(dataHex, true)) throw std::runtime_error("Invalid data hex");
-        auto dataBytes = Hex::toBytes(dataHex);
-        if (dataBytes.size() >= 4) {
-          functor = Functor(Utils::create_view_span(dataBytes, 0, 4));
-        }
-        if (dataBytes.size() > 4) {
-          data = Bytes(dataBytes.begin() + 4, dataBytes.end());
-        }
+    }
+  }
+
+  ethCallInfoAllocated eth_call(const json& request, const std::unique_ptr<Storage> &storage) {
+    ethCallInfoAllocated result;
+    try {
+      // The transaction object is read in place, without copying it out of the request
+      const json& params = request["params"];
+      if (!params.is_array() && !params.is_object()) throw std::runtime_error("Invalid params");
+      const json& txObj = params.is_array() ? params.at(0) : params;
+      if (params.is_array() && params.size() > 1) {
+        checkLatestBlock(params.at(1).get_ref<const std::string&>(), storage);
       }
+      decodeCallObject(result, &txObj.at("to").get_ref<const std::string&>(), jsonField(txObj));
       return result;
     } catch (std::exception& e) {
       Logger::logToDebug(LogType::ERROR, Log::JsonRPCDecoding, __func__,
@@ -332,78 +490,41 @@ namespace JsonRPC::Decoding {
     }
   }
 
-  ethCallInfoAllocated eth_estimateGas(const json& request, const std::unique_ptr<Storage> &storage) {
+  ethCallInfoAllocated eth_call(const ParsedRequest& request, const std::unique_ptr<Storage>& storage) {
     ethCallInfoAllocated result;
-    auto& [from, to, gas, gasPrice, value, functor, data] = result;
-    static const std::regex addFilter("^0x[0-9,a-f,A-F]{40}$");
-    static const std::regex numFilter("^0x([1-9a-f]+[0-9a-f]*|0)$");
-    try {
-      json txObj;
-      if (request["params"].is_array()) {
-        txObj = request["params"].at(0);
-        if (request["params"].size() > 1) {
-          const auto block = request["params"].at(1).get<std::string>();
-          if (block != "latest") {
-            if (!std::regex_match(block, numFilter)) throw std::runtime_error(
-              "Invalid block number"
-            );
-            auto blockNum = uint64_t(Hex(block).getUint());
-            if (blockNum != storage->latest()->getNHeight()) throw std::runtime_error(
-              "Only latest block is supported"
-            );
-          }
-        }
-      } else if (request["params"].is_object()) {
-        txObj = request["params"];
-      } else {
-        throw std::runtime_error("Invalid params");
-      }
+    try {
+      auto field = [&request](const char* name) -> const std::string* {
+        for (const auto& [key, value] : request.txObject) if (key == name) return &value;
+        return nullptr;
+      };
+      if (!request.params.empty()) checkLatestBlock(request.params[0], storage);
+      // parseRequest() only decodes calls with a "to" field, the others get the json path's error
+      decodeCallObject(result, field("to"), field);
+      return result;
+    } catch (std::exception& e) {
+      Logger::logToDebug(LogType::ERROR, Log::JsonRPCDecoding, __func__,
+        std::string("Error while decoding eth_call: ") + e.what()
+      );
+      throw std::runtime_error("Error while decoding eth_call: " + std::string(e.what()));
+    }
+  }
 
-      // Optional: Check from address
-      if (txObj.contains("from") && !txObj["from"].is_null()) {
-        std::string fromAdd = txObj["from"].get<std::string>();
-        if (!std::regex_match(fromAdd, addFilter)) throw std::runtime_error("Invalid from address hex");
-        from = Address(Hex::toBytes(fromAdd));
-      }
-      // Optional: Check to address
-      if (txObj.contains("to") && !txObj["to"].is_null()) {
-        std::string toAdd = txObj["to"].get<std::string>();
-        if (!std::regex_match(toAdd, addFilter)) throw std::runtime_error("Invalid to address hex");
-        to = Address(Hex::toBytes(toAdd));
-      }
-      // Optional: Check gas
-      if (txObj.contains("gas") && !txObj["gas"].is_null()) {
-        std::string gasHex = txObj["gas"].get<std::string>();
-        if (!std::regex_match(gasHex, numFilter)) throw std::runtime_error("Invalid gas hex");
-        gas = uint64_t(Hex(gasHex).getUint());
-      } else { // eth_estimateGas set gas to max if not specified
-        // TODO: Change this if we ever change gas dynamics with the chain
-        gas = std::numeric_limits<uint64_t>::max();
-      }
-      // Optional: Check gasPrice
-      if (txObj.contains("gasPrice") && !txObj["gasPrice"].is_null()) {
-        std::string gasPriceHex = txObj["gasPrice"].get<std::string>();
-        if (!std::regex_match(gasPriceHex, numFilter)) throw std::runtime_error("Invalid gasPrice hex");
-        gasPrice = uint256_t(Hex(gasPriceHex).getUint());
-      }
-      // Optional: Check value
-      if (txObj.contains("value") && !txObj["value"].is_null()) {
-        std::string valueHex = txObj["value"].get<std::string>();
-        if (!std::regex_match(valueHex, numFilter)) throw std::runtime_error("Invalid value hex");
-        value = uint256_t(Hex(valueHex).getUint());
-      }
-      // Optional: Check data
-      if (txObj.contains("data") && !txObj["data"].is_null()) {
-        std::string dataHex = txObj["data"].get<std::string>();
-        if (!Hex::isValid(dataHex, true)) throw std::runtime_error("Invalid data hex");
-        auto dataBytes = Hex::toBytes(dataHex);
-        if (dataBytes.size() >= 4) {
-          functor = Functor(Utils::create_view_span(dataBytes, 0, 4));
-        }
-        if (dataBytes.size() > 4) {
-          data = Bytes(dataBytes.begin() + 4, dataBytes.end());
-        }
+  ethCallInfoAllocated eth_estimateGas(const json& request, const std::unique_ptr<Storage> &storage) {
+    ethCallInfoAllocated result;
+    try {
+      // The transaction object is read in place, without copying it out of the request
+      const json& params = request["params"];
+      if (!params.is_array() && !params.is_object()) throw std::runtime_error("Invalid params");
+      const json& txObj = params.is_array() ? params.at(0) : params;
+      if (params.is_array() && params.size() > 1) {
+        checkLatestBlock(params.at(1).get_ref<const std::string&>(), storage);
       }
+      // eth_estimateGas sets gas to max if not specified
+      // TODO: Change this if we ever change gas dynamics with the chain
+      auto& gas = std::get<2>(result);
+      gas = std::numeric_limits<uint64_t>::max();
+      auto field = jsonField(txObj);
+      decodeCallObject(result, field("to"), field);
       return result;
     } catch (std::exception& e) {
       Logger::logToDebug(LogType::ERROR, Log::JsonRPCDecoding, __func__,
@@ -424,12 +545,66 @@ namespace JsonRPC::Decoding {
     }
   }
 
+  void eth_maxPriorityFeePerGas(const json& request) {
+    try {
+      // No params are needed.
+      if (!request["params"].empty()) throw std::runtime_error("eth_maxPriorityFeePerGas does not need params");
+      return;
+    } catch (std::exception& e) {
+      Logger::logToDebug(LogType::ERROR, Log::JsonRPCDecoding, __func__,
+        std::string("Error while decoding eth_maxPriorityFeePerGas: ") + e.what()
+      );
+      throw std::runtime_error("Error while decoding eth_maxPriorityFeePerGas: " + std::string(e.what()));
+    }
+  }
+
+  std::tuple<uint64_t, uint64_t, std::vector<double>> eth_feeHistory(
+    const json& request, const std::unique_ptr<Storage>& storage
+  ) {
+    try {
+      // Block count may be a hex string or a plain number, and is capped like other clients do
+      uint64_t blockCount = 0;
+      const json& blockCountJson = request["params"].at(0);
+      if (blockCountJson.is_number_unsigned()) {
+        blockCount = blockCountJson.get<uint64_t>();
+      } else {
+        const std::string& blockCountHex = blockCountJson.get_ref<const std::string&>();
+        if (!isHexQuantity(blockCountHex)) throw std::runtime_error("Invalid block count hex");
+        blockCount = uint64_t(Hex(blockCountHex).getUint());
+      }
+      blockCount = std::min<uint64_t>(blockCount, 1024);
+
+      uint64_t latest = storage->latest()->getNHeight();
+      uint64_t newestBlock = latest;
+      const std::string& newestBlockHex = request["params"].at(1).get_ref<const std::string&>();
+      if (newestBlockHex == "earliest") {
+        newestBlock = 0;
+      } else if (newestBlockHex != "latest" && newestBlockHex != "pending") {
+        if (!isHexQuantity(newestBlockHex)) throw std::runtime_error("Invalid newest block hex");
+        newestBlock = uint64_t(Hex(newestBlockHex).getUint());
+        if (newestBlock > latest) throw std::runtime_error("Newest block is in the future");
+      }
+
+      std::vector<double> percentiles;
+      if (request["params"].size() > 2 && !request["params"].at(2).is_null()) {
+        percentiles = request["params"].at(2).get<std::vector<double>>();
+        for (size_t i = 0; i < percentiles.size(); i++) {
+          if (percentiles[i] < 0 || percentiles[i] > 100) throw std::runtime_error("Percentile out of range");
+          if (i > 0 && percentiles[i] < percentiles[i - 1]) throw std::runtime_error("Percentiles are not sorted");
+        }
+      }
+      return std::make_tuple(blockCount, newestBlock, percentiles);
+    } catch (std::exception& e) {
+      Logger::logToDebug(LogType::ERROR, Log::JsonRPCDecoding, __func__,
+        std::string("Error while decoding eth_feeHistory: ") + e.what()
+      );
+      throw std::runtime_error("Error while decoding eth_feeHistory: " + std::string(e.what()));
+    }
+  }
+
   std::tuple<uint64_t, uint64_t, Address, std::vector<Hash>> eth_getLogs(
     const json& request, const std::unique_ptr<Storage>& storage
   ) {
-    static const std::regex addFilter("^0x[0-9,a-f,A-F]{40}$");
-    static const std::regex numFilter("^0x([1-9a-f]+[0-9a-f]*|0)$");
-    static const std::regex hashFilter("^0x[0-9a-f]{64}$");
     try {
       uint64_t fromBlock = ContractGlobals::getBlockHeight(); // "latest" by default
       uint64_t toBlock = ContractGlobals::getBlockHeight(); // "latest" by default
@@ -438,34 +613,34 @@ namespace JsonRPC::Decoding {
       json logsObject = request["params"].at(0);
 
       if (logsObject.contains("blockHash")) {
-        std::string blockHashHex = logsObject["blockHash"].get<std::string>();
-        if (!std::regex_match(blockHashHex, hashFilter)) throw std::runtime_error("Invalid block hash hex");
+        const std::string& blockHashHex = logsObject["blockHash"].get_ref<const std::string&>();
+        if (!isHexBytes(blockHashHex, 32, true)) throw std::runtime_error("Invalid block hash hex");
         const std::shared_ptr<const Block> block = storage->getBlock(Hash(Hex::toBytes(blockHashHex)));
         fromBlock = toBlock = block->getNHeight();
       } else {
         if (logsObject.contains("fromBlock")) {
-          std::string fromBlockHex = logsObject["fromBlock"].get<std::string>();
+          const std::string& fromBlockHex = logsObject["fromBlock"].get_ref<const std::string&>();
           if (fromBlockHex == "latest") {
             fromBlock = storage->latest()->getNHeight();
           } else if (fromBlockHex == "earliest") {
             fromBlock = 0;
           } else if (fromBlockHex == "pending") {
             throw std::runtime_error("Pending block is not supported");
-          } else if (std::regex_match(fromBlockHex, numFilter)) {
+          } else if (isHexQuantity(fromBlockHex)) {
             fromBlock = uint64_t(Hex(fromBlockHex).getUint());
           } else {
             throw std::runtime_error("Invalid fromBlock hex");
           }
         }
         if (logsObject.contains("toBlock")) {
-          std::string toBlockHex = logsObject["toBlock"].get<std::string>();
+          const std::string& toBlockHex = logsObject["toBlock"].get_ref<const std::string&>();
           if (toBlockHex == "latest") {
             toBlock = storage->latest()->getNHeight();
           } else if (toBlockHex == "earliest") {
             toBlock = 0;
           } else if (toBlockHex == "pending") {
             throw std::runtime_error("Pending block is not supported");
-          } else if (std::regex_match(toBlockHex, numFilter)) {
+          } else if (isHexQuantity(toBlockHex)) {
             toBlock = uint64_t(Hex(toBlockHex).getUint());
           } else {
             throw std::runtime_error("Invalid fromBlock hex");
@@ -474,8 +649,8 @@ namespace JsonRPC::Decoding {
       }
 
       if (logsObject.contains("address")) {
-        std::string addressHex = logsObject["address"].get<std::string>();
-        if (!std::regex_match(addressHex, addFilter)) throw std::runtime_error("Invalid address hex");
+        const std::string& addressHex = logsObject["address"].get_ref<const std::string&>();
+        if (!isHexBytes(addressHex, 20)) throw std::runtime_error("Invalid address hex");
         address = Address(Hex::toBytes(addressHex));
       }
 
@@ -485,7 +660,7 @@ namespace JsonRPC::Decoding {
         }
         auto topicsArray = logsObject.at("topics").get<std::vector<std::string>>();
         for (const auto& topic : topicsArray) {
-          if (!std::regex_match(topic, hashFilter)) throw std::runtime_error("Invalid topic hex");
+          if (!isHexBytes(topic, 32, true)) throw std::runtime_error("Invalid topic hex");
           topics.emplace_back(Hash(Hex::toBytes(topic)));
         }
       }
@@ -500,21 +675,10 @@ namespace JsonRPC::Decoding {
   }
 
   Address eth_getBalance(const json& request, const std::unique_ptr<Storage>& storage) {
-    static const std::regex addFilter("^0x[0-9,a-f,A-F]{40}$");
-    static const std::regex numFilter("^0x([1-9a-f]+[0-9a-f]*|0)$");
     try {
-      const auto address = request["params"].at(0).get<std::string>();
-      const auto block = request["params"].at(1).get<std::string>();
-      if (block != "latest") {
-        if (!std::regex_match(block, numFilter)) throw std::runtime_error(
-          "Invalid block number"
-        );
-        auto blockNum = uint64_t(Hex(block).getUint());
-        if (blockNum != storage->latest()->getNHeight()) throw std::runtime_error(
-          "Only latest block is supported"
-        );
-      }
-      if (!std::regex_match(address, addFilter)) throw std::runtime_error("Invalid address hex");
+      const std::string& address = request["params"].at(0).get_ref<const std::string&>();
+      checkLatestBlock(request["params"].at(1).get_ref<const std::string&>(), storage);
+      if (!isHexBytes(address, 20)) throw std::runtime_error("Invalid address hex");
       return Address(Hex::toBytes(address));
     } catch (std::exception& e) {
       Logger::logToDebug(LogType::ERROR, Log::JsonRPCDecoding, __func__,
@@ -524,14 +688,26 @@ namespace JsonRPC::Decoding {
     }
   }
 
+  Address eth_getBalance(const ParsedRequest& request, const std::unique_ptr<Storage>& storage) {
+    try {
+      // parseRequest() only decodes requests with both params
+      checkLatestBlock(request.params[1], storage);
+      if (!isHexBytes(request.params[0], 20)) throw std::runtime_error("Invalid address hex");
+      return Address(Hex::toBytes(request.params[0]));
+    } catch (std::exception& e) {
+      Logger::logToDebug(LogType::ERROR, Log::JsonRPCDecoding, __func__,
+        std::string("Error while decoding eth_getBalance: ") + e.what()
+      );
+      throw std::runtime_error("Error while decoding eth_getBalance: " + std::string(e.what()));
+    }
+  }
+
   Address eth_getTransactionCount(const json& request, const std::unique_ptr<Storage>& storage) {
-    static const std::regex addFilter("^0x[0-9,a-f,A-F]{40}$");
-    static const std::regex numFilter("^0x([1-9a-f]+[0-9a-f]*|0)$");
     try {
-      const auto address = request["params"].at(0).get<std::string>();
-      const auto block = request["params"].at(1).get<std::string>();
+      const std::string& address = request["params"].at(0).get_ref<const std::string&>();
+      const std::string& block = request["params"].at(1).get_ref<const std::string&>();
       if (block != "latest") {
-        if (!std::regex_match(block, numFilter)) throw std::runtime_error(
+        if (!isHexQuantity(block)) throw std::runtime_error(
           "Invalid block number"
         );
         auto blockNum = uint64_t(Hex(block).getUint());
@@ -539,7 +715,7 @@ namespace JsonRPC::Decoding {
           "Only latest block is supported"
         );
       }
-      if (!std::regex_match(address, addFilter)) throw std::runtime_error("Invalid address hex");
+      if (!isHexBytes(address, 20)) throw std::runtime_error("Invalid address hex");
       return Address(Hex::toBytes(address));
     } catch (std::exception& e) {
       Logger::logToDebug(LogType::ERROR, Log::JsonRPCDecoding, __func__,
@@ -550,13 +726,11 @@ namespace JsonRPC::Decoding {
   }
 
   Address eth_getCode(const json& request, const std::unique_ptr<Storage>& storage) {
-    static const std::regex addFilter("^0x[0-9,a-f,A-F]{40}$");
-    static const std::regex numFilter("^0x([1-9a-f]+[0-9a-f]*|0)$");
     try {
-      const auto address = request["params"].at(0).get<std::string>();
-      const auto block = request["params"].at(1).get<std::string>();
+      const std::string& address = request["params"].at(0).get_ref<const std::string&>();
+      const std::string& block = request["params"].at(1).get_ref<const std::string&>();
       if (block != "latest") {
-        if (!std::regex_match(block, numFilter)) throw std::runtime_error(
+        if (!isHexQuantity(block)) throw std::runtime_error(
           "Invalid block number"
         );
         auto blockNum = uint64_t(Hex(block).getUint());
@@ -564,7 +738,7 @@ namespace JsonRPC::Decoding {
           "Only latest block is supported"
         );
       }
-      if (!std::regex_match(address, addFilter)) throw std::runtime_error("Invalid address hex");
+      if (!isHexBytes(address, 20)) throw std::runtime_error("Invalid address hex");
       return Address(Hex::toBytes(address));
     } catch (std::exception& e) {
       Logger::logToDebug(LogType::ERROR, Log::JsonRPCDecoding, __func__,
@@ -576,7 +750,7 @@ namespace JsonRPC::Decoding {
 
   TxBlock eth_sendRawTransaction(const json& request, const uint64_t& requiredChainId) {
     try {
-      const auto txHex = request["params"].at(0).get<std::string>();
+      const std::string& txHex = request["params"].at(0).get_ref<const std::string&>();
       if (!Hex::isValid(txHex, true)) throw std::runtime_error("Invalid transaction hex");
       return TxBlock(Hex::toBytes(txHex), requiredChainId);
     } catch (std::exception& e) {
@@ -588,10 +762,9 @@ namespace JsonRPC::Decoding {
   }
 
   Hash eth_getTransactionByHash(const json& request) {
-    static const std::regex hashFilter("^0x[0-9,a-f,A-F]{64}$");
     try {
-      const auto hash = request["params"].at(0).get<std::string>();
-      if (!std::regex_match(hash, hashFilter)) throw std::runtime_error("Invalid hash hex");
+      const std::string& hash = request["params"].at(0).get_ref<const std::string&>();
+      if (!isHexBytes(hash, 32)) throw std::runtime_error("Invalid hash hex");
       return Hash(Hex::toBytes(hash));
     } catch (std::exception& e) {
       Logger::logToDebug(LogType::ERROR, Log::JsonRPCDecoding, __func__,
@@ -602,13 +775,11 @@ namespace JsonRPC::Decoding {
   }
 
   std::pair<Hash,uint64_t> eth_getTransactionByBlockHashAndIndex(const json& request) {
-    static const std::regex hashFilter("^0x[0-9,a-f,A-F]{64}$");
-    static const std::regex numFilter("^0x([1-9a-f]+[0-9a-f]*|0)$");
     try {
-      std::string blockHash = request["params"].at(0).get<std::string>();
-      std::string index = request["params"].at(1).get<std::string>();
-      if (!std::regex_match(blockHash, hashFilter)) throw std::runtime_error("Invalid blockHash hex");
-      if (!std::regex_match(index, numFilter)) throw std::runtime_error("Invalid index hex");
+      const std::string& blockHash = request["params"].at(0).get_ref<const std::string&>();
+      const std::string& index = request["params"].at(1).get_ref<const std::string&>();
+      if (!isHexBytes(blockHash, 32)) throw std::runtime_error("Invalid blockHash hex");
+      if (!isHexQuantity(index)) throw std::runtime_error("Invalid index hex");
       return std::make_pair(Hash(Hex::toBytes(blockHash)), uint64_t(Hex(index).getUint()));
     } catch (std::exception& e) {
       Logger::logToDebug(LogType::ERROR, Log::JsonRPCDecoding, __func__,
@@ -623,15 +794,14 @@ namespace JsonRPC::Decoding {
   std::pair<uint64_t,uint64_t> eth_getTransactionByBlockNumberAndIndex(
     const json& request, const std::unique_ptr<Storage>& storage
   ) {
-    static const std::regex numFilter("^0x([1-9a-f]+[0-9a-f]*|0)$");
     try {
-      std::string blockNum = request["params"].at(0).get<std::string>();
-      std::string index = request["params"].at(1).get<std::string>();
-      if (!std::regex_match(index, numFilter)) throw std::runtime_error("Invalid index hex");
+      const std::string& blockNum = request["params"].at(0).get_ref<const std::string&>();
+      const std::string& index = request["params"].at(1).get_ref<const std::string&>();
+      if (!isHexQuantity(index)) throw std::runtime_error("Invalid index hex");
       if (blockNum == "latest") return std::make_pair<uint64_t,uint64_t>(
         storage->latest()->getNHeight(), uint64_t(Hex(index).getUint())
       );
-      if (!std::regex_match(blockNum, numFilter)) throw std::runtime_error("Invalid blockNumber hex");
+      if (!isHexQuantity(blockNum)) throw std::runtime_error("Invalid blockNumber hex");
       return std::make_pair<uint64_t,uint64_t>(
         uint64_t(Hex(blockNum).getUint()), uint64_t(Hex(index).getUint())
       );
@@ -646,10 +816,9 @@ namespace JsonRPC::Decoding {
   }
 
   Hash eth_getTransactionReceipt(const json& request) {
-    static const std::regex hashFilter("^0x[0-9,a-f,A-F]{64}$");
     try {
-      std::string txHash = request["params"].at(0).get<std::string>();
-      if (!std::regex_match(txHash, hashFilter)) throw std::runtime_error("Invalid Hex");
+      const std::string& txHash = request["params"].at(0).get_ref<const std::string&>();
+      if (!isHexBytes(txHash, 32)) throw std::runtime_error("Invalid Hex");
       return Hash(Hex::toBytes(txHash));
     } catch (std::exception& e) {
       Logger::logToDebug(LogType::ERROR, Log::JsonRPCDecoding, __func__,
@@ -660,5 +829,126 @@ namespace JsonRPC::Decoding {
       );
     }
   }
-}
 
+  std::tuple<LogFilter, uint64_t, uint64_t> eth_newFilter(
+    const json& request, const std::unique_ptr<Storage>& storage
+  ) {
+    try {
+      const json& filterObject = request["params"].at(0);
+      uint64_t fromBlock = storage->latest()->getNHeight(); // "latest" by default
+      uint64_t toBlock = UINT64_MAX; // "latest" by default, follows the chain
+      if (filterObject.contains("fromBlock")) {
+        const std::string& fromBlockHex = filterObject["fromBlock"].get_ref<const std::string&>();
+        if (fromBlockHex == "earliest") {
+          fromBlock = 0;
+        } else if (fromBlockHex == "pending") {
+          throw std::runtime_error("Pending block is not supported");
+        } else if (fromBlockHex != "latest") {
+          if (!isHexQuantity(fromBlockHex)) throw std::runtime_error("Invalid fromBlock hex");
+          fromBlock = uint64_t(Hex(fromBlockHex).getUint());
+        }
+      }
+      if (filterObject.contains("toBlock")) {
+        const std::string& toBlockHex = filterObject["toBlock"].get_ref<const std::string&>();
+        if (toBlockHex == "earliest") {
+          toBlock = 0;
+        } else if (toBlockHex == "pending") {
+          throw std::runtime_error("Pending block is not supported");
+        } else if (toBlockHex != "latest") {
+          if (!isHexQuantity(toBlockHex)) throw std::runtime_error("Invalid toBlock hex");
+          toBlock = uint64_t(Hex(toBlockHex).getUint());
+        }
+      }
+      return std::make_tuple(LogFilter::fromJson(filterObject), fromBlock, toBlock);
+    } catch (std::exception& e) {
+      Logger::logToDebug(LogType::ERROR, Log::JsonRPCDecoding, __func__,
+        std::string("Error while decoding eth_newFilter: ") + e.what()
+      );
+      throw std::runtime_error("Error while decoding eth_newFilter: " + std::string(e.what()));
+    }
+  }
+
+  void eth_newBlockFilter(const json& request) {
+    try {
+      // No params are needed.
+      if (!request["params"].empty()) throw std::runtime_error("eth_newBlockFilter does not need params");
+      return;
+    } catch (std::exception& e) {
+      Logger::logToDebug(LogType::ERROR, Log::JsonRPCDecoding, __func__,
+        std::string("Error while decoding eth_newBlockFilter: ") + e.what()
+      );
+      throw std::runtime_error("Error while decoding eth_newBlockFilter: " + std::string(e.what()));
+    }
+  }
+
+  void eth_newPendingTransactionFilter(const json& request) {
+    try {
+      // No params are needed.
+      if (!request["params"].empty()) throw std::runtime_error("eth_newPendingTransactionFilter does not need params");
+      return;
+    } catch (std::exception& e) {
+      Logger::logToDebug(LogType::ERROR, Log::JsonRPCDecoding, __func__,
+        std::string("Error while decoding eth_newPendingTransactionFilter: ") + e.what()
+      );
+      throw std::runtime_error("Error while decoding eth_newPendingTransactionFilter: " + std::string(e.what()));
+    }
+  }
+
+  /**
+   * Parse the filter ID that is the only parameter of the filter methods.
+   * @param request The request object.
+   * @param method The method name, for the error message.
+   * @return The filter ID.
+   */
+  static std::string getFilterId(const json& request, const std::string& method) {
+    try {
+      const std::string& id = request["params"].at(0).get_ref<const std::string&>();
+      if (!Hex::isValid(id, true)) throw std::runtime_error("Invalid filter ID");
+      return id;
+    } catch (std::exception& e) {
+      Logger::logToDebug(LogType::ERROR, Log::JsonRPCDecoding, std::string(method),
+        "Error while decoding " + method + ": " + e.what()
+      );
+      throw std::runtime_error("Error while decoding " + method + ": " + std::string(e.what()));
+    }
+  }
+
+  std::string eth_uninstallFilter(const json& request) { return getFilterId(request, __func__); }
+
+  std::string eth_getFilterChanges(const json& request) { return getFilterId(request, __func__); }
+
+  std::string eth_getFilterLogs(const json& request) { return getFilterId(request, __func__); }
+
+  std::variant<uint64_t, Hash> eth_getBlockReceipts(
+    const json& request, const std::unique_ptr<Storage>& storage
+  ) {
+    try {
+      const std::string& block = request["params"].at(0).get_ref<const std::string&>();
+      if (block == "latest") return storage->latest()->getNHeight();
+      if (block == "earliest") return uint64_t(0);
+      if (block == "pending") throw std::runtime_error("Pending block is not supported");
+      if (isHexBytes(block, 32)) return Hash(Hex::toBytes(block));
+      if (!isHexQuantity(block)) throw std::runtime_error("Invalid block hex");
+      return uint64_t(Hex(block).getUint());
+    } catch (std::exception& e) {
+      Logger::logToDebug(LogType::ERROR, Log::JsonRPCDecoding, __func__,
+        std::string("Error while decoding eth_getBlockReceipts: ") + e.what()
+      );
+      throw std::runtime_error("Error while decoding eth_getBlockReceipts: " + std::string(e.what()));
+    }
+  }
+
+  void debug_dumpTrace(const json& request) {
+    try {
+      // No params are needed, the file is set in the options.
+      if (!request["params"].empty()) throw std::runtime_error(
+        "debug_dumpTrace does not need params"
+      );
+    } catch (std::exception& e) {
+      Logger::logToDebug(LogType::ERROR, Log::JsonRPCDecoding, __func__,
+        std::string("Error while decoding debug_dumpTrace: ") + e.what()
+      );
+      throw std::runtime_error("Error while decoding debug_dumpTrace: " + std::string(e.what()));
+    }
+  }
+}
@@ -8,7 +8,7 @@ See the LICENSE.txt file in the project root for more information.
 #ifndef JSONRPC_DECODING_H
 #define JSONRPC_DECODING_H
 
-#include <regex>
+#include <string_view>
 
 #include "../../../utils/utils.h"
 #include "../../../utils/strings.h"
@@ -20,12 +20,31 @@ See the LICENSE.txt file in the project root for more information.
 
 // Forward declarations.
 class Storage;
+struct LogFilter;
 
 /**
  * Namespace for decoding JSON-RPC data.
  * All functions require a JSON object that is the request itself to be operated on.
  */
 namespace JsonRPC::Decoding {
+  /**
+   * Check if a string is a "0x"-prefixed hex string of an exact number of bytes (hashes, addresses, topics).
+   * Replaces the `std::regex` filters the decoders used to match on every request.
+   * @param str The string to check.
+   * @param size The expected number of bytes.
+   * @param lowercase If `true`, uppercase hex digits are rejected.
+   * @return `true` if the string is valid, `false` otherwise.
+   */
+  bool isHexBytes(std::string_view str, const uint64_t& size, bool lowercase = false);
+
+  /**
+   * Check if a string is a "0x"-prefixed hex quantity, as defined by the JSON-RPC spec
+   * (lowercase digits only, no leading zeroes, "0x0" for zero).
+   * @param str The string to check.
+   * @return `true` if the string is valid, `false` otherwise.
+   */
+  bool isHexQuantity(std::string_view str);
+
   /**
    * Helper function to check if a given JSON-RPC request is valid.
    * Does NOT check if the method called is valid, only if the request follows JSON-RPC 2.0 spec.
@@ -41,6 +60,29 @@ namespace JsonRPC::Decoding {
    */
   Methods getMethod(const json& request);
 
+  /**
+   * A single request decoded straight from its body by parseRequest(), without building a json object.
+   * Only the hottest read methods (`eth_getBalance` and `eth_call`) are decoded this way.
+   */
+  struct ParsedRequest {
+    Methods method = Methods::invalid;  ///< The method of the request.
+    std::string name;                   ///< The method name, for rate limiting and the access log.
+    json id;                            ///< The request id (a string, an unsigned number or null).
+    std::vector<std::string> params;    ///< The string params, in order (without `eth_call`'s transaction object).
+    std::vector<std::pair<std::string, std::string>> txObject;  ///< The non-null fields of `eth_call`'s transaction object.
+  };
+
+  /**
+   * Decode a request body with a SAX parser, for the methods ParsedRequest covers.
+   * Anything else (batches, other methods, unexpected shapes, invalid JSON) is left to
+   * the regular json path, which also builds the error responses, so the answers are the same.
+   * Parsing stops as soon as the method is known not to be covered.
+   * @param body The request string.
+   * @param request The decoded request (only meaningful if the function succeeds).
+   * @return `true` if the request was decoded, `false` if it must be parsed as json instead.
+   */
+  bool parseRequest(std::string_view body, ParsedRequest& request);
+
   /**
    * Check if `web3_clientVersion` is valid.
    * @param request The request object.
@@ -144,6 +186,14 @@ namespace JsonRPC::Decoding {
    */
   ethCallInfoAllocated eth_call(const json& request, const std::unique_ptr<Storage>& storage);
 
+  /**
+   * Check and parse an `eth_call` request decoded by parseRequest().
+   * @param request The decoded request.
+   * @param storage Pointer to the blockchain's storage.
+   * @return A tuple with the call response data (from, to, gas, gasPrice, value, functor, data).
+   */
+  ethCallInfoAllocated eth_call(const ParsedRequest& request, const std::unique_ptr<Storage>& storage);
+
   /**
    * Check and parse a given `eth_estimateGas` request.
    * @param request The request object.
@@ -158,6 +208,22 @@ namespace JsonRPC::Decoding {
    */
   void eth_gasPrice(const json& request);
 
+  /**
+   * Check if `eth_maxPriorityFeePerGas` is valid.
+   * @param request The request object.
+   */
+  void eth_maxPriorityFeePerGas(const json& request);
+
+  /**
+   * Parse an `eth_feeHistory` call's parameters.
+   * @param request The request object.
+   * @param storage Reference pointer to the blockchain's storage.
+   * @return A tuple with the number of blocks (up to 1024), the newest block height and the reward percentiles.
+   */
+  std::tuple<uint64_t, uint64_t, std::vector<double>> eth_feeHistory(
+    const json& request, const std::unique_ptr<Storage>& storage
+  );
+
   /**
    * Parse an `eth_getLogs` call's parameters.
    * @param request The request object.
@@ -176,6 +242,14 @@ namespace JsonRPC::Decoding {
    */
   Address eth_getBalance(const json& request, const std::unique_ptr<Storage>& storage);
 
+  /**
+   * Parse the address of an `eth_getBalance` request decoded by parseRequest() and check if it is valid.
+   * @param request The decoded request.
+   * @param storage Pointer to the blockchain's storage.
+   * @return The requested address.
+   */
+  Address eth_getBalance(const ParsedRequest& request, const std::unique_ptr<Storage>& storage);
+
   /**
    * Parse an `eth_getTransactionCount` address and check if it is valid.
    * @param request The request object.
@@ -230,6 +304,65 @@ namespace JsonRPC::Decoding {
    * @return The build transaction hash object.
    */
   Hash eth_getTransactionReceipt(const json& request);
+
+  /**
+   * Parse an `eth_newFilter` call's parameters.
+   * @param request The request object.
+   * @param storage Reference pointer to the blockchain's storage.
+   * @return A tuple with the log criteria, and starting and ending block height (UINT64_MAX = latest).
+   */
+  std::tuple<LogFilter, uint64_t, uint64_t> eth_newFilter(
+    const json& request, const std::unique_ptr<Storage>& storage
+  );
+
+  /**
+   * Check if `eth_newBlockFilter` is valid.
+   * @param request The request object.
+   */
+  void eth_newBlockFilter(const json& request);
+
+  /**
+   * Check if `eth_newPendingTransactionFilter` is valid.
+   * @param request The request object.
+   */
+  void eth_newPendingTransactionFilter(const json& request);
+
+  /**
+   * Parse an `eth_uninstallFilter` filter ID and check if it is valid.
+   * @param request The request object.
+   * @return The filter ID.
+   */
+  std::string eth_uninstallFilter(const json& request);
+
+  /**
+   * Parse an `eth_getFilterChanges` filter ID and check if it is valid.
+   * @param request The request object.
+   * @return The filter ID.
+   */
+  std::string eth_getFilterChanges(const json& request);
+
+  /**
+   * Parse an `eth_getFilterLogs` filter ID and check if it is valid.
+   * @param request The request object.
+   * @return The filter ID.
+   */
+  std::string eth_getFilterLogs(const json& request);
+
+  /**
+   * Parse an `eth_getBlockReceipts` block and check if it is valid.
+   * @param request The request object.
+   * @param storage Reference pointer to the blockchain's storage.
+   * @return The block height, or the block hash.
+   */
+  std::variant<uint64_t, Hash> eth_getBlockReceipts(
+    const json& request, const std::unique_ptr<Storage>& storage
+  );
+
+  /**
+   * Check if `debug_dumpTrace` is valid.
+   * @param request The request object.
+   */
+  void debug_dumpTrace(const json& request);
 }
 
 #endif /// JSONRPC_DECODING_H
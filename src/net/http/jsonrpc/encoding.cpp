@@ -9,8 +9,30 @@ See the LICENSE.txt file in the project root for more information.
 
 #include "../../../core/storage.h"
 #include "../../../core/state.h"
+#include "../filters.h"
+#include "../../../utils/tracer.h"
 
 namespace JsonRPC::Encoding {
+  std::string writeResult(std::string_view result, const json& id) {
+    std::string ret = "{\"jsonrpc\":\"2.0\",\"result\":\"";
+    ret += result;
+    ret += "\",\"id\":";
+    ret += id.dump();
+    ret += "}";
+    return ret;
+  }
+
+  std::string writeError(const int& code, const std::string& message, const json& id) {
+    std::string ret = "{\"jsonrpc\":\"2.0\",\"error\":{\"code\":";
+    ret += std::to_string(code);
+    ret += ",\"message\":";
+    ret += json(message).dump();
+    ret += "},\"id\":";
+    ret += id.dump();
+    ret += "}";
+    return ret;
+  }
+
   json getBlockJson(const std::shared_ptr<const Block>& block, bool includeTransactions) {
     json ret;
     ret["jsonrpc"] = 2.0;
@@ -35,8 +57,7 @@ namespace JsonRPC::Encoding {
       ret["result"]["totalDifficulty"] = "0x1";
       ret["result"]["baseFeePerGas"] = "0x9502f900";
       ret["result"]["withdrawRoot"] = Hash().hex(true); // No withdrawRoot.
-      // TODO: to get a block you have to serialize it entirely, this can be expensive.
-      ret["result"]["size"] = Hex::fromBytes(Utils::uintToBytes(block->serializeBlock().size()),true).forRPC();
+      ret["result"]["size"] = Hex::fromBytes(Utils::uintToBytes(block->getSize()),true).forRPC();
       ret["result"]["transactions"] = json::array();
       for (const auto& tx : block->getTxs()) {
         if (!includeTransactions) { // Only include the transaction hashes.
@@ -69,6 +90,31 @@ namespace JsonRPC::Encoding {
     return ret;
   }
 
+  json getReceiptJson(
+    const TxBlock& tx, const Hash& blockHash, const uint64_t& txIndex,
+    const uint64_t& blockHeight, const std::vector<Event>& events
+  ) {
+    json ret;
+    ret["transactionHash"] = tx.hash().hex(true);
+    ret["transactionIndex"] = Hex::fromBytes(Utils::uintToBytes(txIndex), true).forRPC();
+    ret["blockHash"] = blockHash.hex(true);
+    ret["blockNumber"] = Hex::fromBytes(Utils::uintToBytes(blockHeight), true).forRPC();
+    ret["from"] = tx.getFrom().hex(true);
+    ret["to"] = tx.getTo().hex(true);
+    ret["cumulativeGasUsed"] = Hex::fromBytes(Utils::uintToBytes(tx.getGasLimit()), true).forRPC();
+    ret["effectiveGasUsed"] = Hex::fromBytes(Utils::uintToBytes(tx.getGasLimit()), true).forRPC();
+    ret["effectiveGasPrice"] = Hex::fromBytes(Utils::uintToBytes(tx.getMaxFeePerGas()),true).forRPC();
+    ret["gasUsed"] = Hex::fromBytes(Utils::uintToBytes(tx.getGasLimit()), true).forRPC();
+    ret["contractAddress"] = json::value_t::null; // TODO: CHANGE THIS WHEN CREATING CONTRACTS!
+    ret["logs"] = json::array();
+    ret["logsBloom"] = Hash().hex(true);
+    ret["type"] = "0x00";
+    ret["root"] = Hash().hex(true);
+    ret["status"] = "0x1"; // TODO: change this when contracts are ready
+    for (const Event& e : events) ret["logs"].push_back(e.serializeForRPC());
+    return ret;
+  }
+
   json web3_clientVersion(const std::unique_ptr<Options>& options) {
     json ret;
     ret["jsonrpc"] = "2.0";
@@ -174,8 +220,6 @@ namespace JsonRPC::Encoding {
     json ret;
     ret["jsonrpc"] = "2.0";
     try {
-      std::cout << "Calling State...: " << std::endl;
-      std::cout << "callInfo functor: " << std::get<5>(callInfo).hex() << std::endl;
       auto result = Hex::fromBytes(state->ethCall(callInfo), true);
       ret["result"] = result;
     } catch (std::exception& e) {
@@ -185,6 +229,18 @@ namespace JsonRPC::Encoding {
     return ret;
   }
 
+  std::string eth_call(
+    const ethCallInfoAllocated& callInfo, const std::unique_ptr<State>& state, const json& id, int& status
+  ) {
+    try {
+      status = 0;
+      return writeResult(Hex::fromBytes(state->ethCall(callInfo), true), id);
+    } catch (std::exception& e) {
+      status = -32000;
+      return writeError(-32000, "Internal error: " + std::string(e.what()), id);
+    }
+  }
+
   json eth_estimateGas(const ethCallInfoAllocated& callInfo, const std::unique_ptr<State>& state) {
     json ret;
     ret["jsonrpc"] = "2.0";
@@ -195,7 +251,6 @@ namespace JsonRPC::Encoding {
       ret["error"]["code"] = -32000;
       ret["error"]["message"] = "Internal error: " + std::string(e.what());
     }
-    Utils::safePrint("Estimate gas encoding returning!");
     return ret;
   }
 
@@ -206,6 +261,65 @@ namespace JsonRPC::Encoding {
     return ret;
   }
 
+  json eth_maxPriorityFeePerGas(const std::unique_ptr<Storage>& storage) {
+    json ret;
+    ret["jsonrpc"] = "2.0";
+    try {
+      // Same sampling as other clients: 60th percentile of up to 20 recent blocks with transactions
+      std::vector<uint64_t> samples;
+      uint64_t height = storage->latest()->getNHeight();
+      for (uint64_t i = 0; i < 20 && i <= height; i++) {
+        BlockFeeStats stats = storage->getFeeStats(height - i);
+        if (stats.txCount != 0) samples.push_back(stats.reward(60));
+      }
+      uint64_t fee = 0;
+      if (!samples.empty()) {
+        std::nth_element(samples.begin(), samples.begin() + samples.size() / 2, samples.end());
+        fee = samples[samples.size() / 2];
+      }
+      ret["result"] = Hex::fromBytes(Utils::uintToBytes(fee), true).forRPC();
+    } catch (std::exception& e) {
+      ret["error"]["code"] = -32000;
+      ret["error"]["message"] = "Internal error: " + std::string(e.what());
+    }
+    return ret;
+  }
+
+  json eth_feeHistory(
+    const std::tuple<uint64_t, uint64_t, std::vector<double>>& info,
+    const std::unique_ptr<Storage>& storage, const std::unique_ptr<Options>& options
+  ) {
+    json ret;
+    ret["jsonrpc"] = "2.0";
+    try {
+      const auto& [blockCount, newestBlock, percentiles] = info;
+      const uint64_t oldestBlock = (blockCount > newestBlock) ? 0 : newestBlock - blockCount + 1;
+      const double maxBlockGas = double(options->getBlockBuilderOptions().maxBlockGas);
+      const std::string baseFee = Hex::fromBytes(Utils::uintToBytes(BlockFeeStats::baseFee), true).forRPC();
+      ret["result"]["oldestBlock"] = Hex::fromBytes(Utils::uintToBytes(oldestBlock), true).forRPC();
+      ret["result"]["baseFeePerGas"] = json::array();
+      ret["result"]["gasUsedRatio"] = json::array();
+      if (!percentiles.empty()) ret["result"]["reward"] = json::array();
+      for (uint64_t height = oldestBlock; blockCount != 0 && height <= newestBlock; height++) {
+        BlockFeeStats stats = storage->getFeeStats(height);
+        ret["result"]["baseFeePerGas"].push_back(baseFee);
+        ret["result"]["gasUsedRatio"].push_back((maxBlockGas > 0) ? std::min(stats.gasUsed / maxBlockGas, 1.0) : 0.0);
+        if (percentiles.empty()) continue;
+        json rewards = json::array();
+        for (const double& percentile : percentiles) {
+          rewards.push_back(Hex::fromBytes(Utils::uintToBytes(stats.reward(percentile)), true).forRPC());
+        }
+        ret["result"]["reward"].push_back(std::move(rewards));
+      }
+      // The base fee array also includes the block after the newest one
+      ret["result"]["baseFeePerGas"].push_back(baseFee);
+    } catch (std::exception& e) {
+      ret["error"]["code"] = -32000;
+      ret["error"]["message"] = "Internal error: " + std::string(e.what());
+    }
+    return ret;
+  }
+
   json eth_getLogs(
     std::tuple<uint64_t, uint64_t, Address, std::vector<Hash>> info,
     const std::unique_ptr<State>& state
@@ -231,6 +345,10 @@ namespace JsonRPC::Encoding {
     return ret;
   }
 
+  std::string eth_getBalance(const Address& address, const std::unique_ptr<State>& state, const json& id) {
+    return writeResult(Hex::fromBytes(Utils::uintToBytes(state->getNativeBalance(address)), true).forRPC(), id);
+  }
+
   json eth_getTransactionCount(const Address& address, const std::unique_ptr<State>& state) {
     json ret;
     ret["jsonrpc"] = "2.0";
@@ -253,8 +371,6 @@ namespace JsonRPC::Encoding {
     auto TxInvalid = state->addTx(TxBlock(tx));
     if (!TxInvalid) {
       ret["result"] = txHash.hex(true);
-      // TODO: Make this use threadpool instead of blocking
-      // TODO: Make tx broadcasting better, the current solution is not good.
       p2p->broadcastTxBlock(tx);
     } else {
       ret["error"]["code"] = -32000;
@@ -380,29 +496,143 @@ namespace JsonRPC::Encoding {
     auto txInfo = storage->getTx(txHash);
     const auto& [tx, blockHash, txIndex, blockHeight] = txInfo;
     if (tx != nullptr) {
-      ret["result"]["transactionHash"] = tx->hash().hex(true);
-      ret["result"]["transactionIndex"] = Hex::fromBytes(Utils::uintToBytes(txIndex), true).forRPC();
-      ret["result"]["blockHash"] = blockHash.hex(true);
-      ret["result"]["blockNumber"] = Hex::fromBytes(Utils::uintToBytes(blockHeight), true).forRPC();
-      ret["result"]["from"] = tx->getFrom().hex(true);
-      ret["result"]["to"] = tx->getTo().hex(true);
-      ret["result"]["cumulativeGasUsed"] = Hex::fromBytes(Utils::uintToBytes(tx->getGasLimit()), true).forRPC();
-      ret["result"]["effectiveGasUsed"] = Hex::fromBytes(Utils::uintToBytes(tx->getGasLimit()), true).forRPC();
-      ret["result"]["effectiveGasPrice"] = Hex::fromBytes(Utils::uintToBytes(tx->getMaxFeePerGas()),true).forRPC();
-      ret["result"]["gasUsed"] = Hex::fromBytes(Utils::uintToBytes(tx->getGasLimit()), true).forRPC();
-      ret["result"]["contractAddress"] = json::value_t::null; // TODO: CHANGE THIS WHEN CREATING CONTRACTS!
-      ret["result"]["logs"] = json::array();
-      ret["result"]["logsBloom"] = Hash().hex(true);
-      ret["result"]["type"] = "0x00";
-      ret["result"]["root"] = Hash().hex(true);
-      ret["result"]["status"] = "0x1"; // TODO: change this when contracts are ready
-      for (const Event& e : state->getEvents(txHash, blockHeight, txIndex)) {
-        ret["result"]["logs"].push_back(e.serializeForRPC());
-      }
+      ret["result"] = getReceiptJson(*tx, blockHash, txIndex, blockHeight, state->getEvents(txHash, blockHeight, txIndex));
       return ret;
     }
     ret["result"] = json::value_t::null;
     return ret;
   }
-}
 
+  json eth_getBlockReceipts(
+    const std::variant<uint64_t, Hash>& block, const std::unique_ptr<Storage>& storage,
+    const std::unique_ptr<State>& state
+  ) {
+    json ret;
+    ret["jsonrpc"] = "2.0";
+    try {
+      const std::shared_ptr<const Block> blockPtr = std::holds_alternative<Hash>(block)
+        ? storage->getBlock(std::get<Hash>(block)) : storage->getBlock(std::get<uint64_t>(block));
+      if (blockPtr == nullptr) { ret["result"] = json::value_t::null; return ret; }
+      const Hash blockHash = blockPtr->hash();
+      const uint64_t blockHeight = blockPtr->getNHeight();
+      const auto& txs = blockPtr->getTxs();
+      // Fetch the events of the whole block at once and hand them to their transactions.
+      // Receipts must be complete, so the log cap doesn't apply (a single block is bounded by its gas anyway).
+      std::vector<std::vector<Event>> txEvents(txs.size());
+      auto events = state->getEvents(blockHeight, blockHeight, Address(), [](const Event&) { return true; }, UINT64_MAX);
+      for (const Event& e : events) {
+        if (e.getTxIndex() < txEvents.size()) txEvents[e.getTxIndex()].push_back(e);
+      }
+      ret["result"] = json::array();
+      for (uint64_t i = 0; i < txs.size(); i++) {
+        ret["result"].push_back(getReceiptJson(txs[i], blockHash, i, blockHeight, txEvents[i]));
+      }
+    } catch (std::exception& e) {
+      ret["error"]["code"] = -32000;
+      ret["error"]["message"] = "Internal error: " + std::string(e.what());
+    }
+    return ret;
+  }
+
+  json eth_newFilter(std::tuple<LogFilter, uint64_t, uint64_t>&& info, FilterRegistry& filters) {
+    json ret;
+    ret["jsonrpc"] = "2.0";
+    try {
+      ret["result"] = filters.newLogFilter(
+        std::move(std::get<0>(info)), std::get<1>(info), std::get<2>(info)
+      );
+    } catch (std::exception& e) {
+      ret["error"]["code"] = -32000;
+      ret["error"]["message"] = e.what();
+    }
+    return ret;
+  }
+
+  json eth_newBlockFilter(FilterRegistry& filters) {
+    json ret;
+    ret["jsonrpc"] = "2.0";
+    try {
+      ret["result"] = filters.newFilter(BLOCK_FILTER);
+    } catch (std::exception& e) {
+      ret["error"]["code"] = -32000;
+      ret["error"]["message"] = e.what();
+    }
+    return ret;
+  }
+
+  json eth_newPendingTransactionFilter(FilterRegistry& filters) {
+    json ret;
+    ret["jsonrpc"] = "2.0";
+    try {
+      ret["result"] = filters.newFilter(PENDING_TX_FILTER);
+    } catch (std::exception& e) {
+      ret["error"]["code"] = -32000;
+      ret["error"]["message"] = e.what();
+    }
+    return ret;
+  }
+
+  json eth_uninstallFilter(const std::string& id, FilterRegistry& filters) {
+    json ret;
+    ret["jsonrpc"] = "2.0";
+    ret["result"] = filters.uninstall(id);
+    return ret;
+  }
+
+  json eth_getFilterChanges(const std::string& id, FilterRegistry& filters) {
+    json ret;
+    ret["jsonrpc"] = "2.0";
+    try {
+      ret["result"] = filters.getChanges(id);
+    } catch (std::exception& e) {
+      ret["error"]["code"] = -32000;
+      ret["error"]["message"] = e.what();
+    }
+    return ret;
+  }
+
+  json eth_getFilterLogs(
+    const std::string& id, FilterRegistry& filters, const std::unique_ptr<Storage>& storage,
+    const std::unique_ptr<State>& state, const std::unique_ptr<Options>& options
+  ) {
+    json ret;
+    ret["jsonrpc"] = "2.0";
+    try {
+      auto [criteria, fromBlock, toBlock] = filters.getLogFilter(id);
+      toBlock = std::min(toBlock, storage->latest()->getNHeight());
+      // Let the State narrow down by address when there's only one, the criteria does the rest
+      const Address address = (criteria.addresses.size() == 1) ? criteria.addresses[0] : Address();
+      ret["result"] = json::array();
+      if (fromBlock > toBlock) return ret;
+      // The criteria is checked before the log cap, so unrelated events don't take up its room
+      auto events = state->getEvents(fromBlock, toBlock, address,
+        [&criteria](const Event& e) { return criteria.matches(e); }, options->getEventLogCap()
+      );
+      for (const Event& e : events) ret["result"].push_back(json::parse(e.serializeForRPC()));
+    } catch (std::exception& e) {
+      ret["error"]["code"] = -32000;
+      ret["error"]["message"] = e.what();
+    }
+    return ret;
+  }
+
+  json debug_dumpTrace(const std::unique_ptr<Options>& options) {
+    json ret;
+    ret["jsonrpc"] = "2.0";
+    const std::string& path = options->getRPCOptions().traceFile;
+    if (!options->getRPCOptions().enableDumpTrace || path.empty()) {
+      ret["error"]["code"] = -32000;
+      ret["error"]["message"] = "Tracing is disabled, set enableDumpTrace and traceFile in the RPC options to enable it";
+      return ret;
+    }
+    try {
+      const uint64_t events = Tracer::dump(path);
+      ret["result"]["file"] = path;
+      ret["result"]["events"] = events;
+    } catch (std::exception& e) {
+      ret["error"]["code"] = -32000;
+      ret["error"]["message"] = e.what();
+    }
+    return ret;
+  }
+}
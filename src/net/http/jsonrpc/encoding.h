@@ -18,6 +18,9 @@ See the LICENSE.txt file in the project root for more information.
 namespace P2P { class ManagerNormal; }
 class Storage;
 class State;
+class FilterRegistry;
+class Event;
+struct LogFilter;
 
 /// Namespace for encoding JSON-RPC data.
 namespace JsonRPC::Encoding {
@@ -32,6 +35,40 @@ namespace JsonRPC::Encoding {
    */
   json getBlockJson(const std::shared_ptr<const Block>& block, bool includeTransactions);
 
+  /**
+   * Write a successful response straight to a string, without building a json object.
+   * The output is the same as dumping the json response once its id is set.
+   * @param result The result, a hex string (written as is, as it never needs escaping).
+   * @param id The request id.
+   * @return The serialized response.
+   */
+  std::string writeResult(std::string_view result, const json& id);
+
+  /**
+   * Write an error response straight to a string, without building a json object.
+   * The output is the same as dumping the json response once its id is set.
+   * @param code The error code.
+   * @param message The error message.
+   * @param id The request id.
+   * @return The serialized response.
+   */
+  std::string writeError(const int& code, const std::string& message, const json& id);
+
+  /**
+   * Helper function to get a transaction receipt in JSON format.
+   * Used by `eth_getTransactionReceipt` and `eth_getBlockReceipts`.
+   * @param tx The transaction.
+   * @param blockHash The hash of the block that contains the transaction.
+   * @param txIndex The position of the transaction in the block.
+   * @param blockHeight The height of the block that contains the transaction.
+   * @param events The events emitted by the transaction.
+   * @return The receipt as a JSON object.
+   */
+  json getReceiptJson(
+    const TxBlock& tx, const Hash& blockHash, const uint64_t& txIndex,
+    const uint64_t& blockHeight, const std::vector<Event>& events
+  );
+
   /**
    * Encode a `web3_clientVersion` response.
    * @param options Pointer to the options singleton.
@@ -150,6 +187,18 @@ namespace JsonRPC::Encoding {
    */
   json eth_call(const ethCallInfoAllocated& callInfo, const std::unique_ptr<State>& state);
 
+  /**
+   * Write a `eth_call` response straight to a string.
+   * @param callInfo Info about the call (from, to, gas, gasPrice, value, functor, data).
+   * @param state Pointer to the blockchain's state.
+   * @param id The request id.
+   * @param status Set to the JSON-RPC error code of the response, 0 on success.
+   * @return The serialized response.
+   */
+  std::string eth_call(
+    const ethCallInfoAllocated& callInfo, const std::unique_ptr<State>& state, const json& id, int& status
+  );
+
   /**,
    * Encode a `eth_estimateGas` response.
    * @param callInfo Info about the call (from, to, gas, gasPrice, value, functor, data).
@@ -166,6 +215,26 @@ namespace JsonRPC::Encoding {
   // TODO: We don't really estimate gas because we don't have a Gas structure, it is fixed to 21000
   json eth_gasPrice();
 
+  /**
+   * Encode a `eth_maxPriorityFeePerGas` response.
+   * Suggests the median of the 60th percentile priority fee of the recent non-empty blocks.
+   * @param storage Reference pointer to the blockchain's storage.
+   * @return The encoded JSON response.
+   */
+  json eth_maxPriorityFeePerGas(const std::unique_ptr<Storage>& storage);
+
+  /**
+   * Encode a `eth_feeHistory` response.
+   * @param info A tuple of number of blocks, newest block height and reward percentiles.
+   * @param storage Reference pointer to the blockchain's storage.
+   * @param options Reference pointer to the options singleton.
+   * @return The encoded JSON response.
+   */
+  json eth_feeHistory(
+    const std::tuple<uint64_t, uint64_t, std::vector<double>>& info,
+    const std::unique_ptr<Storage>& storage, const std::unique_ptr<Options>& options
+  );
+
   /**
    * Encode a `eth_getLogs` response.
    * @param info A tuple of starting and ending block, address and a list of topics.
@@ -185,6 +254,15 @@ namespace JsonRPC::Encoding {
    */
   json eth_getBalance(const Address& address, const std::unique_ptr<State>& state);
 
+  /**
+   * Write a `eth_getBalance` response straight to a string.
+   * @param address The address to get the balance from.
+   * @param state Pointer to the blockchain's state.
+   * @param id The request id.
+   * @return The serialized response.
+   */
+  std::string eth_getBalance(const Address& address, const std::unique_ptr<State>& state, const json& id);
+
   /**
    * Encode a `eth_getTransactionCount` response.
    * @param address The address to get the transaction count from.
@@ -254,6 +332,79 @@ namespace JsonRPC::Encoding {
     const Hash& txHash, const std::unique_ptr<Storage>& storage,
     const std::unique_ptr<State>& state
   );
+
+  /**
+   * Encode a `eth_getBlockReceipts` response.
+   * Builds all receipts in one pass over the block and all of its events (regardless of the log cap).
+   * @param block The block height or hash.
+   * @param storage Reference pointer to the blockchain's storage.
+   * @param state Reference pointer to the blockchain's state.
+   * @return The encoded JSON response.
+   */
+  json eth_getBlockReceipts(
+    const std::variant<uint64_t, Hash>& block, const std::unique_ptr<Storage>& storage,
+    const std::unique_ptr<State>& state
+  );
+
+  /**
+   * Encode a `eth_newFilter` response. Installs a log filter.
+   * @param info A tuple of log criteria, and starting and ending block (UINT64_MAX = latest).
+   * @param filters Reference to the filter registry.
+   * @return The encoded JSON response.
+   */
+  json eth_newFilter(std::tuple<LogFilter, uint64_t, uint64_t>&& info, FilterRegistry& filters);
+
+  /**
+   * Encode a `eth_newBlockFilter` response. Installs a block filter.
+   * @param filters Reference to the filter registry.
+   * @return The encoded JSON response.
+   */
+  json eth_newBlockFilter(FilterRegistry& filters);
+
+  /**
+   * Encode a `eth_newPendingTransactionFilter` response. Installs a pending transaction filter.
+   * @param filters Reference to the filter registry.
+   * @return The encoded JSON response.
+   */
+  json eth_newPendingTransactionFilter(FilterRegistry& filters);
+
+  /**
+   * Encode a `eth_uninstallFilter` response. Uninstalls the filter.
+   * @param id The filter ID.
+   * @param filters Reference to the filter registry.
+   * @return The encoded JSON response.
+   */
+  json eth_uninstallFilter(const std::string& id, FilterRegistry& filters);
+
+  /**
+   * Encode a `eth_getFilterChanges` response.
+   * @param id The filter ID.
+   * @param filters Reference to the filter registry.
+   * @return The encoded JSON response.
+   */
+  json eth_getFilterChanges(const std::string& id, FilterRegistry& filters);
+
+  /**
+   * Encode a `eth_getFilterLogs` response.
+   * @param id The filter ID.
+   * @param filters Reference to the filter registry.
+   * @param storage Reference pointer to the blockchain's storage.
+   * @param state Reference pointer to the blockchain's state.
+   * @param options Pointer to the options singleton (for the log cap).
+   * @return The encoded JSON response.
+   */
+  json eth_getFilterLogs(
+    const std::string& id, FilterRegistry& filters, const std::unique_ptr<Storage>& storage,
+    const std::unique_ptr<State>& state, const std::unique_ptr<Options>& options
+  );
+
+  /**
+   * Encode a `debug_dumpTrace` response, writing the span trace to `RPCOptions::traceFile`.
+   * Errors out unless `RPCOptions::enableDumpTrace` is set.
+   * @param options Pointer to the options singleton.
+   * @return The encoded JSON response, with the file and the number of spans written.
+   */
+  json debug_dumpTrace(const std::unique_ptr<Options>& options);
 }
 
 #endif  // JSONRPC_ENCODING_H
@@ -51,14 +51,14 @@ namespace JsonRPC {
    * eth_estimateGas =========================== DONE
    * eth_createAccessList ====================== NOT IMPLEMENTED: NOT SUPPORTED BY THE BLOCKCHAIN, WE ARE NOT AN EVM
    * eth_gasPrice ============================== DONE
-   * eth_maxPriorityFeePerGas ================== TODO: IMPLEMENT THIS
-   * eth_feeHistory ============================ TODO: IMPLEMENT THIS, SEE https://docs.alchemy.com/reference/eth-feehistory
-   * eth_newFilter ============================= NOT IMPLEMENTED: WE DON'T SUPPORT FILTERS (FOR NOW)
-   * eth_newBlockFilter ======================== NOT IMPLEMENTED: WE DON'T SUPPORT FILTERS (FOR NOW)
-   * eth_newPendingTransactionFilter =========== NOT IMPLEMENTED: WE DON'T SUPPORT FILTERS (FOR NOW)
-   * eth_uninstallFilter ======================= NOT IMPLEMENTED: WE DON'T SUPPORT FILTERS (FOR NOW)
-   * eth_getFilterChanges ====================== NOT IMPLEMENTED: WE DON'T SUPPORT FILTERS (FOR NOW)
-   * eth_getFilterLogs ========================= NOT IMPLEMENTED: WE DON'T SUPPORT FILTERS (FOR NOW)
+   * eth_maxPriorityFeePerGas ================== DONE
+   * eth_feeHistory ============================ DONE
+   * eth_newFilter ============================= DONE
+   * eth_newBlockFilter ======================== DONE
+   * eth_newPendingTransactionFilter =========== DONE
+   * eth_uninstallFilter ======================= DONE
+   * eth_getFilterChanges ====================== DONE
+   * eth_getFilterLogs ========================= DONE
    * eth_getLogs =============================== DONE
    * eth_mining ================================ NOT IMPLEMENTED: WE ARE RDPOS NOT POW
    * eth_hashrate ============================== NOT IMPLEMENTED: WE ARE RDPOS NOT POW
@@ -79,6 +79,8 @@ namespace JsonRPC {
    * eth_getTransactionByBlockHashAndIndex ===== DONE
    * eth_getTransactionByBlockNumberAndIndex === DONE
    * eth_getTransactionReceipt ================= DONE
+   * eth_getBlockReceipts ====================== DONE
+   * debug_dumpTrace =========================== DONE (WRITES THE SPAN TRACE TO THE CONFIGURED FILE)
    * ```
    */
   enum Methods {
@@ -131,7 +133,9 @@ namespace JsonRPC {
     eth_getTransactionByHash,
     eth_getTransactionByBlockHashAndIndex,
     eth_getTransactionByBlockNumberAndIndex,
-    eth_getTransactionReceipt
+    eth_getTransactionReceipt,
+    eth_getBlockReceipts,
+    debug_dumpTrace
   };
 
   /// Lookup table for the implemented methods.
@@ -153,6 +157,15 @@ namespace JsonRPC {
     { "eth_call", eth_call },
     { "eth_estimateGas", eth_estimateGas },
     { "eth_gasPrice", eth_gasPrice },
+    { "eth_maxPriorityFeePerGas", eth_maxPriorityFeePerGas },
+    { "eth_feeHistory", eth_feeHistory },
+    { "eth_newFilter", eth_newFilter },
+    { "eth_newBlockFilter", eth_newBlockFilter },
+    { "eth_newPendingTransactionFilter", eth_newPendingTransactionFilter },
+    { "eth_uninstallFilter", eth_uninstallFilter },
+    { "eth_getFilterChanges", eth_getFilterChanges },
+    { "eth_getFilterLogs", eth_getFilterLogs },
+    { "eth_getLogs", eth_getLogs },
     { "eth_getBalance", eth_getBalance },
     { "eth_getTransactionCount", eth_getTransactionCount },
     { "eth_getCode", eth_getCode },
@@ -161,7 +174,9 @@ namespace JsonRPC {
     { "eth_getTransactionByHash", eth_getTransactionByHash },
     { "eth_getTransactionByBlockHashAndIndex", eth_getTransactionByBlockHashAndIndex },
     { "eth_getTransactionByBlockNumberAndIndex", eth_getTransactionByBlockNumberAndIndex },
-    { "eth_getTransactionReceipt", eth_getTransactionReceipt }
+    { "eth_getTransactionReceipt", eth_getTransactionReceipt },
+    { "eth_getBlockReceipts", eth_getBlockReceipts },
+    { "debug_dumpTrace", debug_dumpTrace }
   };
 }
 
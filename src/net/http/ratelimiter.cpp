@@ -0,0 +1,85 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include "ratelimiter.h"
+
+RateLimiter::RateLimiter(const RPCOptions& options, Clock clock) :
+  rate_(options.rateLimit), burst_(std::max<uint64_t>(options.rateLimitBurst, 1)), costs_(options.rateLimitCosts),
+  maxConnections_(options.maxConnections), maxConnectionsPerPeer_(options.maxConnectionsPerPeer),
+  clock_(std::move(clock)), lastPrune_(this->clock_())
+{}
+
+uint64_t RateLimiter::getMethodCost(const std::string& method) const {
+  auto it = this->costs_.find(method);
+  return (it != this->costs_.end()) ? it->second : 1;
+}
+
+uint64_t RateLimiter::getCost(const json& request) const {
+  if (!request.is_object()) return 1;
+  auto method = request.find("method");
+  if (method == request.end() || !method->is_string()) return 1;
+  return this->getMethodCost(method->get_ref<const std::string&>());
+}
+
+bool RateLimiter::allow(const std::string& peer, const uint64_t& cost) {
+  if (this->rate_ == 0) return true;
+  const auto now = this->clock_();
+  const double tokens = std::min<double>(cost, this->burst_);
+  std::lock_guard lock(this->mutex_);
+  // Buckets that are full again are the same as new ones, so they are dropped once in a while
+  if (now - this->lastPrune_ >= RateLimiter::pruneInterval) {
+    std::erase_if(this->buckets_, [&](const auto& item) {
+      const std::chrono::duration<double> idle = now - item.second.updated;
+      return item.second.tokens + idle.count() * this->rate_ >= this->burst_;
+    });
+    this->lastPrune_ = now;
+  }
+  auto [it, inserted] = this->buckets_.try_emplace(peer, Bucket{this->burst_, now});
+  Bucket& bucket = it->second;
+  if (!inserted) {
+    const std::chrono::duration<double> elapsed = now - bucket.updated;
+    bucket.tokens = std::min(this->burst_, bucket.tokens + elapsed.count() * this->rate_);
+    bucket.updated = now;
+  }
+  if (bucket.tokens < tokens) return false;
+  bucket.tokens -= tokens;
+  return true;
+}
+
+std::shared_ptr<const RateLimiter::Connection> RateLimiter::connect(const std::string& peer) {
+  std::lock_guard lock(this->mutex_);
+  if (this->maxConnections_ != 0 && this->totalConnections_ >= this->maxConnections_) return nullptr;
+  uint64_t& connections = this->connections_[peer];
+  if (this->maxConnectionsPerPeer_ != 0 && connections >= this->maxConnectionsPerPeer_) return nullptr;
+  connections++;
+  this->totalConnections_++;
+  return std::make_shared<const Connection>(*this, peer);
+}
+
+void RateLimiter::disconnect(const std::string& peer) {
+  std::lock_guard lock(this->mutex_);
+  auto it = this->connections_.find(peer);
+  if (it == this->connections_.end()) return;
+  if (--it->second == 0) this->connections_.erase(it);
+  this->totalConnections_--;
+}
+
+uint64_t RateLimiter::getConnections() const {
+  std::lock_guard lock(this->mutex_);
+  return this->totalConnections_;
+}
+
+uint64_t RateLimiter::getConnections(const std::string& peer) const {
+  std::lock_guard lock(this->mutex_);
+  auto it = this->connections_.find(peer);
+  return (it != this->connections_.end()) ? it->second : 0;
+}
+
+uint64_t RateLimiter::getBuckets() const {
+  std::lock_guard lock(this->mutex_);
+  return this->buckets_.size();
+}
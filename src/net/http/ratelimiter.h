@@ -0,0 +1,170 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#ifndef RATELIMITER_H
+#define RATELIMITER_H
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "../../utils/options.h"
+
+/**
+ * Per-client limits of the JSON-RPC server, keyed by the client's IP address.
+ * - Requests take tokens from a bucket that holds up to `RPCOptions::rateLimitBurst`
+ *   tokens and is refilled at `RPCOptions::rateLimit` tokens per second. Each method
+ *   costs 1 token unless it is weighted in `RPCOptions::rateLimitCosts`, so a client
+ *   looping over `eth_call` or `eth_getLogs` runs dry much faster than one polling
+ *   `eth_blockNumber`. A rate of 0 disables the buckets.
+ * - Open connections are capped globally (`RPCOptions::maxConnections`) and per client
+ *   (`RPCOptions::maxConnectionsPerPeer`), 0 meaning unlimited.
+ * The clock is injected so the limits can be tested without waiting or networking.
+ */
+class RateLimiter {
+  public:
+    /// Function returning the current time.
+    using Clock = std::function<std::chrono::steady_clock::time_point()>;
+
+    /// An open connection, released when destroyed. Shared by the HTTP and WebSocket sessions.
+    class Connection {
+      private:
+        RateLimiter& limiter_;    ///< Reference to the limiter that accepted the connection.
+        const std::string peer_;  ///< IP address of the client.
+
+      public:
+        /**
+         * Constructor. Only called by connect().
+         * @param limiter Reference to the limiter.
+         * @param peer IP address of the client.
+         */
+        Connection(RateLimiter& limiter, const std::string& peer) : limiter_(limiter), peer_(peer) {}
+
+        /// Destructor. Releases the connection from the limiter.
+        ~Connection() { this->limiter_.disconnect(this->peer_); }
+
+        Connection(const Connection&) = delete; ///< Copy constructor (deleted).
+        Connection& operator=(const Connection&) = delete; ///< Copy assignment operator (deleted).
+
+        /// Getter for `peer_`.
+        const std::string& getPeer() const { return this->peer_; }
+    };
+
+  private:
+    /// Token bucket of a client.
+    struct Bucket {
+      double tokens;                                  ///< Tokens left.
+      std::chrono::steady_clock::time_point updated;  ///< When the tokens were last refilled.
+    };
+
+    /// Tokens refilled per second, 0 disables the buckets.
+    const double rate_;
+
+    /// Maximum number of tokens in a bucket.
+    const double burst_;
+
+    /// Costs of the weighted methods (method -> tokens).
+    const std::map<std::string, uint64_t> costs_;
+
+    /// Maximum number of open connections, 0 for unlimited.
+    const uint64_t maxConnections_;
+
+    /// Maximum number of open connections per client, 0 for unlimited.
+    const uint64_t maxConnectionsPerPeer_;
+
+    /// Function returning the current time.
+    const Clock clock_;
+
+    /// Buckets of the clients (IP address -> bucket).
+    std::unordered_map<std::string, Bucket> buckets_;
+
+    /// Open connections of the clients (IP address -> number of connections).
+    std::unordered_map<std::string, uint64_t> connections_;
+
+    /// Total number of open connections.
+    uint64_t totalConnections_ = 0;
+
+    /// When the full buckets were last dropped.
+    std::chrono::steady_clock::time_point lastPrune_;
+
+    /// Mutex for managing read/write access to the buckets and connections.
+    mutable std::mutex mutex_;
+
+    /**
+     * Release a connection. Called by Connection's destructor.
+     * @param peer IP address of the client.
+     */
+    void disconnect(const std::string& peer);
+
+  public:
+    /// Interval between sweeps of the buckets, which drop the ones that are full again.
+    static constexpr std::chrono::seconds pruneInterval = std::chrono::seconds(60);
+
+    /**
+     * Constructor.
+     * @param options The RPC options with the limits.
+     * @param clock Function returning the current time.
+     */
+    explicit RateLimiter(const RPCOptions& options, Clock clock = std::chrono::steady_clock::now);
+
+    /**
+     * Get the cost of a JSON-RPC method.
+     * @param method The method name.
+     * @return The number of tokens taken by the method.
+     */
+    uint64_t getMethodCost(const std::string& method) const;
+
+    /**
+     * Get the cost of a JSON-RPC request.
+     * @param request The request object.
+     * @return The number of tokens taken by the request's method (1 if the request is invalid).
+     */
+    uint64_t getCost(const json& request) const;
+
+    /**
+     * Take tokens from a client's bucket.
+     * Costs above the burst size take the whole bucket, so they can still be served when it's full.
+     * @param peer IP address of the client.
+     * @param cost The number of tokens to take.
+     * @return `true` if the client had enough tokens (or the buckets are disabled), `false` otherwise.
+     */
+    bool allow(const std::string& peer, const uint64_t& cost);
+
+    /**
+     * Take tokens from a client's bucket for a JSON-RPC request.
+     * @param peer IP address of the client.
+     * @param request The request object.
+     * @return `true` if the request can be executed, `false` if the client is over its limit.
+     */
+    bool allow(const std::string& peer, const json& request) { return this->allow(peer, this->getCost(request)); }
+
+    /**
+     * Open a connection for a client, if it doesn't go over the connection limits.
+     * @param peer IP address of the client.
+     * @return The connection, which must be kept alive while the socket is open,
+     *         or `nullptr` if the connection should be refused.
+     */
+    std::shared_ptr<const Connection> connect(const std::string& peer);
+
+    /// Get the total number of open connections.
+    uint64_t getConnections() const;
+
+    /**
+     * Get the number of open connections of a client.
+     * @param peer IP address of the client.
+     * @return The number of open connections.
+     */
+    uint64_t getConnections(const std::string& peer) const;
+
+    /// Get the number of clients with a bucket.
+    uint64_t getBuckets() const;
+};
+
+#endif  // RATELIMITER_H
@@ -0,0 +1,44 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include "rpccache.h"
+
+RPCCache::RPCCache(const RPCOptions& options) : maxBytes_(options.cacheBytes) {}
+
+std::shared_ptr<const std::string> RPCCache::get(const std::string& key) {
+  std::lock_guard lock(this->mutex_);
+  auto it = this->index_.find(key);
+  if (it == this->index_.end()) return nullptr;
+  this->entries_.splice(this->entries_.begin(), this->entries_, it->second);
+  return it->second->value;
+}
+
+void RPCCache::put(const std::string& key, std::shared_ptr<const std::string> value) {
+  const uint64_t entryBytes = key.size() + value->size();
+  if (entryBytes > this->maxBytes_) return;
+  std::lock_guard lock(this->mutex_);
+  if (this->index_.contains(key)) return; // Another request got here first, the value is the same
+  while (this->bytes_ + entryBytes > this->maxBytes_) {
+    const Entry& last = this->entries_.back();
+    this->bytes_ -= last.key.size() + last.value->size();
+    this->index_.erase(last.key);
+    this->entries_.pop_back();
+  }
+  this->entries_.push_front(Entry{key, std::move(value)});
+  this->index_.emplace(key, this->entries_.begin());
+  this->bytes_ += entryBytes;
+}
+
+uint64_t RPCCache::size() const {
+  std::lock_guard lock(this->mutex_);
+  return this->entries_.size();
+}
+
+uint64_t RPCCache::bytes() const {
+  std::lock_guard lock(this->mutex_);
+  return this->bytes_;
+}
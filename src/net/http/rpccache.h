@@ -0,0 +1,81 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#ifndef RPCCACHE_H
+#define RPCCACHE_H
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "../../utils/options.h"
+
+/**
+ * Memory-bounded LRU cache of already serialized JSON-RPC responses.
+ * Only responses that can never change are stored (blocks and transactions that are
+ * already in the chain), keyed by the method and its decoded parameters, with block
+ * tags like "latest" already resolved to a height. Each entry holds the dumped response
+ * without its `id`, which is spliced in for every request (see processJsonRpcRequest()),
+ * so repeated queries skip the JSON tree, the hex conversions and the `dump()` entirely.
+ * Least recently used entries are dropped once their keys and values take more than
+ * `RPCOptions::cacheBytes` bytes.
+ */
+class RPCCache {
+  private:
+    /// A cached response.
+    struct Entry {
+      std::string key;                              ///< The entry key.
+      std::shared_ptr<const std::string> value;     ///< The serialized response, without the `id`.
+    };
+
+    /// Memory budget of the cache, in bytes.
+    const uint64_t maxBytes_;
+
+    /// Bytes currently taken by the keys and values of the entries.
+    uint64_t bytes_ = 0;
+
+    /// Entries, from the most to the least recently used.
+    std::list<Entry> entries_;
+
+    /// Entry lookup (key -> position in the list).
+    std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+
+    /// Mutex for managing read/write access to the entries.
+    mutable std::mutex mutex_;
+
+  public:
+    /**
+     * Constructor.
+     * @param options The RPC options with the memory budget of the cache.
+     */
+    explicit RPCCache(const RPCOptions& options);
+
+    /**
+     * Get a cached response, marking it as recently used.
+     * @param key The entry key.
+     * @return The serialized response, or `nullptr` if it isn't cached.
+     */
+    std::shared_ptr<const std::string> get(const std::string& key);
+
+    /**
+     * Store a response, evicting the least recently used ones if needed.
+     * Responses bigger than the whole budget are not stored.
+     * @param key The entry key.
+     * @param value The serialized response, without the `id`.
+     */
+    void put(const std::string& key, std::shared_ptr<const std::string> value);
+
+    /// Get the number of cached responses.
+    uint64_t size() const;
+
+    /// Get the bytes currently taken by the cached responses and their keys.
+    uint64_t bytes() const;
+};
+
+#endif  // RPCCACHE_H
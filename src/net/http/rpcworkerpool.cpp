@@ -0,0 +1,46 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include "rpcworkerpool.h"
+
+RPCWorkerPool::RPCWorkerPool(const RPCOptions& options) :
+  fastLane_(std::max<uint64_t>(options.workerThreads, 1)),
+  callLane_(std::max<uint64_t>(options.callThreads, 1)),
+  logsLane_(std::max<uint64_t>(options.logsThreads, 1))
+{}
+
+RPCLane RPCWorkerPool::getLane(const JsonRPC::Methods& method) {
+  switch (method) {
+    case JsonRPC::Methods::eth_call:
+    case JsonRPC::Methods::eth_estimateGas:
+      return CALL_LANE;
+    case JsonRPC::Methods::eth_getLogs:
+    case JsonRPC::Methods::eth_getFilterLogs:
+    case JsonRPC::Methods::eth_getBlockReceipts:
+    case JsonRPC::Methods::debug_dumpTrace:
+      return LOGS_LANE;
+    default:
+      return FAST_LANE;
+  }
+}
+
+RPCLane RPCWorkerPool::getLane(const json& request) {
+  if (!request.is_object()) return FAST_LANE;
+  auto method = request.find("method");
+  if (method == request.end() || !method->is_string()) return FAST_LANE;
+  auto it = JsonRPC::methodsLookupTable.find(method->get<std::string>());
+  if (it == JsonRPC::methodsLookupTable.end()) return FAST_LANE;
+  return RPCWorkerPool::getLane(it->second);
+}
+
+void RPCWorkerPool::push(const RPCLane& lane, std::function<void()>&& task) {
+  switch (lane) {
+    case CALL_LANE: this->callLane_.push_task(std::move(task)); break;
+    case LOGS_LANE: this->logsLane_.push_task(std::move(task)); break;
+    default: this->fastLane_.push_task(std::move(task)); break;
+  }
+}
@@ -0,0 +1,67 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#ifndef RPCWORKERPOOL_H
+#define RPCWORKERPOOL_H
+
+#include <functional>
+
+#include "../../libs/BS_thread_pool_light.hpp"
+#include "../../utils/options.h"
+#include "jsonrpc/methods.h"
+
+/// Enum for identifying the lane a JSON-RPC request is executed on.
+enum RPCLane { FAST_LANE, CALL_LANE, LOGS_LANE };
+
+/**
+ * Worker pool that executes JSON-RPC requests apart from the HTTP I/O threads.
+ * Each lane has its own threads, which caps how many requests of that kind run
+ * at the same time. Slow requests (contract calls, log queries) can only pile
+ * up on their own lane, so cheap reads like `eth_blockNumber` never wait behind
+ * them, and sockets keep being served while requests wait for the State's lock.
+ */
+class RPCWorkerPool {
+  private:
+    /// Threads for cheap requests, and for parsing request bodies.
+    BS::thread_pool_light fastLane_;
+
+    /// Threads for `eth_call` and `eth_estimateGas`.
+    BS::thread_pool_light callLane_;
+
+    /// Threads for `eth_getLogs`, `eth_getFilterLogs` and `eth_getBlockReceipts`.
+    BS::thread_pool_light logsLane_;
+
+  public:
+    /**
+     * Constructor.
+     * @param options The RPC options with the number of threads of each lane.
+     */
+    explicit RPCWorkerPool(const RPCOptions& options);
+
+    /**
+     * Get the lane a given JSON-RPC method should be executed on.
+     * @param method The method.
+     * @return The lane for the method.
+     */
+    static RPCLane getLane(const JsonRPC::Methods& method);
+
+    /**
+     * Get the lane a given JSON-RPC request should be executed on.
+     * @param request The request object.
+     * @return The lane for the request's method, or the fast lane if the request is invalid.
+     */
+    static RPCLane getLane(const json& request);
+
+    /**
+     * Queue a task to be executed on a given lane.
+     * @param lane The lane to execute the task on.
+     * @param task The task to execute.
+     */
+    void push(const RPCLane& lane, std::function<void()>&& task);
+};
+
+#endif  // RPCWORKERPOOL_H
@@ -0,0 +1,101 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include "subscriptions.h"
+#include "wssession.h"
+
+LogFilter LogFilter::fromJson(const json& filter) {
+  auto parseHex = [](const json& value, const size_t& size) {
+    if (!value.is_string()) throw std::runtime_error("Expected a hex string");
+    const std::string& hex = value.get_ref<const std::string&>();
+    if (hex.size() != 2 + size * 2 || !Hex::isValid(hex, true)) throw std::runtime_error("Invalid hex: " + hex);
+    return Hex::toBytes(hex);
+  };
+  LogFilter ret;
+  if (!filter.is_object()) throw std::runtime_error("Filter is not an object");
+  if (filter.contains("address") && !filter["address"].is_null()) {
+    const json& address = filter["address"];
+    if (address.is_array()) {
+      for (const auto& item : address) ret.addresses.emplace_back(parseHex(item, 20));
+    } else {
+      ret.addresses.emplace_back(parseHex(address, 20));
+    }
+  }
+  if (filter.contains("topics") && !filter["topics"].is_null()) {
+    const json& topics = filter["topics"];
+    if (!topics.is_array()) throw std::runtime_error("topics is not an array");
+    if (topics.size() > 4) throw std::runtime_error("Too many topics");
+    for (const auto& position : topics) {
+      std::vector<Hash>& options = ret.topics.emplace_back();
+      if (position.is_null()) continue;
+      if (position.is_array()) {
+        for (const auto& item : position) options.emplace_back(parseHex(item, 32));
+      } else {
+        options.emplace_back(parseHex(position, 32));
+      }
+    }
+  }
+  return ret;
+}
+
+bool LogFilter::matches(const Event& event) const {
+  if (!this->addresses.empty() &&
+    std::find(this->addresses.begin(), this->addresses.end(), event.getAddress()) == this->addresses.end()
+  ) return false;
+  const std::vector<Hash>& eventTopics = event.getTopics();
+  for (size_t i = 0; i < this->topics.size(); i++) {
+    if (this->topics[i].empty()) continue;
+    if (i >= eventTopics.size()) return false;
+    if (std::find(this->topics[i].begin(), this->topics[i].end(), eventTopics[i]) == this->topics[i].end()) return false;
+  }
+  return true;
+}
+
+SubscriptionManager::SubscriptionManager(const std::unique_ptr<State>& state) : state_(state) {
+  if (this->state_) this->state_->addListener(this);
+}
+
+SubscriptionManager::~SubscriptionManager() {
+  if (this->state_) this->state_->removeListener(this);
+}
+
+void SubscriptionManager::addSession(const std::shared_ptr<WSSession>& session) {
+  std::lock_guard lock(this->mutex_);
+  this->sessions_.emplace_back(session);
+}
+
+std::vector<std::shared_ptr<WSSession>> SubscriptionManager::getSubscribers(const uint8_t& types) {
+  std::vector<std::shared_ptr<WSSession>> ret;
+  std::lock_guard lock(this->mutex_);
+  std::erase_if(this->sessions_, [&](const std::weak_ptr<WSSession>& weak) {
+    auto session = weak.lock();
+    if (!session) return true;
+    if (session->getSubscribedTypes() & types) ret.emplace_back(std::move(session));
+    return false;
+  });
+  return ret;
+}
+
+void SubscriptionManager::onNewBlock(const std::shared_ptr<const Block>& block, const std::vector<Event>& events) {
+  auto subscribers = this->getSubscribers(NEW_HEADS | LOGS);
+  if (subscribers.empty()) return;
+  auto published = std::make_shared<SubscriptionBlock>();
+  json header = JsonRPC::Encoding::getBlockJson(block, false)["result"];
+  header.erase("transactions");
+  published->header = header.dump();
+  published->events = events;
+  published->logs.reserve(events.size());
+  for (const Event& event : events) published->logs.emplace_back(event.serializeForRPC());
+  for (const auto& session : subscribers) session->notifyBlock(published);
+}
+
+void SubscriptionManager::onNewTx(const Hash& txHash) {
+  auto subscribers = this->getSubscribers(NEW_PENDING_TXS);
+  if (subscribers.empty()) return;
+  auto published = std::make_shared<const std::string>("\"" + txHash.hex(true).get() + "\"");
+  for (const auto& session : subscribers) session->notifyTx(published);
+}
@@ -0,0 +1,95 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#ifndef SUBSCRIPTIONS_H
+#define SUBSCRIPTIONS_H
+
+#include <mutex>
+
+#include "../../core/state.h"
+
+// Forward declarations.
+class WSSession;
+
+/// Enum for the types of `eth_subscribe` subscriptions (as bit flags).
+enum SubscriptionType : uint8_t { NEW_HEADS = 1, LOGS = 2, NEW_PENDING_TXS = 4 };
+
+/// Criteria for matching logs (the `address` and `topics` fields of a log filter object).
+struct LogFilter {
+  std::vector<Address> addresses;         ///< Addresses to match, any of them (empty = any address).
+  std::vector<std::vector<Hash>> topics;  ///< Topics to match by position, any of each position's hashes (empty = any topic).
+
+  /**
+   * Parse the criteria from a log filter object.
+   * @param filter The filter object, e.g. `{"address": "0x...", "topics": [null, ["0x...", "0x..."]]}`.
+   * @return The parsed criteria.
+   * @throw std::runtime_error if the object is malformed.
+   */
+  static LogFilter fromJson(const json& filter);
+
+  /**
+   * Check if an event matches the criteria.
+   * @param event The event to check.
+   * @return `true` if the event matches, `false` otherwise.
+   */
+  bool matches(const Event& event) const;
+};
+
+/// A new block, serialized once for all subscribers.
+struct SubscriptionBlock {
+  std::string header;             ///< The block header, as sent to `newHeads` subscribers.
+  std::vector<Event> events;      ///< The events emitted by the block.
+  std::vector<std::string> logs;  ///< The events serialized for RPC, in the same order.
+};
+
+/**
+ * Feeds the WebSocket sessions with new blocks, logs and mempool transactions from the State.
+ * Each notification is serialized once, and handed to the sessions that have
+ * subscriptions of its type. Sessions filter and queue the notifications on their own strand.
+ */
+class SubscriptionManager : public StateListener {
+  private:
+    /// Reference pointer to the blockchain's state.
+    const std::unique_ptr<State>& state_;
+
+    /// Open WebSocket sessions.
+    std::vector<std::weak_ptr<WSSession>> sessions_;
+
+    /// Mutex for managing read/write access to the sessions.
+    std::mutex mutex_;
+
+    /**
+     * Get the open sessions that have subscriptions of the given types, dropping the closed ones.
+     * @param types The subscription types (as bit flags).
+     * @return The sessions.
+     */
+    std::vector<std::shared_ptr<WSSession>> getSubscribers(const uint8_t& types);
+
+  public:
+    /**
+     * Constructor. Registers the manager as a State listener.
+     * @param state Reference pointer to the blockchain's state.
+     */
+    explicit SubscriptionManager(const std::unique_ptr<State>& state);
+
+    /// Destructor. Unregisters the manager from the State.
+    ~SubscriptionManager() override;
+
+    /**
+     * Register a new WebSocket session.
+     * @param session The session.
+     */
+    void addSession(const std::shared_ptr<WSSession>& session);
+
+    /// Publish a new block to the `newHeads` and `logs` subscribers.
+    void onNewBlock(const std::shared_ptr<const Block>& block, const std::vector<Event>& events) override;
+
+    /// Publish a new mempool transaction to the `newPendingTransactions` subscribers.
+    void onNewTx(const Hash& txHash) override;
+};
+
+#endif  // SUBSCRIPTIONS_H
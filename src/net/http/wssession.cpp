@@ -0,0 +1,240 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include "wssession.h"
+
+/**
+ * Build an `eth_subscription` notification.
+ * @param id The subscription ID.
+ * @param result The notification result, already serialized.
+ * @return The notification message.
+ */
+static std::string subscriptionNotification(const std::string& id, const std::string& result) {
+  return R"({"jsonrpc":"2.0","method":"eth_subscription","params":{"subscription":")" + id + R"(","result":)" + result + "}}";
+}
+
+void WSSession::start(http::request<http::string_body>&& req) {
+  // The WebSocket stream has its own timeouts (with pings), the HTTP timeout no longer applies
+  beast::get_lowest_layer(this->ws_).expires_never();
+  // Idle clients are pinged halfway through the timeout, and disconnected if they don't answer
+  auto timeout = websocket::stream_base::timeout::suggested(beast::role_type::server);
+  timeout.idle_timeout = std::chrono::seconds(this->options_->getRPCOptions().wsIdleTimeout);
+  timeout.keep_alive_pings = true;
+  this->ws_.set_option(timeout);
+  this->ws_.set_option(websocket::stream_base::decorator([](websocket::response_type& res) {
+    res.set(http::field::server, BOOST_BEAST_VERSION_STRING);
+  }));
+  this->ws_.read_message_max(this->options_->getRPCOptions().maxBodyBytes);
+  this->ws_.async_accept(req, beast::bind_front_handler(
+    &WSSession::on_accept, this->shared_from_this()
+  ));
+}
+
+void WSSession::on_accept(beast::error_code ec) {
+  if (ec) return fail("WSSession", __func__, ec, "Failed to accept WebSocket handshake");
+  this->manager_.addSession(this->shared_from_this());
+  this->do_read();
+}
+
+void WSSession::do_read() {
+  this->ws_.async_read(this->buf_, beast::bind_front_handler(
+    &WSSession::on_read, this->shared_from_this()
+  ));
+}
+
+void WSSession::on_read(beast::error_code ec, std::size_t bytes) {
+  boost::ignore_unused(bytes);
+  if (ec) {
+    this->close();
+    // This means the other side closed the connection
+    if (ec == websocket::error::closed) return;
+    return fail("WSSession", __func__, ec, "Failed to read message");
+  }
+  std::string msg = beast::buffers_to_string(this->buf_.data());
+  this->buf_.consume(this->buf_.size());
+  this->handleMessage(std::move(msg));
+  // Stop reading while the client has too many requests in flight, like pipelined HTTP requests
+  if (this->inFlight_ < std::max<uint64_t>(this->options_->getRPCOptions().maxPipelinedRequests, 1)) {
+    this->do_read();
+  } else {
+    this->readPaused_ = true;
+  }
+}
+
+void WSSession::do_write() {
+  this->ws_.text(true);
+  this->ws_.async_write(net::buffer(this->outbox_.front()), beast::bind_front_handler(
+    &WSSession::on_write, this->shared_from_this()
+  ));
+}
+
+void WSSession::on_write(beast::error_code ec, std::size_t bytes) {
+  boost::ignore_unused(bytes);
+  if (ec) {
+    this->close();
+    return fail("WSSession", __func__, ec, "Failed to write message");
+  }
+  this->outbox_.pop_front();
+  if (!this->outbox_.empty()) this->do_write();
+}
+
+void WSSession::close() {
+  this->closing_ = true;
+  this->subscriptions_.clear();
+  this->subscribedTypes_ = 0;
+}
+
+void WSSession::send(std::string&& msg) {
+  if (this->closing_) return;
+  if (this->outbox_.size() >= this->options_->getRPCOptions().maxQueuedMessages) {
+    Logger::logToDebug(LogType::WARNING, Log::wsSession, __func__,
+      "Client is not reading its messages fast enough, disconnecting"
+    );
+    this->close();
+    this->ws_.async_close(
+      websocket::close_reason(websocket::close_code::policy_error, "Too many queued messages"),
+      [self = this->shared_from_this()](beast::error_code) {}
+    );
+    return;
+  }
+  this->outbox_.push_back(std::move(msg));
+  if (this->outbox_.size() == 1) this->do_write();
+}
+
+void WSSession::handleMessage(std::string&& msg) {
+  this->inFlight_++;
+  const bool logged = this->accessLog_.sample();
+  const auto received = logged ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+  // Parsing a large message is expensive, so it is done by the workers, just like HTTP requests
+  this->workers_.push(FAST_LANE, [self = this->shared_from_this(), msg = std::move(msg), logged, received]() mutable {
+    std::function<void(std::string)> callback = [self](std::string answer) { self->answer(std::move(answer)); };
+    if (dispatchParsedJsonRpcRequest(msg, self->state_, self->storage_, self->workers_, self->accessLog_,
+      self->limiter_, self->connection_->getPeer(), logged, received, callback
+    )) return;
+    json request;
+    try {
+      request = json::parse(msg);
+    } catch (std::exception& e) {
+      return self->answer(parseError(e));
+    }
+    // Subscriptions belong to the session, so they are handled on its strand
+    if (request.is_object()) {
+      auto method = request.find("method");
+      if (method != request.end() && (*method == "eth_subscribe" || *method == "eth_unsubscribe")) {
+        return net::post(self->ws_.get_executor(), [self, request = std::move(request)]() mutable {
+          self->send(self->handleSubscription(request).dump());
+          self->finishRequest();
+        });
+      }
+    }
+    // Anything else is executed by the workers, just like HTTP requests
+    dispatchJsonRpcRequest(std::move(request), self->state_, self->storage_, self->p2p_, self->options_,
+      self->workers_, self->filters_, self->cache_, self->accessLog_, self->limiter_, self->connection_->getPeer(),
+      logged, received, std::move(callback)
+    );
+  });
+}
+
+void WSSession::answer(std::string&& msg) {
+  net::post(this->ws_.get_executor(), [self = this->shared_from_this(), msg = std::move(msg)]() mutable {
+    self->send(std::move(msg));
+    self->finishRequest();
+  });
+}
+
+void WSSession::finishRequest() {
+  this->inFlight_--;
+  if (this->readPaused_ && !this->closing_) {
+    this->readPaused_ = false;
+    this->do_read();
+  }
+}
+
+json WSSession::handleSubscription(json& request) {
+  json ret;
+  ret["jsonrpc"] = 2.0;
+  ret["id"] = nullptr;
+  // Subscriptions can't be batched (batches go to the workers), as the notifications couldn't be told apart from the responses
+  if (!JsonRPC::Decoding::checkJsonRPCSpec(request)) {
+    ret["error"]["code"] = -32600;
+    ret["error"]["message"] = "Invalid request - does not conform to JSON-RPC 2.0 spec";
+    return ret;
+  }
+  if (request["id"].is_string() || request["id"].is_number()) ret["id"] = request["id"];
+  const json& params = request["params"];
+  try {
+    if (!params.is_array() || params.empty() || !params[0].is_string()) throw std::runtime_error("Missing params");
+    const std::string& param = params[0].get_ref<const std::string&>();
+    if (request["method"] == "eth_unsubscribe") {
+      bool removed = this->subscriptions_.erase(param) > 0;
+      uint8_t types = 0;
+      for (const auto& [id, subscription] : this->subscriptions_) types |= subscription.type;
+      this->subscribedTypes_ = types;
+      ret["result"] = removed;
+      return ret;
+    }
+    if (request["method"] != "eth_subscribe") throw std::runtime_error("Unknown method");
+
+    Subscription subscription;
+    if (param == "newHeads") {
+      subscription.type = NEW_HEADS;
+    } else if (param == "logs") {
+      subscription.type = LOGS;
+      if (params.size() > 1) subscription.filter = LogFilter::fromJson(params[1]);
+    } else if (param == "newPendingTransactions") {
+      subscription.type = NEW_PENDING_TXS;
+    } else {
+      throw std::runtime_error("Unsupported subscription type: " + param);
+    }
+    if (this->subscriptions_.size() >= this->options_->getRPCOptions().maxSubscriptions) {
+      ret["error"]["code"] = -32005;
+      ret["error"]["message"] = "Too many subscriptions";
+      return ret;
+    }
+    std::string id = Hex::fromBytes(Utils::randBytes(16), true).get();
+    this->subscribedTypes_ |= subscription.type;
+    this->subscriptions_.emplace(id, std::move(subscription));
+    ret["result"] = id;
+  } catch (std::exception& e) {
+    ret["error"]["code"] = -32602;
+    ret["error"]["message"] = "Invalid params: " + std::string(e.what());
+  }
+  return ret;
+}
+
+void WSSession::publishBlock(const SubscriptionBlock& block) {
+  for (const auto& [id, subscription] : this->subscriptions_) {
+    if (subscription.type == NEW_HEADS) {
+      this->send(subscriptionNotification(id, block.header));
+    } else if (subscription.type == LOGS) {
+      for (size_t i = 0; i < block.events.size(); i++) {
+        if (subscription.filter.matches(block.events[i])) this->send(subscriptionNotification(id, block.logs[i]));
+      }
+    }
+    // Sending may close the session (and clear the subscriptions) if the client is too slow
+    if (this->closing_) return;
+  }
+}
+
+void WSSession::publishTx(const std::string& txHash) {
+  for (const auto& [id, subscription] : this->subscriptions_) {
+    if (subscription.type == NEW_PENDING_TXS) this->send(subscriptionNotification(id, txHash));
+    if (this->closing_) return;
+  }
+}
+
+void WSSession::notifyBlock(const std::shared_ptr<const SubscriptionBlock>& block) {
+  net::post(this->ws_.get_executor(), [self = this->shared_from_this(), block]() {
+    self->publishBlock(*block);
+  });
+}
+
+void WSSession::notifyTx(const std::shared_ptr<const std::string>& txHash) {
+  net::post(this->ws_.get_executor(), [self = this->shared_from_this(), txHash]() {
+    self->publishTx(*txHash);
+  });
+}
@@ -0,0 +1,217 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#ifndef WSSESSION_H
+#define WSSESSION_H
+
+#include <deque>
+
+#include "httpparser.h"
+#include "filters.h"
+#include "rpccache.h"
+#include "accesslog.h"
+#include "ratelimiter.h"
+
+/**
+ * Class that handles a WebSocket connection session, upgraded from an HTTP session.
+ * Messages are parsed by the RPC workers. `eth_subscribe`/`eth_unsubscribe` requests are
+ * then handled by the session itself, and any other JSON-RPC request by the workers, just
+ * like HTTP requests. Up to `RPCOptions::maxPipelinedRequests` messages are processed at
+ * once, the session stops reading from the client until one of them is answered.
+ * Outgoing messages are queued up to `RPCOptions::maxQueuedMessages`. A client that
+ * doesn't read them fast enough is disconnected, instead of buffering without bound.
+ * Everything except the notify functions runs on the session's strand.
+ */
+class WSSession : public std::enable_shared_from_this<WSSession> {
+  private:
+    /// A subscription of the session.
+    struct Subscription {
+      SubscriptionType type;  ///< The subscription type.
+      LogFilter filter;       ///< The log criteria, for `logs` subscriptions.
+    };
+
+    /// WebSocket stream.
+    websocket::stream<beast::tcp_stream> ws_;
+
+    /// Internal buffer to read from.
+    beast::flat_buffer buf_;
+
+    /// Messages waiting to be sent, the first one is being written.
+    std::deque<std::string> outbox_;
+
+    /// Subscriptions of the session (subscription ID -> subscription).
+    std::unordered_map<std::string, Subscription> subscriptions_;
+
+    /// Types of the session's subscriptions (as bit flags), readable from any thread.
+    std::atomic<uint8_t> subscribedTypes_ = 0;
+
+    /// Indicates whether the session is closing (nothing else is sent).
+    bool closing_ = false;
+
+    /// Number of messages from the client that weren't answered yet.
+    uint64_t inFlight_ = 0;
+
+    /// Indicates whether reading was paused because of too many messages in flight.
+    bool readPaused_ = false;
+
+    /// Reference pointer to the blockchain's state.
+    const std::unique_ptr<State>& state_;
+
+    /// Reference pointer to the blockchain's storage.
+    const std::unique_ptr<Storage>& storage_;
+
+    /// Reference pointer to the P2P connection manager.
+    const std::unique_ptr<P2P::ManagerNormal>& p2p_;
+
+    /// Reference pointer to the options singleton.
+    const std::unique_ptr<Options>& options_;
+
+    /// Reference to the RPC worker pool.
+    RPCWorkerPool& workers_;
+
+    /// Reference to the filter registry.
+    FilterRegistry& filters_;
+
+    /// Reference to the cache of immutable responses.
+    RPCCache& cache_;
+
+    /// Reference to the access log.
+    AccessLog& accessLog_;
+
+    /// Reference to the rate limiter.
+    RateLimiter& limiter_;
+
+    /// The connection slot of the client (with its IP address), taken over from the HTTP session.
+    const std::shared_ptr<const RateLimiter::Connection> connection_;
+
+    /// Reference to the subscription manager.
+    SubscriptionManager& manager_;
+
+    /**
+     * Callback for the WebSocket handshake.
+     * @param ec The error code to parse.
+     */
+    void on_accept(beast::error_code ec);
+
+    /// Read a message.
+    void do_read();
+
+    /**
+     * Callback for do_read().
+     * @param ec The error code to parse.
+     * @param bytes The number of read bytes.
+     */
+    void on_read(beast::error_code ec, std::size_t bytes);
+
+    /// Write the first message of the outbox.
+    void do_write();
+
+    /**
+     * Callback for do_write().
+     * @param ec The error code to parse.
+     * @param bytes The number of written bytes.
+     */
+    void on_write(beast::error_code ec, std::size_t bytes);
+
+    /// Stop sending messages and drop all subscriptions.
+    void close();
+
+    /**
+     * Queue a message to be sent. Disconnects the client if the outbox is full.
+     * @param msg The message.
+     */
+    void send(std::string&& msg);
+
+    /**
+     * Handle a message from the client, on the RPC workers.
+     * @param msg The message.
+     */
+    void handleMessage(std::string&& msg);
+
+    /**
+     * Send the answer to a message of the client. Can be called from any thread.
+     * @param msg The answer.
+     */
+    void answer(std::string&& msg);
+
+    /// Count a message as answered, and resume reading if it was paused.
+    void finishRequest();
+
+    /**
+     * Handle an `eth_subscribe` or `eth_unsubscribe` request.
+     * @param request The request object.
+     * @return The response object.
+     */
+    json handleSubscription(json& request);
+
+    /**
+     * Send a new block to the matching subscriptions.
+     * @param block The block.
+     */
+    void publishBlock(const SubscriptionBlock& block);
+
+    /**
+     * Send a new mempool transaction to the matching subscriptions.
+     * @param txHash The transaction hash, as a JSON string.
+     */
+    void publishTx(const std::string& txHash);
+
+  public:
+    /**
+     * Constructor.
+     * @param sock The socket to take ownership of.
+     * @param connection The connection slot of the client, see RateLimiter::connect().
+     * @param state Reference pointer to the blockchain's state.
+     * @param storage Reference pointer to the blockchain's storage.
+     * @param p2p Reference pointer to the P2P connection manager.
+     * @param options Reference pointer to the options singleton.
+     * @param workers Reference to the RPC worker pool.
+     * @param filters Reference to the filter registry.
+     * @param cache Reference to the cache of immutable responses.
+     * @param accessLog Reference to the access log.
+     * @param limiter Reference to the rate limiter.
+     * @param manager Reference to the subscription manager.
+     */
+    WSSession(tcp::socket&& sock, const std::shared_ptr<const RateLimiter::Connection>& connection,
+      const std::unique_ptr<State>& state,
+      const std::unique_ptr<Storage>& storage,
+      const std::unique_ptr<P2P::ManagerNormal>& p2p,
+      const std::unique_ptr<Options>& options,
+      RPCWorkerPool& workers,
+      FilterRegistry& filters,
+      RPCCache& cache,
+      AccessLog& accessLog,
+      RateLimiter& limiter,
+      SubscriptionManager& manager
+    ) : ws_(std::move(sock)), state_(state), storage_(storage), p2p_(p2p),
+      options_(options), workers_(workers), filters_(filters), cache_(cache), accessLog_(accessLog),
+      limiter_(limiter), connection_(connection), manager_(manager)
+    {}
+
+    /**
+     * Start the session, accepting the WebSocket handshake.
+     * @param req The HTTP upgrade request.
+     */
+    void start(http::request<http::string_body>&& req);
+
+    /// Getter for `subscribedTypes_`.
+    uint8_t getSubscribedTypes() const { return this->subscribedTypes_; }
+
+    /**
+     * Notify the session about a new block. Can be called from any thread.
+     * @param block The block.
+     */
+    void notifyBlock(const std::shared_ptr<const SubscriptionBlock>& block);
+
+    /**
+     * Notify the session about a new mempool transaction. Can be called from any thread.
+     * @param txHash The transaction hash, as a JSON string.
+     */
+    void notifyTx(const std::shared_ptr<const std::string>& txHash);
+};
+
+#endif  // WSSESSION_H
@@ -0,0 +1,69 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include "broadcastfilter.h"
+
+namespace P2P {
+  BroadcastFilter::BroadcastFilter(
+    const size_t& capacity, const std::chrono::milliseconds& generationLifetime
+  ) : generationCapacity_(std::max<size_t>(1, capacity / (shardCount * generationCount))),
+    generationLifetime_(generationLifetime),
+    shards_(std::make_unique<std::array<Shard, shardCount>>())
+  {
+    for (auto& shard : *this->shards_) {
+      for (auto& generation : shard.generations) generation.reserve(this->generationCapacity_);
+    }
+  }
+
+  bool BroadcastFilter::containsInternal(const Shard& shard, const uint64_t& id) {
+    for (const auto& generation : shard.generations) {
+      if (generation.contains(id)) return true;
+    }
+    return false;
+  }
+
+  void BroadcastFilter::rotateIfNeeded(Shard& shard) const {
+    auto now = clock::now();
+    if (
+      shard.generations[shard.current].size() < this->generationCapacity_ &&
+      now - shard.generationStart < this->generationLifetime_
+    ) return;
+    // The oldest generation is the one right after the current, clear it and make it current.
+    shard.current = (shard.current + 1) % generationCount;
+    shard.generations[shard.current].clear();
+    shard.generationStart = now;
+  }
+
+  bool BroadcastFilter::contains(const uint64_t& id) {
+    Shard& shard = this->shardFor(id);
+    bool found;
+    {
+      std::lock_guard lock(shard.mutex);
+      found = containsInternal(shard, id);
+    }
+    (found ? this->hits_ : this->misses_).fetch_add(1, std::memory_order_relaxed);
+    return found;
+  }
+
+  bool BroadcastFilter::insert(const uint64_t& id) {
+    Shard& shard = this->shardFor(id);
+    std::lock_guard lock(shard.mutex);
+    if (containsInternal(shard, id)) return false;
+    this->rotateIfNeeded(shard);
+    shard.generations[shard.current].insert(id);
+    return true;
+  }
+
+  size_t BroadcastFilter::size() const {
+    size_t total = 0;
+    for (auto& shard : *this->shards_) {
+      std::lock_guard lock(shard.mutex);
+      for (const auto& generation : shard.generations) total += generation.size();
+    }
+    return total;
+  }
+};
@@ -0,0 +1,139 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#ifndef P2P_BROADCAST_FILTER_H
+#define P2P_BROADCAST_FILTER_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_set>
+
+#include "../../utils/safehash.h"
+
+namespace P2P {
+  /**
+   * Bounded filter used to de-duplicate broadcast messages.
+   * IDs are spread across a fixed number of shards, each guarded by its own mutex,
+   * so concurrent lookups for different messages rarely contend with each other.
+   * Every shard keeps a small ring of generations (hash sets). New IDs always go
+   * into the current generation; once it is full or older than the configured
+   * lifetime, the oldest generation is cleared and becomes the new current one.
+   * This gives the filter a fixed memory ceiling of `capacity` entries, while
+   * still remembering any ID for at least one full generation.
+   */
+  class BroadcastFilter {
+    public:
+      using clock = std::chrono::steady_clock;  ///< Typedef for a less verbose clock.
+
+      /// Number of shards the IDs are spread across.
+      static constexpr size_t shardCount = 16;
+
+      /// Number of rotating generations kept per shard.
+      static constexpr size_t generationCount = 3;
+
+    private:
+      /// A single shard of the filter.
+      struct Shard {
+        /// Mutex for managing read/write access to the shard.
+        std::mutex mutex;
+
+        /// Ring of generations. `generations[current]` receives new IDs.
+        std::array<std::unordered_set<uint64_t, SafeHash>, generationCount> generations;
+
+        /// Index of the current generation.
+        size_t current = 0;
+
+        /// Time point at which the current generation was started.
+        clock::time_point generationStart = clock::now();
+      };
+
+      /// Maximum number of entries a single generation of a shard can hold.
+      const size_t generationCapacity_;
+
+      /// Maximum time a generation stays current before being rotated.
+      const std::chrono::milliseconds generationLifetime_;
+
+      /// List of shards.
+      const std::unique_ptr<std::array<Shard, shardCount>> shards_;
+
+      /// Number of contains() calls that found a previously seen ID.
+      std::atomic<uint64_t> hits_ = 0;
+
+      /// Number of contains() calls that did not find the ID.
+      std::atomic<uint64_t> misses_ = 0;
+
+      /**
+       * Get the shard responsible for a given ID.
+       * @param id The message ID.
+       * @return A reference to the shard.
+       */
+      Shard& shardFor(const uint64_t& id) const {
+        return (*this->shards_)[SafeHash::splitmix(id) % shardCount];
+      }
+
+      /**
+       * Check whether a shard holds a given ID in any of its generations.
+       * Shard mutex MUST be locked by the caller.
+       * @param shard The shard to look into.
+       * @param id The message ID.
+       * @return `true` if found, `false` otherwise.
+       */
+      static bool containsInternal(const Shard& shard, const uint64_t& id);
+
+      /**
+       * Rotate the shard's generations if the current one is full or expired.
+       * Shard mutex MUST be locked by the caller.
+       * @param shard The shard to rotate.
+       */
+      void rotateIfNeeded(Shard& shard) const;
+
+    public:
+      /**
+       * Constructor.
+       * @param capacity Maximum number of IDs held by the whole filter.
+       * @param generationLifetime Maximum time a generation stays current.
+       */
+      explicit BroadcastFilter(
+        const size_t& capacity = 1 << 18,
+        const std::chrono::milliseconds& generationLifetime = std::chrono::minutes(5)
+      );
+
+      /**
+       * Check if an ID was seen, without registering it.
+       * @param id The message ID.
+       * @return `true` if the ID was already seen, `false` otherwise.
+       */
+      bool contains(const uint64_t& id);
+
+      /**
+       * Register an ID in the filter. Not counted in `hits_`/`misses_`, as an
+       * incoming message is already looked up with contains() before it's relayed.
+       * @param id The message ID.
+       * @return `true` if the ID was not seen before (and is now registered),
+       *         `false` if it was already in the filter.
+       */
+      bool insert(const uint64_t& id);
+
+      /// Get the current number of IDs held by the filter.
+      size_t size() const;
+
+      /// Get the maximum number of IDs the filter can hold.
+      size_t capacity() const { return this->generationCapacity_ * generationCount * shardCount; }
+
+      /// Getter for `hits_`.
+      uint64_t hits() const { return this->hits_.load(std::memory_order_relaxed); }
+
+      /// Getter for `misses_`.
+      uint64_t misses() const { return this->misses_.load(std::memory_order_relaxed); }
+  };
+};
+
+#endif // P2P_BROADCAST_FILTER_H
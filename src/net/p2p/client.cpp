@@ -16,7 +16,7 @@ namespace P2P {
 
 
   bool ClientFactory::run() {
-    Logger::logToDebug(LogType::INFO, Log::P2PClientFactory, __func__,
+    LOGINFO(Log::P2PClientFactory,
                       "Starting P2P Client Factory "
     );
 
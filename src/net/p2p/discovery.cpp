@@ -51,7 +51,7 @@ namespace P2P {
 
   bool DiscoveryWorker::discoverLoop() {
     bool discoveryPass = false;
-    Logger::logToDebug(LogType::INFO, Log::P2PDiscoveryWorker, __func__, "Discovery thread started");
+    LOGINFO(Log::P2PDiscoveryWorker, "Discovery thread started");
     while (!this->stopWorker_) {
       // Check if we reached connection limit
       {
@@ -62,12 +62,12 @@ namespace P2P {
           // This is to make sure that local_testnet can quickly start up a new
           // network, but still sleep discovery if the minimum is reached.
           lock.unlock();
-          Logger::logToDebug(LogType::INFO, Log::P2PDiscoveryWorker, __func__, "Min connections reached, sleeping");
+          LOGINFO(Log::P2PDiscoveryWorker, "Min connections reached, sleeping");
           std::this_thread::sleep_for(std::chrono::seconds(5)); // Only 1 second because we still want to reach maxConnections
           lock.lock();
         } else if (this->manager_.sessions_.size() >= this->manager_.maxConnections()) {
           lock.unlock();
-          Logger::logToDebug(LogType::INFO, Log::P2PDiscoveryWorker, __func__, "Max connections reached, sleeping");
+          LOGINFO(Log::P2PDiscoveryWorker, "Max connections reached, sleeping");
           std::this_thread::sleep_for(std::chrono::seconds(60));
           continue;
         }
@@ -17,16 +17,18 @@ namespace P2P {
   CommandType getCommandType(const BytesArrView message) {
     if (message.size() != 2) { throw std::runtime_error("Invalid Command Type size." + std::to_string(message.size())); }
     uint16_t commandType = Utils::bytesToUint16(message);
-    if (commandType > commandPrefixes.size()) { throw std::runtime_error("Invalid command type."); }
+    if (commandType >= commandPrefixes.size()) { throw std::runtime_error("Invalid command type."); }
     return static_cast<CommandType>(commandType);
   }
 
   const Bytes& getCommandPrefix(const CommandType& commType) { return commandPrefixes[commType]; }
 
+  uint64_t getShortTxId(const Hash& txHash) { return Utils::bytesToUint64(txHash.view_const(0, 8)); }
+
   RequestType getRequestType(const BytesArrView message) {
     if (message.size() != 1) { throw std::runtime_error("Invalid Request Type size. " + std::to_string(message.size())); }
     uint8_t requestType = Utils::bytesToUint8(message);
-    if (requestType > typePrefixes.size()) { throw std::runtime_error("Invalid request type."); }
+    if (requestType >= typePrefixes.size()) { throw std::runtime_error("Invalid request type."); }
     return static_cast<RequestType>(requestType);
   }
 
@@ -70,6 +72,45 @@ namespace P2P {
     return Message(std::move(message));
   }
 
+  Message RequestEncoder::requestBlockTxs(const Hash& blockHash, const std::vector<uint32_t>& indexes) {
+    Bytes message = getRequestTypePrefix(Requesting);
+    message.reserve(message.size() + 8 + 2 + 32 + (indexes.size() * 4));
+    Utils::appendBytes(message, Utils::randBytes(8));
+    Utils::appendBytes(message, getCommandPrefix(RequestBlockTxs));
+    Utils::appendBytes(message, blockHash);
+    for (const auto& index : indexes) Utils::appendBytes(message, Utils::uint32ToBytes(index));
+    return Message(std::move(message));
+  }
+
+  Message RequestEncoder::requestTxs(const std::vector<Hash>& txHashes) {
+    Bytes message = getRequestTypePrefix(Requesting);
+    message.reserve(message.size() + 8 + 2 + (txHashes.size() * 32));
+    Utils::appendBytes(message, Utils::randBytes(8));
+    Utils::appendBytes(message, getCommandPrefix(RequestTxs));
+    for (const auto& txHash : txHashes) Utils::appendBytes(message, txHash);
+    return Message(std::move(message));
+  }
+
+  Message RequestEncoder::requestBlockHeaders(const uint64_t& startHeight, const uint64_t& count) {
+    Bytes message = getRequestTypePrefix(Requesting);
+    message.reserve(message.size() + 8 + 2 + 8 + 8);
+    Utils::appendBytes(message, Utils::randBytes(8));
+    Utils::appendBytes(message, getCommandPrefix(RequestBlockHeaders));
+    Utils::appendBytes(message, Utils::uint64ToBytes(startHeight));
+    Utils::appendBytes(message, Utils::uint64ToBytes(count));
+    return Message(std::move(message));
+  }
+
+  Message RequestEncoder::requestBlockBodies(const uint64_t& startHeight, const uint64_t& count) {
+    Bytes message = getRequestTypePrefix(Requesting);
+    message.reserve(message.size() + 8 + 2 + 8 + 8);
+    Utils::appendBytes(message, Utils::randBytes(8));
+    Utils::appendBytes(message, getCommandPrefix(RequestBlockBodies));
+    Utils::appendBytes(message, Utils::uint64ToBytes(startHeight));
+    Utils::appendBytes(message, Utils::uint64ToBytes(count));
+    return Message(std::move(message));
+  }
+
   bool RequestDecoder::ping(const Message& message) {
     if (message.size() != 11) { return false; }
     if (message.command() != Ping) { return false; }
@@ -98,6 +139,41 @@ namespace P2P {
     return true;
   }
 
+  std::pair<Hash, std::vector<uint32_t>> RequestDecoder::requestBlockTxs(const Message& message) {
+    if (message.command() != RequestBlockTxs) { throw std::runtime_error("Invalid RequestBlockTxs message command."); }
+    BytesArrView data = message.message();
+    if (data.size() < 32 || (data.size() - 32) % 4 != 0) { throw std::runtime_error("Invalid RequestBlockTxs message size."); }
+    Hash blockHash(data.subspan(0, 32));
+    std::vector<uint32_t> indexes;
+    indexes.reserve((data.size() - 32) / 4);
+    for (size_t index = 32; index < data.size(); index += 4) {
+      indexes.push_back(Utils::bytesToUint32(data.subspan(index, 4)));
+    }
+    return {blockHash, indexes};
+  }
+
+  std::vector<Hash> RequestDecoder::requestTxs(const Message& message) {
+    if (message.command() != RequestTxs) { throw std::runtime_error("Invalid RequestTxs message command."); }
+    BytesArrView data = message.message();
+    if (data.size() % 32 != 0) { throw std::runtime_error("Invalid RequestTxs message size."); }
+    std::vector<Hash> txHashes;
+    txHashes.reserve(data.size() / 32);
+    for (size_t index = 0; index < data.size(); index += 32) txHashes.emplace_back(data.subspan(index, 32));
+    return txHashes;
+  }
+
+  std::pair<uint64_t, uint64_t> RequestDecoder::requestBlockHeaders(const Message& message) {
+    if (message.size() != 27) { throw std::runtime_error("Invalid RequestBlockHeaders message size."); }
+    if (message.command() != RequestBlockHeaders) { throw std::runtime_error("Invalid RequestBlockHeaders message command."); }
+    return {Utils::bytesToUint64(message.message().subspan(0, 8)), Utils::bytesToUint64(message.message().subspan(8, 8))};
+  }
+
+  std::pair<uint64_t, uint64_t> RequestDecoder::requestBlockBodies(const Message& message) {
+    if (message.size() != 27) { throw std::runtime_error("Invalid RequestBlockBodies message size."); }
+    if (message.command() != RequestBlockBodies) { throw std::runtime_error("Invalid RequestBlockBodies message command."); }
+    return {Utils::bytesToUint64(message.message().subspan(0, 8)), Utils::bytesToUint64(message.message().subspan(8, 8))};
+  }
+
   Message AnswerEncoder::ping(const Message& request) {
     Bytes message = getRequestTypePrefix(Answering);
     message.reserve(message.size() + 8 + 2);
@@ -160,6 +236,68 @@ namespace P2P {
     return Message(std::move(message));
   }
 
+  Message AnswerEncoder::requestBlockTxs(const Message& request, const std::vector<TxBlock>& txs) {
+    Bytes message = getRequestTypePrefix(Answering);
+    Utils::appendBytes(message, request.id());
+    Utils::appendBytes(message, getCommandPrefix(RequestBlockTxs));
+    for (const auto& tx : txs) {
+      Bytes rlp = tx.rlpSerialize();
+      Utils::appendBytes(message, Utils::uint32ToBytes(rlp.size()));
+      message.insert(message.end(), rlp.begin(), rlp.end());
+    }
+    return Message(std::move(message));
+  }
+
+  Message AnswerEncoder::requestTxs(const Message& request, const std::vector<TxBlock>& txs) {
+    Bytes message = getRequestTypePrefix(Answering);
+    Utils::appendBytes(message, request.id());
+    Utils::appendBytes(message, getCommandPrefix(RequestTxs));
+    for (const auto& tx : txs) {
+      Bytes rlp = tx.rlpSerialize();
+      Utils::appendBytes(message, Utils::uint32ToBytes(rlp.size()));
+      message.insert(message.end(), rlp.begin(), rlp.end());
+    }
+    return Message(std::move(message));
+  }
+
+  Message AnswerEncoder::requestBlockHeaders(const Message& request,
+    const std::vector<std::shared_ptr<const Block>>& blocks
+  ) {
+    Bytes message = getRequestTypePrefix(Answering);
+    message.reserve(message.size() + 8 + 2 + (blocks.size() * (65 + 144)));
+    Utils::appendBytes(message, request.id());
+    Utils::appendBytes(message, getCommandPrefix(RequestBlockHeaders));
+    for (const auto& block : blocks) {
+      Utils::appendBytes(message, block->getValidatorSig());
+      Utils::appendBytes(message, block->serializeHeader());
+    }
+    return Message(std::move(message));
+  }
+
+  Message AnswerEncoder::requestBlockBodies(const Message& request,
+    const std::vector<std::shared_ptr<const Block>>& blocks
+  ) {
+    // Each body is: tx count + Validator tx count + [block txs...] + [Validator txs...]
+    Bytes message = getRequestTypePrefix(Answering);
+    Utils::appendBytes(message, request.id());
+    Utils::appendBytes(message, getCommandPrefix(RequestBlockBodies));
+    for (const auto& block : blocks) {
+      Utils::appendBytes(message, Utils::uint32ToBytes(block->getTxs().size()));
+      Utils::appendBytes(message, Utils::uint32ToBytes(block->getTxValidators().size()));
+      for (const auto& tx : block->getTxs()) {
+        Bytes rlp = tx.rlpSerialize();
+        Utils::appendBytes(message, Utils::uint32ToBytes(rlp.size()));
+        message.insert(message.end(), rlp.begin(), rlp.end());
+      }
+      for (const auto& tx : block->getTxValidators()) {
+        Bytes rlp = tx.rlpSerialize();
+        Utils::appendBytes(message, Utils::uint32ToBytes(rlp.size()));
+        message.insert(message.end(), rlp.begin(), rlp.end());
+      }
+    }
+    return Message(std::move(message));
+  }
+
   bool AnswerDecoder::ping(const Message& message) {
     if (message.size() != 11) { return false; }
     if (message.type() != Answering) { return false; }
@@ -233,6 +371,92 @@ namespace P2P {
     return txs;
   }
 
+  std::vector<TxBlock> AnswerDecoder::requestBlockTxs(
+    const Message& message, const uint64_t& requiredChainId
+  ) {
+    if (message.type() != Answering) { throw std::runtime_error("Invalid message type."); }
+    if (message.command() != RequestBlockTxs) { throw std::runtime_error("Invalid command."); }
+    std::vector<TxBlock> txs;
+    BytesArrView data = message.message();
+    size_t index = 0;
+    while (index < data.size()) {
+      if (data.size() - index < 4) { throw std::runtime_error("Invalid data size."); }
+      uint32_t txSize = Utils::bytesToUint32(data.subspan(index, 4));
+      index += 4;
+      if (data.size() - index < txSize) { throw std::runtime_error("Invalid data size."); }
+      txs.emplace_back(data.subspan(index, txSize), requiredChainId);
+      index += txSize;
+    }
+    return txs;
+  }
+
+  std::vector<TxBlock> AnswerDecoder::requestTxs(
+    const Message& message, const uint64_t& requiredChainId
+  ) {
+    if (message.type() != Answering) { throw std::runtime_error("Invalid message type."); }
+    if (message.command() != RequestTxs) { throw std::runtime_error("Invalid command."); }
+    std::vector<TxBlock> txs;
+    BytesArrView data = message.message();
+    size_t index = 0;
+    while (index < data.size()) {
+      if (data.size() - index < 4) { throw std::runtime_error("Invalid data size."); }
+      uint32_t txSize = Utils::bytesToUint32(data.subspan(index, 4));
+      index += 4;
+      if (data.size() - index < txSize) { throw std::runtime_error("Invalid data size."); }
+      txs.emplace_back(data.subspan(index, txSize), requiredChainId);
+      index += txSize;
+    }
+    return txs;
+  }
+
+  std::vector<BlockHeader> AnswerDecoder::requestBlockHeaders(const Message& message) {
+    if (message.type() != Answering) { throw std::runtime_error("Invalid message type."); }
+    if (message.command() != RequestBlockHeaders) { throw std::runtime_error("Invalid command."); }
+    BytesArrView data = message.message();
+    if (data.size() % (65 + 144) != 0) { throw std::runtime_error("Invalid data size."); }
+    std::vector<BlockHeader> headers;
+    headers.reserve(data.size() / (65 + 144));
+    for (size_t index = 0; index < data.size(); index += 65 + 144) {
+      BlockHeader header;
+      header.signedHeader = Bytes(data.begin() + index, data.begin() + index + 65 + 144);
+      header.hash = Utils::sha3(data.subspan(index + 65, 144));
+      header.prevBlockHash = Hash(data.subspan(index + 65, 32));
+      header.nHeight = Utils::bytesToUint64(data.subspan(index + 65 + 136, 8));
+      headers.push_back(std::move(header));
+    }
+    return headers;
+  }
+
+  std::vector<BlockBody> AnswerDecoder::requestBlockBodies(
+    const Message& message, const uint64_t& requiredChainId
+  ) {
+    if (message.type() != Answering) { throw std::runtime_error("Invalid message type."); }
+    if (message.command() != RequestBlockBodies) { throw std::runtime_error("Invalid command."); }
+    std::vector<BlockBody> bodies;
+    BytesArrView data = message.message();
+    size_t index = 0;
+    // Returns the next length-prefixed transaction in the data, advancing the index.
+    auto nextTx = [&data, &index]() {
+      if (data.size() - index < 4) { throw std::runtime_error("Invalid data size."); }
+      uint32_t txSize = Utils::bytesToUint32(data.subspan(index, 4));
+      index += 4;
+      if (data.size() - index < txSize) { throw std::runtime_error("Invalid data size."); }
+      index += txSize;
+      return data.subspan(index - txSize, txSize);
+    };
+    while (index < data.size()) {
+      if (data.size() - index < 8) { throw std::runtime_error("Invalid data size."); }
+      uint32_t txCount = Utils::bytesToUint32(data.subspan(index, 4));
+      uint32_t txValidatorCount = Utils::bytesToUint32(data.subspan(index + 4, 4));
+      index += 8;
+      BlockBody body;
+      for (uint32_t i = 0; i < txCount; i++) body.txs.emplace_back(nextTx(), requiredChainId);
+      for (uint32_t i = 0; i < txValidatorCount; i++) body.txValidators.emplace_back(nextTx(), requiredChainId);
+      bodies.push_back(std::move(body));
+    }
+    return bodies;
+  }
+
   Message BroadcastEncoder::broadcastValidatorTx(const TxValidator& tx) {
     Bytes message = getRequestTypePrefix(Broadcasting);
     // We need to use std::hash instead of SafeHash
@@ -264,6 +488,30 @@ namespace P2P {
     return Message(std::move(message));
   }
 
+  Message BroadcastEncoder::broadcastCompactBlock(const std::shared_ptr<const Block>& block) {
+    // Signed header + tx count + short tx IDs + [validator txs...]
+    Bytes compactBlock;
+    const auto& txs = block->getTxs();
+    compactBlock.reserve(65 + 144 + 4 + (txs.size() * 8));
+    Utils::appendBytes(compactBlock, block->getValidatorSig());
+    Utils::appendBytes(compactBlock, block->serializeHeader());
+    Utils::appendBytes(compactBlock, Utils::uint32ToBytes(txs.size()));
+    for (const auto& tx : txs) Utils::appendBytes(compactBlock, Utils::uint64ToBytes(getShortTxId(tx.hash())));
+    for (const auto& tx : block->getTxValidators()) {
+      Bytes rlp = tx.rlpSerialize();
+      Utils::appendBytes(compactBlock, Utils::uint32ToBytes(rlp.size()));
+      compactBlock.insert(compactBlock.end(), rlp.begin(), rlp.end());
+    }
+    Bytes message = getRequestTypePrefix(Broadcasting);
+    message.reserve(message.size() + 8 + 2 + compactBlock.size());
+    // We need to use std::hash instead of SafeHash
+    // Because hashing with SafeHash will always be different between nodes
+    Utils::appendBytes(message, Utils::uint64ToBytes(FNVHash()(compactBlock)));
+    Utils::appendBytes(message, getCommandPrefix(BroadcastCompactBlock));
+    message.insert(message.end(), compactBlock.begin(), compactBlock.end());
+    return Message(std::move(message));
+  }
+
   TxValidator BroadcastDecoder::broadcastValidatorTx(const Message& message, const uint64_t& requiredChainId) {
     if (message.type() != Broadcasting) { throw std::runtime_error("Invalid message type."); }
     if (message.id().toUint64() != FNVHash()(message.message())) { throw std::runtime_error("Invalid message id."); }
@@ -284,5 +532,56 @@ namespace P2P {
     if (message.command() != BroadcastBlock) { throw std::runtime_error("Invalid command."); }
     return Block(message.message(), requiredChainId);
   }
-}
 
+  CompactBlock BroadcastDecoder::broadcastCompactBlock(const Message& message, const uint64_t& requiredChainId) {
+    if (message.type() != Broadcasting) { throw std::runtime_error("Invalid message type."); }
+    if (message.id().toUint64() != FNVHash()(message.message())) { throw std::runtime_error("Invalid message id."); }
+    if (message.command() != BroadcastCompactBlock) { throw std::runtime_error("Invalid command."); }
+    BytesArrView data = message.message();
+    if (data.size() < 65 + 144 + 4) { throw std::runtime_error("Invalid compact block size - too short"); }
+    CompactBlock compactBlock;
+    compactBlock.signedHeader = Bytes(data.begin(), data.begin() + 65 + 144);
+    compactBlock.hash = Utils::sha3(data.subspan(65, 144));
+    compactBlock.nHeight = Utils::bytesToUint64(data.subspan(65 + 136, 8));
+    uint64_t txCount = Utils::bytesToUint32(data.subspan(65 + 144, 4));
+    size_t index = 65 + 144 + 4;
+    if ((data.size() - index) / 8 < txCount) { throw std::runtime_error("Invalid compact block size - missing short IDs"); }
+    compactBlock.shortTxIds.reserve(txCount);
+    for (uint64_t i = 0; i < txCount; i++) {
+      compactBlock.shortTxIds.push_back(Utils::bytesToUint64(data.subspan(index, 8)));
+      index += 8;
+    }
+    while (index < data.size()) {
+      if (data.size() - index < 4) { throw std::runtime_error("Invalid data size."); }
+      uint32_t txSize = Utils::bytesToUint32(data.subspan(index, 4));
+      index += 4;
+      if (data.size() - index < txSize) { throw std::runtime_error("Invalid data size."); }
+      compactBlock.txValidators.emplace_back(data.subspan(index, txSize), requiredChainId);
+      if (compactBlock.txValidators.back().getNHeight() != compactBlock.nHeight) {
+        throw std::runtime_error("Invalid validator tx height");
+      }
+      index += txSize;
+    }
+    return compactBlock;
+  }
+
+  Message NotificationEncoder::notifyTxHashes(const std::vector<Hash>& txHashes) {
+    Bytes message = getRequestTypePrefix(Notifying);
+    message.reserve(message.size() + 8 + 2 + (txHashes.size() * 32));
+    Utils::appendBytes(message, Utils::randBytes(8));
+    Utils::appendBytes(message, getCommandPrefix(NotifyTxHashes));
+    for (const auto& txHash : txHashes) Utils::appendBytes(message, txHash);
+    return Message(std::move(message));
+  }
+
+  std::vector<Hash> NotificationDecoder::notifyTxHashes(const Message& message) {
+    if (message.type() != Notifying) { throw std::runtime_error("Invalid message type."); }
+    if (message.command() != NotifyTxHashes) { throw std::runtime_error("Invalid command."); }
+    BytesArrView data = message.message();
+    if (data.size() % 32 != 0) { throw std::runtime_error("Invalid data size."); }
+    std::vector<Hash> txHashes;
+    txHashes.reserve(data.size() / 32);
+    for (size_t index = 0; index < data.size(); index += 32) txHashes.emplace_back(data.subspan(index, 32));
+    return txHashes;
+  }
+}
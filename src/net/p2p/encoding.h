@@ -8,6 +8,7 @@ See the LICENSE.txt file in the project root for more information.
 #ifndef P2P_ENCODING_H
 #define P2P_ENCODING_H
 
+#include <functional>
 #include <future>
 
 #include "../../utils/utils.h"
@@ -35,7 +36,7 @@ namespace P2P {
   enum NodeType { NORMAL_NODE, DISCOVERY_NODE };
 
   /// Enum for identifying the type of a request.
-  enum RequestType { Requesting, Answering, Broadcasting };
+  enum RequestType { Requesting, Answering, Broadcasting, Notifying };
 
   /// Enum for identifying the type of a command.
   enum CommandType {
@@ -45,7 +46,13 @@ namespace P2P {
     RequestValidatorTxs,
     BroadcastValidatorTx,
     BroadcastTx,
-    BroadcastBlock
+    BroadcastBlock,
+    BroadcastCompactBlock,
+    RequestBlockTxs,
+    NotifyTxHashes,
+    RequestTxs,
+    RequestBlockHeaders,
+    RequestBlockBodies
   };
 
   /**
@@ -54,11 +61,13 @@ namespace P2P {
    * - "00" = %Request
    * - "01" = Answer
    * - "02" = Broadcast
+   * - "03" = Notification (sent to a single node, never answered nor relayed)
    */
   inline extern const std::vector<Bytes> typePrefixes {
     Bytes(1, 0x00), // Request
     Bytes(1, 0x01), // Answer
-    Bytes(1, 0x02)  // Broadcast
+    Bytes(1, 0x02), // Broadcast
+    Bytes(1, 0x03)  // Notification
   };
 
   /**
@@ -71,6 +80,12 @@ namespace P2P {
    * - "0004" = BroadcastValidatorTx
    * - "0005" = BroadcastTx
    * - "0006" = BroadcastBlock
+   * - "0007" = BroadcastCompactBlock
+   * - "0008" = RequestBlockTxs
+   * - "0009" = NotifyTxHashes
+   * - "000A" = RequestTxs
+   * - "000B" = RequestBlockHeaders
+   * - "000C" = RequestBlockBodies
    */
   inline extern const std::vector<Bytes> commandPrefixes {
     Bytes{0x00, 0x00}, // Ping
@@ -79,7 +94,13 @@ namespace P2P {
     Bytes{0x00, 0x03}, // RequestValidatorTxs
     Bytes{0x00, 0x04}, // BroadcastValidatorTx
     Bytes{0x00, 0x05}, // BroadcastTx
-    Bytes{0x00, 0x06}  // BroadcastBlock
+    Bytes{0x00, 0x06}, // BroadcastBlock
+    Bytes{0x00, 0x07}, // BroadcastCompactBlock
+    Bytes{0x00, 0x08}, // RequestBlockTxs
+    Bytes{0x00, 0x09}, // NotifyTxHashes
+    Bytes{0x00, 0x0A}, // RequestTxs
+    Bytes{0x00, 0x0B}, // RequestBlockHeaders
+    Bytes{0x00, 0x0C}  // RequestBlockBodies
   };
 
   /**
@@ -110,6 +131,13 @@ namespace P2P {
    */
   const Bytes& getCommandPrefix(const CommandType& commType);
 
+  /**
+   * Get the short ID of a transaction, used to reference it in compact blocks.
+   * @param txHash The transaction hash.
+   * @return The first 8 bytes of the hash, as an unsigned number.
+   */
+  uint64_t getShortTxId(const Hash& txHash);
+
   /// Abstraction of an 8-byte/64-bit hash that represents a unique ID for a request. Inherits `FixedBytes<8>`.
   class RequestID : public FixedBytes<8> {
     public:
@@ -168,6 +196,51 @@ namespace P2P {
     }
   };
 
+  /**
+   * A block relayed by its signed header, Validator transactions and
+   * short IDs of its block transactions, which peers rebuild from their mempool.
+   */
+  struct CompactBlock {
+    /// Validator signature + block header, in the same layout as Block::serializeBlock().
+    Bytes signedHeader;
+
+    /// %Hash of the block.
+    Hash hash;
+
+    /// Height of the block.
+    uint64_t nHeight = 0;
+
+    /// List of Validator transactions.
+    std::vector<TxValidator> txValidators;
+
+    /// Short IDs of the block transactions, in block order.
+    std::vector<uint64_t> shortTxIds;
+  };
+
+  /// A signed block header, used to sync the chain of headers before the block bodies.
+  struct BlockHeader {
+    /// Validator signature + block header, in the same layout as Block::serializeBlock().
+    Bytes signedHeader;
+
+    /// %Hash of the block.
+    Hash hash;
+
+    /// %Hash of the previous block.
+    Hash prevBlockHash;
+
+    /// Height of the block.
+    uint64_t nHeight = 0;
+  };
+
+  /// The transactions of a block, which rebuild the full block together with its header.
+  struct BlockBody {
+    /// List of block transactions.
+    std::vector<TxBlock> txs;
+
+    /// List of Validator transactions.
+    std::vector<TxValidator> txValidators;
+  };
+
   /// Helper class used to create requests.
   class RequestEncoder {
     public:
@@ -199,6 +272,37 @@ namespace P2P {
        * @return The formatted request.
        */
       static Message requestValidatorTxs();
+
+      /**
+       * Create a `RequestBlockTxs` request.
+       * @param blockHash The hash of the block that holds the transactions.
+       * @param indexes The indexes of the wanted transactions inside the block.
+       * @return The formatted request.
+       */
+      static Message requestBlockTxs(const Hash& blockHash, const std::vector<uint32_t>& indexes);
+
+      /**
+       * Create a `RequestTxs` request.
+       * @param txHashes The hashes of the wanted transactions.
+       * @return The formatted request.
+       */
+      static Message requestTxs(const std::vector<Hash>& txHashes);
+
+      /**
+       * Create a `RequestBlockHeaders` request.
+       * @param startHeight The height of the first wanted header.
+       * @param count The number of wanted headers.
+       * @return The formatted request.
+       */
+      static Message requestBlockHeaders(const uint64_t& startHeight, const uint64_t& count);
+
+      /**
+       * Create a `RequestBlockBodies` request.
+       * @param startHeight The height of the first wanted body.
+       * @param count The number of wanted bodies.
+       * @return The formatted request.
+       */
+      static Message requestBlockBodies(const uint64_t& startHeight, const uint64_t& count);
   };
 
   /// Helper class used to parse requests.
@@ -232,6 +336,38 @@ namespace P2P {
        * @return `true` if the message is valid, `false` otherwise.
        */
       static bool requestValidatorTxs(const Message& message);
+
+      /**
+       * Parse a `RequestBlockTxs` message.
+       * @param message The message to parse.
+       * @return A pair with the block hash and the indexes of the wanted transactions.
+       * @throw std::runtime_error if the message is invalid.
+       */
+      static std::pair<Hash, std::vector<uint32_t>> requestBlockTxs(const Message& message);
+
+      /**
+       * Parse a `RequestTxs` message.
+       * @param message The message to parse.
+       * @return The hashes of the wanted transactions.
+       * @throw std::runtime_error if the message is invalid.
+       */
+      static std::vector<Hash> requestTxs(const Message& message);
+
+      /**
+       * Parse a `RequestBlockHeaders` message.
+       * @param message The message to parse.
+       * @return A pair with the height of the first wanted header and the number of wanted headers.
+       * @throw std::runtime_error if the message is invalid.
+       */
+      static std::pair<uint64_t, uint64_t> requestBlockHeaders(const Message& message);
+
+      /**
+       * Parse a `RequestBlockBodies` message.
+       * @param message The message to parse.
+       * @return A pair with the height of the first wanted body and the number of wanted bodies.
+       * @throw std::runtime_error if the message is invalid.
+       */
+      static std::pair<uint64_t, uint64_t> requestBlockBodies(const Message& message);
   };
 
   /// Helper class used to create answers to requests.
@@ -275,6 +411,42 @@ namespace P2P {
       static Message requestValidatorTxs(const Message& request,
         const std::unordered_map<Hash, TxValidator, SafeHash>& txs
       );
+
+      /**
+       * Create a `RequestBlockTxs` answer.
+       * @param request The request message.
+       * @param txs The requested transactions, in the requested order.
+       * @return The formatted answer.
+       */
+      static Message requestBlockTxs(const Message& request, const std::vector<TxBlock>& txs);
+
+      /**
+       * Create a `RequestTxs` answer.
+       * @param request The request message.
+       * @param txs The requested transactions that were found in the mempool.
+       * @return The formatted answer.
+       */
+      static Message requestTxs(const Message& request, const std::vector<TxBlock>& txs);
+
+      /**
+       * Create a `RequestBlockHeaders` answer.
+       * @param request The request message.
+       * @param blocks The blocks whose signed headers will be sent, in height order.
+       * @return The formatted answer.
+       */
+      static Message requestBlockHeaders(const Message& request,
+        const std::vector<std::shared_ptr<const Block>>& blocks
+      );
+
+      /**
+       * Create a `RequestBlockBodies` answer.
+       * @param request The request message.
+       * @param blocks The blocks whose bodies will be sent, in height order.
+       * @return The formatted answer.
+       */
+      static Message requestBlockBodies(const Message& request,
+        const std::vector<std::shared_ptr<const Block>>& blocks
+      );
   };
 
   /// Helper class used to parse answers to requests.
@@ -312,6 +484,43 @@ namespace P2P {
       static std::vector<TxValidator> requestValidatorTxs(
         const Message& message, const uint64_t& requiredChainId
       );
+
+      /**
+       * Parse a `RequestBlockTxs` answer.
+       * @param message The answer to parse.
+       * @param requiredChainId The chain ID to use as reference.
+       * @return A list of requested block transactions, in the requested order.
+       */
+      static std::vector<TxBlock> requestBlockTxs(
+        const Message& message, const uint64_t& requiredChainId
+      );
+
+      /**
+       * Parse a `RequestTxs` answer.
+       * @param message The answer to parse.
+       * @param requiredChainId The chain ID to use as reference.
+       * @return A list of requested block transactions.
+       */
+      static std::vector<TxBlock> requestTxs(
+        const Message& message, const uint64_t& requiredChainId
+      );
+
+      /**
+       * Parse a `RequestBlockHeaders` answer.
+       * @param message The answer to parse.
+       * @return A list of signed block headers, in height order.
+       */
+      static std::vector<BlockHeader> requestBlockHeaders(const Message& message);
+
+      /**
+       * Parse a `RequestBlockBodies` answer.
+       * @param message The answer to parse.
+       * @param requiredChainId The chain ID to use as reference.
+       * @return A list of block bodies, in height order.
+       */
+      static std::vector<BlockBody> requestBlockBodies(
+        const Message& message, const uint64_t& requiredChainId
+      );
   };
 
   /// Helper class used to create broadcast messages.
@@ -337,6 +546,14 @@ namespace P2P {
        * @return The formatted message.
        */
       static Message broadcastBlock(const std::shared_ptr<const Block>& block);
+
+      /**
+       * Create a message to broadcast a block in compact form
+       * (signed header, Validator transactions and short IDs of the block transactions).
+       * @param block The block to broadcast.
+       * @return The formatted message.
+       */
+      static Message broadcastCompactBlock(const std::shared_ptr<const Block>& block);
   };
 
   /// Helper class used to parse broadcast messages.
@@ -365,6 +582,37 @@ namespace P2P {
        * @return The build block object.
        */
       static Block broadcastBlock(const Message& message, const uint64_t& requiredChainId);
+
+      /**
+       * Parse a broadcasted message for a compact block.
+       * @param message The message that was broadcast.
+       * @param requiredChainId The chain ID to use as reference.
+       * @return The parsed compact block.
+       */
+      static CompactBlock broadcastCompactBlock(const Message& message, const uint64_t& requiredChainId);
+  };
+
+  /// Helper class used to create notifications.
+  class NotificationEncoder {
+    public:
+      /**
+       * Create a notification announcing a batch of transactions.
+       * @param txHashes The hashes of the announced transactions.
+       * @return The formatted message.
+       */
+      static Message notifyTxHashes(const std::vector<Hash>& txHashes);
+  };
+
+  /// Helper class used to parse notifications.
+  class NotificationDecoder {
+    public:
+      /**
+       * Parse a notification announcing a batch of transactions.
+       * @param message The message to parse.
+       * @return The hashes of the announced transactions.
+       * @throw std::runtime_error if the message is invalid.
+       */
+      static std::vector<Hash> notifyTxHashes(const Message& message);
   };
 
   /**
@@ -424,10 +672,18 @@ namespace P2P {
       friend class RequestEncoder;
       friend class AnswerEncoder;
       friend class BroadcastEncoder;
+      friend class NotificationEncoder;
       friend class Session;
       friend class Request;
   };
 
+  /**
+   * Callback for an asynchronous request.
+   * Called once with the node that was requested and its answer,
+   * or a null answer if the request timed out.
+   */
+  using AnswerCallback = std::function<void(const NodeID&, const std::shared_ptr<const Message>&)>;
+
   /// Abstraction of a %P2P request, passed through the network.
   class Request {
     private:
@@ -436,7 +692,9 @@ namespace P2P {
       NodeID nodeId_;                                                                       ///< Host node ID.
       std::promise<const std::shared_ptr<const Message>> answer_;                           ///< Answer to the request.
       const std::shared_ptr<const Message> message_;                                        ///< The request message. Used if we need to ask another node.
-      bool isAnswered_ = false;                                                             ///< Indicates whether the request was answered.
+      std::atomic<bool> isAnswered_ = false;                                                ///< Indicates whether the request was answered (or timed out).
+      std::atomic<bool> isTimedOut_ = false;                                                ///< Indicates whether the request timed out.
+      const AnswerCallback callback_;                                                       ///< Optional callback called when the request is answered or times out.
 
     public:
       /**
@@ -444,10 +702,13 @@ namespace P2P {
        * @param command The request's command type.
        * @param id The request's ID.
        * @param nodeId The request's host node ID.
-        * @param message The request's message.
+       * @param message The request's message.
+       * @param callback (optional) Callback to call when the request is answered or times out.
        */
-      Request(const CommandType& command, const RequestID& id, const NodeID& nodeId, const std::shared_ptr<const Message>& message) :
-              command_(command), id_(id), nodeId_(nodeId), message_(message) {};
+      Request(
+        const CommandType& command, const RequestID& id, const NodeID& nodeId,
+        const std::shared_ptr<const Message>& message, const AnswerCallback& callback = nullptr
+      ) : command_(command), id_(id), nodeId_(nodeId), message_(message), callback_(callback) {};
 
       /// Getter for `command_`.
       const CommandType& command() const { return command_; };
@@ -458,14 +719,41 @@ namespace P2P {
       /// Getter for `nodeId_`.
       const NodeID& nodeId() const { return nodeId_; };
 
+      /// Getter for `message_`.
+      const std::shared_ptr<const Message>& message() const { return message_; };
+
       /// Getter for `answer_`.
       std::future<const std::shared_ptr<const Message>> answerFuture() { return answer_.get_future(); };
 
       /// Getter for `isAnswered_`.
       const bool isAnswered() const { return isAnswered_; };
 
-      /// Setter for `answer_`. Also sets `isAnswered_` to `true`.
-      void setAnswer(const std::shared_ptr<const Message> answer) { answer_.set_value(answer); isAnswered_ = true; };
+      /// Getter for `isTimedOut_`.
+      const bool isTimedOut() const { return isTimedOut_; };
+
+      /**
+       * Setter for `answer_`. Also sets `isAnswered_` to `true`.
+       * @param answer The answer message.
+       * @return `true` if the answer was set, `false` if the request was already answered or timed out.
+       */
+      bool setAnswer(const std::shared_ptr<const Message> answer) {
+        if (isAnswered_.exchange(true)) return false;
+        answer_.set_value(answer);
+        if (callback_) callback_(nodeId_, answer);
+        return true;
+      };
+
+      /**
+       * Expire the request, making its answer future throw a timeout error.
+       * @return `true` if the request was expired, `false` if it was already answered or timed out.
+       */
+      bool setTimeout() {
+        if (isAnswered_.exchange(true)) return false;
+        isTimedOut_ = true;
+        answer_.set_exception(std::make_exception_ptr(std::runtime_error("Request timed out")));
+        if (callback_) callback_(nodeId_, nullptr);
+        return true;
+      };
   };
 };
 
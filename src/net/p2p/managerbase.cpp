@@ -24,9 +24,11 @@ namespace P2P {
                         session->hostNodeId().first.to_string() + ":" + std::to_string(session->hostNodeId().second));
       return false;
     }
-    Logger::logToDebug(LogType::INFO, Log::P2PManager, __func__, "Registering session at " +
+    LOGINFO(Log::P2PManager, "Registering session at " +
                       session->hostNodeId().first.to_string() + ":" + std::to_string(session->hostNodeId().second));
     sessions_.insert({session->hostNodeId(), session});
+    lockSession.unlock();
+    this->sessionsSignal_.notify();
     return true;
   }
 
@@ -52,14 +54,16 @@ namespace P2P {
       Logger::logToDebug(LogType::ERROR, Log::P2PManager, __func__, "Session does not exist at " + nodeId.first.to_string() + ":" + std::to_string(nodeId.second));
       return false;
     }
-    Logger::logToDebug(LogType::INFO, Log::P2PManager, __func__, "Disconnecting session at " + nodeId.first.to_string() + ":" + std::to_string(nodeId.second));
+    LOGINFO(Log::P2PManager, "Disconnecting session at " + nodeId.first.to_string() + ":" + std::to_string(nodeId.second));
     // Get a copy of the pointer
     sessions_[nodeId]->close();
     sessions_.erase(nodeId);
     return true;
   }
 
-  std::shared_ptr<Request> ManagerBase::sendRequestTo(const NodeID &nodeId, const std::shared_ptr<const Message>& message) {
+  std::shared_ptr<Request> ManagerBase::sendRequestTo(
+    const NodeID &nodeId, const std::shared_ptr<const Message>& message, const AnswerCallback& callback
+  ) {
     if (this->closed_) return nullptr;
     std::shared_lock<std::shared_mutex> lockSession(this->sessionsMutex_); // ManagerBase::sendRequestTo doesn't change sessions_ map.
     if(!sessions_.contains(nodeId)) {
@@ -73,13 +77,49 @@ namespace P2P {
       (message->command() == CommandType::Info || message->command() == CommandType::RequestValidatorTxs)
     ) {
       lockSession.unlock(); // Unlock before calling logToDebug to avoid waiting for the lock in the logToDebug function.
-      Logger::logToDebug(LogType::INFO, Log::P2PManager, __func__, "Session is discovery, cannot send message");
+      LOGINFO(Log::P2PManager, "Session is discovery, cannot send message");
       return nullptr;
     }
-    std::unique_lock lockRequests(this->requestsMutex_);
-    requests_[message->id()] = std::make_shared<Request>(message->command(), message->id(), session->hostNodeId(), message);
+    auto requestPtr = std::make_shared<Request>(message->command(), message->id(), session->hostNodeId(), message, callback);
+    this->requests_.insert(requestPtr);
     session->write(message);
-    return requests_[message->id()];
+    return requestPtr;
+  }
+
+  size_t ManagerBase::sendRequestToAll(
+    const std::vector<NodeID>& nodeIds, const std::function<Message()>& encoder,
+    const AnswerCallback& callback, const std::chrono::milliseconds& timeout
+  ) {
+    // Shared with the request callbacks, which can outlive this function.
+    struct FanOut {
+      std::mutex mutex;
+      std::condition_variable cv;
+      size_t pending = 0;
+      size_t answered = 0;
+      bool finished = false;
+    };
+    auto fanOut = std::make_shared<FanOut>();
+    fanOut->pending = nodeIds.size();
+    auto onAnswer = [fanOut, callback](const NodeID& nodeId, const std::shared_ptr<const Message>& answer) {
+      std::unique_lock lock(fanOut->mutex);
+      if (fanOut->finished) return;
+      if (answer != nullptr) {
+        fanOut->answered++;
+        callback(nodeId, answer);
+      }
+      if (--fanOut->pending == 0) fanOut->cv.notify_all();
+    };
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    for (const auto& nodeId : nodeIds) {
+      if (this->sendRequestTo(nodeId, std::make_shared<const Message>(encoder()), onAnswer) == nullptr) {
+        std::unique_lock lock(fanOut->mutex);
+        fanOut->pending--;
+      }
+    }
+    std::unique_lock lock(fanOut->mutex);
+    fanOut->cv.wait_until(lock, deadline, [&fanOut]() { return fanOut->pending == 0; });
+    fanOut->finished = true;
+    return fanOut->answered;
   }
 
   // ManagerBase::answerSession doesn't change sessions_ map, but we still need to
@@ -96,6 +136,7 @@ namespace P2P {
 
   void ManagerBase::start() {
     this->closed_ = false;
+    this->requests_.start();
     this->server_->start();
     this->clientfactory_->start();
   }
@@ -112,6 +153,7 @@ namespace P2P {
     }
     this->server_->stop();
     this->clientfactory_->stop();
+    this->requests_.stop();
   }
 
   std::vector<NodeID> ManagerBase::getSessionsIDs() const {
@@ -150,11 +192,13 @@ namespace P2P {
     if (requestPtr == nullptr) throw std::runtime_error(
       "Failed to send ping to " + nodeId.first.to_string() + ":" + std::to_string(nodeId.second)
     );
-    requestPtr->answerFuture().wait();
+    auto answer = requestPtr->answerFuture();
+    if (answer.wait_for(this->requests_.timeout()) == std::future_status::timeout) throw std::runtime_error(
+      "Ping to " + nodeId.first.to_string() + ":" + std::to_string(nodeId.second) + " timed out"
+    );
+    answer.get();
   }
 
-  // TODO: Both ping and requestNodes is a blocking call on .wait()
-  // Somehow change to wait_for.
   std::unordered_map<NodeID, NodeType, SafeHash> ManagerBase::requestNodes(const NodeID& nodeId) {
     auto request = std::make_shared<const Message>(RequestEncoder::requestNodes());
     Utils::logToFile("Requesting nodes from " + nodeId.first.to_string() + ":" + std::to_string(nodeId.second));
@@ -13,7 +13,9 @@ See the LICENSE.txt file in the project root for more information.
 #include "server.h"
 #include "client.h"
 #include "discovery.h"
+#include "requesttable.h"
 #include "../../utils/options.h"
+#include "../../utils/eventsignal.h"
 #include "../../libs/BS_thread_pool_light.hpp"
 
 namespace P2P {
@@ -47,15 +49,14 @@ namespace P2P {
       /// Mutex for managing read/write access to the sessions list.
       mutable std::shared_mutex sessionsMutex_;
 
-      /// Mutex for managing read/write access to the requests list.
-      mutable std::shared_mutex requestsMutex_;
-
       /// List of currently active sessions.
       std::unordered_map<NodeID, std::shared_ptr<Session>, SafeHash> sessions_;
 
-      // TODO: Somehow find a way to clean up requests_ after a certain time/being used.
-      /// List of currently active requests.
-      std::unordered_map<RequestID, std::shared_ptr<Request>, SafeHash> requests_;
+      /// Signal notified every time a session is registered.
+      EventSignal sessionsSignal_;
+
+      /// Table of currently active requests. Unanswered requests expire after a timeout.
+      RequestTable requests_;
 
       /// Server Object
       const std::unique_ptr<Server> server_;
@@ -79,9 +80,28 @@ namespace P2P {
        * Send a Request to a given node.
        * @param nodeId The ID of the node to send the message to.
        * @param message The message to send.
+       * @param callback (optional) Callback to call when the request is answered or times out.
        * @return A pointer to the request object, or null on error.
        */
-      std::shared_ptr<Request> sendRequestTo(const NodeID &nodeId, const std::shared_ptr<const Message>& message);
+      std::shared_ptr<Request> sendRequestTo(
+        const NodeID &nodeId, const std::shared_ptr<const Message>& message, const AnswerCallback& callback = nullptr
+      );
+
+      /**
+       * Send the same kind of Request to several nodes at once, and gather the answers as they arrive.
+       * Requests are sent without waiting for each other, so one slow node doesn't delay the rest.
+       * The callback is called once for each node that answers before the deadline, serialized
+       * (never concurrently) and never after this function returns.
+       * @param nodeIds The IDs of the nodes to send the request to.
+       * @param encoder Function that creates the request message (each request needs its own ID).
+       * @param callback Callback to call with each answer.
+       * @param timeout Maximum time to wait for the answers.
+       * @return The number of nodes that answered in time.
+       */
+      size_t sendRequestToAll(
+        const std::vector<NodeID>& nodeIds, const std::function<Message()>& encoder,
+        const AnswerCallback& callback, const std::chrono::milliseconds& timeout
+      );
 
       /**
        * Answer a message to a given session.
@@ -135,10 +155,10 @@ namespace P2P {
       };
 
       /// Start P2P::Server and P2P::ClientFactory.
-      void start();
+      virtual void start();
 
       /// Stop the P2P::Server and P2P::ClientFactory.
-      void stop();
+      virtual void stop();
 
       /// Start the discovery thread.a
       void startDiscovery() { this->discoveryWorker_->start(); };
@@ -164,6 +184,9 @@ namespace P2P {
       /// Getter for `closed_`.
       const std::atomic<bool>& isClosed() const { return closed_; }
 
+      /// Getter for `sessionsSignal_`.
+      EventSignal& sessionsSignal() { return this->sessionsSignal_; }
+
       /// Get the size of the session list.
       const uint64_t getPeerCount() const { std::shared_lock lock(this->sessionsMutex_); return sessions_.size(); }
 
@@ -210,9 +233,13 @@ namespace P2P {
         // Do nothing by default, child classes are meant to override this
       }
 
+      /// Get the number of outstanding requests.
+      size_t getPendingRequestCount() const { return this->requests_.size(); }
+
       /**
-       * Ping a node and wait for it to answer. Throws on failure.
+       * Ping a node and wait for it to answer.
        * @param nodeId The ID of the node to ping.
+       * @throw std::runtime_error if the ping could not be sent or timed out.
        */
       void ping(const NodeID &nodeId);
 
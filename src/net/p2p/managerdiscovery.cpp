@@ -143,9 +143,8 @@ namespace P2P {
   void ManagerDiscovery::handlePingAnswer(
     std::weak_ptr<Session> session, const std::shared_ptr<const Message>& message
   ) {
-    std::unique_lock lock(this->requestsMutex_);
-    if (!requests_.contains(message->id())) {
-      lock.unlock(); // Unlock before calling logToDebug to avoid waiting for the lock in the logToDebug function.
+    auto request = this->requests_.take(message->id());
+    if (request == nullptr) {
       if (auto sessionPtr = session.lock()) {
         Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
           "Answer to invalid request from " + sessionPtr->hostNodeId().first.to_string() + ":" +
@@ -159,15 +158,14 @@ namespace P2P {
       }
       return;
     }
-    requests_[message->id()]->setAnswer(message);
+    request->setAnswer(message);
   }
 
   void ManagerDiscovery::handleRequestNodesAnswer(
     std::weak_ptr<Session> session, const std::shared_ptr<const Message>& message
   ) {
-    std::unique_lock lock(this->requestsMutex_);
-    if (!requests_.contains(message->id())) {
-      lock.unlock(); // Unlock before calling logToDebug to avoid waiting for the lock in the logToDebug function.
+    auto request = this->requests_.take(message->id());
+    if (request == nullptr) {
       if (auto sessionPtr = session.lock()) {
         Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
           "Answer to invalid request from " + sessionPtr->hostNodeId().first.to_string() + ":" +
@@ -181,7 +179,7 @@ namespace P2P {
       }
       return;
     }
-    requests_[message->id()]->setAnswer(message);
+    request->setAnswer(message);
   }
 };
 
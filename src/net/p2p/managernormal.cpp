@@ -9,25 +9,20 @@ See the LICENSE.txt file in the project root for more information.
 #include "../core/rdpos.h"
 #include "../core/storage.h"
 #include "../core/state.h"
+#include "../../utils/tracer.h"
 
 namespace P2P{
   void ManagerNormal::broadcastMessage(const std::shared_ptr<const Message> message) {
     if (this->closed_) return;
-    {
-      std::unique_lock broadcastLock(this->broadcastMutex_);
-      if (broadcastedMessages_[message->id().toUint64()] > 0) {
-        broadcastLock.unlock(); // Unlock before calling logToDebug to avoid waiting for the lock in the logToDebug function.
-        Logger::logToDebug(LogType::DEBUG, Log::P2PManager, __func__,
-          "Message " + message->id().hex().get() + " already broadcasted, skipping."
-        );
-        return;
-      } else {
-        broadcastedMessages_[message->id().toUint64()]++;
-      }
+    if (!this->broadcastedMessages_.insert(message->id().toUint64())) {
+      LOGDEBUG(Log::P2PManager,
+        "Message " + message->id().hex().get() + " already broadcasted, skipping."
+      );
+      return;
     }
     // ManagerNormal::broadcastMessage doesn't change sessions_ map
     std::shared_lock sessionsLock(this->sessionsMutex_);
-    Logger::logToDebug(LogType::INFO, Log::P2PManager, __func__,
+    LOGINFO(Log::P2PManager,
       "Broadcasting message " + message->id().hex().get() + " to all nodes. "
     );
     for (const auto& [nodeId, session] : this->sessions_) {
@@ -35,10 +30,26 @@ namespace P2P{
     }
   }
 
+  void ManagerNormal::start() {
+    ManagerBase::start();
+    this->txGossip_.start();
+  }
+
+  void ManagerNormal::stop() {
+    this->txGossip_.stop();
+    ManagerBase::stop();
+  }
+
   void ManagerNormal::handleMessage(
     std::weak_ptr<Session> session, const std::shared_ptr<const Message> message
   ) {
     if (this->closed_) return;
+    TraceSpan span("P2P::handleMessage");
+    if (span.active()) {
+      // Raw bytes, the message isn't validated yet
+      span.attr("type", message->raw()[0]).attr("command", Utils::bytesToUint16(message->raw().subspan(9, 2)));
+      span.attr("bytes", message->size());
+    }
     switch (message->type()) {
       case Requesting:
         handleRequest(session, message);
@@ -49,6 +60,9 @@ namespace P2P{
       case Broadcasting:
         handleBroadcast(session, message);
         break;
+      case Notifying:
+        handleNotification(session, message);
+        break;
       default:
         if (auto sessionPtr = session.lock()) {
           Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
@@ -82,6 +96,18 @@ namespace P2P{
       case RequestValidatorTxs:
         handleTxValidatorRequest(session, message);
         break;
+      case RequestBlockTxs:
+        handleBlockTxsRequest(session, message);
+        break;
+      case RequestTxs:
+        handleTxsRequest(session, message);
+        break;
+      case RequestBlockHeaders:
+        handleBlockHeadersRequest(session, message);
+        break;
+      case RequestBlockBodies:
+        handleBlockBodiesRequest(session, message);
+        break;
       default:
         if (auto sessionPtr = session.lock()) {
           Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
@@ -116,6 +142,14 @@ namespace P2P{
       case RequestValidatorTxs:
         handleTxValidatorAnswer(session, message);
         break;
+      case RequestBlockTxs:
+        handleBlockTxsAnswer(session, message);
+        break;
+      case RequestTxs:
+      case RequestBlockHeaders:
+      case RequestBlockBodies:
+        handleGenericAnswer(session, message);
+        break;
       default:
         if (auto sessionPtr = session.lock()) {
           Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
@@ -138,17 +172,13 @@ namespace P2P{
     std::weak_ptr<Session> session, const std::shared_ptr<const Message>& message
   ) {
     if (this->closed_) return;
-    {
-      std::shared_lock broadcastLock(this->broadcastMutex_);
-      auto it = broadcastedMessages_.find(message->id().toUint64());
-      if (it != broadcastedMessages_.end() && it->second > 0) {
-        broadcastLock.unlock(); // Unlock before calling logToDebug to avoid waiting for the lock in the logToDebug function.
-        Logger::logToDebug(LogType::DEBUG, Log::P2PManager, __func__,
-          "Already broadcasted message " + message->id().hex().get() +
-          " to all nodes. Skipping broadcast."
-        );
-        return;
-      }
+    TraceSpan span("P2P::handleBroadcast");
+    if (this->broadcastedMessages_.contains(message->id().toUint64())) {
+      LOGDEBUG(Log::P2PManager,
+        "Already broadcasted message " + message->id().hex().get() +
+        " to all nodes. Skipping broadcast."
+      );
+      return;
     }
     switch (message->command()) {
       case BroadcastValidatorTx:
@@ -160,6 +190,9 @@ namespace P2P{
       case BroadcastBlock:
         handleBlockBroadcast(session, message);
         break;
+      case BroadcastCompactBlock:
+        handleCompactBlockBroadcast(session, message);
+        break;
       default:
         if (auto sessionPtr = session.lock()) {
           Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
@@ -178,6 +211,32 @@ namespace P2P{
     }
   }
 
+  void ManagerNormal::handleNotification(
+    std::weak_ptr<Session> session, const std::shared_ptr<const Message>& message
+  ) {
+    if (this->closed_) return;
+    switch (message->command()) {
+      case NotifyTxHashes:
+        handleTxHashesNotification(session, message);
+        break;
+      default:
+        if (auto sessionPtr = session.lock()) {
+          Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
+            "Invalid Notification Command Type: " + std::to_string(message->command())
+            + " from: " + sessionPtr->hostNodeId().first.to_string() + ":" +
+              std::to_string(sessionPtr->hostNodeId().second) + " , closing session."
+          );
+          this->disconnectSession(sessionPtr->hostNodeId());
+        } else {
+          Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
+            "Invalid Notification Command Type: " + std::to_string(message->command())
+            + " from unknown session, closing session."
+          );
+        }
+        break;
+    }
+  }
+
   void ManagerNormal::handlePingRequest(
     std::weak_ptr<Session> session, const std::shared_ptr<const Message>& message
   ) {
@@ -258,12 +317,119 @@ namespace P2P{
     this->answerSession(session, std::make_shared<const Message>(AnswerEncoder::requestValidatorTxs(*message, this->rdpos_->getMempool())));
   }
 
+  void ManagerNormal::handleBlockTxsRequest(
+    std::weak_ptr<Session> session, const std::shared_ptr<const Message>& message
+  ) {
+    try {
+      auto [blockHash, indexes] = RequestDecoder::requestBlockTxs(*message);
+      // If we don't have the block (anymore), answer with an empty list.
+      std::vector<TxBlock> txs;
+      if (auto block = this->storage_->getBlock(blockHash)) {
+        txs.reserve(indexes.size());
+        for (const auto& index : indexes) txs.push_back(block->getTxs().at(index));
+      }
+      this->answerSession(session, std::make_shared<const Message>(AnswerEncoder::requestBlockTxs(*message, txs)));
+    } catch (std::exception &e) {
+      if (auto sessionPtr = session.lock()) {
+        Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
+          "Invalid requestBlockTxs request from " + sessionPtr->hostNodeId().first.to_string() + ":" +
+          std::to_string(sessionPtr->hostNodeId().second) + " , error: " + e.what() + " closing session."
+        );
+        this->disconnectSession(sessionPtr->hostNodeId());
+      } else {
+        Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
+          std::string("Invalid requestBlockTxs request from unknown session, error: ") + e.what() + " closing session."
+        );
+      }
+    }
+  }
+
+  void ManagerNormal::handleTxsRequest(
+    std::weak_ptr<Session> session, const std::shared_ptr<const Message>& message
+  ) {
+    try {
+      auto sessionPtr = session.lock();
+      if (sessionPtr == nullptr) return;
+      auto txs = this->txGossip_.handleRequest(sessionPtr->hostNodeId(), RequestDecoder::requestTxs(*message));
+      this->answerSession(session, std::make_shared<const Message>(AnswerEncoder::requestTxs(*message, txs)));
+    } catch (std::exception &e) {
+      if (auto sessionPtr = session.lock()) {
+        Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
+          "Invalid requestTxs request from " + sessionPtr->hostNodeId().first.to_string() + ":" +
+          std::to_string(sessionPtr->hostNodeId().second) + " , error: " + e.what() + " closing session."
+        );
+        this->disconnectSession(sessionPtr->hostNodeId());
+      } else {
+        Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
+          std::string("Invalid requestTxs request from unknown session, error: ") + e.what() + " closing session."
+        );
+      }
+    }
+  }
+
+  void ManagerNormal::handleBlockHeadersRequest(
+    std::weak_ptr<Session> session, const std::shared_ptr<const Message>& message
+  ) {
+    try {
+      auto [startHeight, count] = RequestDecoder::requestBlockHeaders(*message);
+      // Answer with the headers we have, stopping at the first missing block.
+      std::vector<std::shared_ptr<const Block>> blocks;
+      uint64_t endHeight = startHeight + std::min(count, ManagerNormal::maxHeadersPerRequest);
+      for (uint64_t height = startHeight; height < endHeight; height++) {
+        auto block = this->storage_->getBlock(height);
+        if (block == nullptr) break;
+        blocks.push_back(std::move(block));
+      }
+      this->answerSession(session, std::make_shared<const Message>(AnswerEncoder::requestBlockHeaders(*message, blocks)));
+    } catch (std::exception &e) {
+      if (auto sessionPtr = session.lock()) {
+        Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
+          "Invalid requestBlockHeaders request from " + sessionPtr->hostNodeId().first.to_string() + ":" +
+          std::to_string(sessionPtr->hostNodeId().second) + " , error: " + e.what() + " closing session."
+        );
+        this->disconnectSession(sessionPtr->hostNodeId());
+      } else {
+        Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
+          std::string("Invalid requestBlockHeaders request from unknown session, error: ") + e.what() + " closing session."
+        );
+      }
+    }
+  }
+
+  void ManagerNormal::handleBlockBodiesRequest(
+    std::weak_ptr<Session> session, const std::shared_ptr<const Message>& message
+  ) {
+    try {
+      auto [startHeight, count] = RequestDecoder::requestBlockBodies(*message);
+      // Answer with the bodies we have, stopping at the first missing block.
+      std::vector<std::shared_ptr<const Block>> blocks;
+      uint64_t endHeight = startHeight + std::min(count, ManagerNormal::maxBodiesPerRequest);
+      for (uint64_t height = startHeight; height < endHeight; height++) {
+        auto block = this->storage_->getBlock(height);
+        if (block == nullptr) break;
+        blocks.push_back(std::move(block));
+      }
+      this->answerSession(session, std::make_shared<const Message>(AnswerEncoder::requestBlockBodies(*message, blocks)));
+    } catch (std::exception &e) {
+      if (auto sessionPtr = session.lock()) {
+        Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
+          "Invalid requestBlockBodies request from " + sessionPtr->hostNodeId().first.to_string() + ":" +
+          std::to_string(sessionPtr->hostNodeId().second) + " , error: " + e.what() + " closing session."
+        );
+        this->disconnectSession(sessionPtr->hostNodeId());
+      } else {
+        Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
+          std::string("Invalid requestBlockBodies request from unknown session, error: ") + e.what() + " closing session."
+        );
+      }
+    }
+  }
+
   void ManagerNormal::handlePingAnswer(
     std::weak_ptr<Session> session, const std::shared_ptr<const Message>& message
   ) {
-    std::unique_lock lock(this->requestsMutex_);
-    if (!requests_.contains(message->id())) {
-      lock.unlock(); // Unlock before doing anything else to avoid waiting for other locks.
+    auto request = this->requests_.take(message->id());
+    if (request == nullptr) {
       if (auto sessionPtr = session.lock()) {
         Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
           "Answer to invalid request from " + sessionPtr->hostNodeId().first.to_string() + ":" +
@@ -277,15 +443,14 @@ namespace P2P{
       }
       return;
     }
-    requests_[message->id()]->setAnswer(message);
+    request->setAnswer(message);
   }
 
   void ManagerNormal::handleInfoAnswer(
     std::weak_ptr<Session> session, const std::shared_ptr<const Message>& message
   ) {
-    std::unique_lock lock(this->requestsMutex_);
-    if (!requests_.contains(message->id())) {
-      lock.unlock(); // Unlock before calling logToDebug to avoid waiting for the lock in the logToDebug function.
+    auto request = this->requests_.take(message->id());
+    if (request == nullptr) {
       if (auto sessionPtr = session.lock()) {
         Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
           "Answer to invalid request from " + sessionPtr->hostNodeId().first.to_string() + ":" +
@@ -299,15 +464,14 @@ namespace P2P{
       }
       return;
     }
-    requests_[message->id()]->setAnswer(message);
+    request->setAnswer(message);
   }
 
   void ManagerNormal::handleRequestNodesAnswer(
     std::weak_ptr<Session> session, const std::shared_ptr<const Message>& message
   ) {
-    std::unique_lock lock(this->requestsMutex_);
-    if (!requests_.contains(message->id())) {
-      lock.unlock(); // Unlock before calling logToDebug to avoid waiting for the lock in the logToDebug function.
+    auto request = this->requests_.take(message->id());
+    if (request == nullptr) {
       if (auto sessionPtr = session.lock()) {
         Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
           "Answer to invalid request from " + sessionPtr->hostNodeId().first.to_string() + ":" +
@@ -321,15 +485,56 @@ namespace P2P{
       }
       return;
     }
-    requests_[message->id()]->setAnswer(message);
+    request->setAnswer(message);
   }
 
   void ManagerNormal::handleTxValidatorAnswer(
     std::weak_ptr<Session> session, const std::shared_ptr<const Message>& message
   ) {
-    std::unique_lock lock(this->requestsMutex_);
-    if (!requests_.contains(message->id())) {
-      lock.unlock(); // Unlock before calling logToDebug to avoid waiting for the lock in the logToDebug function.
+    auto request = this->requests_.take(message->id());
+    if (request == nullptr) {
+      if (auto sessionPtr = session.lock()) {
+        Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
+          "Answer to invalid request from " + sessionPtr->hostNodeId().first.to_string() + ":" +
+          std::to_string(sessionPtr->hostNodeId().second) + " , closing session."
+        );
+        this->disconnectSession(sessionPtr->hostNodeId());
+      } else {
+        Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
+          "Answer to invalid request from unknown session, closing session."
+        );
+      }
+      return;
+    }
+    request->setAnswer(message);
+  }
+
+  void ManagerNormal::handleBlockTxsAnswer(
+    std::weak_ptr<Session> session, const std::shared_ptr<const Message>& message
+  ) {
+    auto request = this->requests_.take(message->id());
+    if (request == nullptr) {
+      if (auto sessionPtr = session.lock()) {
+        Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
+          "Answer to invalid request from " + sessionPtr->hostNodeId().first.to_string() + ":" +
+          std::to_string(sessionPtr->hostNodeId().second) + " , closing session."
+        );
+        this->disconnectSession(sessionPtr->hostNodeId());
+      } else {
+        Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
+          "Answer to invalid request from unknown session, closing session."
+        );
+      }
+      return;
+    }
+    request->setAnswer(message);
+  }
+
+  void ManagerNormal::handleGenericAnswer(
+    std::weak_ptr<Session> session, const std::shared_ptr<const Message>& message
+  ) {
+    auto request = this->requests_.take(message->id());
+    if (request == nullptr) {
       if (auto sessionPtr = session.lock()) {
         Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
           "Answer to invalid request from " + sessionPtr->hostNodeId().first.to_string() + ":" +
@@ -343,7 +548,7 @@ namespace P2P{
       }
       return;
     }
-    requests_[message->id()]->setAnswer(message);
+    request->setAnswer(message);
   }
 
   void ManagerNormal::handleTxValidatorBroadcast(
@@ -372,7 +577,10 @@ namespace P2P{
   ) {
     try {
       auto tx = BroadcastDecoder::broadcastTx(*message, this->options_->getChainID());
-      if (!this->state_->addTx(std::move(tx))) this->broadcastMessage(message);
+      Hash txHash = tx.hash();
+      // Relay accepted transactions through the announcement gossip instead of flooding them again.
+      if (auto sessionPtr = session.lock()) this->txGossip_.markKnown(sessionPtr->hostNodeId(), {txHash});
+      if (!this->state_->addTx(std::move(tx))) this->txGossip_.announce(txHash);
     } catch (std::exception &e) {
       if (auto sessionPtr = session.lock()) {
         Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
@@ -388,6 +596,184 @@ namespace P2P{
     }
   }
 
+  void ManagerNormal::rebuildCompactBlock(
+    const NodeID& nodeId, CompactBlock&& compactBlock, const std::shared_ptr<const Message>& message
+  ) {
+    auto pending = std::make_shared<PendingCompactBlock>();
+    pending->nodeId = nodeId;
+    pending->txs = this->state_->getTxsFromMempoolByShortId(compactBlock.shortTxIds);
+    pending->compactBlock = std::move(compactBlock);
+    pending->message = message;
+    std::vector<uint32_t> missing;
+    for (uint32_t i = 0; i < pending->txs.size(); i++) if (pending->txs[i] == nullptr) missing.push_back(i);
+    if (missing.empty()) {
+      this->finishCompactBlock(pending, pending->txs.empty());
+      return;
+    }
+    if (!this->parkCompactBlock(pending)) {
+      LOGDEBUG(Log::P2PManager,
+        "Compact block " + pending->compactBlock.hash.hex().get() + " is already being fetched or too many are pending, dropping it."
+      );
+      return;
+    }
+    LOGDEBUG(Log::P2PManager,
+      "Compact block " + pending->compactBlock.hash.hex().get() + " is missing " + std::to_string(missing.size())
+      + " of " + std::to_string(pending->txs.size()) + " transactions, requesting them."
+    );
+    this->fetchCompactBlockTxs(pending, std::move(missing));
+  }
+
+  void ManagerNormal::fetchCompactBlockTxs(
+    const std::shared_ptr<PendingCompactBlock>& pending, std::vector<uint32_t>&& indexes
+  ) {
+    auto request = std::make_shared<const Message>(RequestEncoder::requestBlockTxs(pending->compactBlock.hash, indexes));
+    // Called with the answer on the thread that handles it, or with null on timeout (or when stopping)
+    auto onAnswer = [this, pending, indexes](const NodeID& nodeId, const std::shared_ptr<const Message>& answer) {
+      std::vector<TxBlock> fetched;
+      if (answer != nullptr && !this->closed_) {
+        try {
+          fetched = AnswerDecoder::requestBlockTxs(*answer, this->options_->getChainID());
+        } catch (std::exception &e) {
+          Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
+            "Request to " + nodeId.first.to_string() + ":" + std::to_string(nodeId.second) + " failed with error: " + e.what()
+          );
+        }
+      }
+      if (fetched.size() != indexes.size()) {
+        Logger::logToDebug(LogType::WARNING, Log::P2PManager, __func__,
+          "Could not fetch the missing transactions of compact block " + pending->compactBlock.hash.hex().get()
+        );
+        this->unparkCompactBlock(pending);
+        return;
+      }
+      for (uint32_t i = 0; i < indexes.size(); i++) pending->txs[indexes[i]] = std::make_unique<TxBlock>(std::move(fetched[i]));
+      this->finishCompactBlock(pending, indexes.size() == pending->txs.size());
+    };
+    if (this->sendRequestTo(pending->nodeId, request, onAnswer) == nullptr) {
+      Logger::logToDebug(LogType::WARNING, Log::P2PParser, __func__,
+        "Request to " + pending->nodeId.first.to_string() + ":" + std::to_string(pending->nodeId.second) + " failed."
+      );
+      this->unparkCompactBlock(pending);
+    }
+  }
+
+  void ManagerNormal::finishCompactBlock(const std::shared_ptr<PendingCompactBlock>& pending, const bool& fetchedAll) {
+    std::optional<Block> block;
+    try {
+      std::vector<TxBlock> txs;
+      txs.reserve(pending->txs.size());
+      for (auto& tx : pending->txs) txs.emplace_back(std::move(*tx));
+      auto txValidators = pending->compactBlock.txValidators;
+      block.emplace(pending->compactBlock.signedHeader, std::move(txs), std::move(txValidators));
+    } catch (std::exception &e) {
+      if (!fetchedAll) {
+        // Either the block is invalid or two transactions share a short ID,
+        // ask for the whole transaction list to tell them apart.
+        if (!pending->parked && !this->parkCompactBlock(pending)) return;
+        std::vector<uint32_t> all(pending->txs.size());
+        for (uint32_t i = 0; i < all.size(); i++) all[i] = i;
+        this->fetchCompactBlockTxs(pending, std::move(all));
+        return;
+      }
+      this->unparkCompactBlock(pending);
+      Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
+        "Invalid compact block from " + pending->nodeId.first.to_string() + ":" +
+        std::to_string(pending->nodeId.second) + " , error: " + e.what() + " closing session."
+      );
+      this->disconnectSession(pending->nodeId);
+      return;
+    }
+    bool rebroadcast = false;
+    try {
+      // Same locking as handleBlockBroadcast, see the comment there.
+      std::unique_lock lock(this->blockBroadcastMutex_);
+      if (this->storage_->blockExists(block->hash())) {
+        rebroadcast = true;
+      } else if (this->state_->validateNextBlock(*block)) {
+        this->state_->processNextBlock(std::move(*block));
+        rebroadcast = true;
+      }
+    } catch (std::exception &e) {
+      Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
+        "Invalid compact block from " + pending->nodeId.first.to_string() + ":" +
+        std::to_string(pending->nodeId.second) + " , error: " + e.what() + " closing session."
+      );
+      this->disconnectSession(pending->nodeId);
+    }
+    this->unparkCompactBlock(pending);
+    if (rebroadcast) this->broadcastMessage(pending->message);
+  }
+
+  bool ManagerNormal::parkCompactBlock(const std::shared_ptr<PendingCompactBlock>& pending) {
+    std::lock_guard lock(this->pendingCompactBlocksMutex_);
+    if (this->pendingCompactBlocks_.size() >= ManagerNormal::maxPendingCompactBlocks) return false;
+    if (!this->pendingCompactBlocks_.insert(pending->compactBlock.hash).second) return false;
+    pending->parked = true;
+    return true;
+  }
+
+  void ManagerNormal::unparkCompactBlock(const std::shared_ptr<PendingCompactBlock>& pending) {
+    std::lock_guard lock(this->pendingCompactBlocksMutex_);
+    if (!pending->parked) return;
+    this->pendingCompactBlocks_.erase(pending->compactBlock.hash);
+    pending->parked = false;
+  }
+
+  void ManagerNormal::handleCompactBlockBroadcast(
+    std::weak_ptr<Session> session, const std::shared_ptr<const Message>& message
+  ) {
+    bool rebroadcast = false;
+    try {
+      auto compactBlock = BroadcastDecoder::broadcastCompactBlock(*message, this->options_->getChainID());
+      uint64_t latestHeight = this->storage_->latest()->getNHeight();
+      if (compactBlock.nHeight <= latestHeight) {
+        // We already have this block, but if it is the latest one we should still relay it
+        if (compactBlock.nHeight == latestHeight && this->storage_->blockExists(compactBlock.hash)) rebroadcast = true;
+      } else if (compactBlock.nHeight == latestHeight + 1) {
+        auto sessionPtr = session.lock();
+        if (sessionPtr == nullptr) return;
+        // Processed and relayed there, right away or once the missing transactions arrive.
+        this->rebuildCompactBlock(sessionPtr->hostNodeId(), std::move(compactBlock), message);
+      }
+    } catch (std::exception &e) {
+      if (auto sessionPtr = session.lock()) {
+        Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
+          "Invalid compactBlockBroadcast from " + sessionPtr->hostNodeId().first.to_string() + ":" +
+          std::to_string(sessionPtr->hostNodeId().second) + " , error: " + e.what() + " closing session."
+        );
+        this->disconnectSession(sessionPtr->hostNodeId());
+      } else {
+        Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
+          std::string("Invalid compactBlockBroadcast from unknown session, error: ") + e.what() + " closing session."
+        );
+      }
+      return;
+    }
+    if (rebroadcast) this->broadcastMessage(message);
+  }
+
+  void ManagerNormal::handleTxHashesNotification(
+    std::weak_ptr<Session> session, const std::shared_ptr<const Message>& message
+  ) {
+    try {
+      auto sessionPtr = session.lock();
+      if (sessionPtr == nullptr) return;
+      this->txGossip_.handleAnnouncement(sessionPtr->hostNodeId(), NotificationDecoder::notifyTxHashes(*message));
+    } catch (std::exception &e) {
+      if (auto sessionPtr = session.lock()) {
+        Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
+          "Invalid txHashes notification from " + sessionPtr->hostNodeId().first.to_string() + ":" +
+          std::to_string(sessionPtr->hostNodeId().second) + " , error: " + e.what() + " closing session."
+        );
+        this->disconnectSession(sessionPtr->hostNodeId());
+      } else {
+        Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
+          std::string("Invalid txHashes notification from unknown session, error: ") + e.what() + " closing session."
+        );
+      }
+    }
+  }
+
   void ManagerNormal::handleBlockBroadcast(
     std::weak_ptr<Session> session, const std::shared_ptr<const Message>& message
   ) {
@@ -484,6 +870,107 @@ namespace P2P{
     }
   }
 
+  size_t ManagerNormal::requestValidatorTxsFromAll(
+    const std::vector<NodeID>& nodeIds,
+    const std::function<void(const NodeID&, std::vector<TxValidator>&&)>& onAnswer,
+    const std::chrono::milliseconds& timeout
+  ) {
+    return this->sendRequestToAll(nodeIds, &RequestEncoder::requestValidatorTxs,
+      [&](const NodeID& nodeId, const std::shared_ptr<const Message>& answer) {
+        try {
+          onAnswer(nodeId, AnswerDecoder::requestValidatorTxs(*answer, this->options_->getChainID()));
+        } catch (std::exception &e) {
+          Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
+            "Request to " + nodeId.first.to_string() + ":" + std::to_string(nodeId.second) + " failed with error: " + e.what()
+          );
+        }
+      }, timeout
+    );
+  }
+
+  size_t ManagerNormal::requestNodeInfoFromAll(
+    const std::vector<NodeID>& nodeIds,
+    const std::function<void(const NodeID&, const NodeInfo&)>& onAnswer,
+    const std::chrono::milliseconds& timeout
+  ) {
+    auto latest = this->storage_->latest();
+    return this->sendRequestToAll(nodeIds, [&]() { return RequestEncoder::info(latest, this->options_); },
+      [&](const NodeID& nodeId, const std::shared_ptr<const Message>& answer) {
+        try {
+          onAnswer(nodeId, AnswerDecoder::info(*answer));
+        } catch (std::exception &e) {
+          Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
+            "Request to " + nodeId.first.to_string() + ":" + std::to_string(nodeId.second) + " failed with error: " + e.what()
+          );
+        }
+      }, timeout
+    );
+  }
+
+  std::vector<BlockHeader> ManagerNormal::requestBlockHeaders(
+    const NodeID& nodeId, const uint64_t& startHeight, const uint64_t& count
+  ) {
+    auto request = std::make_shared<const Message>(RequestEncoder::requestBlockHeaders(startHeight, count));
+    auto requestPtr = sendRequestTo(nodeId, request);
+    if (requestPtr == nullptr) {
+      Logger::logToDebug(LogType::WARNING, Log::P2PParser, __func__,
+        "Request to " + nodeId.first.to_string() + ":" + std::to_string(nodeId.second) + " failed."
+      );
+      return {};
+    }
+    auto answer = requestPtr->answerFuture();
+    auto status = answer.wait_for(std::chrono::seconds(5)); // 5000ms timeout.
+    if (status == std::future_status::timeout) {
+      Logger::logToDebug(LogType::WARNING, Log::P2PParser, __func__,
+        "Request to " + nodeId.first.to_string() + ":" + std::to_string(nodeId.second) + " timed out."
+      );
+      return {};
+    }
+    std::shared_ptr<const Message> answerPtr;
+    try {
+      answerPtr = answer.get();
+    } catch (std::exception &e) {
+      Logger::logToDebug(LogType::WARNING, Log::P2PParser, __func__,
+        "Request to " + nodeId.first.to_string() + ":" + std::to_string(nodeId.second) + " failed with error: " + e.what()
+      );
+      return {};
+    }
+    // Malformed answers are not caught, so the caller can tell them apart from a missing answer.
+    return AnswerDecoder::requestBlockHeaders(*answerPtr);
+  }
+
+  std::vector<BlockBody> ManagerNormal::requestBlockBodies(
+    const NodeID& nodeId, const uint64_t& startHeight, const uint64_t& count
+  ) {
+    auto request = std::make_shared<const Message>(RequestEncoder::requestBlockBodies(startHeight, count));
+    auto requestPtr = sendRequestTo(nodeId, request);
+    if (requestPtr == nullptr) {
+      Logger::logToDebug(LogType::WARNING, Log::P2PParser, __func__,
+        "Request to " + nodeId.first.to_string() + ":" + std::to_string(nodeId.second) + " failed."
+      );
+      return {};
+    }
+    auto answer = requestPtr->answerFuture();
+    auto status = answer.wait_for(std::chrono::seconds(10)); // 10000ms timeout.
+    if (status == std::future_status::timeout) {
+      Logger::logToDebug(LogType::WARNING, Log::P2PParser, __func__,
+        "Request to " + nodeId.first.to_string() + ":" + std::to_string(nodeId.second) + " timed out."
+      );
+      return {};
+    }
+    std::shared_ptr<const Message> answerPtr;
+    try {
+      answerPtr = answer.get();
+    } catch (std::exception &e) {
+      Logger::logToDebug(LogType::WARNING, Log::P2PParser, __func__,
+        "Request to " + nodeId.first.to_string() + ":" + std::to_string(nodeId.second) + " failed with error: " + e.what()
+      );
+      return {};
+    }
+    // Malformed answers are not caught, so the caller can tell them apart from a missing answer.
+    return AnswerDecoder::requestBlockBodies(*answerPtr, this->options_->getChainID());
+  }
+
   void ManagerNormal::broadcastTxValidator(const TxValidator& tx) {
     auto broadcast = std::make_shared<const Message>(BroadcastEncoder::broadcastValidatorTx(tx));
     this->broadcastMessage(broadcast);
@@ -491,13 +978,13 @@ namespace P2P{
   }
 
   void ManagerNormal::broadcastTxBlock(const TxBlock &txBlock) {
-    auto broadcast = std::make_shared<const Message>(BroadcastEncoder::broadcastTx(txBlock));
-    this->broadcastMessage(broadcast);
-    return;
+    this->txGossip_.announce(txBlock.hash());
   }
 
   void ManagerNormal::broadcastBlock(const std::shared_ptr<const Block> block) {
-    auto broadcast = std::make_shared<const Message>(BroadcastEncoder::broadcastBlock(block));
+    TraceSpan span("P2P::broadcastBlock");
+    span.attr("height", block->getNHeight());
+    auto broadcast = std::make_shared<const Message>(BroadcastEncoder::broadcastCompactBlock(block));
     this->broadcastMessage(broadcast);
     return;
   }
@@ -8,7 +8,12 @@ See the LICENSE.txt file in the project root for more information.
 #ifndef P2P_MANAGER_NORMAL_H
 #define P2P_MANAGER_NORMAL_H
 
+#include <optional>
+#include <unordered_set>
+
 #include "managerbase.h"
+#include "broadcastfilter.h"
+#include "txgossip.h"
 
 // Forward declaration.
 class rdPoS;
@@ -40,6 +45,13 @@ namespace P2P {
        */
       void handleBroadcast(std::weak_ptr<Session> session, const std::shared_ptr<const Message>& message);
 
+      /**
+       * Handle a notification from a node.
+       * @param session The session that sent the notification.
+       * @param message The notification message to handle.
+       */
+      void handleNotification(std::weak_ptr<Session> session, const std::shared_ptr<const Message>& message);
+
     private:
       /// Pointer to the rdPoS object.
       const std::unique_ptr<rdPoS>& rdpos_;
@@ -51,17 +63,32 @@ namespace P2P {
       const std::unique_ptr<State>& state_;
 
       /**
-       * Map with broadcasted messages and a counter of how many times they were broadcast.
+       * Bounded filter with the IDs of already broadcasted messages.
        * Used to avoid broadcasting the same message multiple times.
        */
-      std::unordered_map <uint64_t, unsigned int, SafeHash> broadcastedMessages_;
-
-      /// Mutex for managing read/write access to broadcasted messages.
-      std::shared_mutex broadcastMutex_;
+      BroadcastFilter broadcastedMessages_;
 
       /// Mutex for managing read/write access to block broadcasts.
       std::mutex blockBroadcastMutex_;
 
+      /// Announce/request gossip for block transactions.
+      TxGossip txGossip_;
+
+      /// A compact block being rebuilt, parked while its missing transactions are requested.
+      struct PendingCompactBlock {
+        NodeID nodeId;                              ///< The node that sent the compact block (and is asked for the missing transactions).
+        CompactBlock compactBlock;                  ///< The compact block.
+        std::vector<std::unique_ptr<TxBlock>> txs;  ///< The block transactions in order, null while missing.
+        std::shared_ptr<const Message> message;     ///< The broadcast message, relayed once the block is processed.
+        bool parked = false;                        ///< Whether the block holds a slot in `pendingCompactBlocks_`.
+      };
+
+      /// Hashes of the compact blocks waiting for their missing transactions.
+      std::unordered_set<Hash, SafeHash> pendingCompactBlocks_;
+
+      /// Mutex for managing read/write access to `pendingCompactBlocks_`.
+      std::mutex pendingCompactBlocksMutex_;
+
       /**
        * Broadcast a message to all connected nodes.
        * @param message The message to broadcast.
@@ -96,6 +123,34 @@ namespace P2P {
        */
       void handleTxValidatorRequest(std::weak_ptr<Session> session, const std::shared_ptr<const Message>& message);
 
+      /**
+       * Handle a `RequestBlockTxs` request.
+       * @param session The session that sent the request.
+       * @param message The request message to handle.
+       */
+      void handleBlockTxsRequest(std::weak_ptr<Session> session, const std::shared_ptr<const Message>& message);
+
+      /**
+       * Handle a `RequestTxs` request.
+       * @param session The session that sent the request.
+       * @param message The request message to handle.
+       */
+      void handleTxsRequest(std::weak_ptr<Session> session, const std::shared_ptr<const Message>& message);
+
+      /**
+       * Handle a `RequestBlockHeaders` request.
+       * @param session The session that sent the request.
+       * @param message The request message to handle.
+       */
+      void handleBlockHeadersRequest(std::weak_ptr<Session> session, const std::shared_ptr<const Message>& message);
+
+      /**
+       * Handle a `RequestBlockBodies` request.
+       * @param session The session that sent the request.
+       * @param message The request message to handle.
+       */
+      void handleBlockBodiesRequest(std::weak_ptr<Session> session, const std::shared_ptr<const Message>& message);
+
       /**
        * Handle a `Ping` answer.
        * @param session The session that sent the answer.
@@ -124,6 +179,21 @@ namespace P2P {
        */
       void handleTxValidatorAnswer(std::weak_ptr<Session> session, const std::shared_ptr<const Message>& message);
 
+      /**
+       * Handle a `RequestBlockTxs` answer.
+       * @param session The session that sent the answer.
+       * @param message The answer message to handle.
+       */
+      void handleBlockTxsAnswer(std::weak_ptr<Session> session, const std::shared_ptr<const Message>& message);
+
+      /**
+       * Handle an answer that only needs to be delivered to its request
+       * (`RequestTxs`, `RequestBlockHeaders` and `RequestBlockBodies`).
+       * @param session The session that sent the answer.
+       * @param message The answer message to handle.
+       */
+      void handleGenericAnswer(std::weak_ptr<Session> session, const std::shared_ptr<const Message>& message);
+
       /**
        * Handle a Validator transaction broadcast message.
        * @param session The node that sent the broadcast.
@@ -145,7 +215,77 @@ namespace P2P {
        */
       void handleBlockBroadcast(std::weak_ptr<Session> session, const std::shared_ptr<const Message>& message);
 
+      /**
+       * Handle a compact block broadcast message.
+       * The block is rebuilt from the mempool, fetching only the missing transactions from the sender.
+       * @param session The node that sent the broadcast.
+       * @param message The message that was broadcast.
+       */
+      void handleCompactBlockBroadcast(std::weak_ptr<Session> session, const std::shared_ptr<const Message>& message);
+
+      /**
+       * Rebuild a full block from a compact block, then process and relay it.
+       * Transactions are taken from the mempool. If some are missing, the block is parked
+       * and they are requested from the given node without waiting: the block is finished
+       * by whichever thread delivers the answer, so no handler thread is held meanwhile.
+       * Blocks are dropped (and left to the sync) if `maxPendingCompactBlocks` are already
+       * parked or the same block is already waiting for another node.
+       * @param nodeId The ID of the node that sent the compact block.
+       * @param compactBlock The compact block to rebuild.
+       * @param message The broadcast message, relayed once the block is processed.
+       */
+      void rebuildCompactBlock(
+        const NodeID& nodeId, CompactBlock&& compactBlock, const std::shared_ptr<const Message>& message
+      );
+
+      /**
+       * Request transactions of a parked compact block and finish it when they arrive.
+       * The block is unparked if the request fails or times out.
+       * @param pending The parked block.
+       * @param indexes The indexes of the wanted transactions inside the block.
+       */
+      void fetchCompactBlockTxs(const std::shared_ptr<PendingCompactBlock>& pending, std::vector<uint32_t>&& indexes);
+
+      /**
+       * Build the block once all of its transactions are known, then process and relay it.
+       * If the block doesn't match its header (e.g. a short ID collision) and some
+       * transactions came from the mempool, all of them are requested from the node instead.
+       * @param pending The compact block, with all of its transactions.
+       * @param fetchedAll Whether all transactions came from the node that sent the block.
+       */
+      void finishCompactBlock(const std::shared_ptr<PendingCompactBlock>& pending, const bool& fetchedAll);
+
+      /**
+       * Take a slot in `pendingCompactBlocks_` for a compact block.
+       * @param pending The block to park.
+       * @return `true` if the block was parked, `false` if there are no slots left or it's already waiting.
+       */
+      bool parkCompactBlock(const std::shared_ptr<PendingCompactBlock>& pending);
+
+      /**
+       * Release the slot of a parked compact block, if it has one.
+       * @param pending The block to unpark.
+       */
+      void unparkCompactBlock(const std::shared_ptr<PendingCompactBlock>& pending);
+
+      /**
+       * Handle a notification announcing a batch of transactions.
+       * The transactions we don't have are requested from the node that announced them.
+       * @param session The node that sent the notification.
+       * @param message The notification message to handle.
+       */
+      void handleTxHashesNotification(std::weak_ptr<Session> session, const std::shared_ptr<const Message>& message);
+
     public:
+      /// Maximum number of headers sent in a single `RequestBlockHeaders` answer.
+      static constexpr uint64_t maxHeadersPerRequest = 2000;
+
+      /// Maximum number of bodies sent in a single `RequestBlockBodies` answer.
+      static constexpr uint64_t maxBodiesPerRequest = 256;
+
+      /// Maximum number of compact blocks waiting for their missing transactions at once.
+      static constexpr uint64_t maxPendingCompactBlocks = 16;
+
       /**
        * Constructor.
        * @param hostIp The manager's host IP/address.
@@ -159,12 +299,18 @@ namespace P2P {
         const std::unique_ptr<Options>& options, const std::unique_ptr<Storage>& storage,
         const std::unique_ptr<State>& state
       ) : ManagerBase(hostIp, NodeType::NORMAL_NODE, 50, options),
-      rdpos_(rdpos), storage_(storage), state_(state)
+      rdpos_(rdpos), storage_(storage), state_(state), txGossip_(*this)
       {};
 
       /// Destructor. Automatically stops the manager.
       ~ManagerNormal() { this->stop(); }
 
+      /// Start the manager and the transaction announcement thread.
+      void start() override;
+
+      /// Stop the transaction announcement thread and the manager.
+      void stop() override;
+
       /**
        * Handle a message from a session. Entry point for all the other handlers.
        * @param session The session that sent the message.
@@ -186,6 +332,52 @@ namespace P2P {
        */
       NodeInfo requestNodeInfo(const NodeID& nodeId);
 
+      /**
+       * Request a range of signed block headers from a given node.
+       * @param nodeId The ID of the node to request.
+       * @param startHeight The height of the first wanted header.
+       * @param count The number of wanted headers (capped at `maxHeadersPerRequest` by the node).
+       * @return The headers the node has, in height order, or an empty list if the request failed.
+       * @throw std::runtime_error if the node answered with malformed data.
+       */
+      std::vector<BlockHeader> requestBlockHeaders(const NodeID& nodeId, const uint64_t& startHeight, const uint64_t& count);
+
+      /**
+       * Request a range of block bodies from a given node.
+       * @param nodeId The ID of the node to request.
+       * @param startHeight The height of the first wanted body.
+       * @param count The number of wanted bodies (capped at `maxBodiesPerRequest` by the node).
+       * @return The bodies the node has, in height order, or an empty list if the request failed.
+       * @throw std::runtime_error if the node answered with malformed data (including invalid transactions).
+       */
+      std::vector<BlockBody> requestBlockBodies(const NodeID& nodeId, const uint64_t& startHeight, const uint64_t& count);
+
+      /**
+       * Request Validator transactions from several nodes concurrently.
+       * @param nodeIds The IDs of the nodes to request.
+       * @param onAnswer Callback called with each node's Validator transactions, as soon as they arrive.
+       * @param timeout Maximum time to wait for the answers.
+       * @return The number of nodes that answered in time.
+       */
+      size_t requestValidatorTxsFromAll(
+        const std::vector<NodeID>& nodeIds,
+        const std::function<void(const NodeID&, std::vector<TxValidator>&&)>& onAnswer,
+        const std::chrono::milliseconds& timeout = std::chrono::seconds(2)
+      );
+
+      /**
+       * Request info about several nodes concurrently.
+       * @param nodeIds The IDs of the nodes to request.
+       * @param onAnswer Callback called with each node's info, as soon as it arrives.
+       * @param timeout Maximum time to wait for the answers.
+       * @return The number of nodes that answered in time.
+       */
+      size_t requestNodeInfoFromAll(
+        const std::vector<NodeID>& nodeIds,
+        const std::function<void(const NodeID&, const NodeInfo&)>& onAnswer,
+        const std::chrono::milliseconds& timeout = std::chrono::seconds(2)
+      );
+
       /**
        * Broadcast a Validator transaction to all connected nodes.
        * @param tx The transaction to broadcast.
@@ -193,16 +385,26 @@ namespace P2P {
       void broadcastTxValidator(const TxValidator& tx);
 
       /**
-       * Broadcast a block transaction to all connected nodes.
-       * @param txBlock The transaction to broadcast.
+       * Announce a block transaction to all connected nodes.
+       * The hash is sent on the next announcement batch, and nodes that don't
+       * have the transaction fetch it from us, so it must already be in the mempool.
+       * @param txBlock The transaction to announce.
        */
       void broadcastTxBlock(const TxBlock& txBlock);
 
       /**
-       * Broadcast a block to all connected nodes.
+       * Broadcast a block to all connected nodes, in compact form.
        * @param block The block to broadcast.
        */
       void broadcastBlock(const std::shared_ptr<const Block> block);
+
+      /// Getter for `broadcastedMessages_`, for checking filter size and hit/miss counters.
+      const BroadcastFilter& getBroadcastFilter() const { return this->broadcastedMessages_; }
+
+      /// Getter for `txGossip_`.
+      TxGossip& getTxGossip() { return this->txGossip_; }
+
+      friend class TxGossip;
   };
 };
 
@@ -0,0 +1,99 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include "requesttable.h"
+
+namespace P2P {
+  void RequestTable::insert(const std::shared_ptr<Request>& request) {
+    {
+      Shard& shard = this->shardFor(request->id());
+      std::lock_guard lock(shard.mutex);
+      shard.requests[request->id()] = request;
+    }
+    std::lock_guard lock(this->wheelMutex_);
+    this->wheel_.schedule(request->id(), clock::now() + this->timeout_);
+  }
+
+  std::shared_ptr<Request> RequestTable::take(const RequestID& id) {
+    Shard& shard = this->shardFor(id);
+    std::lock_guard lock(shard.mutex);
+    auto it = shard.requests.find(id);
+    if (it == shard.requests.end()) return nullptr;
+    auto request = std::move(it->second);
+    shard.requests.erase(it);
+    return request;
+  }
+
+  bool RequestTable::contains(const RequestID& id) const {
+    Shard& shard = this->shardFor(id);
+    std::lock_guard lock(shard.mutex);
+    return shard.requests.contains(id);
+  }
+
+  size_t RequestTable::expire(const clock::time_point& now) {
+    std::vector<RequestID> expired;
+    {
+      std::lock_guard lock(this->wheelMutex_);
+      expired = this->wheel_.advance(now);
+    }
+    size_t count = 0;
+    for (const auto& id : expired) {
+      // Requests that were already answered are no longer in the table.
+      auto request = this->take(id);
+      if (request != nullptr && request->setTimeout()) count++;
+    }
+    return count;
+  }
+
+  size_t RequestTable::expireAll() {
+    size_t count = 0;
+    for (auto& shard : *this->shards_) {
+      std::unordered_map<RequestID, std::shared_ptr<Request>, SafeHash> requests;
+      {
+        std::lock_guard lock(shard.mutex);
+        requests.swap(shard.requests);
+      }
+      for (auto& [id, request] : requests) if (request->setTimeout()) count++;
+    }
+    return count;
+  }
+
+  size_t RequestTable::size() const {
+    size_t total = 0;
+    for (const auto& shard : *this->shards_) {
+      std::lock_guard lock(shard.mutex);
+      total += shard.requests.size();
+    }
+    return total;
+  }
+
+  bool RequestTable::expireLoop() {
+    while (!this->stopWorker_) {
+      std::this_thread::sleep_for(this->wheel_.tick());
+      size_t count = this->expire();
+      if (count > 0) LOGDEBUG(Log::P2PManager,
+        std::to_string(count) + " requests timed out."
+      );
+    }
+    return true;
+  }
+
+  void RequestTable::start() {
+    if (!this->workerFuture_.valid()) {
+      this->stopWorker_ = false;
+      this->workerFuture_ = std::async(std::launch::async, &RequestTable::expireLoop, this);
+    }
+  }
+
+  void RequestTable::stop() {
+    if (this->workerFuture_.valid()) {
+      this->stopWorker_ = true;
+      this->workerFuture_.get();
+    }
+    this->expireAll();
+  }
+};
@@ -0,0 +1,136 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#ifndef P2P_REQUEST_TABLE_H
+#define P2P_REQUEST_TABLE_H
+
+#include <mutex>
+
+#include "timerwheel.h"
+
+namespace P2P {
+  /**
+   * Table of outstanding requests sent to other nodes.
+   * Requests are spread across shards with their own mutex, so concurrent
+   * requests and answers don't serialize on a single lock.
+   * Every inserted request is scheduled on a TimerWheel, and a worker thread
+   * periodically expires the requests that were not answered in time,
+   * fulfilling their promises with a timeout error and removing them from the table.
+   * Answered requests are removed as soon as their answer arrives.
+   */
+  class RequestTable {
+    public:
+      using clock = TimerWheel::clock;  ///< Typedef for a less verbose clock.
+
+      /// Number of shards the requests are spread across.
+      static constexpr size_t shardCount = 16;
+
+    private:
+      /// A single shard of the table.
+      struct Shard {
+        /// Mutex for managing read/write access to the shard.
+        mutable std::mutex mutex;
+
+        /// List of outstanding requests in the shard.
+        std::unordered_map<RequestID, std::shared_ptr<Request>, SafeHash> requests;
+      };
+
+      /// Time after which an unanswered request expires.
+      const std::chrono::milliseconds timeout_;
+
+      /// List of shards.
+      const std::unique_ptr<std::array<Shard, shardCount>> shards_;
+
+      /// Timer wheel with the deadlines of the outstanding requests.
+      TimerWheel wheel_;
+
+      /// Mutex for managing read/write access to the timer wheel.
+      std::mutex wheelMutex_;
+
+      /// Flag for stopping the expiry thread.
+      std::atomic<bool> stopWorker_ = false;
+
+      /// Future object for the expiry thread.
+      std::future<bool> workerFuture_;
+
+      /**
+       * Get the shard responsible for a given request ID.
+       * @param id The request ID.
+       * @return A reference to the shard.
+       */
+      Shard& shardFor(const RequestID& id) const {
+        return (*this->shards_)[SafeHash::splitmix(id.toUint64()) % shardCount];
+      }
+
+      /**
+       * Entry function for the expiry thread.
+       * @return `true` when the thread is stopped.
+       */
+      bool expireLoop();
+
+    public:
+      /**
+       * Constructor.
+       * @param timeout Time after which an unanswered request expires.
+       * @param tick Resolution of the timer wheel.
+       */
+      explicit RequestTable(
+        const std::chrono::milliseconds& timeout = std::chrono::seconds(10),
+        const std::chrono::milliseconds& tick = std::chrono::milliseconds(100)
+      ) : timeout_(timeout), shards_(std::make_unique<std::array<Shard, shardCount>>()), wheel_(tick) {}
+
+      /// Destructor. Automatically stops the expiry thread.
+      ~RequestTable() { this->stop(); }
+
+      /**
+       * Insert a request into the table and schedule its expiration.
+       * @param request The request to insert.
+       */
+      void insert(const std::shared_ptr<Request>& request);
+
+      /**
+       * Remove a request from the table, usually because its answer arrived.
+       * @param id The ID of the request.
+       * @return A pointer to the request, or `nullptr` if not found.
+       */
+      std::shared_ptr<Request> take(const RequestID& id);
+
+      /**
+       * Check if a request is in the table.
+       * @param id The ID of the request.
+       * @return `true` if the request is outstanding, `false` otherwise.
+       */
+      bool contains(const RequestID& id) const;
+
+      /**
+       * Expire all requests whose deadline has passed.
+       * @param now The current time point.
+       * @return The number of requests that timed out.
+       */
+      size_t expire(const clock::time_point& now = clock::now());
+
+      /**
+       * Time out and remove every outstanding request.
+       * @return The number of requests that timed out.
+       */
+      size_t expireAll();
+
+      /// Get the number of outstanding requests.
+      size_t size() const;
+
+      /// Getter for `timeout_`.
+      const std::chrono::milliseconds& timeout() const { return this->timeout_; }
+
+      /// Start the expiry thread.
+      void start();
+
+      /// Stop the expiry thread and wait until it is finished.
+      void stop();
+  };
+};
+
+#endif // P2P_REQUEST_TABLE_H
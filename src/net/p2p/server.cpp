@@ -19,7 +19,7 @@ namespace P2P {
   }
 
   void ServerListener::on_accept(boost::system::error_code ec, net::ip::tcp::socket socket) {
-    Logger::logToDebug(LogType::INFO, Log::P2PServerListener, __func__, "New connection.");
+    LOGINFO(Log::P2PServerListener, "New connection.");
     if (ec) {
       Logger::logToDebug(LogType::ERROR, Log::P2PServerListener, __func__, "Error accepting connection: " + ec.message());
       /// TODO: Handle error
@@ -51,27 +51,27 @@ namespace P2P {
 
   bool Server::run() {
     try {
-      Logger::logToDebug(LogType::INFO,Log::P2PServer, __func__,
+      LOGINFO(Log::P2PServer,
                          "Starting server on " + this->localAddress_.to_string() + ":" + std::to_string(this->localPort_));
 
       // Restart is needed to .run() the ioc again, otherwise it returns instantly.
       io_context_.restart();
-      Logger::logToDebug(LogType::DEBUG, Log::P2PServer, __func__, "Starting listener.");
+      LOGDEBUG(Log::P2PServer, "Starting listener.");
       this->listener_ = std::make_shared<ServerListener>(
           io_context_, tcp::endpoint{this->localAddress_, this->localPort_}, this->manager_, this->threadPool_
       );
       this->listener_->run();
-      Logger::logToDebug(LogType::DEBUG, Log::P2PServer, __func__, "Listener started.");
+      LOGDEBUG(Log::P2PServer, "Listener started.");
 
       std::vector<std::thread> v;
       v.reserve(this->threadCount_ - 1);
 
-      Logger::logToDebug(LogType::DEBUG, Log::P2PServer, __func__, "Starting " + std::to_string(this->threadCount_) + " threads.");
+      LOGDEBUG(Log::P2PServer, "Starting " + std::to_string(this->threadCount_) + " threads.");
       for (auto i = this->threadCount_ - 1; i > 0; --i) { v.emplace_back([this] { this->io_context_.run(); }); }
       io_context_.run();
 
       for (auto &t: v) t.join(); // Wait for all threads to exit
-      Logger::logToDebug(LogType::DEBUG, Log::P2PServer, __func__, "All threads stopped.");
+      LOGDEBUG(Log::P2PServer, "All threads stopped.");
     } catch ( std::exception &e ) {
       Logger::logToDebug(LogType::ERROR, Log::P2PServer, __func__, "Exception: " + std::string(e.what()));
       return false;
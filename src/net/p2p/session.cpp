@@ -7,9 +7,58 @@ See the LICENSE.txt file in the project root for more information.
 
 #include "session.h"
 #include "managerbase.h"
+#include "../../utils/metrics.h"
 #include <functional>
 
 namespace P2P {
+  /// Names of the commands (as per CommandType), as exported in the metrics.
+  static const std::array<std::string, RequestBlockBodies + 1> commandNames = {
+    "Ping", "Info", "RequestNodes", "RequestValidatorTxs", "BroadcastValidatorTx", "BroadcastTx",
+    "BroadcastBlock", "BroadcastCompactBlock", "RequestBlockTxs", "NotifyTxHashes", "RequestTxs",
+    "RequestBlockHeaders", "RequestBlockBodies"
+  };
+
+  /// Message and byte counters of each command (plus one for unknown commands) in one direction.
+  struct TrafficCounters {
+    std::array<Counter*, RequestBlockBodies + 2> messages;  ///< Messages of each command.
+    std::array<Counter*, RequestBlockBodies + 2> bytes;     ///< Bytes of each command, including the size header.
+  };
+
+  /**
+   * Register the traffic counters of one direction.
+   * @param direction The direction ("in" or "out").
+   * @return The counters.
+   */
+  static TrafficCounters registerTrafficCounters(const std::string& direction) {
+    TrafficCounters counters;
+    for (uint64_t i = 0; i < counters.messages.size(); i++) {
+      Metrics::Labels labels = {{"direction", direction}, {"command", (i < commandNames.size()) ? commandNames[i] : "unknown"}};
+      counters.messages[i] = &Metrics::counter("orbitersdk_p2p_messages_total", "P2P messages sent or received", labels);
+      counters.bytes[i] = &Metrics::counter("orbitersdk_p2p_bytes_total", "P2P bytes sent or received", labels);
+    }
+    return counters;
+  }
+
+  static const TrafficCounters inboundTraffic = registerTrafficCounters("in");
+  static const TrafficCounters outboundTraffic = registerTrafficCounters("out");
+  static Gauge& writeQueueMessages = Metrics::gauge(
+    "orbitersdk_p2p_write_queue_messages", "P2P messages waiting to be written, across all sessions"
+  );
+
+  /**
+   * Count a message sent or received.
+   * The command is read straight from the raw bytes, as received messages aren't validated yet.
+   * @param counters The counters of the direction.
+   * @param raw The raw message.
+   */
+  static void countTraffic(const TrafficCounters& counters, const Bytes& raw) {
+    uint64_t command = commandNames.size();
+    if (raw.size() >= 11) command = std::min<uint64_t>(Utils::bytesToUint16(BytesArrView(raw).subspan(9, 2)), command);
+    counters.messages[command]->inc();
+    counters.bytes[command]->inc(raw.size() + 8);
+  }
+
+  Session::~Session() { writeQueueMessages.dec(this->outboundMessages_.size()); }
 
   bool Session::handle_error(const std::string& func, const boost::system::error_code& ec) {
     /// TODO: return true/false depending on err code is necessary?
@@ -106,6 +155,7 @@ namespace P2P {
 
   void Session::on_read_message(boost::system::error_code ec, std::size_t) {
     if (ec && this->handle_error(__func__, ec)) return;
+    countTraffic(inboundTraffic, this->inboundMessage_->rawMessage_);
     // Make it a unique_ptr<const Message> so that we can pass it to the thread pool.
     this->threadPool_->push_task(
       &ManagerBase::handleMessage, &this->manager_, shared_from_this(), this->inboundMessage_
@@ -140,22 +190,24 @@ namespace P2P {
 
   void Session::on_write_message(boost::system::error_code ec, std::size_t) {
     if (ec && this->handle_error(__func__, ec)) return;
+    countTraffic(outboundTraffic, this->outboundMessage_->rawMessage_);
     std::unique_lock lock(this->writeQueueMutex_);
     if (this->outboundMessages_.empty()) {
       this->outboundMessage_ = nullptr;
     } else {
       this->outboundMessage_ = this->outboundMessages_.front();
       this->outboundMessages_.pop_front();
+      writeQueueMessages.dec();
       this->do_write_header();
     }
   }
 
   void Session::run() {
     if (this->connectionType_ == ConnectionType::INBOUND) {
-      Logger::logToDebug(LogType::INFO, Log::P2PSession, __func__, "Starting new inbound session");
+      LOGINFO(Log::P2PSession, "Starting new inbound session");
       boost::asio::dispatch(this->socket_.get_executor(), std::bind(&Session::write_handshake, shared_from_this()));
     } else {
-      Logger::logToDebug(LogType::INFO, Log::P2PSession, __func__, "Starting new outbound session");
+      LOGINFO(Log::P2PSession, "Starting new outbound session");
       boost::asio::dispatch(this->socket_.get_executor(), std::bind(&Session::do_connect, shared_from_this()));
     }
   }
@@ -193,6 +245,7 @@ namespace P2P {
       net::post(this->writeStrand_, std::bind(&Session::do_write_header, shared_from_this()));
     } else {
       this->outboundMessages_.push_back(message);
+      writeQueueMessages.inc();
     }
   }
 }
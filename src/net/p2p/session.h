@@ -179,6 +179,9 @@ namespace P2P {
         }
       }
 
+      /// Destructor. Takes the messages still queued out of the write queue metric.
+      ~Session();
+
       /// Max message size
       const uint64_t maxMessageSize_ = 1024 * 1024 * 128; // (128 MB)
 
@@ -0,0 +1,58 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include "timerwheel.h"
+
+namespace P2P {
+  void TimerWheel::place(Entry&& entry) {
+    // Entries that are already due go into the current slot, which is about to be processed.
+    if (entry.expiry < this->currentTick_) entry.expiry = this->currentTick_;
+    uint64_t delta = entry.expiry - this->currentTick_;
+    if (delta > maxTicks) {
+      entry.expiry = this->currentTick_ + maxTicks;
+      delta = maxTicks;
+    }
+    uint64_t level = 0;
+    while (level + 1 < levelCount && delta >= (uint64_t(1) << (slotBits * (level + 1)))) level++;
+    uint64_t slot = (entry.expiry >> (slotBits * level)) & (slotCount - 1);
+    this->slots_[level][slot].push_back(std::move(entry));
+  }
+
+  void TimerWheel::cascade(const uint64_t& level) {
+    uint64_t slot = (this->currentTick_ >> (slotBits * level)) & (slotCount - 1);
+    std::vector<Entry> entries;
+    entries.swap(this->slots_[level][slot]);
+    for (auto& entry : entries) this->place(std::move(entry));
+  }
+
+  void TimerWheel::schedule(const RequestID& id, const clock::time_point& deadline) {
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - this->start_);
+    // Round up, a timer must never expire before its deadline.
+    uint64_t expiry = (elapsed.count() <= 0) ? 0 : (elapsed.count() + this->tick_.count() - 1) / this->tick_.count();
+    if (expiry <= this->currentTick_) expiry = this->currentTick_ + 1;
+    this->place({id, expiry});
+    this->size_++;
+  }
+
+  std::vector<RequestID> TimerWheel::advance(const clock::time_point& now) {
+    std::vector<RequestID> expired;
+    if (now < this->start_) return expired;
+    uint64_t target = std::chrono::duration_cast<std::chrono::milliseconds>(now - this->start_).count() / this->tick_.count();
+    while (this->currentTick_ < target) {
+      this->currentTick_++;
+      // Cascade from the highest level down, so entries can fall through more than one level.
+      for (uint64_t level = levelCount - 1; level > 0; level--) {
+        if ((this->currentTick_ & ((uint64_t(1) << (slotBits * level)) - 1)) == 0) this->cascade(level);
+      }
+      auto& slot = this->slots_[0][this->currentTick_ & (slotCount - 1)];
+      for (const auto& entry : slot) expired.push_back(entry.id);
+      this->size_ -= slot.size();
+      slot.clear();
+    }
+    return expired;
+  }
+};
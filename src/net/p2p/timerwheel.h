@@ -0,0 +1,110 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#ifndef P2P_TIMER_WHEEL_H
+#define P2P_TIMER_WHEEL_H
+
+#include <array>
+#include <chrono>
+#include <vector>
+
+#include "encoding.h"
+
+namespace P2P {
+  /**
+   * Hierarchical timer wheel for expiring requests.
+   * Time is divided in fixed ticks, and each level of the wheel has 64 slots,
+   * where every slot of level N spans 64^N ticks. Timers that are far away
+   * sit in the upper levels and are cascaded down as time advances, so both
+   * scheduling and expiring are O(1) per timer regardless of how many are pending.
+   * Timers are never cancelled: owners are expected to ignore expirations for
+   * IDs they no longer track.
+   * The wheel is NOT thread-safe, callers must synchronize access to it.
+   */
+  class TimerWheel {
+    public:
+      using clock = std::chrono::steady_clock;  ///< Typedef for a less verbose clock.
+
+      /// Number of bits used to index the slots of a level.
+      static constexpr uint64_t slotBits = 6;
+
+      /// Number of slots per level.
+      static constexpr uint64_t slotCount = 1 << slotBits;
+
+      /// Number of levels in the wheel.
+      static constexpr uint64_t levelCount = 3;
+
+      /// Maximum distance, in ticks, a timer can be scheduled to. Longer timers are clamped.
+      static constexpr uint64_t maxTicks = (uint64_t(1) << (slotBits * levelCount)) - 1;
+
+    private:
+      /// A scheduled timer.
+      struct Entry {
+        RequestID id;     ///< ID of the expiring request.
+        uint64_t expiry;  ///< Absolute tick at which the timer expires.
+      };
+
+      /// Duration of a single tick.
+      const std::chrono::milliseconds tick_;
+
+      /// Time point of tick zero.
+      const clock::time_point start_;
+
+      /// The last tick that was processed.
+      uint64_t currentTick_ = 0;
+
+      /// Number of pending timers.
+      size_t size_ = 0;
+
+      /// Slots for each level of the wheel.
+      std::array<std::array<std::vector<Entry>, slotCount>, levelCount> slots_;
+
+      /**
+       * Place an entry in the slot matching its distance from the current tick.
+       * @param entry The entry to place.
+       */
+      void place(Entry&& entry);
+
+      /**
+       * Move all entries of a given upper level slot down to the lower levels.
+       * @param level The level to cascade from.
+       */
+      void cascade(const uint64_t& level);
+
+    public:
+      /**
+       * Constructor.
+       * @param tick Duration of a single tick (the wheel's resolution).
+       * @param start Time point of tick zero.
+       */
+      explicit TimerWheel(
+        const std::chrono::milliseconds& tick, const clock::time_point& start = clock::now()
+      ) : tick_(tick), start_(start) {}
+
+      /**
+       * Schedule a timer.
+       * @param id The ID of the request to expire.
+       * @param deadline The time point at which the timer should expire.
+       */
+      void schedule(const RequestID& id, const clock::time_point& deadline);
+
+      /**
+       * Advance the wheel up to a given time point.
+       * @param now The current time point.
+       * @return The IDs of all timers that expired, in expiration order.
+       */
+      std::vector<RequestID> advance(const clock::time_point& now);
+
+      /// Get the number of pending timers.
+      size_t size() const { return this->size_; }
+
+      /// Getter for `tick_`.
+      const std::chrono::milliseconds& tick() const { return this->tick_; }
+  };
+};
+
+#endif // P2P_TIMER_WHEEL_H
@@ -0,0 +1,179 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include "txgossip.h"
+#include "managernormal.h"
+#include "../../core/state.h"
+
+namespace P2P {
+  BroadcastFilter& TxGossip::knownTxsOf(const NodeID& nodeId) {
+    auto it = this->knownTxs_.find(nodeId);
+    if (it == this->knownTxs_.end()) {
+      it = this->knownTxs_.emplace(nodeId, std::make_unique<BroadcastFilter>(this->knownTxsCapacity_)).first;
+    }
+    return *it->second;
+  }
+
+  void TxGossip::announce(const Hash& txHash) {
+    std::lock_guard lock(this->pendingMutex_);
+    this->pendingAnnouncements_.push_back(txHash);
+  }
+
+  void TxGossip::markKnown(const NodeID& nodeId, const std::vector<Hash>& txHashes) {
+    std::lock_guard lock(this->knownTxsMutex_);
+    BroadcastFilter& knownTxs = this->knownTxsOf(nodeId);
+    for (const auto& txHash : txHashes) knownTxs.insert(getShortTxId(txHash));
+  }
+
+  bool TxGossip::isKnown(const NodeID& nodeId, const Hash& txHash) {
+    std::lock_guard lock(this->knownTxsMutex_);
+    auto it = this->knownTxs_.find(nodeId);
+    return it != this->knownTxs_.end() && it->second->contains(getShortTxId(txHash));
+  }
+
+  size_t TxGossip::handleAnnouncement(const NodeID& nodeId, const std::vector<Hash>& txHashes) {
+    if (txHashes.size() > this->maxBatchSize_) throw std::runtime_error("Too many transactions announced.");
+    this->markKnown(nodeId, txHashes);
+    std::vector<Hash> wanted;
+    for (const auto& txHash : txHashes) {
+      if (this->manager_.state_->isTxInMempool(txHash)) continue;
+      std::lock_guard lock(this->inFlightMutex_);
+      auto it = this->inFlight_.find(txHash);
+      if (it == this->inFlight_.end()) {
+        this->inFlight_.emplace(txHash, std::deque<NodeID>());
+        wanted.push_back(txHash);
+      } else if (it->second.size() < maxFallbacks) {
+        it->second.push_back(nodeId);
+      }
+    }
+    size_t count = wanted.size();
+    if (count > 0) this->requestTxs(nodeId, std::move(wanted));
+    return count;
+  }
+
+  std::vector<TxBlock> TxGossip::handleRequest(const NodeID& nodeId, const std::vector<Hash>& txHashes) {
+    if (txHashes.size() > this->maxBatchSize_) throw std::runtime_error("Too many transactions requested.");
+    std::vector<TxBlock> txs;
+    for (const auto& txHash : txHashes) {
+      auto tx = this->manager_.state_->getTxFromMempool(txHash);
+      if (tx != nullptr) txs.push_back(std::move(*tx));
+    }
+    this->markKnown(nodeId, txHashes);
+    return txs;
+  }
+
+  void TxGossip::requestTxs(const NodeID& nodeId, std::vector<Hash>&& txHashes) {
+    auto requested = std::make_shared<const std::vector<Hash>>(std::move(txHashes));
+    auto request = this->manager_.sendRequestTo(nodeId,
+      std::make_shared<const Message>(RequestEncoder::requestTxs(*requested)),
+      [this, requested](const NodeID&, const std::shared_ptr<const Message>& answer) {
+        this->handleTxsAnswer(*requested, answer);
+      }
+    );
+    if (request == nullptr) this->release(*requested);
+  }
+
+  void TxGossip::handleTxsAnswer(const std::vector<Hash>& requested, const std::shared_ptr<const Message>& answer) {
+    if (answer != nullptr) {
+      try {
+        std::unordered_set<Hash, SafeHash> wanted(requested.begin(), requested.end());
+        for (auto& tx : AnswerDecoder::requestTxs(*answer, this->manager_.options_->getChainID())) {
+          Hash txHash = tx.hash();
+          // Ignore transactions we didn't ask for.
+          if (!wanted.contains(txHash)) continue;
+          if (this->manager_.state_->addTx(std::move(tx)) == TxInvalid::NotInvalid) this->announce(txHash);
+        }
+      } catch (std::exception &e) {
+        Logger::logToDebug(LogType::ERROR, Log::P2PParser, __func__,
+          std::string("Invalid RequestTxs answer, error: ") + e.what()
+        );
+      }
+    }
+    this->release(requested);
+  }
+
+  void TxGossip::release(const std::vector<Hash>& txHashes) {
+    std::unordered_map<NodeID, std::vector<Hash>, SafeHash> retries;
+    {
+      std::lock_guard lock(this->inFlightMutex_);
+      for (const auto& txHash : txHashes) {
+        auto it = this->inFlight_.find(txHash);
+        if (it == this->inFlight_.end()) continue;
+        if (it->second.empty() || this->manager_.state_->isTxInMempool(txHash)) {
+          this->inFlight_.erase(it);
+          continue;
+        }
+        retries[it->second.front()].push_back(txHash);
+        it->second.pop_front();
+      }
+    }
+    for (auto& [nodeId, hashes] : retries) this->requestTxs(nodeId, std::move(hashes));
+  }
+
+  size_t TxGossip::flush() {
+    std::vector<Hash> pending;
+    {
+      std::lock_guard lock(this->pendingMutex_);
+      pending.swap(this->pendingAnnouncements_);
+    }
+    if (pending.empty()) return 0;
+    size_t count = 0;
+    // TxGossip::flush doesn't change sessions_ map
+    std::shared_lock sessionsLock(this->manager_.sessionsMutex_);
+    std::lock_guard knownTxsLock(this->knownTxsMutex_);
+    // Forget the peers that disconnected.
+    std::erase_if(this->knownTxs_, [this](const auto& peer) {
+      return !this->manager_.sessions_.contains(peer.first);
+    });
+    for (const auto& [nodeId, session] : this->manager_.sessions_) {
+      if (session->hostType() != NodeType::NORMAL_NODE) continue;
+      BroadcastFilter& knownTxs = this->knownTxsOf(nodeId);
+      std::vector<Hash> batch;
+      for (const auto& txHash : pending) {
+        if (!knownTxs.insert(getShortTxId(txHash))) continue;
+        batch.push_back(txHash);
+        if (batch.size() == this->maxBatchSize_) {
+          session->write(std::make_shared<const Message>(NotificationEncoder::notifyTxHashes(batch)));
+          batch.clear();
+          count++;
+        }
+      }
+      if (!batch.empty()) {
+        session->write(std::make_shared<const Message>(NotificationEncoder::notifyTxHashes(batch)));
+        count++;
+      }
+    }
+    return count;
+  }
+
+  size_t TxGossip::inFlightCount() {
+    std::lock_guard lock(this->inFlightMutex_);
+    return this->inFlight_.size();
+  }
+
+  bool TxGossip::announceLoop() {
+    while (!this->stopWorker_) {
+      std::this_thread::sleep_for(this->interval_);
+      this->flush();
+    }
+    return true;
+  }
+
+  void TxGossip::start() {
+    if (!this->workerFuture_.valid()) {
+      this->stopWorker_ = false;
+      this->workerFuture_ = std::async(std::launch::async, &TxGossip::announceLoop, this);
+    }
+  }
+
+  void TxGossip::stop() {
+    if (this->workerFuture_.valid()) {
+      this->stopWorker_ = true;
+      this->workerFuture_.get();
+    }
+  }
+};
@@ -0,0 +1,186 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#ifndef P2P_TX_GOSSIP_H
+#define P2P_TX_GOSSIP_H
+
+#include <deque>
+
+#include "broadcastfilter.h"
+#include "encoding.h"
+
+namespace P2P {
+  // Forward declarations.
+  class ManagerNormal;
+
+  /**
+   * Announce/request gossip for block transactions.
+   * Instead of flooding every transaction in full, new transactions are queued
+   * and their hashes are announced in batches to every connected Normal node,
+   * once per interval. Nodes that receive an announcement request only the
+   * transactions they don't have yet, from the node that announced them.
+   * Every peer has a bounded filter of the transactions it is known to have
+   * (because it announced them, requested them or was already told about them),
+   * so a transaction is never announced nor sent twice to the same peer.
+   * While a transaction is being fetched, other nodes that announce it are kept
+   * as fallbacks, in case the first one doesn't deliver it.
+   */
+  class TxGossip {
+    private:
+      /// Reference to the parent connection manager.
+      ManagerNormal& manager_;
+
+      /// Interval between announcement batches.
+      const std::chrono::milliseconds interval_;
+
+      /// Maximum number of hashes in a single announcement or request.
+      const size_t maxBatchSize_;
+
+      /// Capacity of each peer's known transactions filter.
+      const size_t knownTxsCapacity_;
+
+      /// Known transactions filter for each peer (Node ID -> filter of short transaction IDs).
+      std::unordered_map<NodeID, std::unique_ptr<BroadcastFilter>, SafeHash> knownTxs_;
+
+      /// Mutex for managing read/write access to the known transactions filters.
+      std::mutex knownTxsMutex_;
+
+      /// Hashes of the transactions waiting to be announced.
+      std::vector<Hash> pendingAnnouncements_;
+
+      /// Mutex for managing read/write access to the pending announcements.
+      std::mutex pendingMutex_;
+
+      /// Transactions currently being fetched (hash -> other nodes that announced it, as fallbacks).
+      std::unordered_map<Hash, std::deque<NodeID>, SafeHash> inFlight_;
+
+      /// Mutex for managing read/write access to the transactions being fetched.
+      std::mutex inFlightMutex_;
+
+      /// Maximum number of fallback nodes kept for a transaction being fetched.
+      static constexpr size_t maxFallbacks = 4;
+
+      /// Flag for stopping the announcement thread.
+      std::atomic<bool> stopWorker_ = false;
+
+      /// Future object for the announcement thread.
+      std::future<bool> workerFuture_;
+
+      /**
+       * Get the known transactions filter of a given peer, creating it if needed.
+       * Caller must hold `knownTxsMutex_`.
+       * @param nodeId The ID of the peer.
+       * @return A reference to the peer's filter.
+       */
+      BroadcastFilter& knownTxsOf(const NodeID& nodeId);
+
+      /**
+       * Request a list of transactions from a given node.
+       * The transactions must already be registered as in flight.
+       * @param nodeId The ID of the node to request.
+       * @param txHashes The hashes of the wanted transactions.
+       */
+      void requestTxs(const NodeID& nodeId, std::vector<Hash>&& txHashes);
+
+      /**
+       * Handle the answer to a transactions request, adding the received
+       * transactions to the mempool and announcing the accepted ones.
+       * @param requested The hashes that were requested.
+       * @param answer The answer, or `nullptr` if the request timed out.
+       */
+      void handleTxsAnswer(const std::vector<Hash>& requested, const std::shared_ptr<const Message>& answer);
+
+      /**
+       * Stop tracking a list of fetched transactions. Transactions that are
+       * still missing from the mempool are requested again from their fallback nodes.
+       * @param txHashes The hashes of the transactions.
+       */
+      void release(const std::vector<Hash>& txHashes);
+
+      /**
+       * Entry function for the announcement thread.
+       * @return `true` when the thread is stopped.
+       */
+      bool announceLoop();
+
+    public:
+      /**
+       * Constructor.
+       * @param manager Reference to the parent connection manager.
+       * @param interval Interval between announcement batches.
+       * @param maxBatchSize Maximum number of hashes in a single announcement or request.
+       * @param knownTxsCapacity Capacity of each peer's known transactions filter.
+       */
+      explicit TxGossip(
+        ManagerNormal& manager,
+        const std::chrono::milliseconds& interval = std::chrono::milliseconds(10),
+        const size_t& maxBatchSize = 4096, const size_t& knownTxsCapacity = 1 << 14
+      ) : manager_(manager), interval_(interval),
+        maxBatchSize_(maxBatchSize), knownTxsCapacity_(knownTxsCapacity) {}
+
+      /// Destructor. Automatically stops the announcement thread.
+      ~TxGossip() { this->stop(); }
+
+      /**
+       * Queue a transaction to be announced on the next batch.
+       * @param txHash The hash of the transaction. The transaction must be in the mempool.
+       */
+      void announce(const Hash& txHash);
+
+      /**
+       * Mark a list of transactions as known by a given peer.
+       * @param nodeId The ID of the peer.
+       * @param txHashes The hashes of the transactions.
+       */
+      void markKnown(const NodeID& nodeId, const std::vector<Hash>& txHashes);
+
+      /**
+       * Check if a transaction is known by a given peer.
+       * @param nodeId The ID of the peer.
+       * @param txHash The hash of the transaction.
+       * @return `true` if the peer is known to have the transaction, `false` otherwise.
+       */
+      bool isKnown(const NodeID& nodeId, const Hash& txHash);
+
+      /**
+       * Handle a batch of transactions announced by a given node,
+       * requesting the ones that are neither in the mempool nor already being fetched.
+       * @param nodeId The ID of the node that announced the transactions.
+       * @param txHashes The hashes of the announced transactions.
+       * @return The number of transactions requested from the node.
+       * @throw std::runtime_error if the batch is too big.
+       */
+      size_t handleAnnouncement(const NodeID& nodeId, const std::vector<Hash>& txHashes);
+
+      /**
+       * Get the transactions requested by a given node from the mempool.
+       * @param nodeId The ID of the node that requested the transactions.
+       * @param txHashes The hashes of the requested transactions.
+       * @return The requested transactions that are in the mempool.
+       * @throw std::runtime_error if the request is too big.
+       */
+      std::vector<TxBlock> handleRequest(const NodeID& nodeId, const std::vector<Hash>& txHashes);
+
+      /**
+       * Send the pending announcements to every connected Normal node,
+       * skipping the transactions each node is known to have.
+       * @return The number of announcement messages sent.
+       */
+      size_t flush();
+
+      /// Get the number of transactions currently being fetched.
+      size_t inFlightCount();
+
+      /// Start the announcement thread.
+      void start();
+
+      /// Stop the announcement thread and wait until it is finished.
+      void stop();
+  };
+};
+
+#endif // P2P_TX_GOSSIP_H
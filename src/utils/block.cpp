@@ -7,8 +7,11 @@ See the LICENSE.txt file in the project root for more information.
 
 #include "block.h"
 #include "../core/rdpos.h"
+#include "tracer.h"
 
 Block::Block(const BytesArrView bytes, const uint64_t& requiredChainId) {
+  TraceSpan span("Block::parse");
+  span.attr("bytes", bytes.size());
   try {
     // Split the bytes string
     if (bytes.size() < 217) throw std::runtime_error("Invalid block size - too short");
@@ -110,28 +113,8 @@ Block::Block(const BytesArrView bytes, const uint64_t& requiredChainId) {
       }
       index += txSize;
     }
-    // Sanity check the Merkle roots, block randomness and signature
-    auto expectedTxMerkleRoot = Merkle(this->txs_).getRoot();
-    auto expectedValidatorMerkleRoot = Merkle(this->txValidators_).getRoot();
-    auto expectedRandomness = rdPoS::parseTxSeedList(this->txValidators_);
-    if (expectedTxMerkleRoot != this->txMerkleRoot_) {
-      throw std::runtime_error("Invalid tx merkle root");
-    }
-    if (expectedValidatorMerkleRoot != this->validatorMerkleRoot_) {
-      throw std::runtime_error("Invalid validator merkle root");
-    }
-    if (expectedRandomness != this->blockRandomness_) {
-      throw std::runtime_error("Invalid block randomness");
-    }
-    Hash msgHash = this->hash();
-    if (!Secp256k1::verifySig(
-      this->validatorSig_.r(), this->validatorSig_.s(), this->validatorSig_.v()
-    )) {
-      throw std::runtime_error("Invalid validator signature");
-    }
-    // Get the signature and finalize the block
-    this->validatorPubKey_ = Secp256k1::recover(this->validatorSig_, msgHash);
-    this->finalized_ = true;
+    this->size_ = index;
+    this->verifyParsedBlock();
   } catch (std::exception &e) {
     Logger::logToDebug(LogType::ERROR, Log::block, __func__,
       "Error when deserializing a block: " + std::string(e.what())
@@ -141,6 +124,56 @@ Block::Block(const BytesArrView bytes, const uint64_t& requiredChainId) {
   }
 }
 
+Block::Block(
+  const BytesArrView signedHeader, std::vector<TxBlock>&& txs, std::vector<TxValidator>&& txValidators
+) : txValidators_(std::move(txValidators)), txs_(std::move(txs)) {
+  try {
+    if (signedHeader.size() != 209) throw std::runtime_error("Invalid signed header size");
+    this->validatorSig_ = Signature(signedHeader.subspan(0, 65));
+    this->prevBlockHash_ = Hash(signedHeader.subspan(65, 32));
+    this->blockRandomness_= Hash(signedHeader.subspan(97, 32));
+    this->validatorMerkleRoot_ = Hash(signedHeader.subspan(129, 32));
+    this->txMerkleRoot_ = Hash(signedHeader.subspan(161, 32));
+    this->timestamp_ = Utils::bytesToUint64(signedHeader.subspan(193, 8));
+    this->nHeight_ = Utils::bytesToUint64(signedHeader.subspan(201, 8));
+    for (const auto& tx : this->txValidators_) {
+      if (tx.getNHeight() != this->nHeight_) throw std::runtime_error("Invalid validator tx height");
+    }
+    this->verifyParsedBlock();
+    this->size_ = this->serializeBlock().size();
+  } catch (std::exception &e) {
+    Logger::logToDebug(LogType::ERROR, Log::block, __func__,
+      "Error when rebuilding a block: " + std::string(e.what())
+    );
+    throw std::runtime_error(std::string(__func__) + ": " + e.what());
+  }
+}
+
+void Block::verifyParsedBlock() {
+  // Sanity check the Merkle roots, block randomness and signature
+  auto expectedTxMerkleRoot = Merkle(this->txs_).getRoot();
+  auto expectedValidatorMerkleRoot = Merkle(this->txValidators_).getRoot();
+  auto expectedRandomness = rdPoS::parseTxSeedList(this->txValidators_);
+  if (expectedTxMerkleRoot != this->txMerkleRoot_) {
+    throw std::runtime_error("Invalid tx merkle root");
+  }
+  if (expectedValidatorMerkleRoot != this->validatorMerkleRoot_) {
+    throw std::runtime_error("Invalid validator merkle root");
+  }
+  if (expectedRandomness != this->blockRandomness_) {
+    throw std::runtime_error("Invalid block randomness");
+  }
+  Hash msgHash = this->hash();
+  if (!Secp256k1::verifySig(
+    this->validatorSig_.r(), this->validatorSig_.s(), this->validatorSig_.v()
+  )) {
+    throw std::runtime_error("Invalid validator signature");
+  }
+  // Get the signature and finalize the block
+  this->validatorPubKey_ = Secp256k1::recover(this->validatorSig_, msgHash);
+  this->finalized_ = true;
+}
+
 const Bytes Block::serializeHeader() const {
   // Block header is 144 bytes, made of:
   // previous block hash + block randomness + validator merkle root
@@ -212,6 +245,7 @@ bool Block::appendTxValidator(const TxValidator &tx) {
 }
 
 bool Block::finalize(const PrivKey& validatorPrivKey, const uint64_t& newTimestamp) {
+  TraceSpan span("Block::finalize");
   if (this->finalized_) {
     Logger::logToDebug(LogType::ERROR, Log::block, __func__, "Block is already finalized");
     return false;
@@ -230,6 +264,7 @@ bool Block::finalize(const PrivKey& validatorPrivKey, const uint64_t& newTimesta
   this->blockRandomness_= rdPoS::parseTxSeedList(this->txValidators_);
   this->validatorSig_ = Secp256k1::sign(this->hash(), validatorPrivKey);
   this->validatorPubKey_ = Secp256k1::recover(this->validatorSig_, this->hash());
+  this->size_ = this->serializeBlock().size();
   this->finalized_ = true;
   return true;
 }
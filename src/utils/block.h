@@ -87,6 +87,16 @@ class Block {
     /// Indicates whether the block is finalized or not. See finalize().
     bool finalized_ = false;
 
+    /// Size of the serialized block in bytes, known once the block is parsed or finalized.
+    uint64_t size_ = 0;
+
+    /**
+     * Check the Merkle roots, randomness and signature of a parsed block,
+     * then recover the Validator public key and mark the block as finalized.
+     * @throw std::runtime_error if any of the checks fail.
+     */
+    void verifyParsedBlock();
+
   public:
     /**
      * Constructor from network/RPC.
@@ -96,6 +106,16 @@ class Block {
      */
     Block(const BytesArrView bytes, const uint64_t& requiredChainId);
 
+    /**
+     * Constructor from a signed header and already parsed transactions (e.g. a rebuilt compact block).
+     * Transactions are not parsed or verified again, only the Merkle roots, randomness and signature.
+     * @param signedHeader The Validator signature + block header (209 bytes).
+     * @param txs The block transactions, in block order.
+     * @param txValidators The Validator transactions, in block order.
+     * @throw std::runtime_error on any invalid block parameter (size, signature, etc.).
+     */
+    Block(const BytesArrView signedHeader, std::vector<TxBlock>&& txs, std::vector<TxValidator>&& txValidators);
+
     /**
      * Constructor from creation.
      * @param prevBlockHash_ The previous block hash.
@@ -117,7 +137,8 @@ class Block {
       txValidators_(block.txValidators_),
       txs_(block.txs_),
       validatorPubKey_(block.validatorPubKey_),
-      finalized_(block.finalized_)
+      finalized_(block.finalized_),
+      size_(block.size_)
     {}
 
     /// Move constructor.
@@ -132,7 +153,8 @@ class Block {
       txValidators_(std::move(block.txValidators_)),
       txs_(std::move(block.txs_)),
       validatorPubKey_(std::move(block.validatorPubKey_)),
-      finalized_(std::move(block.finalized_))
+      finalized_(std::move(block.finalized_)),
+      size_(std::move(block.size_))
     { block.finalized_ = false; return; } // Block moved -> invalid block, as members of block were moved
 
     /// Getter for `validatorSig_`.
@@ -168,6 +190,9 @@ class Block {
     /// Getter for `finalized_`.
     bool isFinalized() const { return this->finalized_; }
 
+    /// Getter for `size_`, so the block doesn't have to be serialized again just to know its size.
+    uint64_t getSize() const { return this->size_; }
+
     // ========================
     // Serialization Functions
     // ========================
@@ -234,6 +259,7 @@ class Block {
       this->txs_ = other.txs_;
       this->validatorPubKey_ = other.validatorPubKey_;
       this->finalized_ = other.finalized_;
+      this->size_ = other.size_;
       return *this;
     }
 
@@ -250,6 +276,7 @@ class Block {
       this->txs_ = std::move(other.txs_);
       this->validatorPubKey_ = std::move(other.validatorPubKey_);
       this->finalized_ = std::move(other.finalized_);
+      this->size_ = std::move(other.size_);
       return *this;
     }
 };
@@ -7,6 +7,13 @@ See the LICENSE.txt file in the project root for more information.
 
 #include "db.h"
 
+Histogram& DB::readLatency_ = Metrics::histogram("orbitersdk_db_operation_seconds",
+  "Time spent in database operations", Metrics::latencyBuckets, {{"op", "read"}}, 1e-6
+);
+Histogram& DB::writeLatency_ = Metrics::histogram("orbitersdk_db_operation_seconds",
+  "Time spent in database operations", Metrics::latencyBuckets, {{"op", "write"}}, 1e-6
+);
+
 DB::DB(const std::filesystem::path& path) {
   this->opts_.create_if_missing = true;
   if (!std::filesystem::exists(path)) { // Ensure the database path can actually be found
@@ -20,6 +27,9 @@ DB::DB(const std::filesystem::path& path) {
 }
 
 bool DB::putBatch(const DBBatch& batch) const {
+  HistogramTimer timer(DB::writeLatency_);
+  TraceSpan span("DB::putBatch");
+  span.attr("puts", batch.getPuts().size()).attr("dels", batch.getDels().size());
   std::lock_guard lock(this->batchLock_);
   rocksdb::WriteBatch wb;
   for (const rocksdb::Slice& dels : batch.getDelsSlices()) { wb.Delete(dels); }
@@ -31,6 +41,8 @@ bool DB::putBatch(const DBBatch& batch) const {
 std::vector<DBEntry> DB::getBatch(
   const Bytes& bytesPfx, const std::vector<Bytes>& keys
 ) const {
+  HistogramTimer timer(DB::readLatency_);
+  TraceSpan span("DB::getBatch");
   std::lock_guard lock(this->batchLock_);
   std::vector<DBEntry> ret;
   std::unique_ptr<rocksdb::Iterator> it(this->db_->NewIterator(rocksdb::ReadOptions()));
@@ -62,6 +74,8 @@ std::vector<DBEntry> DB::getBatch(
 }
 
 std::vector<Bytes> DB::getKeys(const Bytes& pfx, const Bytes& start, const Bytes& end) {
+  HistogramTimer timer(DB::readLatency_);
+  TraceSpan span("DB::getKeys");
   std::vector<Bytes> ret;
   std::unique_ptr<rocksdb::Iterator> it(this->db_->NewIterator(rocksdb::ReadOptions()));
   Bytes startBytes = pfx;
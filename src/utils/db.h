@@ -18,6 +18,8 @@ See the LICENSE.txt file in the project root for more information.
 #include <rocksdb/write_batch.h>
 
 #include "utils.h"
+#include "metrics.h"
+#include "tracer.h"
 
 /// Namespace for accessing database prefixes.
 namespace DBPrefix {
@@ -29,6 +31,7 @@ namespace DBPrefix {
   const Bytes contracts =       { 0x00, 0x06 }; ///< "contracts" = "0006"
   const Bytes contractManager = { 0x00, 0x07 }; ///< "contractManager" = "0007"
   const Bytes events =          { 0x00, 0x08 }; ///< "events" = "0008"
+  const Bytes feeStats =        { 0x00, 0x09 }; ///< "feeStats" = "0009"
 };
 
 /// Struct for a database connection/endpoint.
@@ -159,6 +162,8 @@ class DB {
     rocksdb::DB* db_;               ///< Pointer to the database object itself.
     rocksdb::Options opts_;         ///< Struct with options for managing the database.
     mutable std::mutex batchLock_;  ///< Mutex for managing read/write access to batch operations.
+    static Histogram& readLatency_;   ///< Latency of the read operations (has, get, getBatch, getKeys).
+    static Histogram& writeLatency_;  ///< Latency of the write operations (put, del, putBatch).
 
   public:
     /**
@@ -185,6 +190,7 @@ class DB {
      */
     template <typename BytesContainer>
     bool has(const BytesContainer& key, const Bytes& pfx = {}) {
+      HistogramTimer timer(DB::readLatency_);
       std::unique_ptr<rocksdb::Iterator> it(this->db_->NewIterator(rocksdb::ReadOptions()));
       Bytes keyTmp = pfx;
       keyTmp.reserve(pfx.size() + key.size());
@@ -205,6 +211,7 @@ class DB {
      */
     template <typename BytesContainer>
     Bytes get(const BytesContainer& key, const Bytes& pfx = {}) const {
+      HistogramTimer timer(DB::readLatency_);
       std::unique_ptr<rocksdb::Iterator> it(this->db_->NewIterator(rocksdb::ReadOptions()));
       Bytes keyTmp = pfx;
       keyTmp.reserve(pfx.size() + key.size());
@@ -231,6 +238,7 @@ class DB {
      */
     template <typename BytesContainerTypeOne, typename BytesContainerTypeSecond>
     bool put(const BytesContainerTypeOne& key, const BytesContainerTypeSecond& value, const Bytes& pfx = {}) const {
+      HistogramTimer timer(DB::writeLatency_);
       Bytes keyTmp = pfx;
       keyTmp.reserve(pfx.size() + key.size());
       keyTmp.insert(keyTmp.end(), key.begin(), key.end());
@@ -252,6 +260,7 @@ class DB {
      */
     template <typename BytesContainer>
     bool del(const BytesContainer& key, const Bytes& pfx = {}) const {
+      HistogramTimer timer(DB::writeLatency_);
       auto keyTmp = pfx;
       keyTmp.reserve(pfx.size() + key.size());
       keyTmp.insert(keyTmp.end(), key.begin(), key.end());
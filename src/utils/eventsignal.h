@@ -0,0 +1,70 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#ifndef EVENTSIGNAL_H
+#define EVENTSIGNAL_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+/**
+ * Signal for waking up threads that wait for an event, instead of sleep-polling.
+ * Every notification bumps a sequence number. Waiters take the current sequence,
+ * check their own condition (and stop flag), and then wait for the sequence to change,
+ * so an event that happens between the check and the wait is never lost:
+ *
+ * ```
+ * while (true) {
+ *   uint64_t seen = signal.sequence();
+ *   if (stop || condition()) break;
+ *   signal.wait(seen);
+ * }
+ * ```
+ *
+ * The condition is checked outside of the signal's mutex, so it is safe to
+ * notify while holding other locks.
+ */
+class EventSignal {
+  private:
+    std::mutex mutex_;            ///< Mutex for managing read/write access to the sequence.
+    std::condition_variable cv_;  ///< Condition variable for waking up the waiters.
+    uint64_t sequence_ = 0;       ///< Number of notifications so far.
+
+  public:
+    /// Get the current sequence number.
+    uint64_t sequence() { std::lock_guard lock(this->mutex_); return this->sequence_; }
+
+    /// Notify an event, waking up all waiters.
+    void notify() {
+      { std::lock_guard lock(this->mutex_); this->sequence_++; }
+      this->cv_.notify_all();
+    }
+
+    /**
+     * Wait until an event is notified after a given sequence number.
+     * @param seen The sequence number taken before checking the condition.
+     */
+    void wait(const uint64_t& seen) {
+      std::unique_lock lock(this->mutex_);
+      this->cv_.wait(lock, [&]{ return this->sequence_ != seen; });
+    }
+
+    /**
+     * Wait until an event is notified after a given sequence number, or a timeout.
+     * @param seen The sequence number taken before checking the condition.
+     * @param timeout Maximum time to wait.
+     * @return `true` if an event was notified, `false` on timeout.
+     */
+    bool waitFor(const uint64_t& seen, const std::chrono::milliseconds& timeout) {
+      std::unique_lock lock(this->mutex_);
+      return this->cv_.wait_for(lock, timeout, [&]{ return this->sequence_ != seen; });
+    }
+};
+
+#endif // EVENTSIGNAL_H
@@ -7,6 +7,226 @@ See the LICENSE.txt file in the project root for more information.
 
 #include "hex.h"
 
+#include <array>
+#include <cstring>
+
+// Hex conversion runs on every RPC request and response, so it is done in bulk:
+// with SIMD kernels on x86 (picked at runtime, see hexKernels()), and with lookup
+// tables elsewhere and for the bytes left over by the SIMD loops.
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define HEX_SIMD
+#include <immintrin.h>
+#endif
+
+/// Lookup table for encoding, with the two hex chars of every byte value.
+static constexpr std::array<std::array<char, 2>, 256> hexPairs = []() {
+  constexpr char digits[] = "0123456789abcdef";
+  std::array<std::array<char, 2>, 256> ret{};
+  for (int i = 0; i < 256; i++) ret[i] = {digits[i >> 4], digits[i & 0x0f]};
+  return ret;
+}();
+
+/// Lookup table for decoding, with the value of every hex char (-1 for any other char).
+static constexpr std::array<int8_t, 256> hexValues = []() {
+  std::array<int8_t, 256> ret{};
+  ret.fill(-1);
+  for (int i = 0; i < 10; i++) ret['0' + i] = int8_t(i);
+  for (int i = 0; i < 6; i++) ret['a' + i] = ret['A' + i] = int8_t(10 + i);
+  return ret;
+}();
+
+/**
+ * Encode bytes as lowercase hex chars.
+ * @param in The bytes.
+ * @param size The number of bytes.
+ * @param out Where to write the chars (`size * 2` of them).
+ */
+static void encodeScalar(const uint8_t* in, size_t size, char* out) {
+  for (size_t i = 0; i < size; i++) std::memcpy(out + i * 2, hexPairs[in[i]].data(), 2);
+}
+
+/**
+ * Decode pairs of hex chars into bytes.
+ * @param in The chars.
+ * @param size The number of bytes to decode (`size * 2` chars are read).
+ * @param out Where to write the bytes.
+ * @return `false` if a char isn't hex, `true` otherwise.
+ */
+static bool decodeScalar(const char* in, size_t size, uint8_t* out) {
+  for (size_t i = 0; i < size; i++) {
+    int8_t h = hexValues[uint8_t(in[i * 2])];
+    int8_t l = hexValues[uint8_t(in[i * 2 + 1])];
+    if ((h | l) < 0) return false;
+    out[i] = uint8_t((h << 4) | l);
+  }
+  return true;
+}
+
+/**
+ * Check if all chars are hex.
+ * @param in The chars.
+ * @param size The number of chars.
+ * @return `true` if all chars are hex, `false` otherwise.
+ */
+static bool validateScalar(const char* in, size_t size) {
+  for (size_t i = 0; i < size; i++) if (hexValues[uint8_t(in[i])] < 0) return false;
+  return true;
+}
+
+#ifdef HEX_SIMD
+// The SIMD kernels work like the scalar ones above, on 16 (SSSE3) or 32 (AVX2) bytes/chars
+// at a time, and leave the rest to them. Chars are classified with unsigned range checks:
+// `c - '0' <= 9` for digits, and `(c | 0x20) - 'a' <= 5` for letters of either case.
+
+__attribute__((target("ssse3"))) static void encodeSSSE3(const uint8_t* in, size_t size, char* out) {
+  const __m128i digits = _mm_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+  const __m128i mask = _mm_set1_epi8(0x0f);
+  size_t i = 0;
+  for (; i + 16 <= size; i += 16) {
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+    __m128i hi = _mm_and_si128(_mm_srli_epi16(bytes, 4), mask);
+    __m128i lo = _mm_and_si128(bytes, mask);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 2), _mm_shuffle_epi8(digits, _mm_unpacklo_epi8(hi, lo)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 2 + 16), _mm_shuffle_epi8(digits, _mm_unpackhi_epi8(hi, lo)));
+  }
+  encodeScalar(in + i, size - i, out + i * 2);
+}
+
+__attribute__((target("ssse3"))) static bool decodeSSSE3(const char* in, size_t size, uint8_t* out) {
+  const __m128i zero = _mm_set1_epi8('0'), a = _mm_set1_epi8('a'), lowerCase = _mm_set1_epi8(0x20);
+  const __m128i nine = _mm_set1_epi8(9), five = _mm_set1_epi8(5), ten = _mm_set1_epi8(10);
+  const __m128i weights = _mm_set1_epi16(0x0110); // 16 for the high nibble, 1 for the low one
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i * 2));
+    __m128i digits = _mm_sub_epi8(chars, zero);
+    __m128i letters = _mm_sub_epi8(_mm_or_si128(chars, lowerCase), a);
+    __m128i isDigit = _mm_cmpeq_epi8(_mm_min_epu8(digits, nine), digits);
+    __m128i isLetter = _mm_cmpeq_epi8(_mm_min_epu8(letters, five), letters);
+    if (_mm_movemask_epi8(_mm_or_si128(isDigit, isLetter)) != 0xffff) return false;
+    __m128i values = _mm_or_si128(_mm_and_si128(isDigit, digits), _mm_and_si128(isLetter, _mm_add_epi8(letters, ten)));
+    __m128i bytes = _mm_maddubs_epi16(values, weights);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(bytes, bytes));
+  }
+  return decodeScalar(in + i * 2, size - i, out + i);
+}
+
+__attribute__((target("ssse3"))) static bool validateSSSE3(const char* in, size_t size) {
+  const __m128i zero = _mm_set1_epi8('0'), a = _mm_set1_epi8('a'), lowerCase = _mm_set1_epi8(0x20);
+  const __m128i nine = _mm_set1_epi8(9), five = _mm_set1_epi8(5);
+  size_t i = 0;
+  for (; i + 16 <= size; i += 16) {
+    __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+    __m128i digits = _mm_sub_epi8(chars, zero);
+    __m128i letters = _mm_sub_epi8(_mm_or_si128(chars, lowerCase), a);
+    __m128i isDigit = _mm_cmpeq_epi8(_mm_min_epu8(digits, nine), digits);
+    __m128i isLetter = _mm_cmpeq_epi8(_mm_min_epu8(letters, five), letters);
+    if (_mm_movemask_epi8(_mm_or_si128(isDigit, isLetter)) != 0xffff) return false;
+  }
+  return validateScalar(in + i, size - i);
+}
+
+__attribute__((target("avx2"))) static void encodeAVX2(const uint8_t* in, size_t size, char* out) {
+  const __m256i digits = _mm256_setr_epi8(
+    '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f',
+    '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f'
+  );
+  const __m256i mask = _mm256_set1_epi8(0x0f);
+  size_t i = 0;
+  for (; i + 32 <= size; i += 32) {
+    __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+    __m256i hi = _mm256_and_si256(_mm256_srli_epi16(bytes, 4), mask);
+    __m256i lo = _mm256_and_si256(bytes, mask);
+    // Unpacking works within each 128-bit lane: `first` has bytes 0-7 and 16-23, `second` has 8-15 and 24-31
+    __m256i first = _mm256_shuffle_epi8(digits, _mm256_unpacklo_epi8(hi, lo));
+    __m256i second = _mm256_shuffle_epi8(digits, _mm256_unpackhi_epi8(hi, lo));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i * 2), _mm256_permute2x128_si256(first, second, 0x20));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i * 2 + 32), _mm256_permute2x128_si256(first, second, 0x31));
+  }
+  _mm256_zeroupper(); // The rest runs legacy SSE code, which stalls if the upper halves are dirty
+  encodeSSSE3(in + i, size - i, out + i * 2);
+}
+
+__attribute__((target("avx2"))) static bool decodeAVX2(const char* in, size_t size, uint8_t* out) {
+  const __m256i zero = _mm256_set1_epi8('0'), a = _mm256_set1_epi8('a'), lowerCase = _mm256_set1_epi8(0x20);
+  const __m256i nine = _mm256_set1_epi8(9), five = _mm256_set1_epi8(5), ten = _mm256_set1_epi8(10);
+  const __m256i weights = _mm256_set1_epi16(0x0110); // 16 for the high nibble, 1 for the low one
+  size_t i = 0;
+  for (; i + 16 <= size; i += 16) {
+    __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i * 2));
+    __m256i digits = _mm256_sub_epi8(chars, zero);
+    __m256i letters = _mm256_sub_epi8(_mm256_or_si256(chars, lowerCase), a);
+    __m256i isDigit = _mm256_cmpeq_epi8(_mm256_min_epu8(digits, nine), digits);
+    __m256i isLetter = _mm256_cmpeq_epi8(_mm256_min_epu8(letters, five), letters);
+    if (_mm256_movemask_epi8(_mm256_or_si256(isDigit, isLetter)) != -1) return false;
+    __m256i values = _mm256_blendv_epi8(_mm256_add_epi8(letters, ten), digits, isDigit);
+    __m256i bytes = _mm256_maddubs_epi16(values, weights);
+    // Packing works within each 128-bit lane too, so the low 8 bytes of each lane are joined
+    __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(bytes, bytes), 0b1000);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm256_castsi256_si128(packed));
+  }
+  _mm256_zeroupper();
+  return decodeSSSE3(in + i * 2, size - i, out + i);
+}
+
+__attribute__((target("avx2"))) static bool validateAVX2(const char* in, size_t size) {
+  const __m256i zero = _mm256_set1_epi8('0'), a = _mm256_set1_epi8('a'), lowerCase = _mm256_set1_epi8(0x20);
+  const __m256i nine = _mm256_set1_epi8(9), five = _mm256_set1_epi8(5);
+  size_t i = 0;
+  for (; i + 32 <= size; i += 32) {
+    __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+    __m256i digits = _mm256_sub_epi8(chars, zero);
+    __m256i letters = _mm256_sub_epi8(_mm256_or_si256(chars, lowerCase), a);
+    __m256i isDigit = _mm256_cmpeq_epi8(_mm256_min_epu8(digits, nine), digits);
+    __m256i isLetter = _mm256_cmpeq_epi8(_mm256_min_epu8(letters, five), letters);
+    if (_mm256_movemask_epi8(_mm256_or_si256(isDigit, isLetter)) != -1) return false;
+  }
+  _mm256_zeroupper();
+  return validateSSSE3(in + i, size - i);
+}
+#endif
+
+/// Hex kernels for the best instruction set supported by the CPU.
+struct HexKernels {
+  void (*encode)(const uint8_t*, size_t, char*);  ///< See encodeScalar().
+  bool (*decode)(const char*, size_t, uint8_t*);  ///< See decodeScalar().
+  bool (*validate)(const char*, size_t);          ///< See validateScalar().
+};
+
+/**
+ * Get the hex kernels for the running CPU, picked on first use.
+ * A function-local static, as Hex is already used by other static initializers.
+ */
+static const HexKernels& hexKernels() {
+  static const HexKernels kernels = []() -> HexKernels {
+#ifdef HEX_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return {encodeAVX2, decodeAVX2, validateAVX2};
+    if (__builtin_cpu_supports("ssse3")) return {encodeSSSE3, decodeSSSE3, validateSSSE3};
+#endif
+    return {encodeScalar, decodeScalar, validateScalar};
+  }();
+  return kernels;
+}
+
+/**
+ * Decode a hex string (without the "0x" prefix). An odd number of chars decodes
+ * the first one as a single nibble (`"123"` = `\x01\x23`).
+ * @param hex The hex string.
+ * @param ret Where to write the bytes (resized to fit them).
+ * @return `false` if the string has a char that isn't hex, `true` otherwise.
+ */
+static bool decodeHex(const std::string_view hex, Bytes& ret) {
+  const size_t odd = hex.size() % 2;
+  ret.resize(hex.size() / 2 + odd);
+  if (odd) {
+    int8_t h = hexValues[uint8_t(hex[0])];
+    if (h < 0) return false;
+    ret[0] = uint8_t(h);
+  }
+  return hexKernels().decode(hex.data() + odd, hex.size() / 2, ret.data() + odd);
+}
+
 Hex::Hex(const std::string_view value, bool strict) : strict_(strict) {
   std::string ret(value);
   if (strict) {
@@ -37,36 +257,20 @@ bool Hex::isValid(const std::string_view hex, bool strict) {
     if (!hex.starts_with("0x") && !hex.starts_with("0X")) return false;
     off = 2;
   }
-  const static std::string_view filter("0123456789abcdefABCDEF");
-  if (hex.find_first_not_of(filter, off) != std::string::npos) return false;
-  return true;
+  return hexKernels().validate(hex.data() + off, hex.size() - off);
 }
 
 Hex Hex::fromBytes(const std::span<const uint8_t> bytes, bool strict) {
-  auto beg = bytes.begin();
-  auto end = bytes.end();
-  static const char* digits = "0123456789abcdef";
-  size_t off = strict ? 2 : 0;
-  std::string hex(std::distance(beg, end) * 2 + off, '0');
-  hex.replace(0, 2, "0x");
-  for (; beg != end; beg++) {
-    hex[off] = digits[(*beg >> 4) & 0x0f];
-    off++;
-    hex[off] = digits[*beg & 0x0f];
-    off++;
-  }
-  return Hex(std::move(hex), strict);
+  // The chars are valid by construction, so the constructors' validation is skipped
+  Hex ret(strict);
+  const size_t off = ret.hex_.size();
+  ret.hex_.resize(off + bytes.size() * 2);
+  hexKernels().encode(bytes.data(), bytes.size(), ret.hex_.data() + off);
+  return ret;
 }
 
 Hex Hex::fromUTF8(std::string_view str, bool strict) {
-  std::stringstream ss;
-  if (strict) ss << "0x";
-  for (int i = 0; i < str.length(); i++) {
-    // We need two casts in order to properly cast char to uint
-    ss << std::hex << std::setfill('0') << std::setw(2)
-      << static_cast<uint>(static_cast<uint8_t>(str[i]));
-  }
-  return Hex(ss.str(), strict);
+  return Hex::fromBytes(BytesArrView(reinterpret_cast<const uint8_t*>(str.data()), str.size()), strict);
 }
 
 // TODO: This function is identical in CommonData.h, is for the better a re-write of commonly used functions at CommonData.h
@@ -89,40 +293,20 @@ std::string Hex::forRPC() const {
 
 Bytes Hex::toBytes(const std::string_view hex) {
   Bytes ret;
-  size_t i = (hex[0] == '0' && (hex[1] == 'x' || hex[1] == 'X')) ? 2 : 0;
-  const static std::string_view filter("0123456789abcdefABCDEF");
-  auto pos = hex.find_first_not_of(filter, i);
-  if (pos != std::string::npos) {
+  size_t i = (hex.size() >= 2 && hex[0] == '0' && (hex[1] == 'x' || hex[1] == 'X')) ? 2 : 0;
+  if (!decodeHex(hex.substr(i), ret)) {
+    // Validation is part of decoding, the position of the invalid char is only needed for the error
+    const static std::string_view filter("0123456789abcdefABCDEF");
+    auto pos = hex.find_first_not_of(filter, i);
     throw std::runtime_error(std::string(__func__) + ": Invalid hex string: "
       + std::string(hex) + " filter: " + std::string(filter) + " at pos: " + std::to_string(pos));
   }
-  if (hex.size() % 2) {
-    int h = Hex::toInt(hex[i]);
-    i++;
-    ret.emplace_back(uint8_t(h));
-  }
-  for (; i < hex.size(); i += 2) {
-    int h = Hex::toInt(hex[i]);
-    int l = Hex::toInt(hex[i + 1]);
-    ret.emplace_back(uint8_t(h * 16 + l));
-  }
   return ret;
 }
 
 Bytes Hex::bytes() const {
-  // Parse two by two chars until the end
   Bytes ret;
-  uint32_t i = (this->strict_) ? 2 : 0; // Strict offset ("0x")
-  if (this->hex_.size() % 2) {
-    int h = Hex::toInt(this->hex_[i]);
-    i++;
-    ret.emplace_back(uint8_t(h));
-  }
-  for (; i < this->hex_.size(); i += 2) {
-    int h = Hex::toInt(this->hex_[i]);
-    int l = Hex::toInt(this->hex_[i + 1]);
-    ret.emplace_back(uint8_t(h * 16 + l));
-  }
+  decodeHex(std::string_view(this->hex_).substr((this->strict_) ? 2 : 0), ret); // Strict offset ("0x")
   return ret;
 }
 
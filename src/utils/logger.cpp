@@ -0,0 +1,191 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include "logger.h"
+
+#include <ctime>
+
+RotatingFileSink::RotatingFileSink(
+  const std::filesystem::path& path, const uint64_t& maxBytes, const uint64_t& maxFiles
+) : path_(path), maxBytes_(maxBytes), maxFiles_(maxFiles) {
+  std::error_code ec;
+  auto size = std::filesystem::file_size(this->path_, ec);
+  if (!ec) this->size_ = size;
+  this->file_.open(this->path_, std::ios::out | std::ios::app | std::ios::binary);
+}
+
+void RotatingFileSink::rotate() {
+  this->file_.close();
+  std::error_code ec; // Rotation is best effort, a missing file is not an error
+  if (this->maxFiles_ == 0) {
+    std::filesystem::remove(this->path_, ec);
+  } else {
+    auto rotated = [this](const uint64_t& i) { return std::filesystem::path(this->path_.string() + "." + std::to_string(i)); };
+    std::filesystem::remove(rotated(this->maxFiles_), ec);
+    for (uint64_t i = this->maxFiles_ - 1; i > 0; i--) std::filesystem::rename(rotated(i), rotated(i + 1), ec);
+    std::filesystem::rename(this->path_, rotated(1), ec);
+  }
+  this->file_.open(this->path_, std::ios::out | std::ios::trunc | std::ios::binary);
+  this->size_ = 0;
+}
+
+void RotatingFileSink::write(std::string_view data) {
+  if (data.empty()) return;
+  if (this->maxBytes_ != 0 && this->size_ != 0 && this->size_ + data.size() > this->maxBytes_) this->rotate();
+  this->file_.write(data.data(), data.size());
+  this->size_ += data.size();
+}
+
+Logger::Logger() : sink_("debug.log", Logger::maxFileBytes, Logger::maxFiles), queue_(Logger::queueCapacity) {
+  this->logThreadFuture_ = std::async(std::launch::async, &Logger::logger, this);
+}
+
+Logger::~Logger() {
+  {
+    std::lock_guard lock(this->writerMutex_);
+    this->stopWorker_ = true;
+  }
+  this->cv_.notify_one();
+  this->logThreadFuture_.get();
+}
+
+void Logger::logger() {
+  std::string buffer;
+  buffer.reserve(Logger::writeBufferBytes * 2);
+  LogInfo info;
+  auto lastFlush = std::chrono::steady_clock::now();
+  while (true) {
+    bool stop;
+    uint64_t requested;
+    {
+      std::lock_guard lock(this->writerMutex_);
+      stop = this->stopWorker_;
+      requested = this->flushRequests_;
+    }
+    // Everything pushed before reading the flags above gets written in this round
+    while (this->queue_.pop(info)) {
+      this->formatLine(info, buffer);
+      if (buffer.size() >= Logger::writeBufferBytes) { this->sink_.write(buffer); buffer.clear(); }
+    }
+    if (uint64_t dropped = this->queue_.takeDropped(); dropped != 0) {
+      this->formatLine(LogInfo(LogType::WARNING, "Logger", "logger",
+        std::to_string(dropped) + " messages were dropped, the log buffer was full"
+      ), buffer);
+    }
+    auto now = std::chrono::steady_clock::now();
+    bool flush = stop || requested != this->flushed_ || now - lastFlush >= Logger::flushInterval;
+    if (flush) {
+      this->sink_.write(buffer);
+      buffer.clear();
+      this->sink_.flush();
+      lastFlush = now;
+    }
+    std::unique_lock lock(this->writerMutex_);
+    if (flush && requested != this->flushed_) {
+      this->flushed_ = requested;
+      this->flushedCv_.notify_all();
+    }
+    if (stop) return;
+    this->cv_.wait_for(lock, Logger::flushInterval, [&]() {
+      return this->stopWorker_ || this->flushRequests_ != requested || this->queue_.size() >= Logger::queueCapacity / 2;
+    });
+  }
+}
+
+void Logger::formatLine(const LogInfo& info, std::string& out) {
+  // The date and time only change once per second, so they're formatted once and reused
+  auto millisec = std::chrono::duration_cast<std::chrono::milliseconds>(info.getTime().time_since_epoch()).count();
+  int64_t second = millisec / 1000;
+  if (second != this->lastSecond_) {
+    std::time_t itt = second;
+    std::tm tm;
+    gmtime_r(&itt, &tm);
+    char buf[32];
+    std::strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &tm);
+    this->lastSecond_ = second;
+    this->lastSecondText_ = buf;
+  }
+  int ms = millisec % 1000;
+  const char msText[5] = { '.', char('0' + ms / 100), char('0' + ms / 10 % 10), char('0' + ms % 10), ' ' };
+  out += '[';
+  out += this->lastSecondText_;
+  out.append(msText, 5);
+  out += Logger::getLevelName(info.getType());
+  out += "] ";
+  out += info.getLogSrc();
+  out += "::";
+  out += info.getFunc();
+  out += " - ";
+  out += info.getMessage();
+  out += '\n';
+}
+
+void Logger::updateMinLevel() {
+  int minLevel = this->level_.load(std::memory_order_relaxed);
+  for (const auto& [logSrc, type] : this->componentLevels_) minLevel = std::min(minLevel, static_cast<int>(type));
+  this->minLevel_.store(minLevel, std::memory_order_relaxed);
+  this->hasComponentLevels_.store(!this->componentLevels_.empty(), std::memory_order_relaxed);
+}
+
+void Logger::setLogLevel(LogType type) {
+  Logger& logger = getInstance();
+  std::unique_lock lock(logger.levelsMutex_);
+  logger.level_.store(static_cast<int>(type), std::memory_order_relaxed);
+  logger.updateMinLevel();
+}
+
+void Logger::setLogLevel(const std::string& logSrc, LogType type) {
+  Logger& logger = getInstance();
+  std::unique_lock lock(logger.levelsMutex_);
+  logger.componentLevels_[logSrc] = type;
+  logger.updateMinLevel();
+}
+
+void Logger::clearComponentLevels() {
+  Logger& logger = getInstance();
+  std::unique_lock lock(logger.levelsMutex_);
+  logger.componentLevels_.clear();
+  logger.updateMinLevel();
+}
+
+std::string_view Logger::getLevelName(LogType type) {
+  switch (type) {
+    case LogType::TRACE: return "TRACE";
+    case LogType::DEBUG: return "DEBUG";
+    case LogType::INFO: return "INFO";
+    case LogType::WARNING: return "WARNING";
+    case LogType::ERROR: return "ERROR";
+  }
+  return "";
+}
+
+LogType Logger::getLevel(const std::string& name) {
+  for (LogType type : {LogType::TRACE, LogType::DEBUG, LogType::INFO, LogType::WARNING, LogType::ERROR}) {
+    if (name == Logger::getLevelName(type)) return type;
+  }
+  throw std::runtime_error("Invalid log level: " + name);
+}
+
+void Logger::flush() {
+  Logger& logger = getInstance();
+  std::unique_lock lock(logger.writerMutex_);
+  uint64_t ticket = ++logger.flushRequests_;
+  logger.cv_.notify_one();
+  logger.flushedCv_.wait(lock, [&]() { return logger.flushed_ >= ticket || logger.stopWorker_; });
+}
+
+std::string Logger::getCurrentTimestamp() {
+  auto now = std::chrono::system_clock::now();
+  std::time_t itt = std::chrono::system_clock::to_time_t(now);
+  std::tm tm;
+  gmtime_r(&itt, &tm);
+  char buf[32];
+  std::strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &tm);
+  auto millisec = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()) % 1000;
+  std::string ms = std::to_string(millisec.count());
+  return std::string(buf) + "." + std::string(3 - ms.size(), '0') + ms;
+}
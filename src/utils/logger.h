@@ -8,14 +8,55 @@ See the LICENSE.txt file in the project root for more information.
 #ifndef LOGGER_H
 #define LOGGER_H
 
-#include <string>
-#include <iostream>
-#include <queue>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <filesystem>
+#include <fstream>
 #include <future>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "ringbuffer.h"
+
+/**
+ * Lowest log level compiled in (as per LogType, from 0 = TRACE to 4 = ERROR),
+ * set by the LOG_LEVEL CMake option. The LOG* macros drop anything below it at compile time.
+ */
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL 0
+#endif
 
-/// Enum for the log message types.
-enum class LogType { DEBUG, INFO, WARNING, ERROR };
+/**
+ * Log a message if its level is enabled (see Logger::isEnabled()).
+ * Unlike calling Logger::logToDebug() directly, the message expression is only
+ * evaluated (and its string built) when the message will actually be logged.
+ * Prefer the LOGTRACE/LOGDEBUG/LOGINFO/LOGWARNING/LOGERROR shorthands.
+ * @param type The LogType of the message.
+ * @param logSrc The source of the log (one of the `Log::` strings).
+ * @param message An expression that builds the message string.
+ */
+#define LOGGER_LOG(type, logSrc, message) do { \
+  if constexpr (static_cast<int>(type) >= LOG_MIN_LEVEL) { \
+    if (Logger::isEnabled(type, logSrc)) Logger::logToDebug(type, logSrc, __func__, message); \
+  } \
+} while (0)
+
+#define LOGTRACE(logSrc, message) LOGGER_LOG(LogType::TRACE, logSrc, message)      ///< Log a TRACE message, see LOGGER_LOG.
+#define LOGDEBUG(logSrc, message) LOGGER_LOG(LogType::DEBUG, logSrc, message)      ///< Log a DEBUG message, see LOGGER_LOG.
+#define LOGINFO(logSrc, message) LOGGER_LOG(LogType::INFO, logSrc, message)        ///< Log an INFO message, see LOGGER_LOG.
+#define LOGWARNING(logSrc, message) LOGGER_LOG(LogType::WARNING, logSrc, message)  ///< Log a WARNING message, see LOGGER_LOG.
+#define LOGERROR(logSrc, message) LOGGER_LOG(LogType::ERROR, logSrc, message)      ///< Log an ERROR message, see LOGGER_LOG.
+
+/**
+ * Enum for the log message types, from the least to the most severe.
+ * TRACE is for per-transaction and per-message diagnostics, and is disabled unless
+ * explicitly enabled with Logger::setLogLevel().
+ */
+enum class LogType { TRACE, DEBUG, INFO, WARNING, ERROR };
 
 /// Namespace with string prefixes for each blockchain module, for printing log/debug messages.
 namespace Log {
@@ -29,6 +70,9 @@ namespace Log {
   const std::string grpcClient = "gRPCClient";                     ///< String for `gRPCClient`.
   const std::string utils = "Utils";                               ///< String for `Utils`.
   const std::string httpServer = "HTTPServer";                     ///< String for `HTTPServer`.
+  const std::string httpListener = "HTTPListener";                 ///< String for `HTTPListener`.
+  const std::string wsSession = "WSSession";                       ///< String for `WSSession`.
+  const std::string filterRegistry = "FilterRegistry";             ///< String for `FilterRegistry`.
   const std::string JsonRPCEncoding = "JsonRPC::Encoding";         ///< String for `JsonRPC::Encoding`.
   const std::string JsonRPCDecoding = "JsonRPC::Decoding";         ///< String for `JsonRPC::Decoding`.
   const std::string rdPoS = "rdPoS";                               ///< String for `rdPoS`.
@@ -46,39 +90,47 @@ namespace Log {
   const std::string P2PBroadcastEncoder = "P2P::BroadcastEncoder"; ///< String for `P2P::BroadcastEncoder`.
   const std::string P2PDiscoveryWorker = "P2P::DiscoveryWorker";   ///< String for `P2P::DiscoveryWorker`.
   const std::string contractManager = "ContractManager";           ///< String for `ContractManager`.
+  const std::string dynamicContract = "DynamicContract";           ///< String for `DynamicContract`.
+  const std::string dexV2Factory = "DEXV2Factory";                 ///< String for `DEXV2Factory`.
+  const std::string dexV2Router = "DEXV2Router02";                 ///< String for `DEXV2Router02`.
   const std::string syncer = "Syncer";                             ///< String for `Syncer`.
+  const std::string syncEngine = "SyncEngine";                     ///< String for `SyncEngine`.
   const std::string event = "Event";                               ///< String for `Event`.
 }
 
 /// Class for storing log information.
 class LogInfo {
   private:
-    LogType type_;        ///< Log type.
-    std::string logSrc_;  ///< Log source.
-    std::string func_;    ///< Function name.
-    std::string message_; ///< Message to log.
+    LogType type_;                                ///< Log type.
+    std::string logSrc_;                          ///< Log source.
+    std::string func_;                            ///< Function name.
+    std::string message_;                         ///< Message to log.
+    std::chrono::system_clock::time_point time_;  ///< When the message was logged.
 
   public:
     /// Default constructor.
-    LogInfo() : type_(LogType::DEBUG), func_(""), logSrc_(""), message_("") {};
+    LogInfo() : type_(LogType::DEBUG), logSrc_(""), func_(""), message_("") {};
 
-    /// Constructor.
+    /// Constructor. Timestamps the message.
     LogInfo(LogType type, const std::string& logSrc, std::string&& func, std::string&& message) :
-      type_(type), logSrc_(logSrc), func_(std::move(func)), message_(std::move(message)) {};
+      type_(type), logSrc_(logSrc), func_(std::move(func)), message_(std::move(message)),
+      time_(std::chrono::system_clock::now()) {};
 
     /// Default destructor.
     ~LogInfo() = default;
 
     /// Move constructor
     LogInfo(LogInfo&& other) noexcept :
-      type_(other.type_), func_(std::move(other.func_)), logSrc_(std::move(other.logSrc_)), message_(std::move(other.message_)) {};
+      type_(other.type_), logSrc_(std::move(other.logSrc_)), func_(std::move(other.func_)),
+      message_(std::move(other.message_)), time_(other.time_) {};
 
     /// Move assign operator
     LogInfo& operator=(LogInfo&& other) noexcept {
       this->type_ = other.type_;
-      this->func_ = std::move(other.func_);
       this->logSrc_ = std::move(other.logSrc_);
+      this->func_ = std::move(other.func_);
       this->message_ = std::move(other.message_);
+      this->time_ = other.time_;
       return *this;
     }
 
@@ -93,15 +145,62 @@ class LogInfo {
 
     /// Getter for `message_`.
     inline const std::string& getMessage() const noexcept { return message_; };
+
+    /// Getter for `time_`.
+    inline const std::chrono::system_clock::time_point& getTime() const noexcept { return time_; };
+};
+
+/**
+ * Append-only log file that keeps its handle open and rotates itself by size.
+ * Once a write would take the file past `maxBytes`, it's renamed to `<path>.1`
+ * (older files shift to `<path>.2` and so on, up to `<path>.<maxFiles>`) and a new one is started.
+ * Not thread-safe, callers must serialize writes.
+ */
+class RotatingFileSink {
+  private:
+    const std::filesystem::path path_;  ///< Path to the current file.
+    const uint64_t maxBytes_;           ///< Size that triggers a rotation (0 never rotates).
+    const uint64_t maxFiles_;           ///< Number of rotated files to keep (0 discards the old contents).
+    std::ofstream file_;                ///< The current file.
+    uint64_t size_ = 0;                 ///< Size of the current file.
+
+    /// Rotate the files and start a new one.
+    void rotate();
+
+  public:
+    /**
+     * Constructor. Opens (or creates) the file, appending to it.
+     * @param path Path to the file.
+     * @param maxBytes Size that triggers a rotation (0 never rotates).
+     * @param maxFiles Number of rotated files to keep.
+     */
+    RotatingFileSink(const std::filesystem::path& path, const uint64_t& maxBytes, const uint64_t& maxFiles);
+
+    /**
+     * Write data to the file (buffered), rotating it first if needed.
+     * @param data The data to write.
+     */
+    void write(std::string_view data);
+
+    /// Flush the buffered data to the file.
+    void flush() { this->file_.flush(); }
+
+    /// Getter for `size_`.
+    uint64_t size() const { return this->size_; }
 };
 
-/// Singleton class for logging.
+/**
+ * Singleton class for logging.
+ * Messages are filtered by level (globally, per `Log::` component, and at compile time
+ * through the LOG* macros), then pushed to a fixed-size ring buffer without locking.
+ * A writer thread formats them in batches into large writes to a rotating `debug.log`,
+ * flushing it periodically. If the writer falls behind and the buffer fills up,
+ * new messages are dropped and the number of dropped messages is logged.
+ */
 class Logger {
   private:
     /// Private constructor as it is a singleton.
-    Logger() : logFile_("debug.log", std::ios::out | std::ios::app) {
-      logThreadFuture_ = std::async(std::launch::async, &Logger::logger, this);
-    }
+    Logger();
     Logger(const Logger&) = delete;             ///< Make it non-copyable
     Logger& operator=(const Logger&) = delete;  ///< Make it non-assignable.
 
@@ -111,105 +210,139 @@ class Logger {
       return instance;
     };
 
-    std::ofstream logFile_;                 ///< The file stream.
-    std::mutex logQueueMutex_;              ///< Mutex for protecting access to the log queue.
-    std::condition_variable cv_;            ///< Conditional variable to wait for new tasks.
-    std::queue<LogInfo> logQueue_;          ///< Queue for the log tasks.
-    LogInfo curTask_;                       ///< Current task being executed.
-    std::atomic<bool> stopWorker_ = false;  ///< Flag for stopping the thread.
+    RotatingFileSink sink_;                 ///< The log file.
+    RingBuffer<LogInfo> queue_;             ///< Messages waiting to be written.
+
+    std::atomic<int> minLevel_ = static_cast<int>(LogType::DEBUG);  ///< Lowest level enabled for any component, checked before anything else.
+    std::atomic<int> level_ = static_cast<int>(LogType::DEBUG);     ///< Level of the components that don't have their own.
+    std::atomic<bool> hasComponentLevels_ = false;              ///< Whether any component has its own level.
+    std::unordered_map<std::string, LogType> componentLevels_;  ///< Levels of specific components (source -> level).
+    mutable std::shared_mutex levelsMutex_;                     ///< Mutex for managing read/write access to the component levels.
+
+    std::mutex writerMutex_;                ///< Mutex for the writer's wake up and flush state.
+    std::condition_variable cv_;            ///< Conditional variable to wake up the writer.
+    std::condition_variable flushedCv_;     ///< Conditional variable to signal finished flushes.
+    uint64_t flushRequests_ = 0;            ///< Number of flushes requested.
+    uint64_t flushed_ = 0;                  ///< Number of requested flushes that were done.
+    bool stopWorker_ = false;               ///< Flag for stopping the thread.
     std::future<void> logThreadFuture_;     ///< Future object used to wait for the log thread to finish.
 
-    /// Function for the future object.
-    void logger() {
-      while (true) {
-        std::unique_lock<std::mutex> lock(logQueueMutex_);
-        // Wait until there's a task in the queue or stopWorker_ is true.
-        cv_.wait(lock, [this] { return !logQueue_.empty() || stopWorker_; });
-        if (stopWorker_) return;  // If stopWorker_ is true, return.
-        curTask_ = std::move(logQueue_.front());
-        logQueue_.pop();
-        lock.unlock();
-        logFileInternal();
-      }
-    };
+    int64_t lastSecond_ = -1;               ///< Second of the last formatted timestamp (writer only).
+    std::string lastSecondText_;            ///< Formatted date and time of `lastSecond_` (writer only).
+
+    /// Function for the future object. Writes the queued messages until the logger is destroyed.
+    void logger();
 
     /**
-     * Log something to the debug file
-     * It doesnt consume a parameter as it will use the curTask_ variable
+     * Format a message as a log line.
+     * @param info The message.
+     * @param out The string to append the line to.
      */
-    void logFileInternal() {
-      std::string logType = "";
-      switch (curTask_.getType()) {
-        case LogType::DEBUG: logType = "DEBUG"; break;
-        case LogType::INFO: logType = "INFO"; break;
-        case LogType::WARNING: logType = "WARNING"; break;
-        case LogType::ERROR: logType = "ERROR"; break;
-      }
-      this->logFile_ << "[" << getCurrentTimestamp() << " " << logType << "] "
-        << curTask_.getLogSrc() << "::" << curTask_.getFunc()
-        << " - " << curTask_.getMessage() << std::endl;
-    };
+    void formatLine(const LogInfo& info, std::string& out);
 
     /// Post a task to the queue.
     void postLogTask(LogInfo&& infoToLog) noexcept {
-      {
-        std::unique_lock<std::mutex> lock(logQueueMutex_);
-        logQueue_.emplace(std::move(infoToLog));
-      }
-      cv_.notify_one();
+      if (!this->queue_.push(std::move(infoToLog))) return;
+      // The writer wakes up by itself periodically, only hurry it if the buffer is filling up
+      if (this->queue_.size() >= Logger::queueCapacity / 2) this->cv_.notify_one();
     };
 
+    /// Recalculate `minLevel_`. Must be called with `levelsMutex_` locked.
+    void updateMinLevel();
+
   public:
+    static constexpr uint64_t queueCapacity = 16384;          ///< Maximum number of messages waiting to be written.
+    static constexpr uint64_t writeBufferBytes = 64 * 1024;   ///< Size of the writer's batches.
+    static constexpr std::chrono::milliseconds flushInterval{100};  ///< Maximum time written lines wait to be flushed.
+    static constexpr uint64_t maxFileBytes = 64 * 1024 * 1024; ///< Size of `debug.log` that triggers a rotation.
+    static constexpr uint64_t maxFiles = 5;                   ///< Number of rotated `debug.log` files to keep.
+
+    /**
+     * Check if messages of a given level and source would be logged.
+     * Costs a single relaxed atomic load unless there are per-component levels
+     * at or below the given level.
+     * @param type The level of the message.
+     * @param logSrc The source of the message.
+     * @return `true` if the message would be logged, `false` otherwise.
+     */
+    static inline bool isEnabled(LogType type, const std::string& logSrc) {
+      Logger& logger = getInstance();
+      int level = static_cast<int>(type);
+      if (level < logger.minLevel_.load(std::memory_order_relaxed)) return false;
+      if (!logger.hasComponentLevels_.load(std::memory_order_relaxed)) return true;
+      std::shared_lock lock(logger.levelsMutex_);
+      auto it = logger.componentLevels_.find(logSrc);
+      if (it != logger.componentLevels_.end()) return level >= static_cast<int>(it->second);
+      return level >= logger.level_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Set the log level of the components that don't have their own.
+     * @param type The lowest level to log.
+     */
+    static void setLogLevel(LogType type);
+
+    /**
+     * Set the log level of a component, overriding the general one.
+     * @param logSrc The component (one of the `Log::` strings).
+     * @param type The lowest level to log for the component.
+     */
+    static void setLogLevel(const std::string& logSrc, LogType type);
+
+    /// Remove the levels of all components, so they all use the general one.
+    static void clearComponentLevels();
+
+    /**
+     * Get the name of a log level, as written in the log lines and in options.json.
+     * @param type The level.
+     * @return The level's name (e.g. "TRACE").
+     */
+    static std::string_view getLevelName(LogType type);
+
+    /**
+     * Get a log level by its name (see getLevelName()).
+     * @param name The level's name.
+     * @return The level.
+     * @throw std::runtime_error if the name isn't a level.
+     */
+    static LogType getLevel(const std::string& name);
+
     /**
      * Log debug data to the debug file.
      * @param infoToLog The data to log.
      */
     static inline void logToDebug(LogInfo&& infoToLog) noexcept {
+      if (!isEnabled(infoToLog.getType(), infoToLog.getLogSrc())) return;
       getInstance().postLogTask(std::move(infoToLog));
     }
 
     /**
      * Log debug data to the debug file.
+     * The message is always built by the caller, use the LOG* macros to avoid that when the level is disabled.
      * @param type The type of the log.
      * @param logSrc The source of the log.
      * @param func The function name.
      * @param message The message to log.
      */
     static inline void logToDebug(LogType type, const std::string& logSrc, std::string&& func, std::string&& message) noexcept {
-      auto log = LogInfo(type, logSrc, std::move(func), std::move(message));
-      getInstance().postLogTask(std::move(log));
+      if (!isEnabled(type, logSrc)) return;
+      getInstance().postLogTask(LogInfo(type, logSrc, std::move(func), std::move(message)));
     }
 
+    /// Block until everything logged so far is written and flushed to the file.
+    static void flush();
+
     /**
-     * Destructor.
+     * Destructor. Writes the remaining messages and stops the writer thread.
      */
-    ~Logger() {
-      stopWorker_ = true;
-      cv_.notify_one();
-      logThreadFuture_.get();
-      // Flush the remaining queue
-      while (!logQueue_.empty()) {
-        curTask_ = std::move(logQueue_.front());
-        logQueue_.pop();
-        logFileInternal();
-      }
-    }
+    ~Logger();
 
     /**
      * Get the current timestamp as string in the following format:
      * "%Y-%m-%d %H:%M:%S.ms"
-     * "%Y-%m-%d %H:%M:%S.ms"
      * @return The current timestamp as string.
      */
-    static inline std::string getCurrentTimestamp() {
-      auto now = std::chrono::system_clock::now();
-      auto itt = std::chrono::system_clock::to_time_t(now);
-      std::ostringstream ss;
-      ss << std::put_time(gmtime(&itt), "%Y-%m-%d %H:%M:%S");
-      auto millisec = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()) % 1000;
-      ss << '.' << std::setfill('0') << std::setw(3) << millisec.count();
-      return ss.str();
-    }
+    static std::string getCurrentTimestamp();
 };
 
 #endif // LOGGER_H
@@ -0,0 +1,132 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include "metrics.h"
+
+#include <charconv>
+#include <stdexcept>
+
+/**
+ * Format a number the shortest way it can be parsed back.
+ * @param value The number.
+ * @return The formatted number.
+ */
+static std::string formatNumber(const double& value) {
+  char buf[32];
+  auto [end, ec] = std::to_chars(buf, buf + sizeof(buf), value);
+  return std::string(buf, end);
+}
+
+Histogram::Histogram(std::span<const uint64_t> bounds) :
+  bounds_(bounds.begin(), bounds.end()), buckets_(new std::atomic<uint64_t>[bounds.size() + 1])
+{
+  for (uint64_t i = 0; i <= this->bounds_.size(); i++) this->buckets_[i].store(0, std::memory_order_relaxed);
+}
+
+uint64_t Histogram::getCount() const {
+  uint64_t count = 0;
+  for (uint64_t i = 0; i <= this->bounds_.size(); i++) count += this->getBucket(i);
+  return count;
+}
+
+Metrics& Metrics::instance() {
+  // Function-local, as metrics are registered by other static initializers
+  static Metrics metrics;
+  return metrics;
+}
+
+Metrics::Family& Metrics::family(const std::string& name, const std::string& type, const std::string& help) {
+  auto [it, inserted] = this->families_.try_emplace(name);
+  if (inserted) {
+    it->second.type = type;
+    it->second.help = help;
+  } else if (it->second.type != type) {
+    throw std::runtime_error("Metric " + name + " is already registered as a " + it->second.type);
+  }
+  return it->second;
+}
+
+std::string Metrics::formatLabels(const Labels& labels) {
+  std::string ret;
+  for (const auto& [name, value] : labels) {
+    if (!ret.empty()) ret += ',';
+    ret += name + "=\"";
+    for (const char& c : value) {
+      if (c == '\\') ret += "\\\\";
+      else if (c == '"') ret += "\\\"";
+      else if (c == '\n') ret += "\\n";
+      else ret += c;
+    }
+    ret += '"';
+  }
+  return ret;
+}
+
+Counter& Metrics::counter(const std::string& name, const std::string& help, const Labels& labels) {
+  Metrics& metrics = Metrics::instance();
+  std::lock_guard lock(metrics.mutex_);
+  auto& ptr = metrics.family(name, "counter", help).counters[Metrics::formatLabels(labels)];
+  if (ptr == nullptr) ptr = std::make_unique<Counter>();
+  return *ptr;
+}
+
+Gauge& Metrics::gauge(const std::string& name, const std::string& help, const Labels& labels) {
+  Metrics& metrics = Metrics::instance();
+  std::lock_guard lock(metrics.mutex_);
+  auto& ptr = metrics.family(name, "gauge", help).gauges[Metrics::formatLabels(labels)];
+  if (ptr == nullptr) ptr = std::make_unique<Gauge>();
+  return *ptr;
+}
+
+Histogram& Metrics::histogram(
+  const std::string& name, const std::string& help, std::span<const uint64_t> bounds,
+  const Labels& labels, const double& scale
+) {
+  Metrics& metrics = Metrics::instance();
+  std::lock_guard lock(metrics.mutex_);
+  Family& family = metrics.family(name, "histogram", help);
+  family.scale = scale;
+  auto& ptr = family.histograms[Metrics::formatLabels(labels)];
+  if (ptr == nullptr) ptr = std::make_unique<Histogram>(bounds);
+  return *ptr;
+}
+
+std::string Metrics::serialize() {
+  Metrics& metrics = Metrics::instance();
+  std::lock_guard lock(metrics.mutex_);
+  std::string ret;
+  // Labels are wrapped in braces, with an extra label (for histogram buckets) appended if needed
+  auto withLabels = [](const std::string& name, const std::string& labels, const std::string& extra = "") {
+    std::string all = labels + ((!labels.empty() && !extra.empty()) ? "," : "") + extra;
+    return all.empty() ? name : name + "{" + all + "}";
+  };
+  for (const auto& [name, family] : metrics.families_) {
+    ret += "# HELP " + name + " " + family.help + "\n";
+    ret += "# TYPE " + name + " " + family.type + "\n";
+    for (const auto& [labels, counter] : family.counters) {
+      ret += withLabels(name, labels) + " " + std::to_string(counter->get()) + "\n";
+    }
+    for (const auto& [labels, gauge] : family.gauges) {
+      ret += withLabels(name, labels) + " " + std::to_string(gauge->get()) + "\n";
+    }
+    for (const auto& [labels, histogram] : family.histograms) {
+      // Bucket counts are exported cumulatively, as Prometheus expects
+      uint64_t count = 0;
+      const auto& bounds = histogram->getBounds();
+      for (uint64_t i = 0; i < bounds.size(); i++) {
+        count += histogram->getBucket(i);
+        ret += withLabels(name + "_bucket", labels, "le=\"" + formatNumber(bounds[i] * family.scale) + "\"")
+          + " " + std::to_string(count) + "\n";
+      }
+      count += histogram->getBucket(bounds.size());
+      ret += withLabels(name + "_bucket", labels, "le=\"+Inf\"") + " " + std::to_string(count) + "\n";
+      ret += withLabels(name + "_sum", labels) + " " + formatNumber(histogram->getSum() * family.scale) + "\n";
+      ret += withLabels(name + "_count", labels) + " " + std::to_string(count) + "\n";
+    }
+  }
+  return ret;
+}
@@ -0,0 +1,238 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+/// Monotonically increasing counter.
+class Counter {
+  private:
+    std::atomic<uint64_t> value_ = 0; ///< Current value.
+
+  public:
+    /**
+     * Increment the counter.
+     * @param n (optional) The amount to increment. Defaults to 1.
+     */
+    void inc(const uint64_t& n = 1) { this->value_.fetch_add(n, std::memory_order_relaxed); }
+
+    /// Getter for `value_`.
+    uint64_t get() const { return this->value_.load(std::memory_order_relaxed); }
+};
+
+/// Value that can go up and down.
+class Gauge {
+  private:
+    std::atomic<int64_t> value_ = 0;  ///< Current value.
+
+  public:
+    /**
+     * Set the gauge.
+     * @param value The new value.
+     */
+    void set(const int64_t& value) { this->value_.store(value, std::memory_order_relaxed); }
+
+    /**
+     * Increment the gauge.
+     * @param n (optional) The amount to increment. Defaults to 1.
+     */
+    void inc(const int64_t& n = 1) { this->value_.fetch_add(n, std::memory_order_relaxed); }
+
+    /**
+     * Decrement the gauge.
+     * @param n (optional) The amount to decrement. Defaults to 1.
+     */
+    void dec(const int64_t& n = 1) { this->value_.fetch_sub(n, std::memory_order_relaxed); }
+
+    /// Getter for `value_`.
+    int64_t get() const { return this->value_.load(std::memory_order_relaxed); }
+};
+
+/**
+ * Distribution of observed values in fixed buckets.
+ * Values are integers (e.g. microseconds), scaled when exported (see Metrics::histogram()).
+ * An observation is two relaxed increments: one for its bucket and one for the sum.
+ */
+class Histogram {
+  private:
+    const std::vector<uint64_t> bounds_;                     ///< Inclusive upper bounds of the buckets, in ascending order.
+    const std::unique_ptr<std::atomic<uint64_t>[]> buckets_; ///< Observations of each bucket (not cumulative), plus one for the rest.
+    std::atomic<uint64_t> sum_ = 0;                          ///< Sum of all observed values.
+
+  public:
+    /**
+     * Constructor.
+     * @param bounds Inclusive upper bounds of the buckets, in ascending order.
+     */
+    explicit Histogram(std::span<const uint64_t> bounds);
+
+    /**
+     * Observe a value.
+     * @param value The value.
+     */
+    void observe(const uint64_t& value) {
+      auto bucket = std::lower_bound(this->bounds_.begin(), this->bounds_.end(), value) - this->bounds_.begin();
+      this->buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+      this->sum_.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    /**
+     * Observe the microseconds elapsed since a given time, and reset it to now.
+     * Meant for timing consecutive phases of an operation.
+     * @param start The start time, set to now.
+     */
+    void observeSince(std::chrono::steady_clock::time_point& start) {
+      auto now = std::chrono::steady_clock::now();
+      this->observe(std::chrono::duration_cast<std::chrono::microseconds>(now - start).count());
+      start = now;
+    }
+
+    /// Getter for `bounds_`.
+    const std::vector<uint64_t>& getBounds() const { return this->bounds_; }
+
+    /**
+     * Get the number of observations of a bucket.
+     * @param i Index of the bucket (`getBounds().size()` for the values above all bounds).
+     * @return The number of observations in the bucket (not cumulative).
+     */
+    uint64_t getBucket(const uint64_t& i) const { return this->buckets_[i].load(std::memory_order_relaxed); }
+
+    /// Get the total number of observations.
+    uint64_t getCount() const;
+
+    /// Getter for `sum_`.
+    uint64_t getSum() const { return this->sum_.load(std::memory_order_relaxed); }
+};
+
+/// Times the scope it lives in, observing the elapsed microseconds in a histogram when destroyed.
+class HistogramTimer {
+  private:
+    Histogram& histogram_;                              ///< The histogram to observe.
+    std::chrono::steady_clock::time_point start_;       ///< When the timer was created.
+
+  public:
+    /**
+     * Constructor. Starts the timer.
+     * @param histogram The histogram to observe.
+     */
+    explicit HistogramTimer(Histogram& histogram) : histogram_(histogram), start_(std::chrono::steady_clock::now()) {}
+
+    /// Destructor. Observes the elapsed time.
+    ~HistogramTimer() { this->histogram_.observeSince(this->start_); }
+
+    HistogramTimer(const HistogramTimer&) = delete; ///< Copy constructor (deleted).
+    HistogramTimer& operator=(const HistogramTimer&) = delete; ///< Copy assignment operator (deleted).
+};
+
+/**
+ * Process-wide registry of metrics, served in the Prometheus text format by the
+ * HTTP server (`GET /metrics`, see handle_request()).
+ * Metrics are registered once (usually as static references next to the code they
+ * measure) and live until the process ends, so updating them is just an atomic
+ * operation on the metric itself. The registry's lock is only taken to register
+ * metrics and to serialize them.
+ */
+class Metrics {
+  public:
+    /// Metric labels, as name/value pairs.
+    using Labels = std::vector<std::pair<std::string, std::string>>;
+
+    /// Bucket bounds for latencies, in microseconds (50us to 10s). Export them with `scale = 1e-6`.
+    static constexpr std::array<uint64_t, 18> latencyBuckets = {
+      50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000,
+      100000, 250000, 500000, 1000000, 2500000, 5000000, 10000000, 30000000
+    };
+
+  private:
+    /// All metrics of the same name (and type), with different labels.
+    struct Family {
+      std::string type;   ///< Metric type ("counter", "gauge" or "histogram").
+      std::string help;   ///< Description of the metric.
+      double scale = 1;   ///< Multiplier for the exported values of histograms.
+      std::map<std::string, std::unique_ptr<Counter>> counters;     ///< Counters (formatted labels -> counter).
+      std::map<std::string, std::unique_ptr<Gauge>> gauges;         ///< Gauges (formatted labels -> gauge).
+      std::map<std::string, std::unique_ptr<Histogram>> histograms; ///< Histograms (formatted labels -> histogram).
+    };
+
+    std::map<std::string, Family> families_;  ///< Registered metrics (name -> family).
+    mutable std::mutex mutex_;                ///< Mutex for managing read/write access to the families.
+
+    Metrics() = default; ///< Private constructor, see instance().
+
+    /// Get the registry instance.
+    static Metrics& instance();
+
+    /**
+     * Get a family, creating it if it doesn't exist.
+     * @param name The metric name.
+     * @param type The metric type.
+     * @param help The metric description.
+     * @return The family.
+     * @throw std::runtime_error if the metric exists with another type.
+     */
+    Family& family(const std::string& name, const std::string& type, const std::string& help);
+
+    /**
+     * Format labels as `name="value",...`, escaping the values.
+     * @param labels The labels.
+     * @return The formatted labels.
+     */
+    static std::string formatLabels(const Labels& labels);
+
+  public:
+    /**
+     * Get a counter, registering it if it doesn't exist.
+     * @param name The metric name.
+     * @param help The metric description.
+     * @param labels (optional) The metric labels.
+     * @return The counter.
+     */
+    static Counter& counter(const std::string& name, const std::string& help, const Labels& labels = {});
+
+    /**
+     * Get a gauge, registering it if it doesn't exist.
+     * @param name The metric name.
+     * @param help The metric description.
+     * @param labels (optional) The metric labels.
+     * @return The gauge.
+     */
+    static Gauge& gauge(const std::string& name, const std::string& help, const Labels& labels = {});
+
+    /**
+     * Get a histogram, registering it if it doesn't exist.
+     * @param name The metric name.
+     * @param help The metric description.
+     * @param bounds Inclusive upper bounds of the buckets, in ascending order.
+     * @param labels (optional) The metric labels.
+     * @param scale (optional) Multiplier for the exported bounds and sum (e.g. 1e-6 for microseconds to seconds).
+     * @return The histogram.
+     */
+    static Histogram& histogram(
+      const std::string& name, const std::string& help, std::span<const uint64_t> bounds,
+      const Labels& labels = {}, const double& scale = 1
+    );
+
+    /**
+     * Serialize all metrics in the Prometheus text format (version 0.0.4).
+     * @return The serialized metrics.
+     */
+    static std::string serialize();
+};
+
+#endif  // METRICS_H
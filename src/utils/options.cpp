@@ -15,49 +15,18 @@ Options::Options(
   const std::vector<std::pair<boost::asio::ip::address, uint64_t>>& discoveryNodes,
   const Block& genesisBlock, const uint64_t genesisTimestamp, const PrivKey& genesisSigner,
   const std::vector<std::pair<Address, uint256_t>>& genesisBalances,
-  const std::vector<Address>& genesisValidators
+  const std::vector<Address>& genesisValidators,
+  const BlockBuilderOptions& blockBuilderOptions,
+  const RPCOptions& rpcOptions,
+  const LogOptions& logOptions
 ) : rootPath_(rootPath), web3clientVersion_(web3clientVersion),
   version_(version), chainID_(chainID), chainOwner_(chainOwner), wsPort_(wsPort),
   httpPort_(httpPort), eventBlockCap_(eventBlockCap), eventLogCap_(eventLogCap),
   coinbase_(Address()), isValidator_(false), discoveryNodes_(discoveryNodes),
-  genesisBlock_(genesisBlock), genesisBalances_(genesisBalances), genesisValidators_(genesisValidators)
+  genesisBlock_(genesisBlock), genesisBalances_(genesisBalances), genesisValidators_(genesisValidators),
+  blockBuilderOptions_(blockBuilderOptions), rpcOptions_(rpcOptions), logOptions_(logOptions)
 {
-  json options;
-  if (std::filesystem::exists(rootPath + "/options.json")) return;
-  options["rootPath"] = rootPath;
-  options["web3clientVersion"] = web3clientVersion;
-  options["version"] = version;
-  options["chainID"] = chainID;
-  options["chainOwner"] = chainOwner.hex(true);
-  options["wsPort"] = wsPort;
-  options["httpPort"] = httpPort;
-  options["eventBlockCap"] = eventBlockCap;
-  options["eventLogCap"] = eventLogCap;
-  options["discoveryNodes"] = json::array();
-  for (const auto& [address, port] : discoveryNodes) {
-    options["discoveryNodes"].push_back(json::object({
-      {"address", address.to_string()},
-      {"port", port}
-    }));
-  }
-  options["genesis"] = json::object();
-  options["genesis"]["timestamp"] = genesisTimestamp;
-  options["genesis"]["signer"] = genesisSigner.hex(true);
-  options["genesis"]["balances"] = json::array();
-  for (const auto& [address, balance] : this->genesisBalances_) {
-    options["genesis"]["balances"].push_back(json::object({
-      {"address", address.hex(true)},
-      {"balance", balance.str()}
-    }));
-  }
-  options["genesis"]["validators"] = json::array();
-  for (const auto& validator : this->genesisValidators_) {
-    options["genesis"]["validators"].push_back(validator.hex(true));
-  }
-  std::filesystem::create_directories(rootPath);
-  std::ofstream o(rootPath + "/options.json");
-  o << options.dump(2) << std::endl;
-  o.close();
+  this->writeToFile(genesisTimestamp, genesisSigner, PrivKey());
 }
 
 Options::Options(
@@ -69,26 +38,73 @@ Options::Options(
   const Block& genesisBlock, const uint64_t genesisTimestamp, const PrivKey& genesisSigner,
   const std::vector<std::pair<Address, uint256_t>>& genesisBalances,
   const std::vector<Address>& genesisValidators,
-  const PrivKey& privKey
+  const PrivKey& privKey,
+  const BlockBuilderOptions& blockBuilderOptions,
+  const RPCOptions& rpcOptions,
+  const LogOptions& logOptions
 ) : rootPath_(rootPath), web3clientVersion_(web3clientVersion),
   version_(version), chainID_(chainID), chainOwner_(chainOwner), wsPort_(wsPort),
   httpPort_(httpPort), eventBlockCap_(eventBlockCap), eventLogCap_(eventLogCap),
   discoveryNodes_(discoveryNodes), coinbase_(Secp256k1::toAddress(Secp256k1::toUPub(privKey))),
-  isValidator_(true), genesisBlock_(genesisBlock), genesisBalances_(genesisBalances), genesisValidators_(genesisValidators)
+  isValidator_(true), genesisBlock_(genesisBlock), genesisBalances_(genesisBalances), genesisValidators_(genesisValidators),
+  blockBuilderOptions_(blockBuilderOptions), rpcOptions_(rpcOptions), logOptions_(logOptions)
 {
-  if (std::filesystem::exists(rootPath + "/options.json")) return;
+  this->writeToFile(genesisTimestamp, genesisSigner, privKey);
+}
+
+void Options::writeToFile(const uint64_t& genesisTimestamp, const PrivKey& genesisSigner, const PrivKey& privKey) const {
+  if (std::filesystem::exists(this->rootPath_ + "/options.json")) return;
   json options;
-  options["rootPath"] = rootPath;
-  options["web3clientVersion"] = web3clientVersion;
-  options["version"] = version;
-  options["chainID"] = chainID;
-  options["chainOwner"] = chainOwner.hex(true);
-  options["wsPort"] = wsPort;
-  options["httpPort"] = httpPort;
-  options["eventBlockCap"] = eventBlockCap;
-  options["eventLogCap"] = eventLogCap;
+  options["rootPath"] = this->rootPath_;
+  options["web3clientVersion"] = this->web3clientVersion_;
+  options["version"] = this->version_;
+  options["chainID"] = this->chainID_;
+  options["chainOwner"] = this->chainOwner_.hex(true);
+  options["wsPort"] = this->wsPort_;
+  options["httpPort"] = this->httpPort_;
+  options["eventBlockCap"] = this->eventBlockCap_;
+  options["eventLogCap"] = this->eventLogCap_;
+  options["blockBuilder"] = json::object({
+    {"maxBlockBytes", this->blockBuilderOptions_.maxBlockBytes},
+    {"maxBlockTxs", this->blockBuilderOptions_.maxBlockTxs},
+    {"maxBlockGas", this->blockBuilderOptions_.maxBlockGas},
+    {"minBlockInterval", this->blockBuilderOptions_.minBlockInterval.count()},
+    {"targetBlockInterval", this->blockBuilderOptions_.targetBlockInterval.count()},
+    {"maxBlockInterval", this->blockBuilderOptions_.maxBlockInterval.count()}
+  });
+  options["rpc"] = json::object({
+    {"maxBodyBytes", this->rpcOptions_.maxBodyBytes},
+    {"maxBatchSize", this->rpcOptions_.maxBatchSize},
+    {"maxPipelinedRequests", this->rpcOptions_.maxPipelinedRequests},
+    {"ioThreads", this->rpcOptions_.ioThreads},
+    {"workerThreads", this->rpcOptions_.workerThreads},
+    {"callThreads", this->rpcOptions_.callThreads},
+    {"logsThreads", this->rpcOptions_.logsThreads},
+    {"maxSubscriptions", this->rpcOptions_.maxSubscriptions},
+    {"maxQueuedMessages", this->rpcOptions_.maxQueuedMessages},
+    {"maxFilters", this->rpcOptions_.maxFilters},
+    {"filterTimeout", this->rpcOptions_.filterTimeout},
+    {"maxFilterChanges", this->rpcOptions_.maxFilterChanges},
+    {"cacheBytes", this->rpcOptions_.cacheBytes},
+    {"accessLogSampling", this->rpcOptions_.accessLogSampling},
+    {"rateLimit", this->rpcOptions_.rateLimit},
+    {"rateLimitBurst", this->rpcOptions_.rateLimitBurst},
+    {"rateLimitCosts", this->rpcOptions_.rateLimitCosts},
+    {"maxConnections", this->rpcOptions_.maxConnections},
+    {"maxConnectionsPerPeer", this->rpcOptions_.maxConnectionsPerPeer},
+    {"idleTimeout", this->rpcOptions_.idleTimeout},
+    {"wsIdleTimeout", this->rpcOptions_.wsIdleTimeout},
+    {"enableDumpTrace", this->rpcOptions_.enableDumpTrace},
+    {"traceFile", this->rpcOptions_.traceFile}
+  });
+  options["log"] = json::object();
+  options["log"]["logLevel"] = Logger::getLevelName(this->logOptions_.logLevel);
+  options["log"]["componentLevels"] = json::object();
+  for (const auto& [component, level] : this->logOptions_.componentLevels) {
+    options["log"]["componentLevels"][component] = Logger::getLevelName(level);
+  }
   options["discoveryNodes"] = json::array();
-  for (const auto& [address, port] : discoveryNodes) {
+  for (const auto& [address, port] : this->discoveryNodes_) {
     options["discoveryNodes"].push_back(json::object({
       {"address", address.to_string()},
       {"port", port}
@@ -108,9 +124,9 @@ Options::Options(
   for (const auto& validator : this->genesisValidators_) {
     options["genesis"]["validators"].push_back(validator.hex(true));
   }
-  options["privKey"] = privKey.hex();
-  std::filesystem::create_directories(rootPath);
-  std::ofstream o(rootPath + "/options.json");
+  if (privKey) options["privKey"] = privKey.hex();
+  std::filesystem::create_directories(this->rootPath_);
+  std::ofstream o(this->rootPath_ + "/options.json");
   o << options.dump(2) << std::endl;
   o.close();
 }
@@ -165,6 +181,56 @@ Options Options::fromFile(const std::string& rootPath) {
       ));
     }
 
+    BlockBuilderOptions blockBuilderOptions;
+    if (options.contains("blockBuilder")) {
+      const auto& blockBuilder = options["blockBuilder"];
+      blockBuilderOptions.maxBlockBytes = blockBuilder.value("maxBlockBytes", blockBuilderOptions.maxBlockBytes);
+      blockBuilderOptions.maxBlockTxs = blockBuilder.value("maxBlockTxs", blockBuilderOptions.maxBlockTxs);
+      blockBuilderOptions.maxBlockGas = blockBuilder.value("maxBlockGas", blockBuilderOptions.maxBlockGas);
+      blockBuilderOptions.minBlockInterval = std::chrono::milliseconds(blockBuilder.value("minBlockInterval", uint64_t(0)));
+      blockBuilderOptions.targetBlockInterval = std::chrono::milliseconds(blockBuilder.value("targetBlockInterval", uint64_t(0)));
+      blockBuilderOptions.maxBlockInterval = std::chrono::milliseconds(blockBuilder.value("maxBlockInterval", uint64_t(0)));
+    }
+
+    RPCOptions rpcOptions;
+    if (options.contains("rpc")) {
+      const auto& rpc = options["rpc"];
+      rpcOptions.maxBodyBytes = rpc.value("maxBodyBytes", rpcOptions.maxBodyBytes);
+      rpcOptions.maxBatchSize = rpc.value("maxBatchSize", rpcOptions.maxBatchSize);
+      rpcOptions.maxPipelinedRequests = rpc.value("maxPipelinedRequests", rpcOptions.maxPipelinedRequests);
+      rpcOptions.ioThreads = rpc.value("ioThreads", rpcOptions.ioThreads);
+      rpcOptions.workerThreads = rpc.value("workerThreads", rpcOptions.workerThreads);
+      rpcOptions.callThreads = rpc.value("callThreads", rpcOptions.callThreads);
+      rpcOptions.logsThreads = rpc.value("logsThreads", rpcOptions.logsThreads);
+      rpcOptions.maxSubscriptions = rpc.value("maxSubscriptions", rpcOptions.maxSubscriptions);
+      rpcOptions.maxQueuedMessages = rpc.value("maxQueuedMessages", rpcOptions.maxQueuedMessages);
+      rpcOptions.maxFilters = rpc.value("maxFilters", rpcOptions.maxFilters);
+      rpcOptions.filterTimeout = rpc.value("filterTimeout", rpcOptions.filterTimeout);
+      rpcOptions.maxFilterChanges = rpc.value("maxFilterChanges", rpcOptions.maxFilterChanges);
+      rpcOptions.cacheBytes = rpc.value("cacheBytes", rpcOptions.cacheBytes);
+      rpcOptions.accessLogSampling = rpc.value("accessLogSampling", rpcOptions.accessLogSampling);
+      rpcOptions.rateLimit = rpc.value("rateLimit", rpcOptions.rateLimit);
+      rpcOptions.rateLimitBurst = rpc.value("rateLimitBurst", rpcOptions.rateLimitBurst);
+      rpcOptions.rateLimitCosts = rpc.value("rateLimitCosts", rpcOptions.rateLimitCosts);
+      rpcOptions.maxConnections = rpc.value("maxConnections", rpcOptions.maxConnections);
+      rpcOptions.maxConnectionsPerPeer = rpc.value("maxConnectionsPerPeer", rpcOptions.maxConnectionsPerPeer);
+      rpcOptions.idleTimeout = rpc.value("idleTimeout", rpcOptions.idleTimeout);
+      rpcOptions.wsIdleTimeout = rpc.value("wsIdleTimeout", rpcOptions.wsIdleTimeout);
+      rpcOptions.enableDumpTrace = rpc.value("enableDumpTrace", rpcOptions.enableDumpTrace);
+      rpcOptions.traceFile = rpc.value("traceFile", rpcOptions.traceFile);
+    }
+
+    LogOptions logOptions;
+    if (options.contains("log")) {
+      const auto& log = options["log"];
+      if (log.contains("logLevel")) logOptions.logLevel = Logger::getLevel(log["logLevel"].get<std::string>());
+      if (log.contains("componentLevels")) {
+        for (const auto& [component, level] : log["componentLevels"].items()) {
+          logOptions.componentLevels[component] = Logger::getLevel(level.get<std::string>());
+        }
+      }
+    }
+
     if (options.contains("privKey")) {
       return Options(
         options["rootPath"].get<std::string>(),
@@ -182,7 +248,10 @@ Options Options::fromFile(const std::string& rootPath) {
         genesisSigner,
         genesisBalances,
         genesisValidators,
-        PrivKey(Hex::toBytes(options["privKey"].get<std::string>()))
+        PrivKey(Hex::toBytes(options["privKey"].get<std::string>())),
+        blockBuilderOptions,
+        rpcOptions,
+        logOptions
       );
     }
 
@@ -201,7 +270,10 @@ Options Options::fromFile(const std::string& rootPath) {
       options["genesis"]["timestamp"].get<uint64_t>(),
       genesisSigner,
       genesisBalances,
-      genesisValidators
+      genesisValidators,
+      blockBuilderOptions,
+      rpcOptions,
+      logOptions
     );
   } catch (std::exception &e) {
     throw std::runtime_error("Could not create blockchain directory: " + std::string(e.what()));
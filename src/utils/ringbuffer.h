@@ -0,0 +1,111 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#ifndef RINGBUFFER_H
+#define RINGBUFFER_H
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <memory>
+
+/**
+ * Fixed-capacity, lock-free queue for many producers and a single consumer.
+ * Each slot carries a sequence number telling whether it's free to be written
+ * or ready to be read, so producers only contend on the head index and never
+ * wait for each other or for the consumer. When the buffer is full, push()
+ * drops the value and counts it instead of blocking or allocating.
+ * @tparam T The type of the values. Must be default constructible and move assignable.
+ */
+template <typename T> class RingBuffer {
+  private:
+    /// A slot of the buffer.
+    struct Cell {
+      std::atomic<uint64_t> sequence;   ///< Position the slot is ready for: `pos` to be written, `pos + 1` to be read.
+      T value;                          ///< The stored value.
+    };
+
+    const uint64_t mask_;                           ///< Capacity minus one (capacity is a power of two).
+    const std::unique_ptr<Cell[]> cells_;           ///< The slots.
+    alignas(64) std::atomic<uint64_t> head_ = 0;    ///< Next position to be written (shared by the producers).
+    alignas(64) std::atomic<uint64_t> tail_ = 0;    ///< Next position to be read (only written by the consumer).
+    alignas(64) std::atomic<uint64_t> dropped_ = 0; ///< Values dropped because the buffer was full, not taken yet.
+
+  public:
+    /**
+     * Constructor.
+     * @param capacity Maximum number of values in the buffer, rounded up to a power of two.
+     */
+    explicit RingBuffer(const uint64_t& capacity) :
+      mask_(std::bit_ceil(std::max<uint64_t>(capacity, 2)) - 1), cells_(new Cell[mask_ + 1])
+    {
+      for (uint64_t i = 0; i <= this->mask_; i++) this->cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    RingBuffer(const RingBuffer&) = delete; ///< Copy constructor (deleted).
+    RingBuffer& operator=(const RingBuffer&) = delete; ///< Copy assignment operator (deleted).
+
+    /**
+     * Add a value to the buffer. Safe to call from any number of threads.
+     * @param value The value. Left untouched if the buffer is full.
+     * @return `true` if the value was added, `false` if it was dropped.
+     */
+    bool push(T&& value) {
+      uint64_t pos = this->head_.load(std::memory_order_relaxed);
+      while (true) {
+        Cell& cell = this->cells_[pos & this->mask_];
+        int64_t diff = int64_t(cell.sequence.load(std::memory_order_acquire) - pos);
+        if (diff == 0) {
+          // The slot is free, claim it (on failure pos is reloaded)
+          if (this->head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+            cell.value = std::move(value);
+            cell.sequence.store(pos + 1, std::memory_order_release);
+            return true;
+          }
+        } else if (diff < 0) {
+          // The slot still holds a value from the previous lap, the buffer is full
+          this->dropped_.fetch_add(1, std::memory_order_relaxed);
+          return false;
+        } else {
+          // Another producer claimed the slot first
+          pos = this->head_.load(std::memory_order_relaxed);
+        }
+      }
+    }
+
+    /**
+     * Take the oldest value from the buffer. Must only be called by one thread at a time.
+     * @param value Output for the value.
+     * @return `true` if a value was taken, `false` if the buffer is empty
+     *         (or its oldest value is still being written).
+     */
+    bool pop(T& value) {
+      uint64_t pos = this->tail_.load(std::memory_order_relaxed);
+      Cell& cell = this->cells_[pos & this->mask_];
+      if (cell.sequence.load(std::memory_order_acquire) != pos + 1) return false;
+      value = std::move(cell.value);
+      cell.sequence.store(pos + this->mask_ + 1, std::memory_order_release);
+      this->tail_.store(pos + 1, std::memory_order_relaxed);
+      return true;
+    }
+
+    /// Get the number of values dropped since the last call, resetting the count.
+    uint64_t takeDropped() { return this->dropped_.exchange(0, std::memory_order_relaxed); }
+
+    /// Get the approximate number of values in the buffer.
+    uint64_t size() const {
+      uint64_t head = this->head_.load(std::memory_order_relaxed);
+      uint64_t tail = this->tail_.load(std::memory_order_relaxed);
+      return (head > tail) ? head - tail : 0;
+    }
+
+    /// Get the capacity of the buffer.
+    uint64_t capacity() const { return this->mask_ + 1; }
+};
+
+#endif  // RINGBUFFER_H
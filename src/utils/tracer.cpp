@@ -0,0 +1,113 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include "tracer.h"
+
+#include <fstream>
+#include <stdexcept>
+#include <unistd.h>
+
+#include "../libs/json.hpp"
+
+Tracer& Tracer::instance() {
+  static Tracer tracer;
+  return tracer;
+}
+
+Tracer::ThreadBuffer& Tracer::threadBuffer() {
+  /// Holds the buffer of a thread, and hands it over to the tracer when the thread ends.
+  struct Owner {
+    std::shared_ptr<ThreadBuffer> buffer; ///< The buffer.
+    ~Owner() {
+      // The list keeps the buffer alive after the thread ends, so its spans still make it to the next dump
+      Tracer& tracer = Tracer::instance();
+      std::lock_guard lock(tracer.mutex_);
+      this->buffer->finished = true;
+      std::lock_guard bufferLock(this->buffer->mutex);
+      if (this->buffer->events.empty()) std::erase(tracer.buffers_, this->buffer);
+    }
+  };
+  thread_local Owner owner{[]() {
+    auto ret = std::make_shared<ThreadBuffer>();
+    ret->tid = ::gettid();
+    Tracer& tracer = Tracer::instance();
+    std::lock_guard lock(tracer.mutex_);
+    tracer.buffers_.push_back(ret);
+    return ret;
+  }()};
+  return *owner.buffer;
+}
+
+uint64_t Tracer::now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now() - Tracer::instance().epoch_
+  ).count();
+}
+
+void Tracer::record(TraceEvent&& event) {
+  ThreadBuffer& buffer = Tracer::threadBuffer();
+  std::lock_guard lock(buffer.mutex);
+  if (buffer.events.size() < Tracer::eventsPerThread) {
+    buffer.events.push_back(std::move(event));
+  } else {
+    buffer.events[buffer.recorded % Tracer::eventsPerThread] = std::move(event);
+  }
+  buffer.recorded++;
+}
+
+void Tracer::clear() {
+  Tracer& tracer = Tracer::instance();
+  std::lock_guard lock(tracer.mutex_);
+  for (const auto& buffer : tracer.buffers_) {
+    std::lock_guard bufferLock(buffer->mutex);
+    buffer->events.clear();
+    buffer->recorded = 0;
+  }
+  std::erase_if(tracer.buffers_, [](const auto& buffer) { return buffer->finished; });
+}
+
+uint64_t Tracer::getThreadCount() {
+  Tracer& tracer = Tracer::instance();
+  std::lock_guard lock(tracer.mutex_);
+  return tracer.buffers_.size();
+}
+
+uint64_t Tracer::dump(const std::string& path) {
+  std::vector<std::pair<uint64_t, std::vector<TraceEvent>>> threads;
+  {
+    // Copy the spans out so the threads aren't held while the file is written
+    Tracer& tracer = Tracer::instance();
+    std::lock_guard lock(tracer.mutex_);
+    for (const auto& buffer : tracer.buffers_) {
+      std::lock_guard bufferLock(buffer->mutex);
+      threads.emplace_back(buffer->tid, buffer->events);
+    }
+    std::erase_if(tracer.buffers_, [](const auto& buffer) { return buffer->finished; });
+  }
+  std::ofstream file(path, std::ios::out | std::ios::trunc);
+  if (!file.is_open()) throw std::runtime_error("Could not open trace file: " + path);
+  uint64_t count = 0;
+  file << R"({"displayTimeUnit":"ms","traceEvents":[)";
+  for (const auto& [tid, events] : threads) {
+    for (const TraceEvent& event : events) {
+      nlohmann::ordered_json json = {
+        {"name", event.name},
+        {"ph", "X"},
+        {"ts", double(event.start) / 1000},
+        {"dur", double(event.duration) / 1000},
+        {"pid", ::getpid()},
+        {"tid", tid}
+      };
+      for (const auto& [key, value] : event.args) if (key != nullptr) json["args"][key] = value;
+      file << (count++ == 0 ? "\n" : ",\n") << json.dump();
+    }
+  }
+  file << "\n]}\n";
+  file.close();
+  if (file.fail()) throw std::runtime_error("Could not write trace file: " + path);
+  return count;
+}
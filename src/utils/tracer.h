@@ -0,0 +1,163 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+/// A finished span, as stored in the trace buffers.
+struct TraceEvent {
+  const char* name = nullptr; ///< Span name (a string literal).
+  uint64_t start = 0;         ///< When the span started, in nanoseconds since the tracer started.
+  uint64_t duration = 0;      ///< Duration of the span, in nanoseconds.
+  std::array<std::pair<const char*, std::string>, 4> args;  ///< Attributes (name/value), unused ones have a null name.
+};
+
+/**
+ * Process-wide span tracer, exported in the Chrome trace event format (open the file
+ * in chrome://tracing or https://ui.perfetto.dev).
+ * Each thread records its finished spans into its own fixed-size buffer, overwriting
+ * the oldest ones, so the trace always holds the latest activity of every thread.
+ * Nesting is given by the spans' times within each thread. Tracing is off by default
+ * (see RPCOptions::enableDumpTrace), and spans cost a single relaxed atomic load while it is.
+ * Buffers of finished threads are kept until their spans are dumped or cleared, so
+ * short-lived threads don't pile up.
+ */
+class Tracer {
+  private:
+    /// Spans recorded by one thread.
+    struct ThreadBuffer {
+      uint64_t tid = 0;                 ///< ID of the thread.
+      std::vector<TraceEvent> events;   ///< Recorded spans, used as a ring once full.
+      uint64_t recorded = 0;            ///< Number of spans ever recorded (the next position is `recorded % size`).
+      std::mutex mutex;                 ///< Mutex for managing read/write access to the buffer (only contended by dumps).
+      bool finished = false;            ///< Whether the thread ended (guarded by the tracer's mutex).
+    };
+
+    static inline std::atomic<bool> enabled_ = false; ///< Whether spans are being recorded.
+
+    const std::chrono::steady_clock::time_point epoch_ = std::chrono::steady_clock::now(); ///< When the tracer started.
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers_;  ///< Buffers of the running threads that recorded spans, and of finished ones with spans left.
+    std::mutex mutex_;                                    ///< Mutex for managing read/write access to the buffer list.
+
+    Tracer() = default; ///< Private constructor, see instance().
+
+    /// Get the tracer instance.
+    static Tracer& instance();
+
+    /// Get the buffer of the calling thread, registering it on first use.
+    static ThreadBuffer& threadBuffer();
+
+  public:
+    /// Maximum number of spans kept per thread.
+    static constexpr uint64_t eventsPerThread = 8192;
+
+    /// Check if spans are being recorded.
+    static bool isEnabled() { return enabled_.load(std::memory_order_relaxed); }
+
+    /**
+     * Start or stop recording spans. Spans already recorded are kept.
+     * @param enabled `true` to start recording, `false` to stop.
+     */
+    static void setEnabled(const bool& enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+
+    /// Get the current time in nanoseconds since the tracer started.
+    static uint64_t now();
+
+    /**
+     * Record a finished span into the calling thread's buffer.
+     * @param event The span.
+     */
+    static void record(TraceEvent&& event);
+
+    /// Discard all recorded spans, and forget the finished threads.
+    static void clear();
+
+    /// Get the number of threads whose buffers are kept (see `buffers_`).
+    static uint64_t getThreadCount();
+
+    /**
+     * Write all recorded spans to a file as Chrome trace event JSON.
+     * The spans of finished threads are only written once, their buffers are dropped afterwards.
+     * @param path Path to the file (overwritten).
+     * @return The number of spans written.
+     * @throw std::runtime_error if the file can't be written.
+     */
+    static uint64_t dump(const std::string& path);
+};
+
+/**
+ * RAII span: records the time from its construction to its destruction as a
+ * trace event of the current thread, if tracing was enabled when it started.
+ * Attributes are only converted and stored when the span is active, so arguments
+ * that are expensive to build should be guarded with active().
+ */
+class TraceSpan {
+  private:
+    const bool active_;   ///< Whether the span is being recorded.
+    uint8_t args_ = 0;    ///< Number of attributes set.
+    TraceEvent event_;    ///< The span being recorded.
+
+  public:
+    /**
+     * Constructor. Starts the span.
+     * @param name The span name. Must be a string literal (only the pointer is kept).
+     */
+    explicit TraceSpan(const char* name) : active_(Tracer::isEnabled()) {
+      if (!this->active_) return;
+      this->event_.name = name;
+      this->event_.start = Tracer::now();
+    }
+
+    /// Destructor. Ends and records the span.
+    ~TraceSpan() {
+      if (!this->active_) return;
+      this->event_.duration = Tracer::now() - this->event_.start;
+      Tracer::record(std::move(this->event_));
+    }
+
+    TraceSpan(const TraceSpan&) = delete; ///< Copy constructor (deleted).
+    TraceSpan& operator=(const TraceSpan&) = delete; ///< Copy assignment operator (deleted).
+
+    /// Getter for `active_`.
+    bool active() const { return this->active_; }
+
+    /**
+     * Set an attribute. Attributes past the fourth are ignored.
+     * @param key The attribute name. Must be a string literal.
+     * @param value The attribute value.
+     * @return The span itself, for chaining.
+     */
+    TraceSpan& attr(const char* key, std::string value) {
+      if (this->active_ && this->args_ < this->event_.args.size()) {
+        this->event_.args[this->args_++] = std::make_pair(key, std::move(value));
+      }
+      return *this;
+    }
+
+    /**
+     * Set a numeric attribute. Attributes past the fourth are ignored.
+     * @param key The attribute name. Must be a string literal.
+     * @param value The attribute value.
+     * @return The span itself, for chaining.
+     */
+    template <std::integral T> TraceSpan& attr(const char* key, const T& value) {
+      if (!this->active_) return *this;
+      return this->attr(key, std::to_string(value));
+    }
+};
+
+#endif  // TRACER_H
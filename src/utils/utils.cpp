@@ -22,9 +22,10 @@ std::string Utils::getTestDumpPath() { return std::string("testdump"); }
 void Utils::logToFile(std::string_view str) {
   // Lock to prevent multiple memory writes
   std::lock_guard lock(log_lock);
-  std::ofstream log("log.txt", std::ios::app);
-  log << str << std::endl;
-  log.close();
+  static RotatingFileSink log("log.txt", Logger::maxFileBytes, Logger::maxFiles);
+  log.write(str);
+  log.write("\n");
+  log.flush();
 }
 
 void Utils::safePrint(std::string_view str) {
@@ -748,7 +749,7 @@ Bytes Utils::padRightBytes(const BytesArrView bytes, unsigned int charAmount, ui
 
 json Utils::readConfigFile() {
   if (!std::filesystem::exists("config.json")) {
-    Logger::logToDebug(LogType::INFO, Log::utils, __func__, "No config file found, generating default");
+    LOGINFO(Log::utils, "No config file found, generating default");
     json config;
     config["rpcport"] = 8080;
     config["p2pport"] = 8081;
@@ -379,7 +379,7 @@ namespace Utils {
   extern std::atomic<bool> logToCout; ///< Indicates whether logging to stdout is allowed (for safePrint()).
 
   /**
-   * %Log a string to a file called `log.txt`.
+   * %Log a string to a file called `log.txt` (kept open and rotated by size, see RotatingFileSink).
    * @param str The string to log.
    */
   void logToFile(std::string_view str);
@@ -0,0 +1,44 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include "../../src/libs/catch2/catch_amalgamated.hpp"
+#include "../../src/utils/block.h"
+#include "../../src/utils/tx.h"
+
+namespace BBlock {
+  // Create a finalized block with the given number of signed native transfers
+  Block createBlock(const uint64_t& txs) {
+    PrivKey privKey(Hex::toBytes("0x4d5db4107d237df6a3d58ee5f70ae63d73d765d8a1214214d8a13340d0f2750d"));
+    Address from = Secp256k1::toAddress(Secp256k1::toUPub(privKey));
+    Block block(Hash(Hex::toBytes("22143e16db549af9ccfd3b746ea4a74421847fa0fe7e0e278626a4e7307ac0f6")), 1678400201858, 1);
+    for (uint64_t i = 0; i < txs; i++) {
+      block.appendTx(TxBlock(
+        Address(Utils::randBytes(20)), from, Bytes(), 8080, i,
+        1000000000000000000, 1000000000, 1000000000, 21000, privKey
+      ));
+    }
+    block.finalize(privKey, 1678400201859);
+    return block;
+  }
+
+  TEST_CASE("TxBlock Benchmarks", "[bench][utils][tx]") {
+    Block block = createBlock(1);
+    const TxBlock& tx = block.getTxs()[0];
+    const Bytes txBytes = tx.rlpSerialize();
+    BENCHMARK("TxBlock parse") { return TxBlock(txBytes, 8080); };
+    BENCHMARK("TxBlock serialize") { return tx.rlpSerialize(); };
+  }
+
+  TEST_CASE("Block Benchmarks", "[bench][utils][block]") {
+    for (const uint64_t txs : {uint64_t(1), uint64_t(100), uint64_t(10000)}) {
+      Block block = createBlock(txs);
+      const Bytes blockBytes = block.serializeBlock();
+      BENCHMARK("Block parse " + std::to_string(txs) + " txs") { return Block(blockBytes, 8080); };
+      BENCHMARK("Block serialize " + std::to_string(txs) + " txs") { return block.serializeBlock(); };
+    }
+  }
+}
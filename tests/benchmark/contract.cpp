@@ -0,0 +1,119 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include "../../src/libs/catch2/catch_amalgamated.hpp"
+#include "../../src/contract/templates/erc20.h"
+#include "../../src/contract/templates/dexv2/dexv2factory.h"
+#include "../../src/contract/templates/dexv2/dexv2router02.h"
+#include "../../src/contract/templates/nativewrapper.h"
+
+#include "../sdktestsuite.hpp"
+
+namespace BContract {
+  // Number of contract calls in each block, one per account.
+  const uint64_t callsPerBlock = 250;
+
+  // Build a signed contract call with an explicit nonce, so the calls of
+  // future blocks can be signed before the measurement starts.
+  template <typename ReturnType, typename TContract, typename ...Args> TxBlock createCallTx(
+    SDKTestSuite& sdk, const TestAccount& account, const uint64_t& nonce, const Address& contract,
+    ReturnType(TContract::*func)(const Args&...), const Args&... args
+  ) {
+    Functor functor = ABI::FunctorEncoder::encode<Args...>(ContractReflectionInterface::getFunctionName(func));
+    Bytes data(functor.cbegin(), functor.cend());
+    Utils::appendBytes(data, ABI::Encoder::encodeData<Args...>(args...));
+    return TxBlock(contract, account.address, data, sdk.getOptions()->getChainID(),
+      nonce, 0, 1000000000, 1000000000, 21000, account.privKey
+    );
+  }
+
+  // Give every account 1000 tokens from the chain owner (one block per account, as they share the sender)
+  void fundAccounts(SDKTestSuite& sdk, const std::vector<TestAccount>& accounts, const Address& token) {
+    for (const TestAccount& account : accounts) {
+      sdk.callFunction(token, &ERC20::transfer, account.address, uint256_t("1000000000000000000000"));
+    }
+  }
+
+  // Make every account approve `spender` on the token, all in the same block
+  void approveAll(SDKTestSuite& sdk, const std::vector<TestAccount>& accounts, const Address& token, const Address& spender) {
+    std::vector<TxBlock> approvals;
+    for (const TestAccount& account : accounts) approvals.emplace_back(createCallTx(
+      sdk, account, sdk.getNativeNonce(account.address), token, &ERC20::approve, spender, uint256_t("1000000000000000000000")
+    ));
+    sdk.advanceChain(0, approvals);
+  }
+
+  // Sign the calls of every run (one block each) before the measurement, `makeCall(index, nonce)` builds each call
+  template <typename MakeCall> std::vector<std::vector<TxBlock>> createBlocks(
+    SDKTestSuite& sdk, const std::vector<TestAccount>& accounts, const int& runs, MakeCall&& makeCall
+  ) {
+    std::vector<std::vector<TxBlock>> blocks(runs);
+    for (uint64_t i = 0; i < accounts.size(); i++) {
+      const uint64_t nonce = sdk.getNativeNonce(accounts[i].address);
+      for (uint64_t run = 0; run < blocks.size(); run++) blocks[run].emplace_back(makeCall(i, nonce + run));
+    }
+    return blocks;
+  }
+
+  // Contract throughput, measured as blocks full of calls going through the whole node
+  // (validation, processing, events and storage). The signatures are made beforehand.
+  TEST_CASE("Contract Benchmarks", "[bench][contract]") {
+    std::vector<TestAccount> accounts;
+    for (uint64_t i = 0; i < callsPerBlock; i++) accounts.emplace_back(TestAccount::newRandomAccount());
+
+    SECTION("ERC20 transfer") {
+      SDKTestSuite sdk("benchContractERC20", accounts);
+      Address token = sdk.deployContract<ERC20>(
+        std::string("TestToken"), std::string("TST"), uint8_t(18), uint256_t("1000000000000000000000000000")
+      );
+      fundAccounts(sdk, accounts, token);
+      BENCHMARK_ADVANCED("ERC20 transfer " + std::to_string(callsPerBlock) + " calls per block")(Catch::Benchmark::Chronometer meter) {
+        auto blocks = createBlocks(sdk, accounts, meter.runs(), [&](const uint64_t& i, const uint64_t& nonce) {
+          return createCallTx(sdk, accounts[i], nonce, token, &ERC20::transfer,
+            accounts[(i + 1) % accounts.size()].address, uint256_t(1000)
+          );
+        });
+        meter.measure([&](int i) { return sdk.advanceChain(0, blocks[i]); });
+      };
+    }
+
+    SECTION("DEXV2 swap") {
+      SDKTestSuite sdk("benchContractDEXV2", accounts);
+      Address tokenA = sdk.deployContract<ERC20>(
+        std::string("TokenA"), std::string("TKNA"), uint8_t(18), uint256_t("1000000000000000000000000000")
+      );
+      Address tokenB = sdk.deployContract<ERC20>(
+        std::string("TokenB"), std::string("TKNB"), uint8_t(18), uint256_t("1000000000000000000000000000")
+      );
+      Address wrapped = sdk.deployContract<NativeWrapper>(std::string("WSPARQ"), std::string("WSPARQ"), uint8_t(18));
+      Address factory = sdk.deployContract<DEXV2Factory>(Address());
+      Address router = sdk.deployContract<DEXV2Router02>(factory, wrapped);
+      const Address owner = sdk.getChainOwnerAccount().address;
+      const uint256_t deadline = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()
+      ).count() + 3600000000;  // One hour
+      sdk.callFunction(tokenA, &ERC20::approve, router, uint256_t("1000000000000000000000000"));
+      sdk.callFunction(tokenB, &ERC20::approve, router, uint256_t("1000000000000000000000000"));
+      sdk.callFunction(router, &DEXV2Router02::addLiquidity,
+        tokenA, tokenB, uint256_t("1000000000000000000000000"), uint256_t("1000000000000000000000000"),
+        uint256_t(0), uint256_t(0), owner, deadline
+      );
+      fundAccounts(sdk, accounts, tokenA);
+      approveAll(sdk, accounts, tokenA, router);
+      // Swaps go through the router, which moves the tokens to the pair and calls DEXV2Pair::swap
+      const std::vector<Address> path = {tokenA, tokenB};
+      BENCHMARK_ADVANCED("DEXV2 swap " + std::to_string(callsPerBlock) + " calls per block")(Catch::Benchmark::Chronometer meter) {
+        auto blocks = createBlocks(sdk, accounts, meter.runs(), [&](const uint64_t& i, const uint64_t& nonce) {
+          return createCallTx(sdk, accounts[i], nonce, router, &DEXV2Router02::swapExactTokensForTokens,
+            uint256_t(1000000), uint256_t(0), path, accounts[i].address, deadline
+          );
+        });
+        meter.measure([&](int i) { return sdk.advanceChain(0, blocks[i]); });
+      };
+    }
+  }
+}
@@ -0,0 +1,37 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include "../../src/libs/catch2/catch_amalgamated.hpp"
+#include "../../src/utils/ecdsa.h"
+#include "../../src/utils/merkle.h"
+#include "../../src/utils/utils.h"
+
+namespace BCrypto {
+  TEST_CASE("Secp256k1 Benchmarks", "[bench][utils][ecdsa]") {
+    PrivKey privKey(Hex::toBytes("0x4d5db4107d237df6a3d58ee5f70ae63d73d765d8a1214214d8a13340d0f2750d"));
+    const Hash msg = Utils::sha3(Utils::randBytes(32));
+    const Signature sig = Secp256k1::sign(msg, privKey);
+    BENCHMARK("Secp256k1::sign") { return Secp256k1::sign(msg, privKey); };
+    BENCHMARK("Secp256k1::recover") { return Secp256k1::recover(sig, msg); };
+  }
+
+  TEST_CASE("SHA3 Benchmarks", "[bench][utils][sha3]") {
+    for (const uint64_t size : {uint64_t(32), uint64_t(1024), uint64_t(1024 * 1024)}) {
+      const Bytes input = Utils::randBytes(size);
+      BENCHMARK("Utils::sha3 " + std::to_string(size) + " bytes") { return Utils::sha3(input); };
+    }
+  }
+
+  TEST_CASE("Merkle Benchmarks", "[bench][utils][merkle]") {
+    for (const uint64_t leafCount : {uint64_t(1000), uint64_t(10000), uint64_t(100000)}) {
+      std::vector<Hash> leaves;
+      leaves.reserve(leafCount);
+      for (uint64_t i = 0; i < leafCount; i++) leaves.emplace_back(Hash::random());
+      BENCHMARK("Merkle " + std::to_string(leafCount) + " leaves") { return Merkle(leaves).getRoot(); };
+    }
+  }
+}
@@ -0,0 +1,42 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include "../../src/libs/catch2/catch_amalgamated.hpp"
+#include "../../src/utils/db.h"
+
+#include <filesystem>
+
+namespace BDB {
+  TEST_CASE("DB Benchmarks", "[bench][utils][db]") {
+    if (std::filesystem::exists("benchDB")) std::filesystem::remove_all("benchDB");
+    DB db("benchDB");
+    const Bytes pfx{0x00, 0x01};
+    const Bytes batchPfx{0x00, 0x02};
+
+    // Keys that are already in the DB, so reads always hit
+    std::vector<Hash> keys;
+    DBBatch fill;
+    for (uint64_t i = 0; i < 10000; i++) {
+      keys.emplace_back(Hash::random());
+      fill.push_back(keys.back().get(), Hash::random().get(), pfx);
+    }
+    REQUIRE(db.putBatch(fill));
+
+    uint64_t next = 0;
+    BENCHMARK("DB get") { return db.get(keys[next++ % keys.size()].get(), pfx); };
+    BENCHMARK("DB has") { return db.has(keys[next++ % keys.size()].get(), pfx); };
+    BENCHMARK("DB put") { return db.put(Hash::random().get(), keys[next++ % keys.size()].get(), pfx); };
+
+    DBBatch batch;
+    for (uint64_t i = 0; i < 1000; i++) batch.push_back(Hash::random().get(), Hash::random().get(), batchPfx);
+    BENCHMARK("DB putBatch 1000 entries") { return db.putBatch(batch); };
+    BENCHMARK("DB getBatch 1000 entries") { return db.getBatch(batchPfx); };
+
+    REQUIRE(db.close());
+    std::filesystem::remove_all("benchDB");
+  }
+}
@@ -0,0 +1,39 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include "../../src/libs/catch2/catch_amalgamated.hpp"
+#include "../../src/contract/variables/safeunorderedmap.h"
+
+#include <deque>
+
+namespace BSafeUnorderedMap {
+  TEST_CASE("SafeUnorderedMap Benchmarks", "[bench][contract][variables][safeunorderedmap]") {
+    std::vector<Address> addresses;
+    for (uint64_t i = 0; i < 1000; i++) addresses.emplace_back(Utils::randBytes(20));
+
+    // Every run needs its own map with 1000 pending writes, built outside the measurement
+    auto fillMaps = [&](const int runs) {
+      std::deque<SafeUnorderedMap<Address, uint256_t>> maps(runs);
+      for (auto& map : maps) for (const Address& address : addresses) map[address] = uint256_t(1000000000);
+      return maps;
+    };
+
+    BENCHMARK("SafeUnorderedMap write 1000 entries") {
+      SafeUnorderedMap<Address, uint256_t> map;
+      for (const Address& address : addresses) map[address] = uint256_t(1000000000);
+      return map.size();
+    };
+    BENCHMARK_ADVANCED("SafeUnorderedMap commit 1000 entries")(Catch::Benchmark::Chronometer meter) {
+      auto maps = fillMaps(meter.runs());
+      meter.measure([&](int i) { maps[i].commit(); });
+    };
+    BENCHMARK_ADVANCED("SafeUnorderedMap revert 1000 entries")(Catch::Benchmark::Chronometer meter) {
+      auto maps = fillMaps(meter.runs());
+      meter.measure([&](int i) { maps[i].revert(); });
+    };
+  }
+}
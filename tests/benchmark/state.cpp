@@ -0,0 +1,56 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include "../../src/libs/catch2/catch_amalgamated.hpp"
+
+#include "../sdktestsuite.hpp"
+
+namespace BState {
+  // Block processing, with every transaction coming from a different account (the State
+  // only accepts one transaction per account per block). Each run processes a new block,
+  // and only the signatures of the user transactions are made outside the measurement,
+  // so the times include the rdPoS transactions and the block signature (see "empty block").
+  TEST_CASE("State Benchmarks", "[bench][core][state]") {
+    std::vector<TestAccount> accounts;
+    for (uint64_t i = 0; i < 1000; i++) accounts.emplace_back(TestAccount::newRandomAccount());
+    SDKTestSuite sdk("benchStateProcessNextBlock", accounts);
+
+    BENCHMARK_ADVANCED("State::processNextBlock empty block")(Catch::Benchmark::Chronometer meter) {
+      meter.measure([&]() { return sdk.advanceChain(); });
+    };
+    auto createBlocks = [&](const uint64_t& runs, const uint64_t& txCount) {
+      std::vector<std::vector<TxBlock>> blocks(runs);
+      for (uint64_t i = 0; i < txCount; i++) {
+        const uint64_t nonce = sdk.getNativeNonce(accounts[i].address);
+        for (uint64_t run = 0; run < blocks.size(); run++) blocks[run].emplace_back(
+          Address(Utils::randBytes(20)), accounts[i].address, Bytes(), sdk.getOptions()->getChainID(),
+          nonce + run, 1, 1000000000, 1000000000, 21000, accounts[i].privKey
+        );
+      }
+      return blocks;
+    };
+    for (const uint64_t txCount : {uint64_t(100), uint64_t(1000)}) {
+      BENCHMARK_ADVANCED("State::processNextBlock " + std::to_string(txCount) + " native transfers")(Catch::Benchmark::Chronometer meter) {
+        auto blocks = createBlocks(meter.runs(), txCount);
+        meter.measure([&](int i) { return sdk.advanceChain(0, blocks[i]); });
+      };
+    }
+    // The block dump and the per-transaction lines processNextBlock() used to build for every
+    // block are only built at the TRACE level now, so enabling it for the State gives the
+    // cost they had before next to the default logging.
+    for (const bool trace : {true, false}) {
+      BENCHMARK_ADVANCED(std::string("State::processNextBlock 500 native transfers, ")
+        + (trace ? "block and transaction diagnostics (before)" : "default logging (after)")
+      )(Catch::Benchmark::Chronometer meter) {
+        auto blocks = createBlocks(meter.runs(), 500);
+        if (trace) Logger::setLogLevel(Log::state, LogType::TRACE);
+        meter.measure([&](int i) { return sdk.advanceChain(0, blocks[i]); });
+        Logger::clearComponentLevels();
+      };
+    }
+  }
+}
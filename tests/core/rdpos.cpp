@@ -273,6 +273,52 @@ namespace TRdPoS {
       REQUIRE(rdpos->validateBlock(block));
     }
 
+    SECTION ("rdPoS addValidatorTx(), transactions pushed early for the next round") {
+      std::unique_ptr<DB> db;
+      std::unique_ptr<Storage> storage;
+      std::unique_ptr<P2P::ManagerNormal> p2p;
+      PrivKey validatorKey = PrivKey();
+      std::unique_ptr<rdPoS> rdpos;
+      std::unique_ptr<Options> options;
+      std::unique_ptr<State> state;
+      initialize(db, storage, p2p, validatorKey, rdpos, options, state, 8080, true, testDumpPath + "/rdPoSNextRoundTxs");
+
+      // Every validator pushes a randomHash transaction for height 2 before block 1 is processed.
+      std::vector<TxValidator> earlyTxs;
+      for (const auto& privKey : validatorPrivKeys) {
+        Bytes hashTxData = Hex::toBytes("0xcfffe746");
+        Utils::appendBytes(hashTxData, Utils::sha3(Hash::random().get()));
+        earlyTxs.emplace_back(Secp256k1::toAddress(Secp256k1::toUPub(privKey)), hashTxData, 8080, 2, privKey);
+      }
+      for (const auto& tx : earlyTxs) REQUIRE(rdpos->addValidatorTx(tx));
+      // At most two transactions per validator are held, and height 3 is too far ahead.
+      Bytes seedTxData = Hex::toBytes("0x6fc5a2d6");
+      Utils::appendBytes(seedTxData, Hash::random().get());
+      TxValidator earlySeedTx(earlyTxs[0].getFrom(), seedTxData, 8080, 2, validatorPrivKeys[0]);
+      REQUIRE(rdpos->addValidatorTx(earlySeedTx));
+      Bytes otherHashTxData = Hex::toBytes("0xcfffe746");
+      Utils::appendBytes(otherHashTxData, Utils::sha3(Hash::random().get()));
+      REQUIRE(!rdpos->addValidatorTx(TxValidator(earlyTxs[0].getFrom(), otherHashTxData, 8080, 2, validatorPrivKeys[0])));
+      REQUIRE(!rdpos->addValidatorTx(TxValidator(earlyTxs[1].getFrom(), seedTxData, 8080, 3, validatorPrivKeys[1])));
+      REQUIRE(rdpos->getMempool().empty());
+
+      auto block = createValidBlock(rdpos, storage);
+      REQUIRE(rdpos->validateBlock(block));
+      rdpos->processBlock(block);
+      storage->pushBack(std::move(block));
+
+      // Only the transactions from the validators participating in the new round are kept.
+      auto randomList = rdpos->getRandomList();
+      auto mempool = rdpos->getMempool();
+      auto participates = [&](const Address& add) {
+        return std::find(randomList.begin() + 1, randomList.begin() + rdPoS::minValidators + 1, Validator(add))
+          != randomList.begin() + rdPoS::minValidators + 1;
+      };
+      for (const auto& tx : earlyTxs) REQUIRE(mempool.contains(tx.hash()) == participates(tx.getFrom()));
+      REQUIRE(mempool.contains(earlySeedTx.hash()) == participates(earlySeedTx.getFrom()));
+      REQUIRE(mempool.size() == rdPoS::minValidators + (participates(earlySeedTx.getFrom()) ? 1 : 0));
+    }
+
     SECTION ("rdPoS validateBlock(), ten block from genesis") {
       Hash expectedRandomnessFromBestBlock;
       std::vector<Validator> expectedRandomList;
@@ -331,6 +331,64 @@ namespace TState {
       }
     }
 
+    SECTION("Test State fillBlockWithTransactions limits and ordering") {
+      std::unique_ptr<DB> db;
+      std::unique_ptr<Storage> storage;
+      std::unique_ptr<P2P::ManagerNormal> p2p;
+      std::unique_ptr<rdPoS> rdpos;
+      std::unique_ptr<State> state;
+      std::unique_ptr<Options> options;
+      initialize(db, storage, p2p, rdpos, state, options, validatorPrivKeys[0], 8080, true, testDumpPath + "/stateFillBlockTest");
+
+      // One transaction per sender, each paying a different fee.
+      std::vector<TxBlock> txs;
+      for (uint64_t i = 0; i < 100; ++i) {
+        PrivKey privKey(Utils::randBytes(32));
+        Address me = Secp256k1::toAddress(Secp256k1::toUPub(privKey));
+        state->addBalance(me);
+        uint256_t fee = uint256_t(i + 1) * 1000000000;
+        txs.emplace_back(Address(Utils::randBytes(20)), me, Bytes(), 8080, state->getNativeNonce(me), 1, fee, fee, 21000, privKey);
+        state->addTx(TxBlock(txs.back()));
+      }
+      std::sort(txs.begin(), txs.end(), [](const TxBlock& a, const TxBlock& b) { return a.getMaxFeePerGas() > b.getMaxFeePerGas(); });
+
+      auto fillWithLimits = [&](const BlockBuilderOptions& limits) {
+        options = std::make_unique<Options>(
+          options->getRootPath(), options->getWeb3ClientVersion(), options->getVersion(), options->getChainID(),
+          options->getChainOwner(), options->getP2PPort(), options->getHttpPort(), options->getEventBlockCap(),
+          options->getEventLogCap(), options->getDiscoveryNodes(), options->getGenesisBlock(),
+          options->getGenesisBlock().getTimestamp(), PrivKey(), options->getGenesisBalances(),
+          options->getGenesisValidators(), limits
+        );
+        Block block(storage->latest()->hash(), storage->latest()->getTimestamp(), storage->latest()->getNHeight() + 1);
+        state->fillBlockWithTransactions(block);
+        return block.getTxs();
+      };
+
+      // Transaction count limit, highest fees first.
+      BlockBuilderOptions limits;
+      limits.maxBlockTxs = 60;
+      auto blockTxs = fillWithLimits(limits);
+      REQUIRE(blockTxs.size() == 60);
+      for (uint64_t i = 0; i < blockTxs.size(); ++i) REQUIRE(blockTxs[i] == txs[i]);
+      REQUIRE(fillWithLimits(limits) == blockTxs);
+
+      // Gas limit.
+      limits.maxBlockGas = 21000 * 10;
+      blockTxs = fillWithLimits(limits);
+      REQUIRE(blockTxs.size() == 10);
+      for (uint64_t i = 0; i < blockTxs.size(); ++i) REQUIRE(blockTxs[i] == txs[i]);
+
+      // Size limit.
+      limits = BlockBuilderOptions();
+      limits.maxBlockBytes = 0;
+      for (uint64_t i = 0; i < 5; ++i) limits.maxBlockBytes += txs[i].rlpSerialize().size();
+      REQUIRE(fillWithLimits(limits).size() == 5);
+
+      // No limits, the whole mempool.
+      REQUIRE(fillWithLimits(BlockBuilderOptions()).size() == 100);
+    }
+
     SECTION("Test State mempool refresh") {
       /// The block included will only have transactions where the address starts with \x08 or lower
       /// where the mempool will have 500 transactions, including the \x08 addresses txs.
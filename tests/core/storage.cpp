@@ -133,6 +133,47 @@ Block createRandomBlock(uint64_t txCount, uint64_t validatorCount, uint64_t nHei
 }
 
 namespace TStorage {
+  TEST_CASE("BlockFeeStats Struct", "[core][storage]") {
+    SECTION("BlockFeeStats gas-weighted percentiles") {
+      const uint64_t chainId = 808080;
+      const uint256_t gwei = 1000000000;
+      const uint256_t baseFee = BlockFeeStats::baseFee;
+      auto makeTx = [&](const uint256_t& maxPriorityFee, const uint256_t& maxFee, const uint256_t& gas) {
+        PrivKey privKey = PrivKey::random();
+        return TxBlock(Address(Utils::randBytes(20)), Secp256k1::toAddress(Secp256k1::toUPub(privKey)),
+          Bytes(), chainId, 0, 0, maxPriorityFee, maxFee, gas, privKey
+        );
+      };
+      Block block(Hash::random(), 230915972837111, 1);
+      block.appendTx(makeTx(gwei, baseFee + 3 * gwei, 100));     // Pays its full priority fee
+      block.appendTx(makeTx(5 * gwei, baseFee + 2 * gwei, 300)); // Capped by the max fee
+      block.appendTx(makeTx(gwei, baseFee - 1, 100));            // Can't even pay the base fee
+      block.finalize(PrivKey::random(), 230915972837112);
+      BlockFeeStats stats(block);
+      REQUIRE(stats.txCount == 3);
+      REQUIRE(stats.gasUsed == 500);
+      REQUIRE(stats.reward(0) == 0);
+      REQUIRE(stats.reward(20) == 0);
+      REQUIRE(stats.reward(20.5) == uint64_t(gwei));
+      REQUIRE(stats.reward(40) == uint64_t(gwei));
+      REQUIRE(stats.reward(41) == uint64_t(2 * gwei));
+      REQUIRE(stats.reward(100) == uint64_t(2 * gwei));
+
+      BlockFeeStats loadedStats(stats.serialize());
+      REQUIRE(loadedStats.txCount == stats.txCount);
+      REQUIRE(loadedStats.gasUsed == stats.gasUsed);
+      REQUIRE(loadedStats.rewards == stats.rewards);
+      REQUIRE_THROWS(BlockFeeStats(Bytes(16)));
+
+      Block emptyBlock(Hash::random(), 230915972837111, 1);
+      emptyBlock.finalize(PrivKey::random(), 230915972837112);
+      BlockFeeStats emptyStats(emptyBlock);
+      REQUIRE(emptyStats.txCount == 0);
+      REQUIRE(emptyStats.gasUsed == 0);
+      REQUIRE(emptyStats.reward(50) == 0);
+    }
+  }
+
   TEST_CASE("Storage Class", "[core][storage]") {
     SECTION("Simple Storage Startup") {
       std::unique_ptr<DB> db;
@@ -293,6 +334,14 @@ namespace TStorage {
           REQUIRE(blockHeight == i + 1);
           REQUIRE(tx->hash() == requiredTxs[ii].hash());
         }
+
+        // Fee statistics are saved along with the block instead of parsing it again
+        REQUIRE(db->has(Utils::uint64ToBytes(i + 1), DBPrefix::feeStats));
+        BlockFeeStats requiredStats(requiredBlock);
+        BlockFeeStats feeStats = storage->getFeeStats(i + 1);
+        REQUIRE(feeStats.txCount == requiredStats.txCount);
+        REQUIRE(feeStats.gasUsed == requiredStats.gasUsed);
+        REQUIRE(feeStats.rewards == requiredStats.rewards);
       }
     }
   }
@@ -0,0 +1,192 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include "../../src/libs/catch2/catch_amalgamated.hpp"
+#include "../../src/core/rdpos.h"
+#include "../../src/core/storage.h"
+#include "../../src/core/state.h"
+#include "../../src/core/syncengine.h"
+#include "../../src/utils/db.h"
+#include "../../src/net/p2p/managernormal.h"
+
+// Definition from rdpos.cpp, when linking, the compiler should find the function.
+Block createValidBlock(std::unique_ptr<rdPoS>& rdpos, std::unique_ptr<Storage>& storage, const std::vector<TxBlock>& txs = {});
+
+// Definition from state.cpp, when linking, the compiler should find the function.
+void initialize(std::unique_ptr<DB>& db,
+                std::unique_ptr<Storage>& storage,
+                std::unique_ptr<P2P::ManagerNormal>& p2p,
+                std::unique_ptr<rdPoS>& rdpos,
+                std::unique_ptr<State>& state,
+                std::unique_ptr<Options>& options,
+                PrivKey validatorKey,
+                uint64_t serverPort,
+                bool clearDb,
+                std::string folderName);
+
+namespace TSyncEngine {
+  std::string testDumpPath = Utils::getTestDumpPath();
+
+  // Wait until a node has the given number of sessions, up to 5 seconds.
+  bool waitForSessions(std::unique_ptr<P2P::ManagerNormal>& p2p, size_t count) {
+    for (int i = 0; i < 500; i++) {
+      if (p2p->getSessionsIDs().size() == count) return true;
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return false;
+  }
+
+  // Get the info of every node connected to the given one.
+  std::unordered_map<P2P::NodeID, P2P::NodeInfo, SafeHash> getNodeInfos(std::unique_ptr<P2P::ManagerNormal>& p2p) {
+    std::unordered_map<P2P::NodeID, P2P::NodeInfo, SafeHash> nodes;
+    std::mutex nodesMutex;
+    p2p->requestNodeInfoFromAll(p2p->getSessionsIDs(), [&](const P2P::NodeID& nodeId, const P2P::NodeInfo& nodeInfo) {
+      std::lock_guard lock(nodesMutex);
+      nodes[nodeId] = nodeInfo;
+    });
+    return nodes;
+  }
+
+  TEST_CASE("SyncEngine Class", "[core][syncengine]") {
+    SECTION("Headers and bodies encoding") {
+      std::unique_ptr<DB> db;
+      std::unique_ptr<Storage> storage;
+      std::unique_ptr<P2P::ManagerNormal> p2p;
+      std::unique_ptr<rdPoS> rdpos;
+      std::unique_ptr<State> state;
+      std::unique_ptr<Options> options;
+      initialize(db, storage, p2p, rdpos, state, options, PrivKey(), 8100, true, testDumpPath + "/syncEngineEncodingTest");
+
+      std::vector<std::shared_ptr<const Block>> blocks;
+      for (uint64_t i = 0; i < 10; i++) {
+        auto block = createValidBlock(rdpos, storage);
+        REQUIRE(state->validateNextBlock(block));
+        state->processNextBlock(std::move(block));
+        blocks.push_back(storage->latest());
+      }
+
+      auto headersRequest = P2P::RequestEncoder::requestBlockHeaders(1, 10);
+      REQUIRE(headersRequest.command() == P2P::RequestBlockHeaders);
+      REQUIRE(P2P::RequestDecoder::requestBlockHeaders(headersRequest) == std::make_pair<uint64_t, uint64_t>(1, 10));
+      auto headers = P2P::AnswerDecoder::requestBlockHeaders(P2P::AnswerEncoder::requestBlockHeaders(headersRequest, blocks));
+      REQUIRE(headers.size() == blocks.size());
+      for (uint64_t i = 0; i < blocks.size(); i++) {
+        REQUIRE(headers[i].hash == blocks[i]->hash());
+        REQUIRE(headers[i].prevBlockHash == blocks[i]->getPrevBlockHash());
+        REQUIRE(headers[i].nHeight == blocks[i]->getNHeight());
+      }
+
+      auto bodiesRequest = P2P::RequestEncoder::requestBlockBodies(1, 10);
+      REQUIRE(bodiesRequest.command() == P2P::RequestBlockBodies);
+      REQUIRE(P2P::RequestDecoder::requestBlockBodies(bodiesRequest) == std::make_pair<uint64_t, uint64_t>(1, 10));
+      auto bodies = P2P::AnswerDecoder::requestBlockBodies(P2P::AnswerEncoder::requestBlockBodies(bodiesRequest, blocks), 8080);
+      REQUIRE(bodies.size() == blocks.size());
+      for (uint64_t i = 0; i < blocks.size(); i++) {
+        Block rebuilt(headers[i].signedHeader, std::move(bodies[i].txs), std::move(bodies[i].txValidators));
+        REQUIRE(rebuilt == *blocks[i]);
+      }
+
+      // Bodies must not be decoded from other commands.
+      REQUIRE_THROWS(P2P::AnswerDecoder::requestBlockBodies(P2P::AnswerEncoder::requestBlockHeaders(headersRequest, blocks), 8080));
+    }
+
+    SECTION("Sync 10000 blocks from multiple nodes") {
+      std::unique_ptr<DB> db1;
+      std::unique_ptr<Storage> storage1;
+      std::unique_ptr<P2P::ManagerNormal> p2p1;
+      std::unique_ptr<rdPoS> rdpos1;
+      std::unique_ptr<State> state1;
+      std::unique_ptr<Options> options1;
+      initialize(db1, storage1, p2p1, rdpos1, state1, options1, PrivKey(), 8101, true, testDumpPath + "/syncEngineNode1");
+
+      std::unique_ptr<DB> db2;
+      std::unique_ptr<Storage> storage2;
+      std::unique_ptr<P2P::ManagerNormal> p2p2;
+      std::unique_ptr<rdPoS> rdpos2;
+      std::unique_ptr<State> state2;
+      std::unique_ptr<Options> options2;
+      initialize(db2, storage2, p2p2, rdpos2, state2, options2, PrivKey(), 8102, true, testDumpPath + "/syncEngineNode2");
+
+      std::unique_ptr<DB> db3;
+      std::unique_ptr<Storage> storage3;
+      std::unique_ptr<P2P::ManagerNormal> p2p3;
+      std::unique_ptr<rdPoS> rdpos3;
+      std::unique_ptr<State> state3;
+      std::unique_ptr<Options> options3;
+      initialize(db3, storage3, p2p3, rdpos3, state3, options3, PrivKey(), 8103, true, testDumpPath + "/syncEngineNode3");
+
+      // Node 1 builds the chain by itself.
+      for (uint64_t i = 0; i < 10000; i++) {
+        auto block = createValidBlock(rdpos1, storage1);
+        REQUIRE(state1->validateNextBlock(block));
+        state1->processNextBlock(std::move(block));
+      }
+      REQUIRE(storage1->latest()->getNHeight() == 10000);
+
+      p2p1->start();
+      p2p2->start();
+      p2p3->start();
+      std::atomic<bool> stop = false;
+
+      // Node 2 syncs from node 1 alone.
+      p2p2->connectToServer(boost::asio::ip::address::from_string("127.0.0.1"), 8101);
+      REQUIRE(waitForSessions(p2p2, 1));
+      SyncEngine syncEngine2(p2p2, storage2, state2);
+      REQUIRE(syncEngine2.sync(getNodeInfos(p2p2), stop) == 10000);
+      REQUIRE(storage2->latest()->hash() == storage1->latest()->hash());
+      REQUIRE(state2->getNativeBalance(Address(Hex::toBytes("0x00dead00665771855a34155f5e7405489df2c3c6"))) ==
+              state1->getNativeBalance(Address(Hex::toBytes("0x00dead00665771855a34155f5e7405489df2c3c6"))));
+
+      // Node 3 syncs from nodes 1 and 2 at the same time, in small ranges so both are used.
+      p2p3->connectToServer(boost::asio::ip::address::from_string("127.0.0.1"), 8101);
+      p2p3->connectToServer(boost::asio::ip::address::from_string("127.0.0.1"), 8102);
+      REQUIRE(waitForSessions(p2p3, 2));
+      SyncEngine syncEngine3(p2p3, storage3, state3, 32, 256);
+      REQUIRE(syncEngine3.sync(getNodeInfos(p2p3), stop) == 10000);
+      REQUIRE(storage3->latest()->hash() == storage1->latest()->hash());
+      for (const auto& nodeId : p2p3->getSessionsIDs()) REQUIRE(!syncEngine3.isBanned(nodeId));
+
+      // Nothing left to sync.
+      REQUIRE(syncEngine3.sync(getNodeInfos(p2p3), stop) == 0);
+
+      // Node 4 syncs from node 1 while the same blocks also arrive by broadcast,
+      // so heights get committed between the sync's checks. No node may be banned for it.
+      std::unique_ptr<DB> db4;
+      std::unique_ptr<Storage> storage4;
+      std::unique_ptr<P2P::ManagerNormal> p2p4;
+      std::unique_ptr<rdPoS> rdpos4;
+      std::unique_ptr<State> state4;
+      std::unique_ptr<Options> options4;
+      initialize(db4, storage4, p2p4, rdpos4, state4, options4, PrivKey(), 8104, true, testDumpPath + "/syncEngineNode4");
+      p2p4->start();
+      p2p4->connectToServer(boost::asio::ip::address::from_string("127.0.0.1"), 8101);
+      REQUIRE(waitForSessions(p2p4, 1));
+      auto node1Id = p2p4->getSessionsIDs()[0];
+      SyncEngine syncEngine4(p2p4, storage4, state4, 32, 256);
+      auto broadcaster = std::async(std::launch::async, [&]() {
+        uint64_t broadcasted = 0;
+        for (uint64_t height = 1; height <= 10000; height++) {
+          Block block = *storage1->getBlock(height);
+          // Same as the broadcast handler, the block may be processed by the sync in the meantime.
+          try {
+            if (state4->validateNextBlock(block)) {
+              state4->processNextBlock(std::move(block));
+              broadcasted++;
+            }
+          } catch (std::exception&) {}
+        }
+        return broadcasted;
+      });
+      uint64_t synced = syncEngine4.sync(getNodeInfos(p2p4), stop);
+      uint64_t broadcasted = broadcaster.get();
+      REQUIRE(storage4->latest()->hash() == storage1->latest()->hash());
+      REQUIRE(synced + broadcasted == 10000);
+      REQUIRE(!syncEngine4.isBanned(node1Id));
+      REQUIRE(p2p4->getSessionsIDs().size() == 1);
+    }
+  }
+}
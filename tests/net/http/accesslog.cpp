@@ -0,0 +1,72 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include "../../src/libs/catch2/catch_amalgamated.hpp"
+#include "../../src/net/http/accesslog.h"
+#include "../../src/utils/utils.h"
+
+#include <filesystem>
+
+namespace TAccessLog {
+  TEST_CASE("AccessLog Class", "[net][http][accesslog]") {
+    SECTION("AccessLog disabled by default") {
+      std::string path = Utils::getTestDumpPath() + "/accessLogDisabled.log";
+      if (std::filesystem::exists(path)) std::filesystem::remove(path);
+      AccessLog log(path, RPCOptions{});
+      for (int i = 0; i < 10; i++) REQUIRE(!log.sample());
+      REQUIRE(!std::filesystem::exists(path));
+    }
+
+    SECTION("AccessLog samples one out of every N requests") {
+      std::string path = Utils::getTestDumpPath() + "/accessLogSampling.log";
+      RPCOptions options;
+      options.accessLogSampling = 4;
+      AccessLog log(path, options);
+      int sampled = 0;
+      for (int i = 0; i < 100; i++) if (log.sample()) sampled++;
+      REQUIRE(sampled == 25);
+    }
+
+    SECTION("AccessLog format") {
+      AccessLogEntry entry;
+      entry.time = std::chrono::system_clock::time_point(std::chrono::milliseconds(1700000000123));
+      entry.peer = "127.0.0.1";
+      entry.method = "eth_blockNumber";
+      entry.status = -32601;
+      entry.latencyUs = 42;
+      entry.bytes = 64;
+      REQUIRE(AccessLog::format(entry) ==
+        R"({"time":"2023-11-14T22:13:20.123Z","peer":"127.0.0.1","method":"eth_blockNumber","status":-32601,"latencyUs":42,"bytes":64})"
+      );
+    }
+
+    SECTION("AccessLog writes every recorded entry") {
+      std::string path = Utils::getTestDumpPath() + "/accessLogWrite.log";
+      std::filesystem::create_directories(Utils::getTestDumpPath());
+      if (std::filesystem::exists(path)) std::filesystem::remove(path);
+      RPCOptions options;
+      options.accessLogSampling = 1;
+      {
+        AccessLog log(path, options);
+        for (int i = 0; i < 100; i++) {
+          REQUIRE(log.sample());
+          log.record(AccessLogEntry{std::chrono::system_clock::now(), "127.0.0.1", "eth_chainId", 0, 10, uint64_t(i)});
+        }
+      } // The destructor writes the remaining entries
+      std::ifstream file(path);
+      std::string line;
+      uint64_t lines = 0;
+      while (std::getline(file, line)) {
+        json entry = json::parse(line);
+        REQUIRE(entry["method"] == "eth_chainId");
+        REQUIRE(entry["bytes"] == lines);
+        lines++;
+      }
+      REQUIRE(lines == 100);
+    }
+  }
+}
@@ -0,0 +1,201 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include <thread>
+
+#include "../../src/libs/catch2/catch_amalgamated.hpp"
+#include "../../src/net/http/filters.h"
+#include "../../src/net/http/jsonrpc/encoding.h"
+#include "../../src/contract/templates/simplecontract.h"
+#include "../../sdktestsuite.hpp"
+
+namespace TFilters {
+  // The registry is fed directly, without a State
+  const std::unique_ptr<State> noState = nullptr;
+
+  // Create an event as if it was emitted in the given block.
+  Event createEvent(const Address& address, const Address& from, const uint64_t& height, const uint64_t& logIndex) {
+    Event event("Transfer", address, std::make_tuple(
+      EventParam<Address, true>(from), EventParam<uint256_t, false>(uint256_t(1000))
+    ));
+    event.setStateData(logIndex, Hash::random(), 0, Hash::random(), height);
+    return event;
+  }
+
+  // Options like SDKTestSuite's defaults, but with a small log cap.
+  std::unique_ptr<Options> createOptions(const std::string& sdkPath, const uint64_t& eventLogCap) {
+    const std::vector<PrivKey> validatorPrivKeys {
+      PrivKey(Hex::toBytes("0x0a0415d68a5ec2df57aab65efc2a7231b59b029bae7ff1bd2e40df9af96418c8")),
+      PrivKey(Hex::toBytes("0xb254f12b4ca3f0120f305cabf1188fe74f0bd38e58c932a3df79c4c55df8fa66")),
+      PrivKey(Hex::toBytes("0x8a52bb289198f0bcf141688a8a899bf1f04a02b003a8b1aa3672b193ce7930da")),
+      PrivKey(Hex::toBytes("0x9048f5e80549e244b7899e85a4ef69512d7d68613a3dba828266736a580e7745")),
+      PrivKey(Hex::toBytes("0x0b6f5ad26f6eb79116da8c98bed5f3ed12c020611777d4de94c3c23b9a03f739")),
+      PrivKey(Hex::toBytes("0xa69eb3a3a679e7e4f6a49fb183fb2819b7ab62f41c341e2e2cc6288ee22fbdc7")),
+      PrivKey(Hex::toBytes("0xd9b0613b7e4ccdb0f3a5ab0956edeb210d678db306ab6fae1e2b0c9ebca1c2c5")),
+      PrivKey(Hex::toBytes("0x426dc06373b694d8804d634a0fd133be18e4e9bcbdde099fce0ccf3cb965492f"))
+    };
+    uint64_t genesisTimestamp = 1678887538000000;
+    PrivKey genesisSigner(Hex::toBytes("0x0a0415d68a5ec2df57aab65efc2a7231b59b029bae7ff1bd2e40df9af96418c8"));
+    Block genesis(Hash(), 0, 0);
+    genesis.finalize(genesisSigner, genesisTimestamp);
+    std::vector<std::pair<boost::asio::ip::address, uint64_t>> discoveryNodes;
+    std::vector<std::pair<Address,uint256_t>> genesisBalances = {{Address(Hex::toBytes("0x00dead00665771855a34155f5e7405489df2c3c6")), uint256_t("1000000000000000000000")}};
+    std::vector<Address> genesisValidators;
+    for (const auto& privKey : validatorPrivKeys) {
+      genesisValidators.push_back(Secp256k1::toAddress(Secp256k1::toUPub(privKey)));
+    }
+    return std::make_unique<Options>(
+      sdkPath,
+      "OrbiterSDK/cpp/linux_x86-64/0.2.0",
+      1,
+      8080,
+      Address(Hex::toBytes("0x00dead00665771855a34155f5e7405489df2c3c6")),
+      8080,
+      9999,
+      2000,
+      eventLogCap,
+      discoveryNodes,
+      genesis,
+      genesisTimestamp,
+      genesisSigner,
+      genesisBalances,
+      genesisValidators
+    );
+  }
+
+  TEST_CASE("FilterRegistry Class", "[net][http][filters]") {
+    SECTION("FilterRegistry returns only the new changes") {
+      FilterRegistry filters(noState, RPCOptions());
+      std::string txFilter = filters.newFilter(PENDING_TX_FILTER);
+      std::string blockFilter = filters.newFilter(BLOCK_FILTER);
+      Hash tx1(Utils::randBytes(32));
+      Hash tx2(Utils::randBytes(32));
+      filters.onNewTx(tx1);
+      filters.onNewTx(tx2);
+      json changes = filters.getChanges(txFilter);
+      REQUIRE(changes == json({tx1.hex(true).get(), tx2.hex(true).get()}));
+      REQUIRE(filters.getChanges(txFilter).empty());
+      Hash tx3(Utils::randBytes(32));
+      filters.onNewTx(tx3);
+      REQUIRE(filters.getChanges(txFilter) == json({tx3.hex(true).get()}));
+      REQUIRE(filters.getChanges(blockFilter).empty());
+      REQUIRE_THROWS(filters.getLogFilter(txFilter));
+    }
+
+    SECTION("FilterRegistry uninstall") {
+      FilterRegistry filters(noState, RPCOptions());
+      std::string id = filters.newFilter(PENDING_TX_FILTER);
+      REQUIRE(filters.uninstall(id));
+      REQUIRE(!filters.uninstall(id));
+      REQUIRE_THROWS(filters.getChanges(id));
+    }
+
+    SECTION("FilterRegistry limits") {
+      RPCOptions options;
+      options.maxFilters = 2;
+      options.maxFilterChanges = 3;
+      FilterRegistry filters(noState, options);
+      std::string id = filters.newFilter(PENDING_TX_FILTER);
+      filters.newFilter(BLOCK_FILTER);
+      REQUIRE_THROWS(filters.newFilter(BLOCK_FILTER));
+      // A filter that isn't polled while changes pile up is uninstalled
+      for (int i = 0; i < 4; i++) filters.onNewTx(Hash(Utils::randBytes(32)));
+      REQUIRE_THROWS(filters.getChanges(id));
+      REQUIRE_NOTHROW(filters.newFilter(BLOCK_FILTER));
+    }
+
+    SECTION("FilterRegistry log filters") {
+      FilterRegistry filters(noState, RPCOptions());
+      const Address contract(Utils::randBytes(20));
+      const Address other(Utils::randBytes(20));
+      const Address from(Utils::randBytes(20));
+      const Hash fromTopic = ABI::EventEncoder::encodeTopicSignature(from);
+      std::string addressFilter = filters.newLogFilter(LogFilter::fromJson({{"address", contract.hex(true).get()}}), 0, UINT64_MAX);
+      std::string topicFilter = filters.newLogFilter(LogFilter::fromJson({{"topics", {nullptr, fromTopic.hex(true).get()}}}), 0, UINT64_MAX);
+      std::string rangeFilter = filters.newLogFilter(LogFilter::fromJson(json::object()), 2, 3);
+
+      std::vector<std::vector<Event>> blockEvents;
+      for (uint64_t height = 1; height <= 4; height++) {
+        std::vector<Event> events = {
+          createEvent(contract, Address(Utils::randBytes(20)), height, 0),
+          createEvent(other, from, height, 1),
+          createEvent(other, Address(Utils::randBytes(20)), height, 2)
+        };
+        filters.onNewBlock(std::make_shared<const Block>(Hash(), 0, height), events);
+        blockEvents.push_back(std::move(events));
+      }
+
+      // Only the events of the contract
+      json changes = filters.getChanges(addressFilter);
+      REQUIRE(changes.size() == 4);
+      for (uint64_t i = 0; i < 4; i++) REQUIRE(changes[i] == json::parse(blockEvents[i][0].serializeForRPC()));
+      // Only the events with the sender topic, from any address
+      changes = filters.getChanges(topicFilter);
+      REQUIRE(changes.size() == 4);
+      for (uint64_t i = 0; i < 4; i++) REQUIRE(changes[i] == json::parse(blockEvents[i][1].serializeForRPC()));
+      // Every event of the blocks within the range, in order
+      changes = filters.getChanges(rangeFilter);
+      REQUIRE(changes.size() == 6);
+      for (uint64_t i = 0; i < 6; i++) REQUIRE(changes[i] == json::parse(blockEvents[1 + i / 3][i % 3].serializeForRPC()));
+      REQUIRE(filters.getChanges(rangeFilter).empty());
+
+      auto [criteria, fromBlock, toBlock] = filters.getLogFilter(rangeFilter);
+      REQUIRE(fromBlock == 2);
+      REQUIRE(toBlock == 3);
+      REQUIRE(criteria.addresses.empty());
+      REQUIRE(criteria.topics.empty());
+    }
+
+    SECTION("eth_getFilterLogs checks the criteria before the log cap") {
+      auto options = createOptions(Utils::getTestDumpPath() + "/filtersGetFilterLogs", 3);
+      SDKTestSuite sdk(Utils::getTestDumpPath() + "/filtersGetFilterLogs", {}, options);
+      Address contract = sdk.deployContract<SimpleContract>(
+        std::string("TestName"), uint256_t(19283187581), std::make_tuple(std::string("TupleName"), uint256_t(987654321))
+      );
+      Address otherContract = sdk.deployContract<SimpleContract>(
+        std::string("TestName"), uint256_t(19283187581), std::make_tuple(std::string("TupleName"), uint256_t(987654321))
+      );
+      // More events than the cap from one contract, then a single one from the other
+      for (uint64_t i = 0; i < 5; i++) sdk.callFunction(contract, &SimpleContract::setValue, uint256_t(i));
+      sdk.callFunction(otherContract, &SimpleContract::setValue, uint256_t(1234));
+
+      FilterRegistry filters(sdk.getState(), RPCOptions());
+      // Two addresses, so the State can't narrow down the search by address
+      std::string id = filters.newLogFilter(LogFilter::fromJson({{"address", {
+        otherContract.hex(true).get(), Address(Utils::randBytes(20)).hex(true).get()
+      }}}), 0, UINT64_MAX);
+      json logs = JsonRPC::Encoding::eth_getFilterLogs(id, filters, sdk.getStorage(), sdk.getState(), sdk.getOptions());
+      REQUIRE(logs["result"].size() == 1);
+      REQUIRE(logs["result"][0]["address"] == otherContract.hex(true).get());
+
+      // The cap still applies to the matching events
+      id = filters.newLogFilter(LogFilter::fromJson({{"address", contract.hex(true).get()}}), 0, UINT64_MAX);
+      logs = JsonRPC::Encoding::eth_getFilterLogs(id, filters, sdk.getStorage(), sdk.getState(), sdk.getOptions());
+      REQUIRE(logs["result"].size() == 3);
+
+      // Blocks outside the filter range are left out
+      id = filters.newLogFilter(LogFilter::fromJson({{"address", {
+        otherContract.hex(true).get(), contract.hex(true).get()
+      }}}), sdk.getStorage()->latest()->getNHeight(), UINT64_MAX);
+      logs = JsonRPC::Encoding::eth_getFilterLogs(id, filters, sdk.getStorage(), sdk.getState(), sdk.getOptions());
+      REQUIRE(logs["result"].size() == 1);
+      REQUIRE(logs["result"][0]["address"] == otherContract.hex(true).get());
+      REQUIRE(JsonRPC::Encoding::eth_getFilterLogs(filters.newFilter(BLOCK_FILTER), filters,
+        sdk.getStorage(), sdk.getState(), sdk.getOptions())["error"]["code"] == -32000
+      );
+    }
+
+    SECTION("FilterRegistry timeout") {
+      RPCOptions options;
+      options.filterTimeout = 0;
+      FilterRegistry filters(noState, options);
+      std::string id = filters.newFilter(PENDING_TX_FILTER);
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      REQUIRE_THROWS(filters.getChanges(id));
+    }
+  }
+}
@@ -12,6 +12,10 @@ See the LICENSE.txt file in the project root for more information.
 #include "../../src/net/http/httpserver.h"
 #include "../../src/core/state.h"
 #include "../../src/core/storage.h"
+#include "../../src/net/http/jsonrpc/encoding.h"
+#include "../../src/utils/tracer.h"
+#include "../../src/contract/templates/simplecontract.h"
+#include "../../sdktestsuite.hpp"
 
 std::string makeHTTPRequest(
   const std::string& reqBody, const std::string& host, const std::string& port,
@@ -176,6 +180,41 @@ json requestMethod(std::string method, T params) {
 }
 
 namespace THTTPJsonRPC{
+  // Options like SDKTestSuite's defaults, but with the given log cap and RPC options.
+  std::unique_ptr<Options> createOptions(
+    const std::string& sdkPath, const uint64_t& eventLogCap, const RPCOptions& rpcOptions = RPCOptions()
+  ) {
+    uint64_t genesisTimestamp = 1678887538000000;
+    PrivKey genesisSigner(Hex::toBytes("0x0a0415d68a5ec2df57aab65efc2a7231b59b029bae7ff1bd2e40df9af96418c8"));
+    Block genesis(Hash(), 0, 0);
+    genesis.finalize(genesisSigner, genesisTimestamp);
+    std::vector<std::pair<boost::asio::ip::address, uint64_t>> discoveryNodes;
+    std::vector<std::pair<Address,uint256_t>> genesisBalances = {{Address(Hex::toBytes("0x00dead00665771855a34155f5e7405489df2c3c6")), uint256_t("1000000000000000000000")}};
+    std::vector<Address> genesisValidators;
+    for (const auto& privKey : validatorPrivKeys) {
+      genesisValidators.push_back(Secp256k1::toAddress(Secp256k1::toUPub(privKey)));
+    }
+    return std::make_unique<Options>(
+      sdkPath,
+      "OrbiterSDK/cpp/linux_x86-64/0.2.0",
+      1,
+      8080,
+      Address(Hex::toBytes("0x00dead00665771855a34155f5e7405489df2c3c6")),
+      8080,
+      9999,
+      2000,
+      eventLogCap,
+      discoveryNodes,
+      genesis,
+      genesisTimestamp,
+      genesisSigner,
+      genesisBalances,
+      genesisValidators,
+      BlockBuilderOptions(),
+      rpcOptions
+    );
+  }
+
   TEST_CASE("HTTPJsonRPC Tests", "[net][http][jsonrpc]") {
     SECTION("HTTPJsonRPC") {
       /// One section to lead it all
@@ -326,6 +365,14 @@ namespace THTTPJsonRPC{
         REQUIRE(txJson["s"] == Hex::fromBytes(Utils::uintToBytes(tx.getS()),true).forRPC());
       }
 
+      // The second time the block is served from the response cache, only the id changes
+      json cachedBlockResponse = json::parse(makeHTTPRequest(
+        json({{"jsonrpc", "2.0"}, {"id", "cached"}, {"method", "eth_getBlockByNumber"}, {"params", json::array({"0x1", true})}}).dump(),
+        "127.0.0.1", std::to_string(8081), "/", "POST", "application/json"
+      ));
+      REQUIRE(cachedBlockResponse["id"] == "cached");
+      REQUIRE(cachedBlockResponse["result"] == eth_getBlockByNumberResponse["result"]);
+
       json eth_getBlockTransactionCountByHashResponse = requestMethod("eth_getBlockTransactionCountByHash", json::array({newBestBlock.hash().hex(true)}));
       REQUIRE(eth_getBlockTransactionCountByHashResponse["result"] == Hex::fromBytes(Utils::uintToBytes(uint64_t(transactions.size())),true).forRPC());
 
@@ -455,6 +502,128 @@ namespace THTTPJsonRPC{
         REQUIRE(eth_getTransactionReceiptResponse["result"]["root"] == Hash().hex(true));
         REQUIRE(eth_getTransactionReceiptResponse["result"]["status"] == "0x1");
       }
+
+      /// Batch requests are answered in order, and each response keeps its own id
+      json batch = json::array();
+      batch.push_back({{"jsonrpc", "2.0"}, {"id", 1}, {"method", "eth_blockNumber"}, {"params", json::array()}});
+      batch.push_back({{"jsonrpc", "2.0"}, {"id", "two"}, {"method", "web3_clientVersion"}, {"params", json::array()}});
+      batch.push_back({{"jsonrpc", "2.0"}, {"id", 3}, {"method", "eth_doesNotExist"}, {"params", json::array()}});
+      batch.push_back(42);
+      for (const auto& [privkey, val] : randomAccounts) {
+        if (batch.size() == options->getRPCOptions().maxBatchSize) break;
+        Address me = Secp256k1::toAddress(Secp256k1::toUPub(privkey));
+        batch.push_back({{"jsonrpc", "2.0"}, {"id", batch.size()}, {"method", "eth_getBalance"}, {"params", json::array({me.hex(true), "latest"})}});
+      }
+      json batchResponse = json::parse(makeHTTPRequest(batch.dump(), "127.0.0.1", std::to_string(8081), "/", "POST", "application/json"));
+      REQUIRE(batchResponse.is_array());
+      REQUIRE(batchResponse.size() == batch.size());
+      REQUIRE(batchResponse[0]["id"] == 1);
+      REQUIRE(batchResponse[0]["result"] == "0x1");
+      REQUIRE(batchResponse[1]["id"] == "two");
+      REQUIRE(batchResponse[1]["result"] == "OrbiterSDK/cpp/linux_x86-64/0.2.0");
+      REQUIRE(batchResponse[2]["id"] == 3);
+      REQUIRE(batchResponse[2]["error"]["code"] == -32601);
+      REQUIRE(batchResponse[3]["error"]["code"] == -32600);
+      uint64_t index = 4;
+      for (const auto& [privkey, val] : randomAccounts) {
+        if (index == batchResponse.size()) break;
+        REQUIRE(batchResponse[index]["id"] == index);
+        REQUIRE(batchResponse[index]["result"] == Hex::fromBytes(Utils::uintToBytes(val.first), true).forRPC());
+        index++;
+      }
+
+      /// Empty and oversized batches are rejected as a whole
+      json emptyBatchResponse = json::parse(makeHTTPRequest("[]", "127.0.0.1", std::to_string(8081), "/", "POST", "application/json"));
+      REQUIRE(emptyBatchResponse["error"]["code"] == -32600);
+      json bigBatch = json::array();
+      for (uint64_t i = 0; i <= options->getRPCOptions().maxBatchSize; i++) {
+        bigBatch.push_back({{"jsonrpc", "2.0"}, {"id", i}, {"method", "eth_blockNumber"}, {"params", json::array()}});
+      }
+      json bigBatchResponse = json::parse(makeHTTPRequest(bigBatch.dump(), "127.0.0.1", std::to_string(8081), "/", "POST", "application/json"));
+      REQUIRE(bigBatchResponse.is_object());
+      REQUIRE(bigBatchResponse["error"]["code"] == -32600);
+
+      /// Filters only return what happened since they were last polled
+      json eth_newBlockFilterResponse = requestMethod("eth_newBlockFilter", json::array());
+      REQUIRE(eth_newBlockFilterResponse["result"].is_string());
+      std::string blockFilter = eth_newBlockFilterResponse["result"].get<std::string>();
+      json eth_getFilterChangesResponse = requestMethod("eth_getFilterChanges", json::array({blockFilter}));
+      REQUIRE(eth_getFilterChangesResponse["result"] == json::array());
+      json eth_uninstallFilterResponse = requestMethod("eth_uninstallFilter", json::array({blockFilter}));
+      REQUIRE(eth_uninstallFilterResponse["result"] == true);
+      eth_getFilterChangesResponse = requestMethod("eth_getFilterChanges", json::array({blockFilter}));
+      REQUIRE(eth_getFilterChangesResponse["error"]["code"] == -32000);
+
+      /// Block receipts match the receipts of each transaction
+      json eth_getBlockReceiptsResponse = requestMethod("eth_getBlockReceipts", json::array({"0x1"}));
+      REQUIRE(eth_getBlockReceiptsResponse["result"].size() == transactions.size());
+      for (uint64_t i = 0; i < transactions.size(); i++) {
+        json eth_getTransactionReceiptResponse = requestMethod("eth_getTransactionReceipt", json::array({transactions[i].hash().hex(true)}));
+        REQUIRE(eth_getBlockReceiptsResponse["result"][i] == eth_getTransactionReceiptResponse["result"]);
+      }
+      eth_getBlockReceiptsResponse = requestMethod("eth_getBlockReceipts", json::array({newBestBlock.hash().hex(true)}));
+      REQUIRE(eth_getBlockReceiptsResponse["result"].size() == transactions.size());
+
+      /// Fee history covers the requested blocks, plus the base fee of the next one
+      json eth_feeHistoryResponse = requestMethod("eth_feeHistory", json::array({"0x2", "latest", json::array({25, 75})}));
+      REQUIRE(eth_feeHistoryResponse["result"]["oldestBlock"] == "0x0");
+      REQUIRE(eth_feeHistoryResponse["result"]["baseFeePerGas"].size() == 3);
+      REQUIRE(eth_feeHistoryResponse["result"]["gasUsedRatio"].size() == 2);
+      REQUIRE(eth_feeHistoryResponse["result"]["reward"].size() == 2);
+      REQUIRE(eth_feeHistoryResponse["result"]["reward"][1].size() == 2);
+      json eth_maxPriorityFeePerGasResponse = requestMethod("eth_maxPriorityFeePerGas", json::array());
+      REQUIRE(eth_maxPriorityFeePerGasResponse["result"].is_string());
+
+      /// Dumping the trace is off unless explicitly enabled
+      json debug_dumpTraceResponse = requestMethod("debug_dumpTrace", json::array());
+      REQUIRE(debug_dumpTraceResponse["error"]["code"] == -32000);
+    }
+  }
+
+  TEST_CASE("HTTPJsonRPC Log Queries", "[net][http][jsonrpc]") {
+    SECTION("eth_getBlockReceipts ignores the log cap") {
+      auto options = createOptions(Utils::getTestDumpPath() + "/HTTPjsonRPCGetBlockReceipts", 0);
+      SDKTestSuite sdk(Utils::getTestDumpPath() + "/HTTPjsonRPCGetBlockReceipts", {}, options);
+      Address contract = sdk.deployContract<SimpleContract>(
+        std::string("TestName"), uint256_t(19283187581), std::make_tuple(std::string("TupleName"), uint256_t(987654321))
+      );
+      sdk.callFunction(contract, &SimpleContract::setValues, std::vector<uint256_t>{1, 2, 3});
+      uint64_t height = sdk.getStorage()->latest()->getNHeight();
+      // With a cap of zero, range queries return nothing at all
+      REQUIRE(sdk.getState()->getEvents(height, height, Address(), {}).empty());
+      json receipts = JsonRPC::Encoding::eth_getBlockReceipts(height, sdk.getStorage(), sdk.getState());
+      REQUIRE(receipts["result"].size() == 1);
+      REQUIRE(receipts["result"][0]["logs"].size() == 1);
+      REQUIRE(json::parse(receipts["result"][0]["logs"][0].get<std::string>())["address"] == contract.hex(true).get());
+    }
+  }
+
+  TEST_CASE("HTTPJsonRPC debug_dumpTrace", "[net][http][jsonrpc]") {
+    const std::string path = Utils::getTestDumpPath() + "/HTTPjsonRPCDumpTrace";
+    RPCOptions rpcOptions;
+    rpcOptions.traceFile = path + "/trace.json";
+
+    SECTION("debug_dumpTrace needs enableDumpTrace") {
+      // A trace file alone doesn't expose the method
+      std::filesystem::remove(rpcOptions.traceFile);
+      json response = JsonRPC::Encoding::debug_dumpTrace(createOptions(path, 10000, rpcOptions));
+      REQUIRE(response["error"]["code"] == -32000);
+      REQUIRE(!response.contains("result"));
+      REQUIRE(!std::filesystem::exists(rpcOptions.traceFile));
+    }
+
+    SECTION("debug_dumpTrace writes the trace file") {
+      rpcOptions.enableDumpTrace = true;
+      auto options = createOptions(path, 10000, rpcOptions);
+      Tracer::clear();
+      Tracer::setEnabled(true);
+      { TraceSpan span("dumpTrace"); }
+      Tracer::setEnabled(false);
+      json response = JsonRPC::Encoding::debug_dumpTrace(options);
+      REQUIRE(response["result"]["file"] == rpcOptions.traceFile);
+      REQUIRE(response["result"]["events"] == 1);
+      REQUIRE(std::filesystem::exists(rpcOptions.traceFile));
+      std::filesystem::remove(rpcOptions.traceFile);
     }
   }
 }
@@ -0,0 +1,194 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include <regex>
+
+#include "../../src/libs/catch2/catch_amalgamated.hpp"
+#include "../../src/net/http/jsonrpc/decoding.h"
+#include "../../src/net/http/jsonrpc/encoding.h"
+#include "../../src/core/storage.h"
+
+namespace TJsonRPCDecoding {
+  // The regexes the decoders used before, kept as a reference for the validators
+  const std::regex hashFilter("^0x[0-9a-fA-F]{64}$");
+  const std::regex lowerHashFilter("^0x[0-9a-f]{64}$");
+  const std::regex addFilter("^0x[0-9a-fA-F]{40}$");
+  const std::regex numFilter("^0x([1-9a-f]+[0-9a-f]*|0)$");
+
+  // Block tags are "latest", so the decoders never touch the storage
+  const std::unique_ptr<Storage> noStorage = nullptr;
+
+  const std::string balanceRequest =
+    R"({"jsonrpc":"2.0","id":1,"method":"eth_getBalance","params":["0x8eeDb88A5Db6b5F2B5C1fE23c2A2e1b7B1DE4B2d","latest"]})";
+  const std::string callRequest =
+    R"({"jsonrpc":"2.0","id":1,"method":"eth_call","params":[{"from":"0x8eeDb88A5Db6b5F2B5C1fE23c2A2e1b7B1DE4B2d",)"
+    R"("to":"0x5B41CEf7F46A4a147e31150c3c5fFD077e54d0e1","gas":"0x5208","value":"0x0",)"
+    R"("data":"0x70a082310000000000000000000000008eedb88a5db6b5f2b5c1fe23c2a2e1b7b1de4b2d"},"latest"]})";
+
+  TEST_CASE("JsonRPC Decoding Validators", "[net][http][jsonrpc][decoding]") {
+    SECTION("isHexBytes matches the old filters") {
+      const std::vector<std::string> inputs = {
+        "", "0x", "0X" + std::string(40, 'a'), "0x" + std::string(40, 'a'), "0x" + std::string(40, 'A'),
+        "0x" + std::string(39, 'a'), "0x" + std::string(41, 'a'), "0x" + std::string(39, 'a') + "g",
+        "0x" + std::string(64, 'f'), "0x" + std::string(64, 'F'), "0x" + std::string(63, 'f') + " ",
+        "0x" + std::string(64, '0'), "0x" + std::string(63, '0') + "x", Hash::random().hex(true).get(),
+        Address(Utils::randBytes(20)).hex(true).get(), std::string(66, '0')
+      };
+      for (const std::string& input : inputs) {
+        REQUIRE(JsonRPC::Decoding::isHexBytes(input, 32) == std::regex_match(input, hashFilter));
+        REQUIRE(JsonRPC::Decoding::isHexBytes(input, 32, true) == std::regex_match(input, lowerHashFilter));
+        REQUIRE(JsonRPC::Decoding::isHexBytes(input, 20) == std::regex_match(input, addFilter));
+      }
+    }
+
+    SECTION("isHexQuantity matches the old filter") {
+      const std::vector<std::string> inputs = {
+        "", "0x", "0x0", "0x00", "0x01", "0x1", "0x10", "0xa", "0xA", "0xff", "0xfF",
+        "0x400", "0x0400", "0xg", "1x1", "0x1 ", "0xdeadbeef", "0xdeadbeefdeadbeefdeadbeef"
+      };
+      for (const std::string& input : inputs) {
+        REQUIRE(JsonRPC::Decoding::isHexQuantity(input) == std::regex_match(input, numFilter));
+      }
+    }
+
+    SECTION("Decoding reads params in place") {
+      json balance = json::parse(balanceRequest);
+      REQUIRE(JsonRPC::Decoding::getMethod(balance) == JsonRPC::Methods::eth_getBalance);
+      REQUIRE(JsonRPC::Decoding::eth_getBalance(balance, noStorage) == Address(Hex::toBytes("0x8eeDb88A5Db6b5F2B5C1fE23c2A2e1b7B1DE4B2d")));
+      json call = json::parse(callRequest);
+      auto [from, to, gas, gasPrice, value, functor, data] = JsonRPC::Decoding::eth_call(call, noStorage);
+      REQUIRE(to == Address(Hex::toBytes("0x5B41CEf7F46A4a147e31150c3c5fFD077e54d0e1")));
+      REQUIRE(gas == 21000);
+      REQUIRE(functor == Functor(Hex::toBytes("0x70a08231")));
+      REQUIRE(data.size() == 32);
+      call["params"][0].erase("to");
+      REQUIRE_THROWS(JsonRPC::Decoding::eth_call(call, noStorage));
+    }
+
+    SECTION("SAX decoding matches the json decoders") {
+      JsonRPC::Decoding::ParsedRequest balance;
+      REQUIRE(JsonRPC::Decoding::parseRequest(balanceRequest, balance));
+      REQUIRE(balance.method == JsonRPC::Methods::eth_getBalance);
+      REQUIRE(balance.name == "eth_getBalance");
+      REQUIRE(balance.id == json(1));
+      REQUIRE(JsonRPC::Decoding::eth_getBalance(balance, noStorage)
+        == JsonRPC::Decoding::eth_getBalance(json::parse(balanceRequest), noStorage));
+
+      // Null fields are skipped, just like missing ones
+      std::string nullGasPrice = callRequest;
+      nullGasPrice.replace(nullGasPrice.find(R"("gas":)"), 0, R"("gasPrice":null,)");
+      for (const std::string& body : {callRequest, nullGasPrice}) {
+        JsonRPC::Decoding::ParsedRequest call;
+        REQUIRE(JsonRPC::Decoding::parseRequest(body, call));
+        REQUIRE(call.method == JsonRPC::Methods::eth_call);
+        REQUIRE(JsonRPC::Decoding::eth_call(call, noStorage)
+          == JsonRPC::Decoding::eth_call(json::parse(body), noStorage));
+      }
+
+      JsonRPC::Decoding::ParsedRequest ids;
+      REQUIRE(JsonRPC::Decoding::parseRequest(
+        R"({"id":"abc","jsonrpc":"2.0","params":["0x8eeDb88A5Db6b5F2B5C1fE23c2A2e1b7B1DE4B2d","latest"],"method":"eth_getBalance"})", ids
+      ));
+      REQUIRE(ids.id == json("abc"));
+      JsonRPC::Decoding::ParsedRequest noId;
+      REQUIRE(JsonRPC::Decoding::parseRequest(
+        R"({"jsonrpc":"2.0","method":"eth_getBalance","params":["0x8eeDb88A5Db6b5F2B5C1fE23c2A2e1b7B1DE4B2d","latest"]})", noId
+      ));
+      REQUIRE(noId.id.is_null());
+
+      // Invalid values are still decoded, the decoders throw the same errors as the json ones
+      JsonRPC::Decoding::ParsedRequest badAddress;
+      REQUIRE(JsonRPC::Decoding::parseRequest(
+        R"({"jsonrpc":"2.0","id":1,"method":"eth_getBalance","params":["0x1234","latest"]})", badAddress
+      ));
+      REQUIRE_THROWS(JsonRPC::Decoding::eth_getBalance(badAddress, noStorage));
+    }
+
+    SECTION("SAX decoding leaves everything else to the json path") {
+      const std::vector<std::string> bodies = {
+        R"({"jsonrpc":"2.0","id":1,"method":"eth_blockNumber","params":[]})",
+        "[" + balanceRequest + "]",
+        balanceRequest.substr(0, balanceRequest.size() - 1),
+        balanceRequest + " {}",
+        R"({"jsonrpc":"1.0","id":1,"method":"eth_getBalance","params":["0x8eeDb88A5Db6b5F2B5C1fE23c2A2e1b7B1DE4B2d","latest"]})",
+        R"({"jsonrpc":"2.0","id":-1,"method":"eth_getBalance","params":["0x8eeDb88A5Db6b5F2B5C1fE23c2A2e1b7B1DE4B2d","latest"]})",
+        R"({"jsonrpc":"2.0","id":true,"method":"eth_getBalance","params":["0x8eeDb88A5Db6b5F2B5C1fE23c2A2e1b7B1DE4B2d","latest"]})",
+        R"({"jsonrpc":"2.0","id":1,"id":2,"method":"eth_getBalance","params":["0x8eeDb88A5Db6b5F2B5C1fE23c2A2e1b7B1DE4B2d","latest"]})",
+        R"({"jsonrpc":"2.0","id":1,"extra":0,"method":"eth_getBalance","params":["0x8eeDb88A5Db6b5F2B5C1fE23c2A2e1b7B1DE4B2d","latest"]})",
+        R"({"jsonrpc":"2.0","id":1,"method":"eth_getBalance","params":["0x8eeDb88A5Db6b5F2B5C1fE23c2A2e1b7B1DE4B2d"]})",
+        R"({"jsonrpc":"2.0","id":1,"method":"eth_getBalance","params":["0x8eeDb88A5Db6b5F2B5C1fE23c2A2e1b7B1DE4B2d",1]})",
+        R"({"jsonrpc":"2.0","id":1,"method":"eth_getBalance"})",
+        R"({"jsonrpc":"2.0","id":1,"method":"eth_call","params":{"to":"0x5B41CEf7F46A4a147e31150c3c5fFD077e54d0e1"}})",
+        R"({"jsonrpc":"2.0","id":1,"method":"eth_call","params":[{"from":"0x5B41CEf7F46A4a147e31150c3c5fFD077e54d0e1"}]})",
+        R"({"jsonrpc":"2.0","id":1,"method":"eth_call","params":[{"to":null}]})",
+        R"({"jsonrpc":"2.0","id":1,"method":"eth_call","params":[{"to":"0x5B41CEf7F46A4a147e31150c3c5fFD077e54d0e1","to":null}]})",
+        R"({"jsonrpc":"2.0","id":1,"method":"eth_call","params":[{"to":"0x5B41CEf7F46A4a147e31150c3c5fFD077e54d0e1","gas":21000}]})",
+        R"({"jsonrpc":"2.0","id":1,"method":"eth_call","params":["latest",{"to":"0x5B41CEf7F46A4a147e31150c3c5fFD077e54d0e1"}]})"
+      };
+      for (const std::string& body : bodies) {
+        JsonRPC::Decoding::ParsedRequest request;
+        REQUIRE_FALSE(JsonRPC::Decoding::parseRequest(body, request));
+      }
+    }
+
+    SECTION("Direct writers match the json responses") {
+      for (const json& id : {json(1), json("abc\"\n"), json(nullptr)}) {
+        json result;
+        result["jsonrpc"] = "2.0";
+        result["result"] = "0x1bc16d674ec80000";
+        result["id"] = id;
+        REQUIRE(JsonRPC::Encoding::writeResult("0x1bc16d674ec80000", id) == result.dump());
+        json error;
+        error["jsonrpc"] = "2.0";
+        error["error"]["code"] = -32000;
+        error["error"]["message"] = "Internal error: \"quoted\"";
+        error["id"] = id;
+        REQUIRE(JsonRPC::Encoding::writeError(-32000, "Internal error: \"quoted\"", id) == error.dump());
+      }
+    }
+  }
+
+  // Hidden benchmarks, run with `orbitersdkd-tests "[bench]"`.
+  // Requests per second per core is the inverse of the mean time of each benchmark.
+  TEST_CASE("JsonRPC Decoding Benchmarks", "[.][bench][net][http][jsonrpc]") {
+    const std::string address = "0x8eeDb88A5Db6b5F2B5C1fE23c2A2e1b7B1DE4B2d";
+    BENCHMARK("Address regex") { return std::regex_match(address, addFilter); };
+    BENCHMARK("Address validator") { return JsonRPC::Decoding::isHexBytes(address, 20); };
+    BENCHMARK("eth_getBalance request") {
+      json request = json::parse(balanceRequest);
+      JsonRPC::Decoding::checkJsonRPCSpec(request);
+      JsonRPC::Decoding::getMethod(request);
+      return JsonRPC::Decoding::eth_getBalance(request, noStorage);
+    };
+    BENCHMARK("eth_call request") {
+      json request = json::parse(callRequest);
+      JsonRPC::Decoding::checkJsonRPCSpec(request);
+      JsonRPC::Decoding::getMethod(request);
+      return JsonRPC::Decoding::eth_call(request, noStorage);
+    };
+    BENCHMARK("eth_getBalance request (SAX)") {
+      JsonRPC::Decoding::ParsedRequest request;
+      JsonRPC::Decoding::parseRequest(balanceRequest, request);
+      return JsonRPC::Decoding::eth_getBalance(request, noStorage);
+    };
+    BENCHMARK("eth_call request (SAX)") {
+      JsonRPC::Decoding::ParsedRequest request;
+      JsonRPC::Decoding::parseRequest(callRequest, request);
+      return JsonRPC::Decoding::eth_call(request, noStorage);
+    };
+    const json id = 1;
+    const std::string balance = "0x1bc16d674ec80000";
+    BENCHMARK("Response (json)") {
+      json ret;
+      ret["jsonrpc"] = "2.0";
+      ret["result"] = balance;
+      ret["id"] = id;
+      return ret.dump();
+    };
+    BENCHMARK("Response (direct writer)") { return JsonRPC::Encoding::writeResult(balance, id); };
+  }
+}
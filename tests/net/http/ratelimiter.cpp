@@ -0,0 +1,91 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include "../../src/libs/catch2/catch_amalgamated.hpp"
+#include "../../src/net/http/ratelimiter.h"
+
+namespace TRateLimiter {
+  /// Manually advanced clock, so the buckets can be tested without waiting.
+  struct TestClock {
+    std::shared_ptr<std::chrono::steady_clock::time_point> now = std::make_shared<std::chrono::steady_clock::time_point>();
+    std::chrono::steady_clock::time_point operator()() const { return *this->now; }
+    void advance(const std::chrono::milliseconds& ms) { *this->now += ms; }
+  };
+
+  TEST_CASE("RateLimiter Class", "[net][http][ratelimiter]") {
+    SECTION("RateLimiter disabled by default") {
+      RateLimiter limiter(RPCOptions{});
+      for (int i = 0; i < 10000; i++) REQUIRE(limiter.allow("127.0.0.1", 100));
+      REQUIRE(limiter.getBuckets() == 0);
+    }
+
+    SECTION("RateLimiter method costs") {
+      RateLimiter limiter(RPCOptions{});
+      REQUIRE(limiter.getMethodCost("eth_blockNumber") == 1);
+      REQUIRE(limiter.getMethodCost("eth_call") == 10);
+      REQUIRE(limiter.getMethodCost("eth_getLogs") == 20);
+      REQUIRE(limiter.getCost(json({{"jsonrpc", "2.0"}, {"method", "eth_getLogs"}, {"id", 1}})) == 20);
+      REQUIRE(limiter.getCost(json({{"jsonrpc", "2.0"}, {"method", 5}, {"id", 1}})) == 1);
+      REQUIRE(limiter.getCost(json::array()) == 1);
+    }
+
+    SECTION("RateLimiter token buckets") {
+      RPCOptions options;
+      options.rateLimit = 10;
+      options.rateLimitBurst = 20;
+      TestClock clock;
+      RateLimiter limiter(options, clock);
+      // A full bucket takes a burst, then the client has to wait for the refill
+      for (int i = 0; i < 20; i++) REQUIRE(limiter.allow("10.0.0.1", 1));
+      REQUIRE(!limiter.allow("10.0.0.1", 1));
+      // Other clients have their own buckets
+      REQUIRE(limiter.allow("10.0.0.2", 10));
+      REQUIRE(limiter.allow("10.0.0.2", 10));
+      REQUIRE(!limiter.allow("10.0.0.2", 10));
+      clock.advance(std::chrono::milliseconds(500)); // 5 tokens
+      REQUIRE(!limiter.allow("10.0.0.2", 10));
+      REQUIRE(limiter.allow("10.0.0.1", 5));
+      REQUIRE(!limiter.allow("10.0.0.1", 1));
+      // Buckets never hold more than the burst, and costs above it take the whole bucket
+      clock.advance(std::chrono::seconds(10));
+      REQUIRE(limiter.allow("10.0.0.1", 50));
+      REQUIRE(!limiter.allow("10.0.0.1", 1));
+      REQUIRE(limiter.getBuckets() == 2);
+      // Full buckets are dropped once the prune interval has passed
+      clock.advance(RateLimiter::pruneInterval);
+      REQUIRE(limiter.allow("10.0.0.3", 1));
+      REQUIRE(limiter.getBuckets() == 1);
+    }
+
+    SECTION("RateLimiter connection limits") {
+      RPCOptions options;
+      options.maxConnections = 3;
+      options.maxConnectionsPerPeer = 2;
+      RateLimiter limiter(options);
+      auto a1 = limiter.connect("10.0.0.1");
+      auto a2 = limiter.connect("10.0.0.1");
+      REQUIRE(a1 != nullptr);
+      REQUIRE(a2 != nullptr);
+      REQUIRE(a1->getPeer() == "10.0.0.1");
+      REQUIRE(limiter.connect("10.0.0.1") == nullptr); // Per-peer limit
+      auto b1 = limiter.connect("10.0.0.2");
+      REQUIRE(b1 != nullptr);
+      REQUIRE(limiter.connect("10.0.0.3") == nullptr); // Global limit
+      REQUIRE(limiter.getConnections() == 3);
+      REQUIRE(limiter.getConnections("10.0.0.1") == 2);
+      // Connections are released when the last session holding them is gone
+      auto a1Copy = a1;
+      a1.reset();
+      REQUIRE(limiter.getConnections("10.0.0.1") == 2);
+      a1Copy.reset();
+      REQUIRE(limiter.getConnections("10.0.0.1") == 1);
+      REQUIRE(limiter.getConnections() == 2);
+      REQUIRE(limiter.connect("10.0.0.3") != nullptr);
+      REQUIRE(limiter.getConnections("10.0.0.3") == 0); // Released right away, the result wasn't kept
+    }
+  }
+}
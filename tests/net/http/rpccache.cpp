@@ -0,0 +1,62 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include "../../src/libs/catch2/catch_amalgamated.hpp"
+#include "../../src/net/http/rpccache.h"
+
+namespace TRPCCache {
+  std::shared_ptr<const std::string> makeValue(const uint64_t& size, const char& c) {
+    return std::make_shared<const std::string>(size, c);
+  }
+
+  TEST_CASE("RPCCache Class", "[net][http][rpccache]") {
+    SECTION("RPCCache get and put") {
+      RPCCache cache(RPCOptions{});
+      REQUIRE(cache.get("a") == nullptr);
+      cache.put("a", makeValue(10, 'a'));
+      REQUIRE(*cache.get("a") == std::string(10, 'a'));
+      REQUIRE(cache.size() == 1);
+      REQUIRE(cache.bytes() == 11);
+      // Values never change, so the first one is kept
+      cache.put("a", makeValue(20, 'b'));
+      REQUIRE(*cache.get("a") == std::string(10, 'a'));
+      REQUIRE(cache.bytes() == 11);
+    }
+
+    SECTION("RPCCache evicts the least recently used entries") {
+      RPCOptions options;
+      options.cacheBytes = 33;
+      RPCCache cache(options);
+      cache.put("a", makeValue(10, 'a'));
+      cache.put("b", makeValue(10, 'b'));
+      cache.put("c", makeValue(10, 'c'));
+      REQUIRE(cache.bytes() == 33);
+      REQUIRE(cache.get("a") != nullptr); // "b" is now the least recently used
+      cache.put("d", makeValue(10, 'd'));
+      REQUIRE(cache.get("b") == nullptr);
+      REQUIRE(cache.get("a") != nullptr);
+      REQUIRE(cache.get("c") != nullptr);
+      REQUIRE(cache.get("d") != nullptr);
+      // A bigger entry takes the place of several smaller ones
+      cache.put("e", makeValue(20, 'e'));
+      REQUIRE(cache.size() == 2);
+      REQUIRE(cache.get("a") == nullptr);
+      REQUIRE(cache.get("c") == nullptr);
+      REQUIRE(cache.get("d") != nullptr);
+      REQUIRE(cache.get("e") != nullptr);
+    }
+
+    SECTION("RPCCache skips entries bigger than the budget") {
+      RPCOptions options;
+      options.cacheBytes = 0;
+      RPCCache cache(options);
+      cache.put("a", makeValue(10, 'a'));
+      REQUIRE(cache.get("a") == nullptr);
+      REQUIRE(cache.size() == 0);
+    }
+  }
+}
@@ -0,0 +1,50 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include <future>
+
+#include "../../src/libs/catch2/catch_amalgamated.hpp"
+#include "../../src/net/http/rpcworkerpool.h"
+
+namespace TRPCWorkerPool {
+  TEST_CASE("RPCWorkerPool Class", "[net][http][rpcworkerpool]") {
+    SECTION("RPCWorkerPool lanes") {
+      REQUIRE(RPCWorkerPool::getLane(JsonRPC::Methods::eth_call) == CALL_LANE);
+      REQUIRE(RPCWorkerPool::getLane(JsonRPC::Methods::eth_estimateGas) == CALL_LANE);
+      REQUIRE(RPCWorkerPool::getLane(JsonRPC::Methods::eth_getLogs) == LOGS_LANE);
+      REQUIRE(RPCWorkerPool::getLane(JsonRPC::Methods::eth_blockNumber) == FAST_LANE);
+      REQUIRE(RPCWorkerPool::getLane(json({{"jsonrpc", "2.0"}, {"id", 1}, {"method", "eth_getLogs"}})) == LOGS_LANE);
+      REQUIRE(RPCWorkerPool::getLane(json({{"jsonrpc", "2.0"}, {"id", 1}, {"method", "eth_doesNotExist"}})) == FAST_LANE);
+      REQUIRE(RPCWorkerPool::getLane(json({{"jsonrpc", "2.0"}, {"id", 1}, {"method", 42}})) == FAST_LANE);
+      REQUIRE(RPCWorkerPool::getLane(json(42)) == FAST_LANE);
+    }
+
+    SECTION("RPCWorkerPool slow lanes don't block the fast lane") {
+      RPCOptions options;
+      options.workerThreads = 1;
+      options.callThreads = 1;
+      options.logsThreads = 1;
+      RPCWorkerPool workers(options);
+      std::promise<void> release;
+      std::shared_future<void> released = release.get_future().share();
+      std::atomic<uint64_t> slowDone = 0;
+      // Fill the call and logs lanes with requests that wait to be released
+      for (int i = 0; i < 4; i++) {
+        workers.push(CALL_LANE, [released, &slowDone]{ released.wait(); slowDone++; });
+        workers.push(LOGS_LANE, [released, &slowDone]{ released.wait(); slowDone++; });
+      }
+      // Cheap requests are still executed
+      std::promise<void> fastDone;
+      workers.push(FAST_LANE, [&fastDone]{ fastDone.set_value(); });
+      REQUIRE(fastDone.get_future().wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+      REQUIRE(slowDone == 0);
+      release.set_value();
+      for (int i = 0; i < 500 && slowDone != 8; i++) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      REQUIRE(slowDone == 8);
+    }
+  }
+}
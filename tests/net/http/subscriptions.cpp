@@ -0,0 +1,48 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include "../../src/libs/catch2/catch_amalgamated.hpp"
+#include "../../src/net/http/subscriptions.h"
+
+namespace TSubscriptions {
+  TEST_CASE("LogFilter Struct", "[net][http][subscriptions]") {
+    const Address contract(Utils::randBytes(20));
+    const Address other(Utils::randBytes(20));
+    const Address from(Utils::randBytes(20));
+    const Event event("Transfer", contract, std::make_tuple(
+      EventParam<Address, true>(from), EventParam<uint256_t, false>(uint256_t(1000))
+    ));
+    const Hash signature = event.getTopics()[0];
+    const Hash fromTopic = ABI::EventEncoder::encodeTopicSignature(from);
+
+    SECTION("LogFilter empty filter matches everything") {
+      REQUIRE(LogFilter::fromJson(json::object()).matches(event));
+    }
+
+    SECTION("LogFilter addresses") {
+      REQUIRE(LogFilter::fromJson({{"address", contract.hex(true).get()}}).matches(event));
+      REQUIRE(!LogFilter::fromJson({{"address", other.hex(true).get()}}).matches(event));
+      REQUIRE(LogFilter::fromJson({{"address", {other.hex(true).get(), contract.hex(true).get()}}}).matches(event));
+    }
+
+    SECTION("LogFilter topics") {
+      REQUIRE(LogFilter::fromJson({{"topics", {signature.hex(true).get()}}}).matches(event));
+      REQUIRE(LogFilter::fromJson({{"topics", {nullptr, fromTopic.hex(true).get()}}}).matches(event));
+      REQUIRE(LogFilter::fromJson({{"topics", {nullptr, {Hash().hex(true).get(), fromTopic.hex(true).get()}}}}).matches(event));
+      REQUIRE(!LogFilter::fromJson({{"topics", {fromTopic.hex(true).get()}}}).matches(event));
+      // The event only has two topics
+      REQUIRE(!LogFilter::fromJson({{"topics", {nullptr, nullptr, fromTopic.hex(true).get()}}}).matches(event));
+    }
+
+    SECTION("LogFilter invalid filters") {
+      REQUIRE_THROWS(LogFilter::fromJson(json::array()));
+      REQUIRE_THROWS(LogFilter::fromJson({{"address", "0x1234"}}));
+      REQUIRE_THROWS(LogFilter::fromJson({{"topics", signature.hex(true).get()}}));
+      REQUIRE_THROWS(LogFilter::fromJson({{"topics", {nullptr, nullptr, nullptr, nullptr, nullptr}}}));
+    }
+  }
+}
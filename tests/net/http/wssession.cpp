@@ -0,0 +1,258 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include <set>
+
+#include "../../src/libs/catch2/catch_amalgamated.hpp"
+#include "../../src/utils/utils.h"
+#include "../../src/utils/options.h"
+#include "../../src/net/p2p/managernormal.h"
+#include "../../src/net/http/httpserver.h"
+#include "../../src/core/rdpos.h"
+#include "../../src/core/state.h"
+#include "../../src/core/storage.h"
+
+// Definition from state.cpp, when linking, the compiler should find the function.
+Block createValidBlock(std::unique_ptr<rdPoS>& rdpos, std::unique_ptr<Storage>& storage, const std::vector<TxBlock>& txs = {});
+
+namespace TWSSession {
+  const std::vector<Hash> validatorPrivKeys {
+    Hash(Hex::toBytes("0x0a0415d68a5ec2df57aab65efc2a7231b59b029bae7ff1bd2e40df9af96418c8")),
+    Hash(Hex::toBytes("0xb254f12b4ca3f0120f305cabf1188fe74f0bd38e58c932a3df79c4c55df8fa66")),
+    Hash(Hex::toBytes("0x8a52bb289198f0bcf141688a8a899bf1f04a02b003a8b1aa3672b193ce7930da")),
+    Hash(Hex::toBytes("0x9048f5e80549e244b7899e85a4ef69512d7d68613a3dba828266736a580e7745")),
+    Hash(Hex::toBytes("0x0b6f5ad26f6eb79116da8c98bed5f3ed12c020611777d4de94c3c23b9a03f739")),
+    Hash(Hex::toBytes("0xa69eb3a3a679e7e4f6a49fb183fb2819b7ab62f41c341e2e2cc6288ee22fbdc7")),
+    Hash(Hex::toBytes("0xd9b0613b7e4ccdb0f3a5ab0956edeb210d678db306ab6fae1e2b0c9ebca1c2c5")),
+    Hash(Hex::toBytes("0x426dc06373b694d8804d634a0fd133be18e4e9bcbdde099fce0ccf3cb965492f"))
+  };
+
+  std::string testDumpPath = Utils::getTestDumpPath();
+
+  // Same as the HTTP JSON-RPC tests, but with custom server limits.
+  void initialize(std::unique_ptr<DB>& db,
+                  std::unique_ptr<Storage>& storage,
+                  std::unique_ptr<P2P::ManagerNormal>& p2p,
+                  std::unique_ptr<rdPoS>& rdpos,
+                  std::unique_ptr<State>& state,
+                  std::unique_ptr<HTTPServer>& httpServer,
+                  std::unique_ptr<Options>& options,
+                  const RPCOptions& rpcOptions,
+                  uint64_t serverPort,
+                  uint64_t httpServerPort,
+                  std::string folderPath) {
+    std::string dbName = folderPath + "/db";
+    if (std::filesystem::exists(dbName)) std::filesystem::remove_all(dbName);
+    db = std::make_unique<DB>(dbName);
+    std::vector<std::pair<boost::asio::ip::address, uint64_t>> discoveryNodes;
+    PrivKey genesisPrivKey(Hex::toBytes("0xe89ef6409c467285bcae9f80ab1cfeb3487cfe61ab28fb7d36443e1daa0c2867"));
+    uint64_t genesisTimestamp = 1678887538000000;
+    Block genesis(Hash(), 0, 0);
+    genesis.finalize(genesisPrivKey, genesisTimestamp);
+    std::vector<std::pair<Address,uint256_t>> genesisBalances = {{Address(Hex::toBytes("0x00dead00665771855a34155f5e7405489df2c3c6")), uint256_t("1000000000000000000000")}};
+    std::vector<Address> genesisValidators;
+    for (const auto& privKey : validatorPrivKeys) {
+      genesisValidators.push_back(Secp256k1::toAddress(Secp256k1::toUPub(privKey)));
+    }
+    options = std::make_unique<Options>(
+      folderPath,
+      "OrbiterSDK/cpp/linux_x86-64/0.2.0",
+      1,
+      8080,
+      Address(Hex::toBytes("0x00dead00665771855a34155f5e7405489df2c3c6")),
+      serverPort,
+      httpServerPort,
+      2000,
+      10000,
+      discoveryNodes,
+      genesis,
+      genesisTimestamp,
+      genesisPrivKey,
+      genesisBalances,
+      genesisValidators,
+      BlockBuilderOptions(),
+      rpcOptions
+    );
+    storage = std::make_unique<Storage>(db, options);
+    p2p = std::make_unique<P2P::ManagerNormal>(boost::asio::ip::address::from_string("127.0.0.1"), rdpos, options, storage, state);
+    rdpos = std::make_unique<rdPoS>(db, storage, p2p, options, state);
+    state = std::make_unique<State>(db, storage, rdpos, p2p, options);
+    httpServer = std::make_unique<HTTPServer>(state, storage, p2p, options);
+  }
+
+  // Minimal synchronous WebSocket client.
+  class WSClient {
+    private:
+      boost::asio::io_context ioc_;
+      websocket::stream<tcp::socket> ws_;
+
+    public:
+      WSClient(uint16_t port, int receiveBufferSize = 0) : ws_(ioc_) {
+        this->ws_.next_layer().open(tcp::v4());
+        if (receiveBufferSize > 0) {
+          this->ws_.next_layer().set_option(net::socket_base::receive_buffer_size(receiveBufferSize));
+        }
+        this->ws_.next_layer().connect(tcp::endpoint(net::ip::address::from_string("127.0.0.1"), port));
+        this->ws_.handshake("127.0.0.1", "/");
+        this->ws_.text(true);
+      }
+
+      void write(const std::string& msg) { this->ws_.write(net::buffer(msg)); }
+
+      json read() {
+        beast::flat_buffer buf;
+        this->ws_.read(buf);
+        return json::parse(beast::buffers_to_string(buf.data()));
+      }
+
+      json request(const std::string& method, const json& params, const uint64_t& id) {
+        this->write(json({{"jsonrpc", "2.0"}, {"id", id}, {"method", method}, {"params", params}}).dump());
+        return this->read();
+      }
+
+      const websocket::close_reason& reason() const { return this->ws_.reason(); }
+  };
+
+  // Every transaction from the genesis account has to carry its current nonce,
+  // so distinct valid transactions only differ by recipient.
+  TxBlock createValidTx() {
+    PrivKey txPrivKey(Hex::toBytes("0xe89ef6409c467285bcae9f80ab1cfeb3487cfe61ab28fb7d36443e1daa0c2867"));
+    Address from = Secp256k1::toAddress(Secp256k1::toUPub(txPrivKey));
+    return TxBlock(Address(Utils::randBytes(20)), from, Bytes(), 8080, 0, 1000000000000000000, 1000000000, 1000000000, 21000, txPrivKey);
+  }
+
+  TEST_CASE("WSSession Class", "[net][http][wssession]") {
+    SECTION("eth_subscribe and eth_unsubscribe deliver State notifications") {
+      std::unique_ptr<DB> db;
+      std::unique_ptr<Storage> storage;
+      std::unique_ptr<P2P::ManagerNormal> p2p;
+      std::unique_ptr<rdPoS> rdpos;
+      std::unique_ptr<State> state;
+      std::unique_ptr<HTTPServer> httpServer;
+      std::unique_ptr<Options> options;
+      initialize(db, storage, p2p, rdpos, state, httpServer, options, RPCOptions(), 8130, 8131, testDumpPath + "/wsSessionSubscribe");
+      httpServer->start();
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      WSClient client(8131);
+
+      json txSubscription = client.request("eth_subscribe", {"newPendingTransactions"}, 1);
+      REQUIRE(txSubscription["id"] == 1);
+      REQUIRE(txSubscription["result"].is_string());
+      json headsSubscription = client.request("eth_subscribe", {"newHeads"}, 2);
+      REQUIRE(headsSubscription["id"] == 2);
+      REQUIRE(headsSubscription["result"].is_string());
+      REQUIRE(client.request("eth_subscribe", {"unknownType"}, 3)["error"]["code"] == -32602);
+
+      // A new mempool transaction reaches the newPendingTransactions subscription
+      auto tx = createValidTx();
+      REQUIRE(state->addTx(TxBlock(tx)) == TxInvalid::NotInvalid);
+      json txNotification = client.read();
+      REQUIRE(txNotification["method"] == "eth_subscription");
+      REQUIRE(txNotification["params"]["subscription"] == txSubscription["result"]);
+      REQUIRE(txNotification["params"]["result"] == tx.hash().hex(true).get());
+
+      // A new block reaches the newHeads subscription
+      auto block = createValidBlock(rdpos, storage);
+      Hash blockHash = block.hash();
+      REQUIRE(state->validateNextBlock(block));
+      state->processNextBlock(std::move(block));
+      json headNotification = client.read();
+      REQUIRE(headNotification["method"] == "eth_subscription");
+      REQUIRE(headNotification["params"]["subscription"] == headsSubscription["result"]);
+      REQUIRE(headNotification["params"]["result"]["hash"] == blockHash.hex(true).get());
+      REQUIRE(headNotification["params"]["result"]["number"] == "0x1");
+
+      // Unsubscribed, the next transaction isn't delivered
+      REQUIRE(client.request("eth_unsubscribe", {txSubscription["result"]}, 4)["result"] == true);
+      REQUIRE(client.request("eth_unsubscribe", {txSubscription["result"]}, 5)["result"] == false);
+      REQUIRE(state->addTx(createValidTx()) == TxInvalid::NotInvalid);
+      // Notifications are queued as soon as the State publishes them, so it would come before this response
+      json response = client.request("eth_blockNumber", json::array(), 6);
+      REQUIRE(response["id"] == 6);
+      REQUIRE(response["result"] == "0x1");
+
+      // Other requests go through the RPC workers, including batches
+      json batch = json::array({
+        {{"jsonrpc", "2.0"}, {"id", 7}, {"method", "eth_blockNumber"}, {"params", json::array()}},
+        {{"jsonrpc", "2.0"}, {"id", 8}, {"method", "eth_subscribe"}, {"params", {"newHeads"}}}
+      });
+      client.write(batch.dump());
+      json batchResponse = client.read();
+      REQUIRE(batchResponse.size() == 2);
+      REQUIRE(batchResponse[0]["result"] == "0x1");
+      REQUIRE(batchResponse[1]["error"]["code"] == -32601);
+      client.write("{not json");
+      REQUIRE(client.read()["error"]["code"] == -32700);
+    }
+
+    SECTION("Requests in flight are capped") {
+      std::unique_ptr<DB> db;
+      std::unique_ptr<Storage> storage;
+      std::unique_ptr<P2P::ManagerNormal> p2p;
+      std::unique_ptr<rdPoS> rdpos;
+      std::unique_ptr<State> state;
+      std::unique_ptr<HTTPServer> httpServer;
+      std::unique_ptr<Options> options;
+      RPCOptions rpcOptions;
+      rpcOptions.maxPipelinedRequests = 2;
+      initialize(db, storage, p2p, rdpos, state, httpServer, options, rpcOptions, 8132, 8133, testDumpPath + "/wsSessionInFlight");
+      httpServer->start();
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      WSClient client(8133);
+
+      // Reading resumes as requests are answered, so every request is eventually answered
+      for (uint64_t i = 0; i < 50; i++) {
+        client.write(json({{"jsonrpc", "2.0"}, {"id", i}, {"method", "eth_chainId"}, {"params", json::array()}}).dump());
+      }
+      std::set<uint64_t> answered;
+      for (uint64_t i = 0; i < 50; i++) {
+        json response = client.read();
+        REQUIRE(response["result"] == "0x1f90");
+        answered.insert(response["id"].get<uint64_t>());
+      }
+      REQUIRE(answered.size() == 50);
+    }
+
+    SECTION("Slow consumers are disconnected") {
+      std::unique_ptr<DB> db;
+      std::unique_ptr<Storage> storage;
+      std::unique_ptr<P2P::ManagerNormal> p2p;
+      std::unique_ptr<rdPoS> rdpos;
+      std::unique_ptr<State> state;
+      std::unique_ptr<HTTPServer> httpServer;
+      std::unique_ptr<Options> options;
+      RPCOptions rpcOptions;
+      rpcOptions.maxQueuedMessages = 8;
+      initialize(db, storage, p2p, rdpos, state, httpServer, options, rpcOptions, 8134, 8135, testDumpPath + "/wsSessionSlowConsumer");
+      httpServer->start();
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      // A small receive buffer, so the server can't write much while the client isn't reading
+      WSClient client(8135, 4096);
+      json subscription = client.request("eth_subscribe", {"newPendingTransactions"}, 1);
+      REQUIRE(subscription["result"].is_string());
+
+      // Publish far more notifications than the socket buffers can hold, without reading them
+      for (uint64_t i = 0; i < 100000; i++) httpServer->getSubscriptions().onNewTx(Hash::random());
+
+      // The client gets what was sent before the outbox filled up, then the close frame
+      uint64_t received = 0;
+      bool closed = false;
+      try {
+        while (true) {
+          json notification = client.read();
+          REQUIRE(notification["params"]["subscription"] == subscription["result"]);
+          received++;
+        }
+      } catch (boost::system::system_error& e) {
+        closed = (e.code() == websocket::error::closed);
+      }
+      REQUIRE(closed);
+      REQUIRE(client.reason().code == websocket::close_code::policy_error);
+      REQUIRE(received < 100000);
+    }
+  }
+}
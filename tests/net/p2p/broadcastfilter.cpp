@@ -0,0 +1,62 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include <thread>
+
+#include "../../src/libs/catch2/catch_amalgamated.hpp"
+#include "../../src/net/p2p/broadcastfilter.h"
+
+namespace TBroadcastFilter {
+  TEST_CASE("P2P BroadcastFilter", "[p2p][broadcastfilter]") {
+    SECTION("BroadcastFilter insert/contains") {
+      P2P::BroadcastFilter filter(1024);
+      REQUIRE(!filter.contains(12345));
+      REQUIRE(filter.insert(12345));
+      REQUIRE(filter.contains(12345));
+      REQUIRE(!filter.insert(12345));
+      REQUIRE(filter.size() == 1);
+      // Only contains() is counted, so each message is counted once
+      REQUIRE(filter.misses() == 1);
+      REQUIRE(filter.hits() == 1);
+    }
+
+    SECTION("BroadcastFilter never exceeds its capacity") {
+      P2P::BroadcastFilter filter(4800);
+      for (uint64_t i = 0; i < 100000; i++) filter.insert(i);
+      REQUIRE(filter.size() <= filter.capacity());
+      // The most recent IDs must still be remembered.
+      for (uint64_t i = 99900; i < 100000; i++) REQUIRE(filter.contains(i));
+    }
+
+    SECTION("BroadcastFilter rotates expired generations") {
+      P2P::BroadcastFilter filter(4800, std::chrono::milliseconds(10));
+      for (uint64_t i = 0; i < 100; i++) filter.insert(i);
+      // Every shard needs generationCount rotations to drop its oldest entries.
+      for (size_t round = 0; round < P2P::BroadcastFilter::generationCount; round++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        for (uint64_t i = 0; i < 10000; i++) filter.insert(1000000 + (round * 10000) + i);
+      }
+      for (uint64_t i = 0; i < 100; i++) REQUIRE(!filter.contains(i));
+    }
+
+    SECTION("BroadcastFilter concurrent inserts") {
+      P2P::BroadcastFilter filter(1 << 16);
+      std::atomic<uint64_t> firstInserts = 0;
+      std::vector<std::thread> threads;
+      for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&]() {
+          for (uint64_t i = 0; i < 1000; i++) if (filter.insert(i)) firstInserts++;
+        });
+      }
+      for (auto& thread : threads) thread.join();
+      REQUIRE(firstInserts == 1000);
+      REQUIRE(filter.size() == 1000);
+      REQUIRE(filter.misses() == 0);
+      REQUIRE(filter.hits() == 0);
+    }
+  }
+}
@@ -0,0 +1,87 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include "../../src/libs/catch2/catch_amalgamated.hpp"
+#include "../../src/net/p2p/encoding.h"
+#include "p2ptestutils.hpp"
+
+namespace TCompactBlock {
+  using P2PTestUtils::createTxs;
+
+  std::shared_ptr<const Block> createBlock(const std::vector<TxBlock>& txs) {
+    PrivKey blockValidatorPrivKey(Hex::toBytes("0x77ec0f8f28012de474dcd0b0a2317df22e188cec0a4cb0c9b760c845a23c9699"));
+    PrivKey txValidatorPrivKey(Hex::toBytes("53f3b164248c7aa5fe610208c0f785063e398fcb329a32ab4fbc9bd4d29b42db"));
+    Hash nPrevBlockHash(Hex::toBytes("0x7c9efc59d7bec8e79499a49915e0a655a3fff1d0609644d98791893afc67e64b"));
+    uint64_t timestamp = 1678464099412509;
+    uint64_t nHeight = 331653115;
+    Block block(nPrevBlockHash, timestamp, nHeight);
+    for (const auto& tx : txs) block.appendTx(tx);
+    Address validatorAddress = Secp256k1::toAddress(Secp256k1::toUPub(txValidatorPrivKey));
+    std::vector<Hash> randomSeeds;
+    for (int i = 0; i < 4; i++) randomSeeds.push_back(Hash::random());
+    for (const auto& seed : randomSeeds) {
+      Bytes data = Hex::toBytes("0xcfffe746");
+      Utils::appendBytes(data, Utils::sha3(seed.get()));
+      block.appendTxValidator(TxValidator(validatorAddress, data, 8080, nHeight, txValidatorPrivKey));
+    }
+    for (const auto& seed : randomSeeds) {
+      Bytes data = Hex::toBytes("0x6fc5a2d6");
+      Utils::appendBytes(data, seed);
+      block.appendTxValidator(TxValidator(validatorAddress, data, 8080, nHeight, txValidatorPrivKey));
+    }
+    block.finalize(blockValidatorPrivKey, timestamp + 1);
+    return std::make_shared<const Block>(std::move(block));
+  }
+
+  TEST_CASE("P2P Compact Block", "[p2p][compactblock]") {
+    SECTION("Compact block encoding and rebuilding") {
+      auto txs = createTxs(100);
+      auto block = createBlock(txs);
+      auto message = P2P::BroadcastEncoder::broadcastCompactBlock(block);
+      auto fullMessage = P2P::BroadcastEncoder::broadcastBlock(block);
+      REQUIRE(message.command() == P2P::BroadcastCompactBlock);
+      REQUIRE(message.size() < fullMessage.size() / 4);
+
+      auto compactBlock = P2P::BroadcastDecoder::broadcastCompactBlock(message, 8080);
+      REQUIRE(compactBlock.hash == block->hash());
+      REQUIRE(compactBlock.nHeight == block->getNHeight());
+      REQUIRE(compactBlock.txValidators == block->getTxValidators());
+      REQUIRE(compactBlock.shortTxIds.size() == txs.size());
+      for (uint64_t i = 0; i < txs.size(); i++) REQUIRE(compactBlock.shortTxIds[i] == P2P::getShortTxId(txs[i].hash()));
+
+      auto txValidators = compactBlock.txValidators;
+      Block rebuiltBlock(compactBlock.signedHeader, std::vector<TxBlock>(txs), std::move(txValidators));
+      REQUIRE(rebuiltBlock == *block);
+      REQUIRE(rebuiltBlock.getTxs() == block->getTxs());
+      REQUIRE(rebuiltBlock.getValidatorPubKey() == block->getValidatorPubKey());
+      REQUIRE(rebuiltBlock.isFinalized());
+
+      // Transactions in the wrong order (or wrong transactions) must not rebuild the block.
+      auto swappedTxs = txs;
+      std::swap(swappedTxs[0], swappedTxs[1]);
+      txValidators = compactBlock.txValidators;
+      REQUIRE_THROWS(Block(compactBlock.signedHeader, std::move(swappedTxs), std::move(txValidators)));
+    }
+
+    SECTION("RequestBlockTxs encoding") {
+      auto txs = createTxs(10);
+      auto block = createBlock(txs);
+      std::vector<uint32_t> indexes = {1, 5, 9};
+      auto request = P2P::RequestEncoder::requestBlockTxs(block->hash(), indexes);
+      auto [blockHash, decodedIndexes] = P2P::RequestDecoder::requestBlockTxs(request);
+      REQUIRE(blockHash == block->hash());
+      REQUIRE(decodedIndexes == indexes);
+
+      std::vector<TxBlock> wanted;
+      for (const auto& index : decodedIndexes) wanted.push_back(block->getTxs()[index]);
+      auto answer = P2P::AnswerEncoder::requestBlockTxs(request, wanted);
+      REQUIRE(answer.id() == request.id());
+      auto answeredTxs = P2P::AnswerDecoder::requestBlockTxs(answer, 8080);
+      REQUIRE(answeredTxs == wanted);
+    }
+  }
+}
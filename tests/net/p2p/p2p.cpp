@@ -320,6 +320,19 @@ namespace TP2P {
       REQUIRE(p2p2NodeInfo.nodeVersion == options2->getVersion());
       REQUIRE(p2p2NodeInfo.latestBlockHeight == storage2->latest()->getNHeight());
       REQUIRE(p2p2NodeInfo.latestBlockHash == storage2->latest()->hash());
+
+      // Same request, fanned out without blocking on each node.
+      std::vector<P2P::NodeInfo> fanOutInfos;
+      auto answered = p2p1->requestNodeInfoFromAll(p2p1->getSessionsIDs(),
+        [&](const P2P::NodeID& nodeId, const P2P::NodeInfo& nodeInfo) {
+          REQUIRE(nodeId == p2p2NodeId);
+          fanOutInfos.push_back(nodeInfo);
+        }
+      );
+      REQUIRE(answered == 1);
+      REQUIRE(fanOutInfos.size() == 1);
+      REQUIRE(fanOutInfos[0].latestBlockHash == storage2->latest()->hash());
+      REQUIRE(p2p1->getPendingRequestCount() == 0);
     }
 
     SECTION("10 P2P::ManagerNormal 1 P2P::ManagerDiscovery") {
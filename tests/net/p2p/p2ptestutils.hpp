@@ -0,0 +1,31 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#ifndef P2PTESTUTILS_H
+#define P2PTESTUTILS_H
+
+#include "../../../src/utils/tx.h"
+
+/// Helpers shared by the %P2P tests.
+namespace P2PTestUtils {
+  /**
+   * Create signed native transfers from the same account, with sequential nonces.
+   * @param count The number of transactions.
+   * @return The transactions.
+   */
+  inline std::vector<TxBlock> createTxs(const uint64_t& count) {
+    PrivKey txPrivKey(Hex::toBytes("0xe89ef6409c467285bcae9f80ab1cfeb3487cfe61ab28fb7d36443e1daa0c2867"));
+    Address from = Secp256k1::toAddress(Secp256k1::toUPub(txPrivKey));
+    std::vector<TxBlock> txs;
+    for (uint64_t i = 0; i < count; i++) {
+      txs.emplace_back(Address(Utils::randBytes(20)), from, Bytes(), 8080, i, 1000000000000000000, 1000000000, 1000000000, 21000, txPrivKey);
+    }
+    return txs;
+  }
+}
+
+#endif  // P2PTESTUTILS_H
@@ -0,0 +1,107 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include "../../src/libs/catch2/catch_amalgamated.hpp"
+#include "../../src/net/p2p/requesttable.h"
+
+using namespace std::chrono_literals;
+
+namespace TRequestTable {
+  std::shared_ptr<P2P::Request> makeRequest() {
+    auto message = std::make_shared<const P2P::Message>(P2P::RequestEncoder::ping());
+    return std::make_shared<P2P::Request>(
+      message->command(), message->id(), P2P::NodeID(boost::asio::ip::address::from_string("127.0.0.1"), 8080), message
+    );
+  }
+
+  TEST_CASE("P2P TimerWheel", "[p2p][timerwheel]") {
+    SECTION("TimerWheel expires timers in order") {
+      auto start = P2P::TimerWheel::clock::now();
+      P2P::TimerWheel wheel(10ms, start);
+      P2P::RequestID first(uint64_t(1)), second(uint64_t(2)), third(uint64_t(3));
+      wheel.schedule(third, start + 5000ms);
+      wheel.schedule(first, start + 30ms);
+      wheel.schedule(second, start + 700ms);
+      REQUIRE(wheel.size() == 3);
+      REQUIRE(wheel.advance(start + 20ms).empty());
+      auto expired = wheel.advance(start + 30ms);
+      REQUIRE(expired.size() == 1);
+      REQUIRE(expired[0] == first);
+      REQUIRE(wheel.advance(start + 690ms).empty());
+      expired = wheel.advance(start + 700ms);
+      REQUIRE(expired.size() == 1);
+      REQUIRE(expired[0] == second);
+      REQUIRE(wheel.advance(start + 4990ms).empty());
+      expired = wheel.advance(start + 5000ms);
+      REQUIRE(expired.size() == 1);
+      REQUIRE(expired[0] == third);
+      REQUIRE(wheel.size() == 0);
+    }
+
+    SECTION("TimerWheel never expires a timer early") {
+      auto start = P2P::TimerWheel::clock::now();
+      P2P::TimerWheel wheel(1ms, start);
+      for (uint64_t i = 1; i <= 250000; i += 997) wheel.schedule(P2P::RequestID(i), start + std::chrono::milliseconds(i));
+      uint64_t expiredCount = 0;
+      for (uint64_t now = 0; now <= 250000; now += 250) {
+        for (const auto& id : wheel.advance(start + std::chrono::milliseconds(now))) {
+          REQUIRE(id.toUint64() <= now);
+          REQUIRE(id.toUint64() > now - 250);
+          expiredCount++;
+        }
+      }
+      REQUIRE(wheel.size() == 0);
+      REQUIRE(expiredCount == 251);
+    }
+  }
+
+  TEST_CASE("P2P RequestTable", "[p2p][requesttable]") {
+    SECTION("RequestTable answered requests are removed") {
+      P2P::RequestTable table(100ms);
+      auto request = makeRequest();
+      auto future = request->answerFuture();
+      table.insert(request);
+      REQUIRE(table.contains(request->id()));
+      auto taken = table.take(request->id());
+      REQUIRE(taken == request);
+      REQUIRE(!table.contains(request->id()));
+      REQUIRE(table.take(request->id()) == nullptr);
+      REQUIRE(taken->setAnswer(request->message()));
+      REQUIRE(future.wait_for(0ms) == std::future_status::ready);
+      // Answered requests are skipped by the timer.
+      REQUIRE(table.expire(P2P::RequestTable::clock::now() + 1s) == 0);
+    }
+
+    SECTION("RequestTable expires unanswered requests") {
+      P2P::RequestTable table(100ms, 10ms);
+      auto request = makeRequest();
+      auto future = request->answerFuture();
+      table.insert(request);
+      REQUIRE(table.expire(P2P::RequestTable::clock::now()) == 0);
+      REQUIRE(table.expire(P2P::RequestTable::clock::now() + 200ms) == 1);
+      REQUIRE(table.size() == 0);
+      REQUIRE(request->isTimedOut());
+      REQUIRE_THROWS(future.get());
+      REQUIRE(!request->setAnswer(request->message()));
+    }
+
+    SECTION("RequestTable expiry thread") {
+      P2P::RequestTable table(50ms, 10ms);
+      table.start();
+      std::vector<std::future<const std::shared_ptr<const P2P::Message>>> futures;
+      for (int i = 0; i < 100; i++) {
+        auto request = makeRequest();
+        futures.push_back(request->answerFuture());
+        table.insert(request);
+      }
+      REQUIRE(table.size() == 100);
+      for (auto& future : futures) REQUIRE(future.wait_for(1s) == std::future_status::ready);
+      REQUIRE(table.size() == 0);
+      table.stop();
+    }
+  }
+}
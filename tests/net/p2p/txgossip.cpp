@@ -0,0 +1,239 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include "../../src/libs/catch2/catch_amalgamated.hpp"
+#include "../../src/net/p2p/encoding.h"
+#include "../../src/net/p2p/managernormal.h"
+#include "../../src/core/rdpos.h"
+#include "../../src/core/storage.h"
+#include "../../src/core/state.h"
+#include "../../src/utils/db.h"
+#include "p2ptestutils.hpp"
+
+// Definition from state.cpp, when linking, the compiler should find the function.
+void initialize(std::unique_ptr<DB>& db,
+                std::unique_ptr<Storage>& storage,
+                std::unique_ptr<P2P::ManagerNormal>& p2p,
+                std::unique_ptr<rdPoS>& rdpos,
+                std::unique_ptr<State>& state,
+                std::unique_ptr<Options>& options,
+                PrivKey validatorKey,
+                uint64_t serverPort,
+                bool clearDb,
+                std::string folderName);
+
+namespace TTxGossip {
+  using P2PTestUtils::createTxs;
+
+  std::string testDumpPath = Utils::getTestDumpPath();
+
+  // Every transaction from the genesis account has to carry its current nonce,
+  // so distinct valid transactions only differ by recipient.
+  TxBlock createValidTx() {
+    PrivKey txPrivKey(Hex::toBytes("0xe89ef6409c467285bcae9f80ab1cfeb3487cfe61ab28fb7d36443e1daa0c2867"));
+    Address from = Secp256k1::toAddress(Secp256k1::toUPub(txPrivKey));
+    return TxBlock(Address(Utils::randBytes(20)), from, Bytes(), 8080, 0, 1000000000000000000, 1000000000, 1000000000, 21000, txPrivKey);
+  }
+
+  // Polls a condition for up to 5 seconds, as gossip answers arrive asynchronously.
+  template <typename Condition> bool waitFor(Condition condition) {
+    for (int i = 0; i < 500; i++) {
+      if (condition()) return true;
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return condition();
+  }
+
+  TEST_CASE("P2P Tx Gossip", "[p2p][txgossip]") {
+    SECTION("NotifyTxHashes encoding") {
+      std::vector<Hash> txHashes;
+      for (const auto& tx : createTxs(50)) txHashes.push_back(tx.hash());
+      auto message = P2P::NotificationEncoder::notifyTxHashes(txHashes);
+      REQUIRE(message.type() == P2P::Notifying);
+      REQUIRE(message.command() == P2P::NotifyTxHashes);
+      REQUIRE(message.size() == 11 + (txHashes.size() * 32));
+      REQUIRE(P2P::NotificationDecoder::notifyTxHashes(message) == txHashes);
+
+      // Announcements are much smaller than the transactions themselves.
+      size_t txsSize = 0;
+      for (const auto& tx : createTxs(50)) txsSize += tx.rlpSerialize().size();
+      REQUIRE(message.size() < txsSize / 2);
+
+      // Other message types must not be parsed as announcements.
+      auto request = P2P::RequestEncoder::requestTxs(txHashes);
+      REQUIRE_THROWS(P2P::NotificationDecoder::notifyTxHashes(request));
+    }
+
+    SECTION("RequestTxs encoding") {
+      auto txs = createTxs(10);
+      std::vector<Hash> txHashes;
+      for (const auto& tx : txs) txHashes.push_back(tx.hash());
+      auto request = P2P::RequestEncoder::requestTxs(txHashes);
+      REQUIRE(request.type() == P2P::Requesting);
+      REQUIRE(request.command() == P2P::RequestTxs);
+      REQUIRE(P2P::RequestDecoder::requestTxs(request) == txHashes);
+
+      auto answer = P2P::AnswerEncoder::requestTxs(request, txs);
+      REQUIRE(answer.type() == P2P::Answering);
+      REQUIRE(answer.id() == request.id());
+      REQUIRE(P2P::AnswerDecoder::requestTxs(answer, 8080) == txs);
+
+      // Nodes answer with only the transactions they have, possibly none.
+      auto emptyAnswer = P2P::AnswerEncoder::requestTxs(request, {});
+      REQUIRE(P2P::AnswerDecoder::requestTxs(emptyAnswer, 8080).empty());
+      REQUIRE_THROWS(P2P::AnswerDecoder::requestTxs(request, 8080));
+    }
+
+    SECTION("markKnown and isKnown") {
+      std::unique_ptr<DB> db;
+      std::unique_ptr<Storage> storage;
+      std::unique_ptr<P2P::ManagerNormal> p2p;
+      std::unique_ptr<rdPoS> rdpos;
+      std::unique_ptr<State> state;
+      std::unique_ptr<Options> options;
+      initialize(db, storage, p2p, rdpos, state, options, PrivKey(), 8110, true, testDumpPath + "/txGossipKnownNode");
+      P2P::NodeID node1Id = { boost::asio::ip::address::from_string("127.0.0.1"), 8111 };
+      P2P::NodeID node2Id = { boost::asio::ip::address::from_string("127.0.0.1"), 8112 };
+      Hash txHash1 = Hash::random();
+      Hash txHash2 = Hash::random();
+
+      auto& txGossip = p2p->getTxGossip();
+      REQUIRE(!txGossip.isKnown(node1Id, txHash1));
+      txGossip.markKnown(node1Id, {txHash1});
+      REQUIRE(txGossip.isKnown(node1Id, txHash1));
+      REQUIRE(!txGossip.isKnown(node1Id, txHash2));
+      REQUIRE(!txGossip.isKnown(node2Id, txHash1));
+    }
+
+    SECTION("flush skips peers that already know the hash") {
+      std::unique_ptr<DB> db1, db2, db3;
+      std::unique_ptr<Storage> storage1, storage2, storage3;
+      std::unique_ptr<P2P::ManagerNormal> p2p1, p2p2, p2p3;
+      std::unique_ptr<rdPoS> rdpos1, rdpos2, rdpos3;
+      std::unique_ptr<State> state1, state2, state3;
+      std::unique_ptr<Options> options1, options2, options3;
+      initialize(db1, storage1, p2p1, rdpos1, state1, options1, PrivKey(), 8113, true, testDumpPath + "/txGossipFlushNode1");
+      initialize(db2, storage2, p2p2, rdpos2, state2, options2, PrivKey(), 8114, true, testDumpPath + "/txGossipFlushNode2");
+      initialize(db3, storage3, p2p3, rdpos3, state3, options3, PrivKey(), 8115, true, testDumpPath + "/txGossipFlushNode3");
+      P2P::NodeID node2Id = { boost::asio::ip::address::from_string("127.0.0.1"), 8114 };
+      P2P::NodeID node3Id = { boost::asio::ip::address::from_string("127.0.0.1"), 8115 };
+      p2p1->start();
+      p2p2->start();
+      p2p3->start();
+      // Flush by hand instead of on the announcement interval.
+      p2p1->getTxGossip().stop();
+      p2p1->connectToServer(boost::asio::ip::address::from_string("127.0.0.1"), 8114);
+      p2p1->connectToServer(boost::asio::ip::address::from_string("127.0.0.1"), 8115);
+      REQUIRE(waitFor([&]() { return p2p1->getSessionsIDs().size() == 2; }));
+
+      auto tx = createValidTx();
+      Hash txHash = tx.hash();
+      REQUIRE(state1->addTx(TxBlock(tx)) == TxInvalid::NotInvalid);
+
+      // Node 2 already has the transaction, so only node 3 is told about it.
+      auto& txGossip = p2p1->getTxGossip();
+      txGossip.markKnown(node2Id, {txHash});
+      txGossip.announce(txHash);
+      REQUIRE(txGossip.flush() == 1);
+      REQUIRE(txGossip.isKnown(node3Id, txHash));
+
+      // Node 3 fetches the transaction it was told about.
+      REQUIRE(waitFor([&]() { return state3->isTxInMempool(txHash); }));
+      REQUIRE(!state2->isTxInMempool(txHash));
+
+      // Now every peer knows it, nothing is sent again.
+      txGossip.announce(txHash);
+      REQUIRE(txGossip.flush() == 0);
+      REQUIRE(txGossip.flush() == 0);
+    }
+
+    SECTION("handleAnnouncement requests only unknown hashes") {
+      std::unique_ptr<DB> db1, db2;
+      std::unique_ptr<Storage> storage1, storage2;
+      std::unique_ptr<P2P::ManagerNormal> p2p1, p2p2;
+      std::unique_ptr<rdPoS> rdpos1, rdpos2;
+      std::unique_ptr<State> state1, state2;
+      std::unique_ptr<Options> options1, options2;
+      initialize(db1, storage1, p2p1, rdpos1, state1, options1, PrivKey(), 8116, true, testDumpPath + "/txGossipAnnounceNode1");
+      initialize(db2, storage2, p2p2, rdpos2, state2, options2, PrivKey(), 8117, true, testDumpPath + "/txGossipAnnounceNode2");
+      P2P::NodeID node1Id = { boost::asio::ip::address::from_string("127.0.0.1"), 8116 };
+      p2p1->start();
+      p2p2->start();
+      p2p1->getTxGossip().stop();
+      p2p2->getTxGossip().stop();
+      p2p2->connectToServer(boost::asio::ip::address::from_string("127.0.0.1"), 8116);
+      REQUIRE(waitFor([&]() { return p2p2->getSessionsIDs().size() == 1; }));
+
+      auto knownTx = createValidTx();
+      auto unknownTx = createValidTx();
+      REQUIRE(state1->addTx(TxBlock(knownTx)) == TxInvalid::NotInvalid);
+      REQUIRE(state1->addTx(TxBlock(unknownTx)) == TxInvalid::NotInvalid);
+      REQUIRE(state2->addTx(TxBlock(knownTx)) == TxInvalid::NotInvalid);
+
+      // Only the transaction missing from the mempool is requested.
+      auto& txGossip = p2p2->getTxGossip();
+      REQUIRE(txGossip.handleAnnouncement(node1Id, {knownTx.hash(), unknownTx.hash()}) == 1);
+      REQUIRE(txGossip.isKnown(node1Id, knownTx.hash()));
+      REQUIRE(txGossip.isKnown(node1Id, unknownTx.hash()));
+      // Either still in flight or already received, never requested twice.
+      REQUIRE(txGossip.handleAnnouncement(node1Id, {unknownTx.hash()}) == 0);
+
+      REQUIRE(waitFor([&]() { return state2->isTxInMempool(unknownTx.hash()) && txGossip.inFlightCount() == 0; }));
+      REQUIRE(txGossip.handleAnnouncement(node1Id, {knownTx.hash(), unknownTx.hash()}) == 0);
+
+      // Oversized announcements are rejected.
+      std::vector<Hash> tooMany(4097, Hash::random());
+      REQUIRE_THROWS(txGossip.handleAnnouncement(node1Id, tooMany));
+    }
+
+    SECTION("In-flight requests retry on fallbacks and expire") {
+      std::unique_ptr<DB> db1, db2, db3;
+      std::unique_ptr<Storage> storage1, storage2, storage3;
+      std::unique_ptr<P2P::ManagerNormal> p2p1, p2p2, p2p3;
+      std::unique_ptr<rdPoS> rdpos1, rdpos2, rdpos3;
+      std::unique_ptr<State> state1, state2, state3;
+      std::unique_ptr<Options> options1, options2, options3;
+      initialize(db1, storage1, p2p1, rdpos1, state1, options1, PrivKey(), 8118, true, testDumpPath + "/txGossipRetryNode1");
+      initialize(db2, storage2, p2p2, rdpos2, state2, options2, PrivKey(), 8119, true, testDumpPath + "/txGossipRetryNode2");
+      initialize(db3, storage3, p2p3, rdpos3, state3, options3, PrivKey(), 8120, true, testDumpPath + "/txGossipRetryNode3");
+      P2P::NodeID node1Id = { boost::asio::ip::address::from_string("127.0.0.1"), 8118 };
+      P2P::NodeID node3Id = { boost::asio::ip::address::from_string("127.0.0.1"), 8120 };
+      P2P::NodeID disconnectedId = { boost::asio::ip::address::from_string("127.0.0.1"), 8121 };
+      p2p1->start();
+      p2p2->start();
+      p2p3->start();
+      p2p1->getTxGossip().stop();
+      p2p2->getTxGossip().stop();
+      p2p3->getTxGossip().stop();
+      p2p2->connectToServer(boost::asio::ip::address::from_string("127.0.0.1"), 8118);
+      p2p2->connectToServer(boost::asio::ip::address::from_string("127.0.0.1"), 8120);
+      REQUIRE(waitFor([&]() { return p2p2->getSessionsIDs().size() == 2; }));
+
+      auto& txGossip = p2p2->getTxGossip();
+
+      // Node 1 announces a transaction it doesn't have, node 3 announces it too
+      // while the request is in flight, so node 3 is asked once node 1 answers empty.
+      auto tx = createValidTx();
+      REQUIRE(state3->addTx(TxBlock(tx)) == TxInvalid::NotInvalid);
+      REQUIRE(txGossip.handleAnnouncement(node1Id, {tx.hash()}) == 1);
+      REQUIRE(txGossip.handleAnnouncement(node3Id, {tx.hash()}) == 0);
+      REQUIRE(txGossip.inFlightCount() == 1);
+      REQUIRE(waitFor([&]() { return state2->isTxInMempool(tx.hash()) && txGossip.inFlightCount() == 0; }));
+      REQUIRE(!state1->isTxInMempool(tx.hash()));
+
+      // Nobody has it and there is no fallback, the entry expires with the answer.
+      auto missingTx = createValidTx();
+      REQUIRE(txGossip.handleAnnouncement(node1Id, {missingTx.hash()}) == 1);
+      REQUIRE(waitFor([&]() { return txGossip.inFlightCount() == 0; }));
+      REQUIRE(!state2->isTxInMempool(missingTx.hash()));
+
+      // The request can't be sent at all, the entry is released right away.
+      REQUIRE(txGossip.handleAnnouncement(disconnectedId, {missingTx.hash()}) == 1);
+      REQUIRE(txGossip.inFlightCount() == 0);
+    }
+  }
+}
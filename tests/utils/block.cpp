@@ -51,6 +51,8 @@ namespace TBlock {
       REQUIRE(reconstructedBlock.getTxs() == newBlock.getTxs());
       REQUIRE(reconstructedBlock.getValidatorPubKey() == newBlock.getValidatorPubKey());
       REQUIRE(reconstructedBlock.isFinalized() == newBlock.isFinalized());
+      REQUIRE(reconstructedBlock.getSize() == newBlock.serializeBlock().size());
+      REQUIRE(reconstructedBlock.getSize() == newBlock.getSize());
 
       // Compare created reconstructed block with block copy constructor
       REQUIRE(reconstructedBlock.getValidatorSig() == blockCopyConstructor.getValidatorSig());
@@ -64,6 +66,7 @@ namespace TBlock {
       REQUIRE(reconstructedBlock.getTxs() == blockCopyConstructor.getTxs());
       REQUIRE(reconstructedBlock.getValidatorPubKey() == blockCopyConstructor.getValidatorPubKey());
       REQUIRE(reconstructedBlock.isFinalized() == blockCopyConstructor.isFinalized());
+      REQUIRE(reconstructedBlock.getSize() == blockCopyConstructor.getSize());
 
       std::shared_ptr<Block> blockPtr = std::make_shared<Block>(std::move(newBlock));
 
@@ -130,6 +133,8 @@ namespace TBlock {
       REQUIRE(reconstructedBlock.getTxs() == newBlock.getTxs());
       REQUIRE(reconstructedBlock.getValidatorPubKey() == newBlock.getValidatorPubKey());
       REQUIRE(reconstructedBlock.isFinalized() == newBlock.isFinalized());
+      REQUIRE(reconstructedBlock.getSize() == newBlock.serializeBlock().size());
+      REQUIRE(reconstructedBlock.getSize() == newBlock.getSize());
 
       // Compare created reconstructed block with block copy constructor
       REQUIRE(reconstructedBlock.getValidatorSig() == blockCopyConstructor.getValidatorSig());
@@ -143,6 +148,7 @@ namespace TBlock {
       REQUIRE(reconstructedBlock.getTxs() == blockCopyConstructor.getTxs());
       REQUIRE(reconstructedBlock.getValidatorPubKey() == blockCopyConstructor.getValidatorPubKey());
       REQUIRE(reconstructedBlock.isFinalized() == blockCopyConstructor.isFinalized());
+      REQUIRE(reconstructedBlock.getSize() == blockCopyConstructor.getSize());
 
       std::shared_ptr<Block> blockPtr = std::make_shared<Block>(std::move(newBlock));
 
@@ -251,6 +257,8 @@ namespace TBlock {
       REQUIRE(reconstructedBlock.getTxs() == newBlock.getTxs());
       REQUIRE(reconstructedBlock.getValidatorPubKey() == newBlock.getValidatorPubKey());
       REQUIRE(reconstructedBlock.isFinalized() == newBlock.isFinalized());
+      REQUIRE(reconstructedBlock.getSize() == newBlock.serializeBlock().size());
+      REQUIRE(reconstructedBlock.getSize() == newBlock.getSize());
 
       // Compare created reconstructed block with block copy constructor
       REQUIRE(reconstructedBlock.getValidatorSig() == blockCopyConstructor.getValidatorSig());
@@ -264,6 +272,7 @@ namespace TBlock {
       REQUIRE(reconstructedBlock.getTxs() == blockCopyConstructor.getTxs());
       REQUIRE(reconstructedBlock.getValidatorPubKey() == blockCopyConstructor.getValidatorPubKey());
       REQUIRE(reconstructedBlock.isFinalized() == blockCopyConstructor.isFinalized());
+      REQUIRE(reconstructedBlock.getSize() == blockCopyConstructor.getSize());
 
       std::shared_ptr<Block> blockPtr = std::make_shared<Block>(std::move(newBlock));
 
@@ -389,6 +398,8 @@ namespace TBlock {
       REQUIRE(reconstructedBlock.getTxs() == newBlock.getTxs());
       REQUIRE(reconstructedBlock.getValidatorPubKey() == newBlock.getValidatorPubKey());
       REQUIRE(reconstructedBlock.isFinalized() == newBlock.isFinalized());
+      REQUIRE(reconstructedBlock.getSize() == newBlock.serializeBlock().size());
+      REQUIRE(reconstructedBlock.getSize() == newBlock.getSize());
 
       // Compare created reconstructed block with block copy constructor
       REQUIRE(reconstructedBlock.getValidatorSig() == blockCopyConstructor.getValidatorSig());
@@ -402,6 +413,7 @@ namespace TBlock {
       REQUIRE(reconstructedBlock.getTxs() == blockCopyConstructor.getTxs());
       REQUIRE(reconstructedBlock.getValidatorPubKey() == blockCopyConstructor.getValidatorPubKey());
       REQUIRE(reconstructedBlock.isFinalized() == blockCopyConstructor.isFinalized());
+      REQUIRE(reconstructedBlock.getSize() == blockCopyConstructor.getSize());
 
       std::shared_ptr<Block> blockPtr = std::make_shared<Block>(std::move(newBlock));
 
@@ -545,6 +557,8 @@ namespace TBlock {
       REQUIRE(reconstructedBlock.getTxs() == newBlock.getTxs());
       REQUIRE(reconstructedBlock.getValidatorPubKey() == newBlock.getValidatorPubKey());
       REQUIRE(reconstructedBlock.isFinalized() == newBlock.isFinalized());
+      REQUIRE(reconstructedBlock.getSize() == newBlock.serializeBlock().size());
+      REQUIRE(reconstructedBlock.getSize() == newBlock.getSize());
 
       // Compare created reconstructed block with block copy constructor
       REQUIRE(reconstructedBlock.getValidatorSig() == blockCopyConstructor.getValidatorSig());
@@ -558,6 +572,7 @@ namespace TBlock {
       REQUIRE(reconstructedBlock.getTxs() == blockCopyConstructor.getTxs());
       REQUIRE(reconstructedBlock.getValidatorPubKey() == blockCopyConstructor.getValidatorPubKey());
       REQUIRE(reconstructedBlock.isFinalized() == blockCopyConstructor.isFinalized());
+      REQUIRE(reconstructedBlock.getSize() == blockCopyConstructor.getSize());
 
       std::shared_ptr<Block> blockPtr = std::make_shared<Block>(std::move(newBlock));
 
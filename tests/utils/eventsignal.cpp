@@ -0,0 +1,44 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include <atomic>
+#include <future>
+
+#include "../../src/utils/eventsignal.h"
+#include "../../src/libs/catch2/catch_amalgamated.hpp"
+
+namespace TEventSignal {
+  TEST_CASE("EventSignal Class", "[utils][eventsignal]") {
+    SECTION("EventSignal sequence and timeout") {
+      EventSignal signal;
+      uint64_t seen = signal.sequence();
+      REQUIRE(!signal.waitFor(seen, std::chrono::milliseconds(10)));
+      signal.notify();
+      REQUIRE(signal.sequence() == seen + 1);
+      // An event notified before waiting is not lost.
+      REQUIRE(signal.waitFor(seen, std::chrono::milliseconds(0)));
+      signal.wait(seen);
+    }
+
+    SECTION("EventSignal wakes up waiters") {
+      EventSignal signal;
+      std::atomic<int> value = 0;
+      auto waiter = std::async(std::launch::async, [&]{
+        while (true) {
+          uint64_t seen = signal.sequence();
+          if (value == 3) return true;
+          if (!signal.waitFor(seen, std::chrono::seconds(5))) return false;
+        }
+      });
+      for (int i = 0; i < 3; i++) {
+        value++;
+        signal.notify();
+      }
+      REQUIRE(waiter.get());
+    }
+  }
+}
@@ -12,6 +12,20 @@ See the LICENSE.txt file in the project root for more information.
 using Catch::Matchers::Equals;
 
 namespace THex {
+  // Reference nibble-by-nibble conversion, to check the table-driven/SIMD one against.
+  std::string referenceHex(const Bytes& bytes) {
+    static const char* digits = "0123456789abcdef";
+    std::string ret;
+    for (const Byte& b : bytes) { ret += digits[b >> 4]; ret += digits[b & 0x0f]; }
+    return ret;
+  }
+
+  Bytes randomBytes(const size_t& size) {
+    Bytes ret(size);
+    for (size_t i = 0; i < size; i++) ret[i] = uint8_t((i * 131 + 7) ^ (i >> 3));
+    return ret;
+  }
+
   TEST_CASE("Hex Class", "[utils][hex]") {
     SECTION("Hex Default Constructor") {
       Hex hex;
@@ -196,6 +210,56 @@ namespace THex {
       REQUIRE_THAT(hex.get(), Equals("12345678"));
       REQUIRE_THAT(hexStrict.get(), Equals("0x12345678"));
     }
+
+    SECTION("Hex conversion of every size and byte value") {
+      // Sizes cover the SIMD blocks (16/32 bytes) and the leftovers handled one by one
+      for (size_t size = 0; size <= 200; size++) {
+        Bytes bytes = randomBytes(size);
+        std::string expected = referenceHex(bytes);
+        Hex hex = Hex::fromBytes(bytes);
+        REQUIRE(hex.get() == expected);
+        REQUIRE(Hex::fromBytes(bytes, true).get() == "0x" + expected);
+        REQUIRE(Hex::isValid(expected));
+        REQUIRE(Hex::toBytes(expected) == bytes);
+        REQUIRE(hex.bytes() == bytes);
+        std::string upper = expected;
+        std::transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
+        REQUIRE(Hex::toBytes("0x" + upper) == bytes);
+      }
+      Bytes all(256);
+      for (int i = 0; i < 256; i++) all[i] = uint8_t(i);
+      REQUIRE(Hex::fromBytes(all).get() == referenceHex(all));
+      REQUIRE(Hex::toBytes(referenceHex(all)) == all);
+      REQUIRE(Hex::toBytes("abc") == Bytes{0x0a, 0xbc}); // Odd sizes start with a single nibble
+    }
+
+    SECTION("Hex rejects every non-hex char at every position") {
+      std::string valid = referenceHex(randomBytes(50));
+      for (int c = 0; c < 256; c++) {
+        if (std::isxdigit(c)) continue;
+        for (size_t pos = 0; pos < valid.size(); pos += 7) {
+          std::string invalid = valid;
+          invalid[pos] = char(c);
+          REQUIRE(!Hex::isValid(invalid));
+          REQUIRE_THROWS(Hex::toBytes(invalid));
+        }
+      }
+    }
+  }
+
+  // Hidden benchmarks, run with `orbitersdkd-tests "[bench]"`.
+  TEST_CASE("Hex Benchmarks", "[.][bench][utils][hex]") {
+    const Bytes hash = randomBytes(32);
+    const Bytes payload = randomBytes(100 * 1024);
+    const std::string hashHex = referenceHex(hash);
+    const std::string payloadHex = referenceHex(payload);
+    BENCHMARK("Hex::fromBytes 32 bytes") { return Hex::fromBytes(hash, true); };
+    BENCHMARK("Hex::toBytes 32 bytes") { return Hex::toBytes(hashHex); };
+    BENCHMARK("Hex::isValid 32 bytes") { return Hex::isValid(hashHex); };
+    BENCHMARK("Reference encoding 100 KB") { return referenceHex(payload); };
+    BENCHMARK("Hex::fromBytes 100 KB") { return Hex::fromBytes(payload, true); };
+    BENCHMARK("Hex::toBytes 100 KB") { return Hex::toBytes(payloadHex); };
+    BENCHMARK("Hex::isValid 100 KB") { return Hex::isValid(payloadHex); };
   }
 }
 
@@ -0,0 +1,129 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include "../../src/libs/catch2/catch_amalgamated.hpp"
+#include "../../src/utils/logger.h"
+#include "../../src/utils/utils.h"
+
+#include <thread>
+
+namespace TLogger {
+  TEST_CASE("RingBuffer Class", "[utils][logger]") {
+    SECTION("RingBuffer push and pop in order") {
+      RingBuffer<uint64_t> buffer(5);
+      REQUIRE(buffer.capacity() == 8);
+      uint64_t value = 0;
+      REQUIRE(!buffer.pop(value));
+      for (uint64_t round = 0; round < 3; round++) {
+        for (uint64_t i = 0; i < 8; i++) REQUIRE(buffer.push(uint64_t(i)));
+        REQUIRE(buffer.size() == 8);
+        for (uint64_t i = 0; i < 8; i++) { REQUIRE(buffer.pop(value)); REQUIRE(value == i); }
+        REQUIRE(!buffer.pop(value));
+      }
+    }
+
+    SECTION("RingBuffer drops and counts when full") {
+      RingBuffer<std::string> buffer(4);
+      for (int i = 0; i < 4; i++) REQUIRE(buffer.push(std::to_string(i)));
+      std::string rejected = "rejected";
+      REQUIRE(!buffer.push(std::move(rejected)));
+      REQUIRE(!buffer.push("rejected"));
+      REQUIRE(buffer.takeDropped() == 2);
+      REQUIRE(buffer.takeDropped() == 0);
+      std::string value;
+      REQUIRE(buffer.pop(value));
+      REQUIRE(value == "0");
+      REQUIRE(buffer.push("4"));
+    }
+
+    SECTION("RingBuffer with concurrent producers") {
+      RingBuffer<uint64_t> buffer(1024);
+      const uint64_t producers = 4, perProducer = 100000;
+      std::vector<std::thread> threads;
+      for (uint64_t p = 0; p < producers; p++) threads.emplace_back([&buffer, p]() {
+        for (uint64_t i = 0; i < perProducer; i++) while (!buffer.push(p * perProducer + i)) std::this_thread::yield();
+      });
+      // Values of each producer must come out in the order they were pushed
+      std::vector<uint64_t> next(producers, 0);
+      uint64_t received = 0, value = 0;
+      while (received < producers * perProducer) {
+        if (!buffer.pop(value)) continue;
+        uint64_t p = value / perProducer;
+        REQUIRE(value % perProducer == next[p]);
+        next[p]++;
+        received++;
+      }
+      for (std::thread& thread : threads) thread.join();
+      REQUIRE(!buffer.pop(value));
+    }
+  }
+
+  TEST_CASE("RotatingFileSink Class", "[utils][logger]") {
+    SECTION("RotatingFileSink rotates by size") {
+      std::string dir = Utils::getTestDumpPath() + "/rotatingFileSinkTest";
+      std::filesystem::remove_all(dir);
+      std::filesystem::create_directories(dir);
+      std::string path = dir + "/test.log";
+      {
+        RotatingFileSink sink(path, 100, 2);
+        for (int i = 0; i < 10; i++) sink.write(std::string(40, char('a' + i)) + "\n");
+        sink.flush();
+        REQUIRE(sink.size() == 82);
+      }
+      std::ifstream current(path), first(path + ".1"), second(path + ".2");
+      std::string line;
+      std::getline(current, line);
+      REQUIRE(line == std::string(40, 'i'));
+      std::getline(first, line);
+      REQUIRE(line == std::string(40, 'g'));
+      std::getline(second, line);
+      REQUIRE(line == std::string(40, 'e'));
+      REQUIRE(!std::filesystem::exists(path + ".3"));
+
+      // Reopening appends to the existing file and keeps counting its size
+      RotatingFileSink sink(path, 100, 2);
+      REQUIRE(sink.size() == 82);
+    }
+  }
+
+  TEST_CASE("Logger Levels", "[utils][logger]") {
+    SECTION("Logger general and per-component levels") {
+      REQUIRE(Logger::isEnabled(LogType::DEBUG, Log::state));
+      REQUIRE(!Logger::isEnabled(LogType::TRACE, Log::state));
+      Logger::setLogLevel(LogType::WARNING);
+      REQUIRE(!Logger::isEnabled(LogType::INFO, Log::state));
+      REQUIRE(Logger::isEnabled(LogType::WARNING, Log::state));
+      Logger::setLogLevel(Log::state, LogType::DEBUG);
+      REQUIRE(Logger::isEnabled(LogType::DEBUG, Log::state));
+      REQUIRE(!Logger::isEnabled(LogType::INFO, Log::storage));
+      Logger::setLogLevel(Log::storage, LogType::ERROR);
+      REQUIRE(!Logger::isEnabled(LogType::WARNING, Log::storage));
+
+      // Disabled messages are never built
+      bool built = false;
+      auto message = [&built]() { built = true; return std::string("message"); };
+      LOGINFO(Log::storage, message());
+      REQUIRE(!built);
+      LOGINFO(Log::state, message());
+      REQUIRE(built);
+
+      Logger::clearComponentLevels();
+      Logger::setLogLevel(LogType::DEBUG);
+      REQUIRE(Logger::isEnabled(LogType::DEBUG, Log::storage));
+      Logger::flush();
+    }
+
+    SECTION("Logger level names") {
+      for (LogType type : {LogType::TRACE, LogType::DEBUG, LogType::INFO, LogType::WARNING, LogType::ERROR}) {
+        REQUIRE(Logger::getLevel(std::string(Logger::getLevelName(type))) == type);
+      }
+      REQUIRE(Logger::getLevelName(LogType::WARNING) == "WARNING");
+      REQUIRE_THROWS(Logger::getLevel("warning"));
+      REQUIRE_THROWS(Logger::getLevel("VERBOSE"));
+    }
+  }
+}
@@ -0,0 +1,84 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include "../../src/libs/catch2/catch_amalgamated.hpp"
+#include "../../src/utils/metrics.h"
+
+#include <thread>
+
+namespace TMetrics {
+  TEST_CASE("Metrics Tests", "[utils][metrics]") {
+    SECTION("Counter and Gauge") {
+      Counter& counter = Metrics::counter("test_counter_total", "A test counter");
+      REQUIRE(&counter == &Metrics::counter("test_counter_total", "A test counter"));
+      uint64_t before = counter.get();
+      std::vector<std::thread> threads;
+      for (int i = 0; i < 4; i++) threads.emplace_back([&counter]() { for (int j = 0; j < 10000; j++) counter.inc(); });
+      for (std::thread& thread : threads) thread.join();
+      counter.inc(5);
+      REQUIRE(counter.get() - before == 40005);
+
+      Gauge& gauge = Metrics::gauge("test_gauge", "A test gauge", {{"kind", "test"}});
+      gauge.set(10);
+      gauge.inc(3);
+      gauge.dec(15);
+      REQUIRE(gauge.get() == -2);
+      REQUIRE_THROWS(Metrics::counter("test_gauge", "A test gauge"));
+    }
+
+    SECTION("Histogram buckets") {
+      static constexpr std::array<uint64_t, 3> bounds = {10, 100, 1000};
+      Histogram histogram(bounds);
+      for (uint64_t value : {0, 10, 11, 100, 500, 1000, 1001, 50000}) histogram.observe(value);
+      REQUIRE(histogram.getBucket(0) == 2);
+      REQUIRE(histogram.getBucket(1) == 2);
+      REQUIRE(histogram.getBucket(2) == 2);
+      REQUIRE(histogram.getBucket(3) == 2);
+      REQUIRE(histogram.getCount() == 8);
+      REQUIRE(histogram.getSum() == 52622);
+    }
+
+    SECTION("Prometheus text format") {
+      static constexpr std::array<uint64_t, 2> bounds = {1000, 1000000};
+      Histogram& histogram = Metrics::histogram(
+        "test_latency_seconds", "A test \"latency\"", bounds, {{"method", "a\"b"}}, 1e-6
+      );
+      histogram.observe(500);
+      histogram.observe(2000);
+      histogram.observe(3000000);
+      Metrics::counter("test_requests_total", "Requests", {{"code", "200"}}).inc(3);
+      Metrics::counter("test_requests_total", "Requests", {{"code", "500"}}).inc();
+      std::string text = Metrics::serialize();
+      REQUIRE(text.find(
+        "# HELP test_latency_seconds A test \"latency\"\n"
+        "# TYPE test_latency_seconds histogram\n"
+        "test_latency_seconds_bucket{method=\"a\\\"b\",le=\"0.001\"} 1\n"
+        "test_latency_seconds_bucket{method=\"a\\\"b\",le=\"1\"} 2\n"
+        "test_latency_seconds_bucket{method=\"a\\\"b\",le=\"+Inf\"} 3\n"
+        "test_latency_seconds_sum{method=\"a\\\"b\"} 3.0025\n"
+        "test_latency_seconds_count{method=\"a\\\"b\"} 3\n"
+      ) != std::string::npos);
+      REQUIRE(text.find(
+        "# HELP test_requests_total Requests\n"
+        "# TYPE test_requests_total counter\n"
+        "test_requests_total{code=\"200\"} 3\n"
+        "test_requests_total{code=\"500\"} 1\n"
+      ) != std::string::npos);
+    }
+
+    SECTION("HistogramTimer") {
+      static constexpr std::array<uint64_t, 1> bounds = {1000000};
+      Histogram histogram(bounds);
+      auto start = std::chrono::steady_clock::now();
+      { HistogramTimer timer(histogram); }
+      histogram.observeSince(start);
+      REQUIRE(histogram.getCount() == 2);
+      REQUIRE(histogram.getBucket(0) == 2);
+      REQUIRE(start > std::chrono::steady_clock::time_point());
+    }
+  }
+}
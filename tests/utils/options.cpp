@@ -36,6 +36,40 @@ namespace TOptions {
       for (const auto& privKey : validatorPrivKeys_) {
         genesisValidators.push_back(Secp256k1::toAddress(Secp256k1::toUPub(privKey)));
       }
+      BlockBuilderOptions blockBuilderOptions;
+      blockBuilderOptions.maxBlockBytes = 1024 * 1024;
+      blockBuilderOptions.maxBlockTxs = 500;
+      blockBuilderOptions.maxBlockGas = 21000 * 500;
+      blockBuilderOptions.minBlockInterval = std::chrono::milliseconds(100);
+      blockBuilderOptions.targetBlockInterval = std::chrono::milliseconds(500);
+      blockBuilderOptions.maxBlockInterval = std::chrono::milliseconds(5000);
+      RPCOptions rpcOptions;
+      rpcOptions.maxBodyBytes = 4 * 1024 * 1024;
+      rpcOptions.maxBatchSize = 250;
+      rpcOptions.maxPipelinedRequests = 16;
+      rpcOptions.ioThreads = 2;
+      rpcOptions.workerThreads = 6;
+      rpcOptions.callThreads = 3;
+      rpcOptions.logsThreads = 1;
+      rpcOptions.maxSubscriptions = 8;
+      rpcOptions.maxQueuedMessages = 128;
+      rpcOptions.maxFilters = 16;
+      rpcOptions.filterTimeout = 60;
+      rpcOptions.maxFilterChanges = 500;
+      rpcOptions.cacheBytes = 4096;
+      rpcOptions.accessLogSampling = 10;
+      rpcOptions.rateLimit = 50;
+      rpcOptions.rateLimitBurst = 100;
+      rpcOptions.rateLimitCosts = {{"eth_call", 5}, {"eth_getLogs", 25}};
+      rpcOptions.maxConnections = 256;
+      rpcOptions.maxConnectionsPerPeer = 8;
+      rpcOptions.idleTimeout = 10;
+      rpcOptions.wsIdleTimeout = 120;
+      rpcOptions.enableDumpTrace = true;
+      rpcOptions.traceFile = "trace.json";
+      LogOptions logOptions;
+      logOptions.logLevel = LogType::INFO;
+      logOptions.componentLevels = {{Log::P2PManager, LogType::TRACE}, {Log::state, LogType::WARNING}};
       Options optionsWithPrivKey(
         testDumpPath + "/optionClassFromFileWithPrivKey",
         "OrbiterSDK/cpp/linux_x86-64/0.2.0",
@@ -52,7 +86,10 @@ namespace TOptions {
         genesisPrivKey,
         genesisBalances,
         genesisValidators,
-        PrivKey(Hex::toBytes("0xb254f12b4ca3f0120f305cabf1188fe74f0bd38e58c932a3df79c4c55df8fa66"))
+        PrivKey(Hex::toBytes("0xb254f12b4ca3f0120f305cabf1188fe74f0bd38e58c932a3df79c4c55df8fa66")),
+        blockBuilderOptions,
+        rpcOptions,
+        logOptions
       );
 
       Options optionsFromFileWithPrivKey(Options::fromFile(testDumpPath + "/optionClassFromFileWithPrivKey"));
@@ -70,6 +107,40 @@ namespace TOptions {
       REQUIRE(optionsFromFileWithPrivKey.getGenesisBlock() == optionsWithPrivKey.getGenesisBlock());
       REQUIRE(optionsFromFileWithPrivKey.getGenesisBalances() == optionsWithPrivKey.getGenesisBalances());
       REQUIRE(optionsFromFileWithPrivKey.getGenesisValidators() == optionsWithPrivKey.getGenesisValidators());
+      const BlockBuilderOptions& blockBuilderFromFile = optionsFromFileWithPrivKey.getBlockBuilderOptions();
+      REQUIRE(blockBuilderFromFile.maxBlockBytes == blockBuilderOptions.maxBlockBytes);
+      REQUIRE(blockBuilderFromFile.maxBlockTxs == blockBuilderOptions.maxBlockTxs);
+      REQUIRE(blockBuilderFromFile.maxBlockGas == blockBuilderOptions.maxBlockGas);
+      REQUIRE(blockBuilderFromFile.minBlockInterval == blockBuilderOptions.minBlockInterval);
+      REQUIRE(blockBuilderFromFile.targetBlockInterval == blockBuilderOptions.targetBlockInterval);
+      REQUIRE(blockBuilderFromFile.maxBlockInterval == blockBuilderOptions.maxBlockInterval);
+      const RPCOptions& rpcFromFile = optionsFromFileWithPrivKey.getRPCOptions();
+      REQUIRE(rpcFromFile.maxBodyBytes == rpcOptions.maxBodyBytes);
+      REQUIRE(rpcFromFile.maxBatchSize == rpcOptions.maxBatchSize);
+      REQUIRE(rpcFromFile.maxPipelinedRequests == rpcOptions.maxPipelinedRequests);
+      REQUIRE(rpcFromFile.ioThreads == rpcOptions.ioThreads);
+      REQUIRE(rpcFromFile.workerThreads == rpcOptions.workerThreads);
+      REQUIRE(rpcFromFile.callThreads == rpcOptions.callThreads);
+      REQUIRE(rpcFromFile.logsThreads == rpcOptions.logsThreads);
+      REQUIRE(rpcFromFile.maxSubscriptions == rpcOptions.maxSubscriptions);
+      REQUIRE(rpcFromFile.maxQueuedMessages == rpcOptions.maxQueuedMessages);
+      REQUIRE(rpcFromFile.maxFilters == rpcOptions.maxFilters);
+      REQUIRE(rpcFromFile.filterTimeout == rpcOptions.filterTimeout);
+      REQUIRE(rpcFromFile.maxFilterChanges == rpcOptions.maxFilterChanges);
+      REQUIRE(rpcFromFile.cacheBytes == rpcOptions.cacheBytes);
+      REQUIRE(rpcFromFile.accessLogSampling == rpcOptions.accessLogSampling);
+      REQUIRE(rpcFromFile.rateLimit == rpcOptions.rateLimit);
+      REQUIRE(rpcFromFile.rateLimitBurst == rpcOptions.rateLimitBurst);
+      REQUIRE(rpcFromFile.rateLimitCosts == rpcOptions.rateLimitCosts);
+      REQUIRE(rpcFromFile.maxConnections == rpcOptions.maxConnections);
+      REQUIRE(rpcFromFile.maxConnectionsPerPeer == rpcOptions.maxConnectionsPerPeer);
+      REQUIRE(rpcFromFile.idleTimeout == rpcOptions.idleTimeout);
+      REQUIRE(rpcFromFile.wsIdleTimeout == rpcOptions.wsIdleTimeout);
+      REQUIRE(rpcFromFile.enableDumpTrace == rpcOptions.enableDumpTrace);
+      REQUIRE(rpcFromFile.traceFile == rpcOptions.traceFile);
+      const LogOptions& logFromFile = optionsFromFileWithPrivKey.getLogOptions();
+      REQUIRE(logFromFile.logLevel == logOptions.logLevel);
+      REQUIRE(logFromFile.componentLevels == logOptions.componentLevels);
     }
   }
 }
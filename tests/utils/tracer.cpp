@@ -0,0 +1,138 @@
+/*
+Copyright (c) [2023-2024] [Sparq Network]
+
+This software is distributed under the MIT License.
+See the LICENSE.txt file in the project root for more information.
+*/
+
+#include "../../src/libs/catch2/catch_amalgamated.hpp"
+#include "../../src/libs/json.hpp"
+#include "../../src/utils/tracer.h"
+
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <thread>
+
+namespace TTracer {
+  // Read a dumped trace back
+  nlohmann::json readTrace(const std::string& path) {
+    std::ifstream file(path);
+    return nlohmann::json::parse(file);
+  }
+
+  TEST_CASE("Tracer Class", "[utils][tracer]") {
+    const std::string path = "testTracer.json";
+
+    SECTION("Tracer disabled records nothing") {
+      Tracer::setEnabled(false);
+      Tracer::clear();
+      {
+        TraceSpan span("disabled");
+        REQUIRE(!span.active());
+        span.attr("key", "value").attr("number", 10);
+      }
+      REQUIRE(Tracer::dump(path) == 0);
+      nlohmann::json trace = readTrace(path);
+      REQUIRE(trace["traceEvents"].empty());
+      std::filesystem::remove(path);
+    }
+
+    SECTION("Tracer records nested spans and attributes") {
+      Tracer::clear();
+      Tracer::setEnabled(true);
+      {
+        TraceSpan outer("outer");
+        REQUIRE(outer.active());
+        outer.attr("height", uint64_t(42)).attr("hash", "0xabcd");
+        {
+          TraceSpan inner("inner");
+          std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+      }
+      Tracer::setEnabled(false);
+      REQUIRE(Tracer::dump(path) == 2);
+      nlohmann::json trace = readTrace(path);
+      REQUIRE(trace["displayTimeUnit"] == "ms");
+      REQUIRE(trace["traceEvents"].size() == 2);
+      // Spans are recorded when they end, so the inner one comes first
+      const nlohmann::json& inner = trace["traceEvents"][0];
+      const nlohmann::json& outer = trace["traceEvents"][1];
+      REQUIRE(inner["name"] == "inner");
+      REQUIRE(outer["name"] == "outer");
+      REQUIRE(inner["ph"] == "X");
+      REQUIRE(inner["tid"] == outer["tid"]);
+      REQUIRE(inner["dur"].get<double>() >= 1000);
+      REQUIRE(outer["ts"].get<double>() <= inner["ts"].get<double>());
+      REQUIRE(outer["ts"].get<double>() + outer["dur"].get<double>() >= inner["ts"].get<double>() + inner["dur"].get<double>());
+      REQUIRE(outer["args"]["height"] == "42");
+      REQUIRE(outer["args"]["hash"] == "0xabcd");
+      REQUIRE(!inner.contains("args"));
+      std::filesystem::remove(path);
+    }
+
+    SECTION("Tracer keeps spans of every thread") {
+      Tracer::clear();
+      Tracer::setEnabled(true);
+      std::vector<std::thread> threads;
+      for (int i = 0; i < 4; i++) threads.emplace_back([]() {
+        for (int j = 0; j < 100; j++) TraceSpan span("worker");
+      });
+      for (auto& thread : threads) thread.join();
+      Tracer::setEnabled(false);
+      // The threads are gone but their spans are still there
+      REQUIRE(Tracer::dump(path) == 400);
+      nlohmann::json trace = readTrace(path);
+      std::set<uint64_t> tids;
+      for (const auto& event : trace["traceEvents"]) tids.insert(event["tid"].get<uint64_t>());
+      REQUIRE(tids.size() == 4);
+      std::filesystem::remove(path);
+    }
+
+    SECTION("Tracer overwrites the oldest spans") {
+      Tracer::clear();
+      Tracer::setEnabled(true);
+      for (uint64_t i = 0; i < Tracer::eventsPerThread; i++) TraceSpan span("old");
+      for (uint64_t i = 0; i < 10; i++) TraceSpan span("new");
+      Tracer::setEnabled(false);
+      REQUIRE(Tracer::dump(path) == Tracer::eventsPerThread);
+      nlohmann::json trace = readTrace(path);
+      uint64_t newSpans = 0;
+      for (const auto& event : trace["traceEvents"]) if (event["name"] == "new") newSpans++;
+      REQUIRE(newSpans == 10);
+      Tracer::clear();
+      std::filesystem::remove(path);
+    }
+
+    SECTION("Tracer forgets finished threads") {
+      Tracer::clear();
+      const uint64_t threads = Tracer::getThreadCount();
+      Tracer::setEnabled(true);
+      // Threads whose spans were cleared are forgotten when they end
+      std::thread([]() {
+        { TraceSpan span("cleared"); }
+        Tracer::clear();
+      }).join();
+      REQUIRE(Tracer::getThreadCount() == threads);
+      // Threads with spans left are kept until they are dumped
+      for (int i = 0; i < 4; i++) std::thread([]() { TraceSpan span("finished"); }).join();
+      Tracer::setEnabled(false);
+      REQUIRE(Tracer::getThreadCount() == threads + 4);
+      REQUIRE(Tracer::dump(path) == 4);
+      REQUIRE(Tracer::getThreadCount() == threads);
+      REQUIRE(Tracer::dump(path) == 0);
+      // Or cleared
+      Tracer::setEnabled(true);
+      std::thread([]() { TraceSpan span("finished"); }).join();
+      Tracer::setEnabled(false);
+      REQUIRE(Tracer::getThreadCount() == threads + 1);
+      Tracer::clear();
+      REQUIRE(Tracer::getThreadCount() == threads);
+      std::filesystem::remove(path);
+    }
+
+    SECTION("Tracer dump throws on invalid path") {
+      REQUIRE_THROWS(Tracer::dump("nonexistent/dir/trace.json"));
+    }
+  }
+}